@@ -7,7 +7,7 @@
  *
  * Basic summary:
  *
- * - Reads data from ADS1115 ADCs (addresses 0x48, 0x49, 0x4A) 10x per second
+ * - Reads data from ADS1x1x ADCs (set by ADC_CHIPS, default ADS1115s at 0x48, 0x49, 0x4A) and internal ADCs 5x per second
  * - Averages data
  * - Stores data to SD card
  * - Sends data to Thingspeak
@@ -56,6 +56,7 @@
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
 #include "DLDataField.Manager.h"
+#include "DLDataField.Burst.h"
 
 #include "DLSettings.h"
 #include "DLSettings.Global.h"
@@ -65,6 +66,9 @@
 #include "DLSettings.DataChannels.h"
 
 #include "DLSensor.ADS1x1x.h"
+#include "DLSensor.ADS1x1x.Scanner.h"
+#include "DLSensor.ADS1x1x.Topology.h"
+#include "DLSensor.I2C.h"
 #include "DLSensor.LinkItONE.h"
 #include "DLSensor.Thermistor.h"
 
@@ -102,6 +106,7 @@ static NetworkInterface * s_gprsConnection;
 static char * s_requestBuffer;
 static uint32_t s_uploadBufferSize;
 static float * s_uploadData;
+static char const ** s_uploadDataKeys;
 
 static bool s_debugUpload = false;
 static bool s_debugGPS = false;
@@ -109,18 +114,26 @@ static bool s_debugGPS = false;
 static bool s_disable_upload = false;
 static bool s_disable_adc_reads = false;
 
-static ADS1115 s_ADCs[] = {
-    ADS1115(0x48),
-    ADS1115(0x49),
-    ADS1115(0x4A)
-};
+// The ADS1x1x ADCs come from the ADC_CHIPS setting (only those that respond, if ADC_PROBE is set)
+#define DEFAULT_ADC_CHIPS "ADS1115@0x48, ADS1115@0x49, ADS1115@0x4A"
+
+static ADS1x1x * s_ADCs[MAX_ADS1x1x_CHIPS];
+static uint8_t s_ADCFirstChannels[MAX_ADS1x1x_CHIPS];
+static uint8_t s_ADCCount = 0;
+
+static ADS1x1xScanner s_ADCScanner;
 
-static LinkItONEADC s_internalADCs[] = {
+#define MAX_INTERNAL_ADCS (3)
+
+static LinkItONEADC s_internalADCs[MAX_INTERNAL_ADCS] = {
     LinkItONEADC(A0),
     LinkItONEADC(A1),
     LinkItONEADC(A2)
 };
 
+static uint8_t s_internalADCCount = MAX_INTERNAL_ADCS;
+static uint8_t s_internalFirstChannel = 0;
+
 static uint32_t s_uploadInterval = 0;
 
 static TM s_gpsTime;
@@ -239,48 +252,89 @@ static void heartbeatTaskFn(void)
     ledState = !ledState;
 }
 
+// One reading per channel (indexed by channel number - 1), allocated by setupADCs to cover every channel in use.
+// Channels with a sample divisor are not read on every scan, and keep their last reading until they are.
+static int32_t * s_allData = NULL;
+static uint16_t s_allDataCount = 0;
+
 static void readFromADCsTaskFn(void)
 {
     uint8_t adc = 0;
     uint8_t ch = 0;
-    uint8_t field = 0;
-    int32_t allData[15] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14};
+    uint8_t channel = 0;
+    uint16_t scanMask = 0;
 
-    if (!s_disable_adc_reads)
+    if (s_disable_adc_reads)
     {
-        // Read the ADC1x1x ICs for fields 1 - 12
-        for (adc = 0; adc < 3; adc++)
+        APP_Data_NewDataArray(s_allData);
+        return;
+    }
+
+    // The ADC1x1x ICs are read by the scanner over the next few loops (see collectADCScan)
+    for (adc = 0; adc < s_ADCCount; adc++)
+    {
+        for (ch = 0; ch < s_ADCs[adc]->getMaxChannels(); ch++)
         {
-            for (ch = 0; ch < 4; ch++)
+            channel = s_ADCFirstChannels[adc] + ch;
+            if (!Settings_ChannelSettingIsValid(channel))
             {
-                field = (adc*4)+ch;
-                if (Settings_ChannelSettingIsValid(field+1))
-                {
-                    allData[field] = s_ADCs[adc].readADC_SingleEnded(ch);
-                }
-                else
-                {
-                    allData[field] = 0;
-                }
+                s_allData[channel-1] = 0;
+            }
+            else if (APP_Data_ChannelIsDue(channel))
+            {
+                scanMask |= (1 << ((adc * ADS1x1x_SCAN_CHANNELS) + ch));
             }
         }
+    }
 
-        // Read the internal ADCs for fields 13-15
-        for (adc = 0; adc < 3; adc++)
+    // Read the internal ADCs
+    for (adc = 0; adc < s_internalADCCount; adc++)
+    {
+        channel = s_internalFirstChannel + adc;
+        if (!Settings_ChannelSettingIsValid(channel))
         {
-            field = adc + 12;
-            if (Settings_ChannelSettingIsValid(field+1))
-            {
-                allData[field] = s_internalADCs[adc].read();
-            }
-            else
+            s_allData[channel-1] = 0;
+        }
+        else if (APP_Data_ChannelIsDue(channel))
+        {
+            s_allData[channel-1] = s_internalADCs[adc].read();
+        }
+    }
+
+    // If the last scan has somehow not finished, this scan is skipped
+    if (!s_ADCScanner.start(scanMask, millis()))
+    {
+        Serial.println("APP: ADC scan overrun.");
+    }
+}
+
+/*
+ * collectADCScan
+ *
+ * Collect ADC1x1x results as their conversions finish.
+ * Once every channel in the scan has been read, the complete scan is passed on.
+ */
+static void collectADCScan(void)
+{
+    uint8_t adc = 0;
+    uint8_t ch = 0;
+    uint8_t channel = 0;
+
+    if (!s_ADCScanner.tick(millis())) { return; }
+
+    for (adc = 0; adc < s_ADCCount; adc++)
+    {
+        for (ch = 0; ch < s_ADCs[adc]->getMaxChannels(); ch++)
+        {
+            channel = s_ADCFirstChannels[adc] + ch;
+            if (Settings_ChannelSettingIsValid(channel))
             {
-                allData[field] = 0;
+                s_allData[channel-1] = s_ADCScanner.getResult(adc, ch);
             }
         }
     }
 
-    APP_Data_NewDataArray(allData);
+    APP_Data_NewDataArray(s_allData);
 }
 
 static TaskAction readFromADCsTask(readFromADCsTaskFn, MS_PER_ADC_READ, INFINITE_TICKS, "ADC Read Task");
@@ -301,8 +355,6 @@ static void remoteUploadTaskFn(void)
         APP_Data_SetUploadPending(false);
         remoteUploadTask.SetInterval(s_uploadInterval * 1000);
 
-        uint16_t nFields = APP_Data_GetNumberOfFields();
-        
         if (!s_gprsConnection->isConnected())
         {
             if (s_debugUpload) { Serial.println("APP: GPRS not connected. Attempting new connection."); }
@@ -323,14 +375,25 @@ static void remoteUploadTaskFn(void)
                 Serial.println(s_thingSpeakService->getURL());
             }
             
-            APP_Data_GetUploadData(s_uploadData);
+            // Get one row (the averages and any statistics) and the time it was stored.
+            // Only channels that have changed (moved outside their deadband) are uploaded.
+            DATAFIELD_TIMESTAMP rowTimestamp;
+            uint32_t changedFields;
+            APP_Data_GetUploadRows(s_uploadData, 1, &rowTimestamp, &changedFields);
+            uint16_t nValues = APP_Data_SelectChangedColumns(s_uploadData, s_uploadDataKeys, changedFields);
             
             char created_at[30];
             TM createTime;
-            Time_GetTime(&createTime, TIME_PLATFORM);
+            Time_FromUnixSeconds(rowTimestamp.seconds, &createTime);
             CSV_writeTimestampToBuffer(&createTime, created_at);
-            s_thingSpeakService->createPostAPICall(
-                s_requestBuffer, s_uploadData, APP_Data_GetChannelNumbers(), nFields, s_uploadBufferSize, NULL);
+            if (!s_thingSpeakService->createPostAPICall(
+                s_requestBuffer, s_uploadData, s_uploadDataKeys, nValues, s_uploadBufferSize, created_at))
+            {
+                // The row can never fit in the request buffer, so it is dropped
+                if (s_debugUpload) { Serial.println("APP: Row too large for request buffer"); }
+                Error_Running(ERR_RUNNING_DATA_UPLOAD_FAILED, true);
+                continue;
+            }
 
             if (s_debugUpload)
             {
@@ -356,7 +419,9 @@ static void remoteUploadTaskFn(void)
                     Serial.println("!");
                 }
             }
-        }        
+        }
+
+        if (s_debugUpload) { APP_Data_PrintBufferCounters(); }
     }
     else
     {
@@ -395,10 +460,60 @@ static void gpsTaskFn(void)
 }
 static TaskAction gpsTask(gpsTaskFn, 30 * 1000, INFINITE_TICKS, "GPS Task");
 
-static char s_request_data_buffer[128];
+/*
+ * validInternalChannelCount
+ *
+ * Returns the number of internal ADC channels with valid settings
+ * (these are always the highest numbered channels, so come last in the data)
+ */
+static uint8_t validInternalChannelCount(void)
+{
+    uint8_t adc = 0;
+    uint8_t count = 0;
+
+    for (adc = 0; adc < s_internalADCCount; adc++)
+    {
+        if (Settings_ChannelSettingIsValid(s_internalFirstChannel + adc)) { count++; }
+    }
+    return count;
+}
+
+/*
+ * getI2CStatistics
+ *
+ * Fill data with the i2c counters of each device (in the order they were first used):
+ * address, NACKs, timeouts, retries, failed transactions, overruns, mean and maximum latency (microseconds).
+ * Returns the number of values.
+ */
+#define I2C_STATISTICS_PER_DEVICE (8)
+static int getI2CStatistics(float * data, int max_values)
+{
+    uint8_t i = 0;
+    int n = 0;
+    I2C_DEVICE_STATS const * pStats;
+
+    for (i = 0; i < I2C_GetDeviceCount(); i++)
+    {
+        if ((n + I2C_STATISTICS_PER_DEVICE) > max_values) { break; }
+
+        pStats = I2C_GetDeviceStats(i);
+        data[n++] = pStats->address;
+        data[n++] = pStats->nacks;
+        data[n++] = pStats->timeouts;
+        data[n++] = pStats->retries;
+        data[n++] = pStats->failures;
+        data[n++] = pStats->overruns;
+        data[n++] = I2C_MeanLatency(pStats);
+        data[n++] = pStats->maxLatency;
+    }
+    return n;
+}
+
+#define REQUEST_DATA_BUFFER_SIZE (256)
+static char s_request_data_buffer[REQUEST_DATA_BUFFER_SIZE];
 static void on_serial_request_received(int request_number)
 {
-    float all_data[15];
+    float all_data[MAX_FIELDS];
     
     float * request_data = all_data;
     
@@ -413,38 +528,43 @@ static void on_serial_request_received(int request_number)
     switch(request_number)
     {
     case 0:
-        if (Settings_ChannelSettingIsValid(13)) { n_fields--; }
-        if (Settings_ChannelSettingIsValid(14)) { n_fields--; }
-        if (Settings_ChannelSettingIsValid(15)) { n_fields--; }
+        n_fields -= validInternalChannelCount();
         request_data = all_data;
         break;
     case 1:
-        request_data = &all_data[n_fields];
-        if (Settings_ChannelSettingIsValid(15))
-        {
-            request_data--;
-            n_temperature_fields++;
-        }
-        if (Settings_ChannelSettingIsValid(14))
-        {
-            request_data--;
-            n_temperature_fields++;
-        }
-        if (Settings_ChannelSettingIsValid(13))
-        {
-            request_data--;
-            n_temperature_fields++;
-        }
-
+        n_temperature_fields = validInternalChannelCount();
+        request_data = &all_data[n_fields - n_temperature_fields];
         n_fields = n_temperature_fields;
         break;
+    case 2:
+        // P5, P50 and P95 over the last storage interval for channels with percentiles enabled
+        n_fields = APP_Data_GetStoragePercentiles(all_data, MAX_FIELDS);
+        request_data = all_data;
+        break;
+    case 3:
+        // i2c bus health (see getI2CStatistics)
+        n_fields = getI2CStatistics(all_data, MAX_FIELDS);
+        request_data = all_data;
+        break;
     }
 
-    TM platform_time;
-    Time_GetTime(&platform_time, TIME_PLATFORM);
+    // Report the time the data was averaged (or the current time if there is no data yet, or for the i2c counters)
+    DATAFIELD_TIMESTAMP data_time;
+    bool have_data_time = false;
+    if (request_number == 2) { have_data_time = APP_Data_GetStorageTimestamp(&data_time); }
+    else if (request_number != 3) { have_data_time = APP_Data_GetRequestTimestamp(&data_time); }
 
-    APP_SerialRequestData_FormatArray(request_data, n_fields, s_request_data_buffer, 128, &platform_time);
-    Serial1.print(s_request_data_buffer);
+    if (!have_data_time)
+    {
+        TM platform_time;
+        Time_GetTime(&platform_time, TIME_PLATFORM);
+        data_time.seconds = (uint32_t)Time_ToUnixSeconds(&platform_time);
+    }
+
+    if (APP_SerialRequestData_FormatArray(request_data, n_fields, s_request_data_buffer, REQUEST_DATA_BUFFER_SIZE, data_time.seconds))
+    {
+        Serial1.print(s_request_data_buffer);
+    }
 }
 
 static void handle_incoming_serial()
@@ -457,14 +577,14 @@ static void handle_incoming_serial()
 
 static void setupUploadVars(void)
 {
-    uint16_t nFields = APP_Data_GetNumberOfFields();
+    uint16_t nColumns = APP_Data_GetNumberOfColumns();
 
     /* Get pointers to the GPRS data and online storage services */
     s_thingSpeakService = Service_GetService(SERVICE_THINGSPEAK);
     s_gprsConnection = Network_GetNetwork(NETWORK_INTERFACE_LINKITONE_GPRS);
 
     // Allocate space for CSV data and HTTP request building.
-    // Allow 10 chars per field, plus 20 for timestamp.
+    // Allow 16 chars per value, plus 20 for timestamp.
     // Then allocate twice as much as that estimate (minimum 512)
 
     s_uploadBufferSize = APP_Data_GetUploadBufferSize();
@@ -473,18 +593,177 @@ static void setupUploadVars(void)
     
     s_requestBuffer = new char [s_uploadBufferSize];
 
-    // Allocate space for floats to pass to upload module
-    s_uploadData = new float[nFields];
+    // Allocate space for floats to pass to upload module (one row of data)
+    s_uploadData = new float[nColumns];
+    s_uploadDataKeys = new char const *[nColumns];
 }
 
-static void setupADCs(void)
+/*
+ * setupADCTopology
+ *
+ * Set up i2c transactions (timeout and attempts) and create the ADS1x1x ADCs listed in ADC_CHIPS,
+ * skipping any that do not respond if ADC_PROBE is set,
+ * and work out which channels the internal ADCs read (by default, the ones after the last ADS1x1x channel).
+ * Channels with a gain get their mvPerBit from it, which also depends on the resolution of their ADC,
+ * so this has to be done before the channel settings are read.
+ */
+static void setupADCTopology(void)
 {
+    ADS1x1x_CHIP chips[MAX_ADS1x1x_CHIPS];
+    uint8_t chipCount = 0;
     uint8_t i = 0;
-    for (i = 0; i < 3; i++)
+    uint8_t ch = 0;
+    uint16_t lastChannel = 0;
+    char address[5];
+    ADS1x1x * adc;
+
+    if (Settings_intIsSet(I2C_TIMEOUT_US)) { I2C_SetTimeout(Settings_getInt(I2C_TIMEOUT_US)); }
+    if (Settings_intIsSet(I2C_ATTEMPTS) && !I2C_SetAttempts(Settings_getInt(I2C_ATTEMPTS)))
+    {
+        Error_Fatal("I2C_ATTEMPTS must be from 1 to 10.", ERR_FATAL_CONFIG);
+    }
+
+    bool probe = Settings_intIsSet(ADC_PROBE) && (Settings_getInt(ADC_PROBE) != 0);
+    char const * chipList = Settings_stringIsSet(ADC_CHIPS) ? Settings_getString(ADC_CHIPS) : DEFAULT_ADC_CHIPS;
+
+    if (!ADS1x1x_ParseTopology(chipList, chips, &chipCount))
+    {
+        Error_Fatal("ADC_CHIPS is not a valid list of ADCs.", ERR_FATAL_CONFIG);
+    }
+
+    for (i = 0; i < chipCount; i++)
+    {
+        // Channels of chips that are not found are not reused by the internal ADCs
+        lastChannel = max(lastChannel, chips[i].firstChannel + ADS1x1x_PartChannels(chips[i].part) - 1);
+    }
+
+    if (lastChannel > Settings_GetMaxChannels())
+    {
+        Error_Fatal("ADC_CHIPS uses more channels than the datalogger has.", ERR_FATAL_CONFIG);
+    }
+
+    for (i = 0; i < chipCount; i++)
+    {
+        adc = ADS1x1x_Create(&chips[i]);
+        if (!adc) { Error_Fatal("Failed to create ADC", ERR_FATAL_RUNTIME); }
+
+        adc->begin();
+
+        if (probe && !adc->isPresent())
+        {
+            sprintf(address, "0x%02X", chips[i].address);
+            Serial.print("APP: No ADC at address ");
+            Serial.print(address);
+            Serial.println(", it will not be read.");
+            delete adc;
+            continue;
+        }
+
+        adc->setGain(GAIN_ONE);
+        s_ADCs[s_ADCCount] = adc;
+        s_ADCFirstChannels[s_ADCCount] = chips[i].firstChannel;
+        s_ADCCount++;
+        s_ADCScanner.addADC(adc);
+
+        for (ch = 0; ch < adc->getMaxChannels(); ch++)
+        {
+            Settings_SetChannelResolution(chips[i].firstChannel + ch, adc->getResolution());
+        }
+    }
+
+    // Internal ADC channels must come after the ADS1x1x channels (serial requests send them separately)
+    if (Settings_intIsSet(INTERNAL_ADC_COUNT)) { s_internalADCCount = Settings_getInt(INTERNAL_ADC_COUNT); }
+    s_internalFirstChannel = Settings_intIsSet(INTERNAL_ADC_FIRST_CHANNEL) ? Settings_getInt(INTERNAL_ADC_FIRST_CHANNEL) : lastChannel + 1;
+
+    if ((s_internalADCCount > MAX_INTERNAL_ADCS) || (s_internalFirstChannel <= lastChannel)
+        || ((uint32_t)(s_internalFirstChannel + s_internalADCCount - 1) > Settings_GetMaxChannels()))
+    {
+        Error_Fatal("Internal ADC settings are invalid.", ERR_FATAL_CONFIG);
+    }
+
+    Serial.print("APP: Reading ");
+    Serial.print(s_ADCCount);
+    Serial.print(" of ");
+    Serial.print(chipCount);
+    Serial.print(" ADS1x1x ADCs and ");
+    Serial.print(s_internalADCCount);
+    Serial.println(" internal ADCs.");
+}
+
+/*
+ * setupADCs
+ *
+ * Apply the channel settings to the ADCs and allocate the data array.
+ * This has to be done after the channel settings are read.
+ */
+static void setupADCs(void)
+{
+    uint8_t adc = 0;
+    uint8_t ch = 0;
+    uint8_t channel = 0;
+    uint16_t allChannels = 0;
+    uint16_t highestChannel = 0;
+    uint16_t lastValidChannel = 0;
+    ADS_GAIN gain;
+
+    // Each channel's gain, data rate and oversampling is applied once here (the scanner keeps its config register value)
+    for (adc = 0; adc < s_ADCCount; adc++)
+    {
+        for (ch = 0; ch < s_ADCs[adc]->getMaxChannels(); ch++)
+        {
+            channel = s_ADCFirstChannels[adc] + ch;
+            highestChannel = max(highestChannel, channel);
+
+            if (!Settings_ChannelSettingIsValid(channel)) { continue; }
+
+            if (!ADS1x1x_GainFromFullScale(Settings_GetChannelFullScale(channel), &gain)) { gain = GAIN_ONE; }
+
+            if (!s_ADCScanner.configureChannel(adc, ch, gain,
+                Settings_GetChannelDataRate(channel), Settings_GetChannelOversample(channel)))
+            {
+                Serial.print("APP: Channel ");
+                Serial.print(channel);
+                Serial.println(" data rate is not supported by its ADC, or oversample is more than 64.");
+                Error_Fatal("Invalid ADC channel settings.", ERR_FATAL_CONFIG);
+            }
+
+            allChannels |= (1 << ((adc * ADS1x1x_SCAN_CHANNELS) + ch));
+        }
+    }
+
+    if (s_ADCScanner.scanTime(allChannels) >= MS_PER_ADC_READ)
+    {
+        Error_Fatal("ADC channel data rates and oversampling are too slow for the scan rate.", ERR_FATAL_CONFIG);
+    }
+
+    // The internal ADCs have a fixed range and speed
+    for (adc = 0; adc < s_internalADCCount; adc++)
     {
-        s_ADCs[i].begin();
-        s_ADCs[i].setGain(GAIN_ONE);
+        channel = s_internalFirstChannel + adc;
+        highestChannel = max(highestChannel, channel);
+
+        if (Settings_GetChannelFullScale(channel) || Settings_GetChannelDataRate(channel) || (Settings_GetChannelOversample(channel) > 1))
+        {
+            Serial.print("APP: Gain, DataRate and Oversample are ignored for channel ");
+            Serial.println(channel);
+        }
     }
+
+    // Channels that are set up but have no ADC (e.g. if it was not found) read 0
+    for (channel = 1; channel <= Settings_GetMaxChannels(); channel++)
+    {
+        if (!Settings_ChannelSettingIsValid(channel) || (channel <= highestChannel)) { continue; }
+
+        Serial.print("APP: Channel ");
+        Serial.print(channel);
+        Serial.println(" has no ADC and will read 0.");
+        lastValidChannel = channel;
+    }
+
+    s_allDataCount = max(highestChannel, lastValidChannel);
+    s_allData = new int32_t[s_allDataCount];
+    if (!s_allData) { Error_Fatal("Failed to allocate ADC data", ERR_FATAL_RUNTIME); }
+    memset(s_allData, 0, s_allDataCount * sizeof(int32_t));
 }
 
 static void setupTime(void)
@@ -537,6 +816,8 @@ void setup()
     int storage_interval = Settings_getInt(DATA_STORAGE_INTERVAL_SECS);
     s_uploadInterval = Settings_getInt(DATA_UPLOAD_INTERVAL_SECS);
 
+    setupADCTopology();
+
     // The SD card module needs to know how often writes occur
     APP_SD_Setup(storage_interval * 1000);
 
@@ -576,6 +857,7 @@ void setup()
 void loop()
 {
     readFromADCsTask.tick();
+    collectADCScan();
     APP_Data_Tick();
     APP_SD_Tick();
     remoteUploadTask.tick();
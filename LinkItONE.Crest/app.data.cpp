@@ -36,6 +36,12 @@
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
 #include "DLDataField.Manager.h"
+#include "DLDataField.ColumnarManager.h"
+#include "DLDataField.Aggregator.h"
+#include "DLDataField.Burst.h"
+
+#include "DLSettings.Reader.Errors.h"
+#include "DLSettings.DataChannels.h"
 
 #include "DLTime.h"
 #include "DLCSV.h"
@@ -53,25 +59,41 @@
  * Applications Data
  */
 
-static DataFieldManager * s_storageManager = NULL;
-static DataFieldManager * s_uploadManager = NULL;
-static DataFieldManager * s_requestManager = NULL;
-static DataFieldManager * s_dataDebugManager = NULL;
+static ColumnarDataFieldManager * s_storageManager = NULL;
+static ColumnarDataFieldManager * s_uploadManager = NULL;
+static ColumnarDataFieldManager * s_requestManager = NULL;
+static ColumnarDataFieldManager * s_dataDebugManager = NULL;
+
+static DataFieldAggregator * s_aggregator = NULL;
+static BurstCapture * s_burst = NULL;
 
 static bool s_uploadPending = false;
 
 static uint32_t s_numberOfAveragesToStore= 0;
 static uint32_t s_numberOfAveragesToUpload = 0;
 static uint8_t s_fieldCount;
+static uint8_t s_columnCount;
+
+// Upload keys are the channel number, with a suffix for statistics and percentile columns (e.g. "12_max")
+#define UPLOAD_KEY_LENGTH (8)
+static char const * const s_statisticsKeySuffixes[] = {"", "_min", "_max", "_sd", "_p5", "_p50", "_p95"};
+static char const ** s_uploadKeys = NULL;
+static uint8_t * s_columnFields = NULL;
 
 static bool s_debugEnabled = true;
 static bool * s_debugFieldFlags;
 
 static bool s_conversion_enabled = true;
+static bool s_fixed_point_enabled = false;
+static bool s_windows_aligned = false;
 static bool s_adc_reads_enabled = true;
 
 static bool s_setupValid = false;
 
+// The RTC only has whole seconds, so milliseconds are counted from when each new second was first seen
+static uint32_t s_clockLastSecond = 0;
+static unsigned long s_clockSecondStartMillis = 0;
+
 /*
  * calculateNumberOfAverages
  *
@@ -79,17 +101,17 @@ static bool s_setupValid = false;
  * For example, the averaging interval may be 2 seconds and the storage/upload interval may be 15 seconds.
  * In this case, the number of averages that needs to be stored will be 7 or 8. This function returns
  * the correct (highest possible) number of averages that need to be stored/uploaded)
+ * If windows are aligned to the clock, the interval can end just after a boundary
+ * (and shortened windows can close early), so allow for one more average.
  */
-static uint16_t calculateNumberOfAverages(uint16_t interval, uint16_t averagingInterval)
+static uint16_t calculateNumberOfAverages(uint16_t interval, uint16_t averagingInterval, bool aligned)
 {
-    if (interval % averagingInterval == 0)
-    {
-        return interval / averagingInterval;
-    }
-    else
-    {
-        return (interval / averagingInterval) + 1;
-    }
+    uint16_t averages = interval / averagingInterval;
+
+    if (interval % averagingInterval != 0) { averages++; }
+    if (aligned) { averages++; }
+
+    return averages;
 }
 
 static void debugTaskFn(void)
@@ -97,20 +119,22 @@ static void debugTaskFn(void)
     uint8_t i;
     uint8_t fieldCount = s_dataDebugManager->fieldCount();
     uint32_t * channelNumbers = s_dataDebugManager->getChannelNumbers();
+    float averages[MAX_FIELDS];
+    float toShow[MAX_FIELDS];
 
     while(s_dataDebugManager->hasData())
     {
+        // Data has to be removed from manager whether it's printed or not
+        s_dataDebugManager->getDataArray(averages, false, false);
+        s_dataDebugManager->getDataArray(toShow, true, true);
+
         for (i = 0; i < fieldCount; i++)
         {
-            // Data has to be removed from manager whether it's printed or not
-            float average = ((NumericDataField *)s_dataDebugManager->getField(i))->getRawData(false);
-            float toShow = ((NumericDataField *)s_dataDebugManager->getField(i))->getConvData(true);
-             
             if (s_debugFieldFlags[i])
             {
-                Serial.print(toShow);
+                Serial.print(toShow[i]);
                 Serial.print("(");
-                Serial.print(average);
+                Serial.print(averages[i]);
                 Serial.print(")[");
                 Serial.print(channelNumbers[i]);
                 Serial.print("]");
@@ -122,6 +146,168 @@ static void debugTaskFn(void)
 }
 static TaskAction debugTask(debugTaskFn, 1000, INFINITE_TICKS);
 
+/*
+ * dataClock
+ *
+ * Timestamps each row of averages as it is stored (i.e. at the end of its averaging window)
+ */
+static void dataClock(DATAFIELD_TIMESTAMP * timestamp)
+{
+    TM now;
+    unsigned long nowMillis = millis();
+
+    Time_GetTime(&now, TIME_PLATFORM);
+    timestamp->seconds = (uint32_t)Time_ToUnixSeconds(&now);
+
+    if (timestamp->seconds != s_clockLastSecond)
+    {
+        s_clockLastSecond = timestamp->seconds;
+        s_clockSecondStartMillis = nowMillis;
+    }
+
+    timestamp->millis = (uint16_t)min(nowMillis - s_clockSecondStartMillis, 999UL);
+}
+
+/*
+ * enableDeadbands
+ *
+ * Apply channel deadbands to a manager, with a heartbeat row (all channels) every heartbeatSecs seconds
+ */
+static void enableDeadbands(ColumnarDataFieldManager * pManager, unsigned long averagingInterval, int heartbeatSecs)
+{
+    uint16_t heartbeatRows = 0;
+
+    if (heartbeatSecs > 0)
+    {
+        heartbeatRows = max(heartbeatSecs / averagingInterval, 1UL);
+    }
+
+    if (!pManager->enableDeadbands(heartbeatRows)) { Error_Fatal("Failed to enable deadbands", ERR_FATAL_RUNTIME); }
+}
+
+static void spillStorageRows(DataFieldManager * pManager) { APP_SD_SpillRows(pManager, "Storage"); }
+static void spillUploadRows(DataFieldManager * pManager) { APP_SD_SpillRows(pManager, "Upload"); }
+
+/*
+ * setOverflowPolicy
+ *
+ * Set a manager's overflow policy from a setting:
+ * 0 (or not set) drops the oldest data, 1 drops the newest data and 2 spills the oldest data to SD card
+ */
+static void setOverflowPolicy(ColumnarDataFieldManager * pManager, INTSETTING setting, OVERFLOW_SPILL_FN * spillFn)
+{
+    int policy = Settings_intIsSet(setting) ? Settings_getInt(setting) : 0;
+
+    switch (policy)
+    {
+    case 1:
+        pManager->setOverflowPolicy(OVERFLOW_DROP_NEWEST, NULL);
+        break;
+    case 2:
+        pManager->setOverflowPolicy(OVERFLOW_SPILL, spillFn);
+        break;
+    default:
+        pManager->setOverflowPolicy(OVERFLOW_DROP_OLDEST, NULL);
+        break;
+    }
+}
+
+static void printCounters(char const * const name, ColumnarDataFieldManager * pManager)
+{
+    DATAFIELD_COUNTERS counters;
+
+    // All fields share the same buffer, so have the same counts
+    if (!pManager->getCounters(0, &counters)) { return; }
+
+    Serial.print(name);
+    Serial.print(" buffer: ");
+    Serial.print(counters.pushes);
+    Serial.print(" stored, ");
+    Serial.print(counters.pops);
+    Serial.print(" read, ");
+    Serial.print(counters.drops);
+    Serial.print(" dropped, ");
+    Serial.print(counters.suppressed);
+    Serial.print(" within deadband, ");
+    Serial.print(pManager->spillCount());
+    Serial.println(" spilled.");
+}
+
+/*
+ * setupUploadKeys
+ *
+ * Make a key for each column of upload data, and note which field each column belongs to
+ */
+static void setupUploadKeys(void)
+{
+    uint8_t column;
+    uint8_t field;
+    DATAFIELD_COLUMN type;
+    uint32_t * channelNumbers = s_uploadManager->getChannelNumbers();
+
+    char * keys = new char[s_columnCount * UPLOAD_KEY_LENGTH];
+    s_uploadKeys = new char const *[s_columnCount];
+    s_columnFields = new uint8_t[s_columnCount];
+
+    if (!keys || !s_uploadKeys || !s_columnFields) { Error_Fatal("Failed to allocate upload keys", ERR_FATAL_RUNTIME); }
+
+    for (column = 0; column < s_columnCount; column++)
+    {
+        s_uploadManager->getColumn(column, &field, &type);
+        char * key = &keys[column * UPLOAD_KEY_LENGTH];
+        sprintf(key, "%d%s", (int)channelNumbers[field], s_statisticsKeySuffixes[type]);
+        s_uploadKeys[column] = key;
+        s_columnFields[column] = field;
+    }
+}
+
+/*
+ * setupBurstCapture
+ *
+ * If any channel has a trigger set, capture raw samples of all channels around each trigger.
+ * BURST_PRE_SAMPLES and BURST_POST_SAMPLES set the length of the capture (default one second each).
+ */
+static void setupBurstCapture(uint16_t valuesPerSecond)
+{
+    uint8_t i;
+    bool triggered = false;
+    uint32_t * channelNumbers = s_storageManager->getChannelNumbers();
+    int preSamples = Settings_intIsSet(BURST_PRE_SAMPLES) ? Settings_getInt(BURST_PRE_SAMPLES) : valuesPerSecond;
+    int postSamples = Settings_intIsSet(BURST_POST_SAMPLES) ? Settings_getInt(BURST_POST_SAMPLES) : valuesPerSecond;
+
+    for (i = 0; i < s_fieldCount; i++)
+    {
+        if (Settings_GetChannelTrigger(channelNumbers[i]) != TRIGGER_NONE) { triggered = true; }
+    }
+
+    if (!triggered) { return; }
+
+    if ((preSamples < 0) || (postSamples < 1) || ((preSamples + postSamples) > 0xFFFF))
+    {
+        Error_Fatal("Burst capture length is not valid", ERR_FATAL_CONFIG);
+    }
+
+    s_burst = new BurstCapture((uint16_t)preSamples, (uint16_t)postSamples);
+    if (!s_burst) { Error_Fatal("Failed to create burst capture", ERR_FATAL_RUNTIME); }
+
+    bool channelsAdded = true;
+    for (i = 0; i < s_fieldCount; i++)
+    {
+        channelsAdded &= s_burst->addChannel(channelNumbers[i],
+            Settings_GetChannelTrigger(channelNumbers[i]), Settings_GetChannelTriggerLevel(channelNumbers[i]));
+    }
+
+    s_burst->setClock(dataClock);
+
+    if (!channelsAdded || !s_burst->allocate()) { Error_Fatal("Failed to allocate burst capture", ERR_FATAL_RUNTIME); }
+
+    Serial.print("Capturing bursts of ");
+    Serial.print(preSamples);
+    Serial.print(" samples before and ");
+    Serial.print(postSamples);
+    Serial.println(" samples from each trigger.");
+}
+
 static bool counts_match(uint8_t storageFieldCount, uint8_t uploadFieldCount, uint8_t requestFieldCount, uint8_t debugFieldCount)
 {
     bool match = true;
@@ -157,8 +343,11 @@ void APP_Data_Setup(
     uint32_t storageAveragerSize = valuesPerSecond * storageAveragingInterval;
     uint32_t uploadAveragerSize = valuesPerSecond * uploadAveragingInterval;
 
-    s_numberOfAveragesToStore = calculateNumberOfAverages(storageInterval, storageAveragingInterval);
-    s_numberOfAveragesToUpload = calculateNumberOfAverages(uploadInterval, uploadAveragingInterval);
+    // Averaging windows close on clock boundaries if ALIGN_AVERAGING_WINDOWS is not zero
+    s_windows_aligned = Settings_intIsSet(ALIGN_AVERAGING_WINDOWS) && (Settings_getInt(ALIGN_AVERAGING_WINDOWS) != 0);
+
+    s_numberOfAveragesToStore = calculateNumberOfAverages(storageInterval, storageAveragingInterval, s_windows_aligned);
+    s_numberOfAveragesToUpload = calculateNumberOfAverages(uploadInterval, uploadAveragingInterval, s_windows_aligned);
 
     Serial.print("Storing ");
     Serial.print(s_numberOfAveragesToStore);
@@ -180,17 +369,48 @@ void APP_Data_Setup(
     Serial.print(uploadAveragingInterval);
     Serial.println(" seconds).");
 
-    // Create four data managers, one for storing data, one for uploading data, one for request data and one for debugging
+    // Create four data managers, one for storing data, one for uploading data, one for request data and one for debugging.
+    // The managers only buffer averages: the averaging itself is done once for all of them by the aggregator.
+    // Each manager is given the number of scans in its averages so that channel sample divisors are checked against it.
     
-    s_storageManager = new DataFieldManager(s_numberOfAveragesToStore, storageAveragerSize);
-    s_uploadManager = new DataFieldManager(s_numberOfAveragesToUpload, uploadAveragerSize);
-    s_requestManager = new DataFieldManager(1, 1);
-    s_dataDebugManager = new DataFieldManager(1, valuesPerSecond);
+    s_storageManager = new ColumnarDataFieldManager(s_numberOfAveragesToStore, storageAveragerSize);
+    s_uploadManager = new ColumnarDataFieldManager(s_numberOfAveragesToUpload, uploadAveragerSize);
+    s_requestManager = new ColumnarDataFieldManager(1, valuesPerSecond);
+    s_dataDebugManager = new ColumnarDataFieldManager(1, valuesPerSecond);
+    s_aggregator = new DataFieldAggregator(valuesPerSecond);
 
     if (!s_storageManager) { Error_Fatal("Failed to create storage manager", ERR_FATAL_RUNTIME); }
     if (!s_uploadManager) { Error_Fatal("Failed to create upload manager", ERR_FATAL_RUNTIME); }
     if (!s_requestManager) { Error_Fatal("Failed to create request manager", ERR_FATAL_RUNTIME); }
     if (!s_dataDebugManager) { Error_Fatal("Failed to create debug manager", ERR_FATAL_RUNTIME); }
+    if (!s_aggregator) { Error_Fatal("Failed to create data aggregator", ERR_FATAL_RUNTIME); }
+
+    // Each stored, uploaded and requested average records the time its window ended
+    s_storageManager->setClock(dataClock);
+    s_uploadManager->setClock(dataClock);
+    s_requestManager->setClock(dataClock);
+
+    // Stored and uploaded averages are only written when a channel with a deadband moves outside it
+    // (debug and request data always have every value)
+    int heartbeatSecs = Settings_intIsSet(DEADBAND_HEARTBEAT_SECS) ? Settings_getInt(DEADBAND_HEARTBEAT_SECS) : 0;
+    enableDeadbands(s_storageManager, storageAveragingInterval, heartbeatSecs);
+    enableDeadbands(s_uploadManager, uploadAveragingInterval, heartbeatSecs);
+
+    // Averages are processed as Q16.16 fixed point if ENABLE_FIXED_POINT is not zero.
+    // This has to be selected before any fields are added to the managers.
+    s_fixed_point_enabled = Settings_intIsSet(ENABLE_FIXED_POINT) && (Settings_getInt(ENABLE_FIXED_POINT) != 0);
+
+    if (s_fixed_point_enabled)
+    {
+        bool fixedPointSet = true;
+        fixedPointSet &= s_storageManager->setFixedPoint(true);
+        fixedPointSet &= s_uploadManager->setFixedPoint(true);
+        fixedPointSet &= s_requestManager->setFixedPoint(true);
+        fixedPointSet &= s_dataDebugManager->setFixedPoint(true);
+
+        if (!fixedPointSet) { Error_Fatal("Failed to enable fixed point data", ERR_FATAL_RUNTIME); }
+        Serial.println("Using fixed point data processing.");
+    }
     
     Serial.print("Attempting to read channel settings from ");
     Serial.print("filename");
@@ -215,6 +435,55 @@ void APP_Data_Setup(
         Error_Fatal("No valid channel configurations read!", ERR_FATAL_CHANNEL);
     }
 
+    // Channels with statistics enabled have min, max and standard deviation columns after their average
+    s_columnCount = s_storageManager->columnCount();
+    setupUploadKeys();
+
+    // All fields have been added, so the storage for each manager can be allocated (in one block per manager)
+    bool allocated = true;
+    allocated &= s_storageManager->allocate();
+    allocated &= s_uploadManager->allocate();
+    allocated &= s_requestManager->allocate();
+    allocated &= s_dataDebugManager->allocate();
+
+    if (!allocated)
+    {
+        Error_Fatal("Failed to allocate data storage", ERR_FATAL_RUNTIME);
+    }
+
+    Serial.print("Data storage uses ");
+    Serial.print(s_storageManager->bytesUsed());
+    Serial.print(" (storage), ");
+    Serial.print(s_uploadManager->bytesUsed());
+    Serial.print(" (upload), ");
+    Serial.print(s_requestManager->bytesUsed());
+    Serial.print(" (request) and ");
+    Serial.print(s_dataDebugManager->bytesUsed());
+    Serial.println(" (debug) bytes.");
+
+    setOverflowPolicy(s_storageManager, STORAGE_OVERFLOW_POLICY, spillStorageRows);
+    setOverflowPolicy(s_uploadManager, UPLOAD_OVERFLOW_POLICY, spillUploadRows);
+
+    // Base aggregation period is one second. The request manager gets the latest one second average.
+    bool windowsAdded = true;
+    windowsAdded &= s_aggregator->addWindow(s_dataDebugManager, 1);
+    windowsAdded &= s_aggregator->addWindow(s_storageManager, storageAveragingInterval);
+    windowsAdded &= s_aggregator->addWindow(s_uploadManager, uploadAveragingInterval);
+    windowsAdded &= s_aggregator->addWindow(s_requestManager, 1);
+
+    if (!windowsAdded)
+    {
+        Error_Fatal("Failed to configure data aggregator (sample divisors must divide the values per second)", ERR_FATAL_CONFIG);
+    }
+
+    if (s_windows_aligned)
+    {
+        s_aggregator->alignToClock(dataClock);
+        Serial.println("Averaging windows are aligned to the clock.");
+    }
+
+    setupBurstCapture(valuesPerSecond);
+
     Serial.print("Data Managers created with ");
     Serial.print(s_fieldCount);
     Serial.println(s_fieldCount > 1 ? " channels." : " channel.");
@@ -222,7 +491,7 @@ void APP_Data_Setup(
     uint32_t i;
 
     uint32_t * channelNumbers = s_storageManager->getChannelNumbers();
-    char configString[100];
+    char configString[128];
 
     for (i = 0; i < s_fieldCount; i++)
     {
@@ -233,7 +502,16 @@ void APP_Data_Setup(
         Serial.print(s_storageManager->getChannel(channelNumbers[i])->getTypeString());
         Serial.print(". (");
         Serial.print(configString);
-        Serial.println(")");
+        Serial.print(")");
+
+        uint8_t divisor = s_storageManager->getSampleDivisors()[i];
+        if (divisor > 1)
+        {
+            Serial.print(" Read every ");
+            Serial.print(divisor);
+            Serial.print(" scans.");
+        }
+        Serial.println();
     }
 
     // Serial data output is enabled if ENABLE_DATA_DEBUG is not zero
@@ -284,10 +562,35 @@ void APP_Data_Setup(
 
 void APP_Data_NewDataArray(int32_t * data)
 {
-    s_storageManager->storeDataArray(data);
-    s_uploadManager->storeDataArray(data);
-    s_dataDebugManager->storeDataArray(data);
-    s_requestManager->storeDataArray(data);
+    s_aggregator->storeDataArray(data);
+
+    // Only copies the raw scan: bursts are written to SD card later by the SD task
+    if (s_burst) { s_burst->storeDataArray(data); }
+}
+
+/*
+ * APP_Data_ChannelIsDue
+ *
+ * Returns true if the channel needs to be read for the next scan.
+ * Channels with a sample divisor are only needed on one scan in every divisor scans
+ * (the values of channels that are not due are ignored, except by the burst capture).
+ */
+bool APP_Data_ChannelIsDue(uint32_t channel)
+{
+    if (!s_setupValid) { return false; }
+
+    NumericDataField * field = (NumericDataField*)s_storageManager->getChannel(channel);
+    return field && s_aggregator->sampleIsDue(field->getSampleDivisor());
+}
+
+/*
+ * APP_Data_GetBurstCapture
+ *
+ * Returns the burst capture (NULL if no channels have triggers)
+ */
+BurstCapture * APP_Data_GetBurstCapture(void)
+{
+    return s_burst;
 }
 
 void APP_Data_GetUploadData(float * buffer)
@@ -295,16 +598,159 @@ void APP_Data_GetUploadData(float * buffer)
     s_uploadManager->getDataArray(buffer, s_conversion_enabled, true);
 }
 
+/*
+ * APP_Data_GetStorageRows, APP_Data_GetUploadRows
+ *
+ * Remove up to maxRows rows of data in one call.
+ * buffer must have space for maxRows * APP_Data_GetNumberOfColumns() values.
+ * timestamps (optional) must have space for maxRows timestamps, and gets the time each row was stored.
+ * changedFields (optional) must have space for maxRows masks, and gets the fields that changed in each row
+ * (see APP_Data_ColumnChanged).
+ * Returns number of rows read.
+ */
+uint32_t APP_Data_GetStorageRows(float * buffer, uint32_t maxRows, DATAFIELD_TIMESTAMP * timestamps, uint32_t * changedFields)
+{
+    return s_storageManager->getDataRows(buffer, maxRows, s_conversion_enabled, true, NULL, timestamps, changedFields);
+}
+
+uint32_t APP_Data_GetUploadRows(float * buffer, uint32_t maxRows, DATAFIELD_TIMESTAMP * timestamps, uint32_t * changedFields)
+{
+    return s_uploadManager->getDataRows(buffer, maxRows, s_conversion_enabled, true, NULL, timestamps, changedFields);
+}
+
+/*
+ * APP_Data_GetStorageFixedRows
+ *
+ * As APP_Data_GetStorageRows, but gets the data as fixed point.
+ * Only avoids floating point operations if APP_Data_FixedPointEnabled() is true.
+ */
+uint32_t APP_Data_GetStorageFixedRows(FIXED * buffer, uint32_t maxRows, DATAFIELD_TIMESTAMP * timestamps, uint32_t * changedFields)
+{
+    return s_storageManager->getFixedDataRows(buffer, maxRows, s_conversion_enabled, true, NULL, timestamps, changedFields);
+}
+
+/*
+ * APP_Data_ColumnChanged
+ *
+ * Returns true if a column of a storage/upload row belongs to a field that changed in that row.
+ * Values of unchanged fields are within their deadband of the last value written, so need not be written again.
+ */
+bool APP_Data_ColumnChanged(uint16_t column, uint32_t changedFields)
+{
+    return (changedFields & (1UL << s_columnFields[column])) != 0;
+}
+
+/*
+ * APP_Data_SelectChangedColumns
+ *
+ * Move the values of changed columns of a row to the start of the row (in order), and fill keys with their upload keys.
+ * keys must have space for APP_Data_GetNumberOfColumns() keys.
+ * Returns the number of values kept.
+ */
+uint16_t APP_Data_SelectChangedColumns(float * row, char const ** keys, uint32_t changedFields)
+{
+    uint16_t column;
+    uint16_t kept = 0;
+
+    for (column = 0; column < s_columnCount; column++)
+    {
+        if (APP_Data_ColumnChanged(column, changedFields))
+        {
+            row[kept] = row[column];
+            keys[kept] = s_uploadKeys[column];
+            kept++;
+        }
+    }
+
+    return kept;
+}
+
+bool APP_Data_FixedPointEnabled(void)
+{
+    return s_fixed_point_enabled;
+}
+
+bool APP_Data_WindowsAligned(void)
+{
+    return s_windows_aligned;
+}
+
 void APP_Data_GetRequestData(float * buffer)
 {
     s_requestManager->getDataArray(buffer, s_conversion_enabled, false);
 }
 
+/*
+ * APP_Data_GetRequestTimestamp, APP_Data_GetStorageTimestamp
+ *
+ * Get the time the latest request/storage average was stored.
+ * Returns false if no average has been stored yet.
+ */
+bool APP_Data_GetRequestTimestamp(DATAFIELD_TIMESTAMP * timestamp)
+{
+    return s_requestManager->getLatestTimestamp(timestamp);
+}
+
+bool APP_Data_GetStorageTimestamp(DATAFIELD_TIMESTAMP * timestamp)
+{
+    return s_storageManager->getLatestTimestamp(timestamp);
+}
+
+/*
+ * APP_Data_GetStoragePercentiles
+ *
+ * Get the P5, P50 and P95 of each field with percentiles enabled, over the most recent storage average.
+ * buffer must have space for maxValues values (three per field with percentiles enabled).
+ * Returns the number of values written.
+ */
+uint8_t APP_Data_GetStoragePercentiles(float * buffer, uint8_t maxValues)
+{
+    uint8_t field;
+    uint8_t n = 0;
+    DATAFIELD_STATISTICS stats;
+
+    for (field = 0; field < s_fieldCount; field++)
+    {
+        if ((n + 3) > maxValues) { break; }
+
+        NumericDataField * pField = (NumericDataField*)s_storageManager->getField(field);
+        if (pField->getLatestPercentiles(&stats, s_conversion_enabled))
+        {
+            buffer[n++] = stats.p5;
+            buffer[n++] = stats.p50;
+            buffer[n++] = stats.p95;
+        }
+    }
+
+    return n;
+}
+
 uint16_t APP_Data_GetNumberOfFields(void)
 {
     return s_fieldCount;
 }
 
+/*
+ * APP_Data_GetNumberOfColumns
+ *
+ * Returns the number of values in each row of storage/upload data:
+ * one per field, plus three for each field with statistics enabled and three for each with percentiles enabled
+ */
+uint16_t APP_Data_GetNumberOfColumns(void)
+{
+    return s_columnCount;
+}
+
+/*
+ * APP_Data_GetUploadKeys
+ *
+ * Returns the key to upload each column of upload data with
+ */
+char const * const * APP_Data_GetUploadKeys(void)
+{
+    return s_uploadKeys;
+}
+
 bool APP_Data_StorageDataRemaining(void)
 {
     return s_storageManager->hasData();
@@ -320,7 +766,7 @@ bool APP_Data_UploadDataRemaining(void)
     return s_uploadManager->count() > 0;
 }
 
-void APP_Data_WriteHeadersToBuffer(char * buffer, uint8_t bufferLength)
+void APP_Data_WriteHeadersToBuffer(char * buffer, uint16_t bufferLength)
 {
     (void)s_storageManager->writeHeadersToBuffer(buffer, bufferLength);
 }
@@ -336,7 +782,7 @@ uint32_t APP_Data_GetNumberOfAveragesForUpload(void) { return s_numberOfAverages
 uint32_t APP_Data_GetUploadBufferSize(void)
 {
     uint32_t uploadBufferSize = 0;
-    uploadBufferSize = 10 * APP_Data_GetNumberOfFields(); // Allow 10 bytes per field
+    uploadBufferSize = 16 * APP_Data_GetNumberOfColumns(); // Allow 16 bytes per value (key and data)
     uploadBufferSize += 20; // Allow 20 extra chars per data line
     uploadBufferSize *= APP_Data_GetNumberOfAveragesForUpload(); // Each line needs recording
     uploadBufferSize *= 2; // For safety, allocate twice the requirement
@@ -344,14 +790,23 @@ uint32_t APP_Data_GetUploadBufferSize(void)
     return uploadBufferSize;
 }
 
-NumericDataField * APP_Data_GetUploadField(uint8_t i)
+/*
+ * APP_Data_PrintBufferCounters
+ *
+ * Print how many averages have been stored, read, dropped and spilled by the storage and upload buffers
+ * (and how many burst triggers were missed)
+ */
+void APP_Data_PrintBufferCounters(void)
 {
-    return (NumericDataField *)s_uploadManager->getField(i);
-}
+    printCounters("Storage", s_storageManager);
+    printCounters("Upload", s_uploadManager);
 
-NumericDataField * APP_Data_GetStorageField(uint8_t i)
-{
-    return (NumericDataField *)s_storageManager->getField(i);
+    if (s_burst)
+    {
+        Serial.print("Burst capture: ");
+        Serial.print(s_burst->missedTriggers());
+        Serial.println(" triggers missed while writing.");
+    }
 }
 
 void APP_Data_SetUploadPending(bool pending)
@@ -5,20 +5,30 @@ void APP_Data_Setup(unsigned long storageAveragingInterval, unsigned long upload
 	uint16_t averagerSize, uint16_t storageInterval, uint16_t uploadInterval, char const * const filename);
 
 void APP_Data_NewDataArray(int32_t * data);
+bool APP_Data_ChannelIsDue(uint32_t channel);
+BurstCapture * APP_Data_GetBurstCapture(void);
 
-void APP_Data_WriteHeadersToBuffer(char * buffer, uint8_t bufferLength);
-
-NumericDataField * APP_Data_GetUploadField(uint8_t i);
-NumericDataField * APP_Data_GetStorageField(uint8_t i);
+void APP_Data_WriteHeadersToBuffer(char * buffer, uint16_t bufferLength);
 
+uint32_t APP_Data_GetStorageRows(float * buffer, uint32_t maxRows, DATAFIELD_TIMESTAMP * timestamps, uint32_t * changedFields);
+uint32_t APP_Data_GetUploadRows(float * buffer, uint32_t maxRows, DATAFIELD_TIMESTAMP * timestamps, uint32_t * changedFields);
+uint32_t APP_Data_GetStorageFixedRows(FIXED * buffer, uint32_t maxRows, DATAFIELD_TIMESTAMP * timestamps, uint32_t * changedFields);
+bool APP_Data_ColumnChanged(uint16_t column, uint32_t changedFields);
+uint16_t APP_Data_SelectChangedColumns(float * row, char const ** keys, uint32_t changedFields);
 void APP_Data_GetUploadData(float * buffer);
 void APP_Data_GetRequestData(float * buffer);
+bool APP_Data_GetRequestTimestamp(DATAFIELD_TIMESTAMP * timestamp);
+bool APP_Data_GetStorageTimestamp(DATAFIELD_TIMESTAMP * timestamp);
+uint8_t APP_Data_GetStoragePercentiles(float * buffer, uint8_t maxValues);
 
 uint32_t APP_Data_GetNumberOfAveragesForStorage(void);
 uint32_t APP_Data_GetNumberOfAveragesForUpload(void);
 uint32_t APP_Data_GetUploadBufferSize(void);
+void APP_Data_PrintBufferCounters(void);
 
 uint16_t APP_Data_GetNumberOfFields(void);
+uint16_t APP_Data_GetNumberOfColumns(void);
+char const * const * APP_Data_GetUploadKeys(void);
 
 void APP_Data_Tick(void);
 
@@ -33,4 +43,7 @@ bool APP_Data_UploadIsPending(void);
 void APP_Data_EnableConversion(bool enable);
 bool APP_Data_ConversionEnabled(void);
 
+bool APP_Data_FixedPointEnabled(void);
+bool APP_Data_WindowsAligned(void);
+
 #endif
@@ -32,6 +32,7 @@
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
 #include "DLDataField.Manager.h"
+#include "DLDataField.Burst.h"
 #include "DLTime.h"
 #include "DLCSV.h"
 #include "DLSettings.h"
@@ -54,7 +55,6 @@ static FILE_HANDLE s_fileHandle;
 static uint32_t s_entryID = 0;
 
 static TM s_time;
-static TM s_lastSDTimestamp;
 
 static char s_directory[] = "Datalogger";
 static char s_filePath[100];
@@ -63,6 +63,20 @@ static char s_errString[128];
 
 static bool s_debugThisModule = false;
 
+static uint16_t s_burstScansWritten = 0;
+
+// Number of values to read from the data manager at once (as many whole rows as fit, and at least one)
+#define SD_WRITE_BATCH_VALUES (MAX_COLUMNS)
+// ...up to this many rows (each row needs a timestamp and a changed field mask on the stack)
+#define SD_WRITE_BATCH_ROWS (16)
+
+// Number of burst scans to write each time the burst task runs (so that a long burst does not hold up other tasks)
+#define BURST_WRITE_BATCH_SCANS (32)
+#define BURST_WRITE_INTERVAL_MS (100)
+
+// Column headers are up to about 20 characters each (e.g. "Temperature (C) P50, ")
+#define CSV_HEADERS_LENGTH (20 * MAX_COLUMNS)
+
 static void localPrintFn(char const * const toPrint)
 {
     Serial.print(toPrint);
@@ -70,18 +84,31 @@ static void localPrintFn(char const * const toPrint)
 
 static void writeToSDCardTaskFn(void)
 {
-    char buffer[10];
-
-    NumericDataField * pField;
+    char buffer[16];
+    union
+    {
+        float floating[SD_WRITE_BATCH_VALUES];
+        FIXED fixed[SD_WRITE_BATCH_VALUES];
+    } data;
+    DATAFIELD_TIMESTAMP timestamps[SD_WRITE_BATCH_ROWS];
+    uint32_t changedFields[SD_WRITE_BATCH_ROWS];
+    uint32_t rowsRead;
+    uint32_t row;
     
-    uint16_t nFields = APP_Data_GetNumberOfFields();
+    // Fields with statistics enabled have extra columns
+    uint16_t nColumns = APP_Data_GetNumberOfColumns();
+    uint32_t batchRows = SD_WRITE_BATCH_VALUES / nColumns;
+    if (batchRows > SD_WRITE_BATCH_ROWS) { batchRows = SD_WRITE_BATCH_ROWS; }
     uint16_t linesWritten = 0;
+    bool fixedPoint = APP_Data_FixedPointEnabled();
 
     if (s_debugThisModule)
     {       
         Serial.print("Writing averages to SD card (");
-        Serial.print(nFields);
-        Serial.println(" fields).");
+        Serial.print(APP_Data_GetNumberOfFields());
+        Serial.print(" fields, ");
+        Serial.print(nColumns);
+        Serial.println(" columns).");
     }
 
     APP_SD_OpenDataFileForToday();
@@ -89,34 +116,47 @@ static void writeToSDCardTaskFn(void)
     if (s_fileHandle != INVALID_HANDLE)
     {
         uint16_t i;
-        while (APP_Data_StorageDataRemaining())
+        // Read a batch of rows (converted if enabled), then write each row to SD file
+        // In fixed point mode, the data is formatted without any floating point operations
+        while ((rowsRead = fixedPoint ?
+            APP_Data_GetStorageFixedRows(data.fixed, batchRows, timestamps, changedFields) :
+            APP_Data_GetStorageRows(data.floating, batchRows, timestamps, changedFields)) > 0)
         {
-            APP_SD_WriteTimestampToOpenFile();
-            APP_SD_WriteEntryIDToOpenFile();
-
-            for (i = 0; i < nFields; ++i)
+            for (row = 0; row < rowsRead; row++)
             {
-                pField = APP_Data_GetStorageField(i);
+                APP_SD_WriteTimestampToOpenFile(&timestamps[row]);
+                APP_SD_WriteEntryIDToOpenFile();
 
-                // Write from datafield to buffer then from buffer to SD file
-                if (APP_Data_ConversionEnabled())
-                {
-                    pField->getConvDataAsString(buffer, "%.4f", true);
-                }
-                else
+                // With aligned windows, mark rows from partial windows so they can be excluded from aggregation
+                if (APP_Data_WindowsAligned())
                 {
-                    pField->getRawDataAsString(buffer, "%.4f", true);
+                    s_sdCard->write(s_fileHandle, (timestamps[row].flags & DATAFIELD_ROW_PARTIAL) ? "1, " : "0, ");
                 }
 
-                s_sdCard->write(s_fileHandle, buffer);
-
-                if (!lastinloop(i, nFields))
+                for (i = 0; i < nColumns; ++i)
                 {
-                    s_sdCard->write(s_fileHandle, ", ");
+                    // Channels within their deadband are left blank (the last value written still applies)
+                    if (APP_Data_ColumnChanged(i, changedFields[row]))
+                    {
+                        if (fixedPoint)
+                        {
+                            FIXED_ToString(buffer, data.fixed[(row * nColumns) + i], 4);
+                        }
+                        else
+                        {
+                            sprintf(buffer, "%.4f", data.floating[(row * nColumns) + i]);
+                        }
+                        s_sdCard->write(s_fileHandle, buffer);
+                    }
+
+                    if (!lastinloop(i, nColumns))
+                    {
+                        s_sdCard->write(s_fileHandle, ", ");
+                    }
                 }
+                s_sdCard->write(s_fileHandle, "\r\n");
+                linesWritten++;
             }
-            s_sdCard->write(s_fileHandle, "\r\n");
-            linesWritten++;
         }
 
         s_sdCard->closeFile(s_fileHandle);
@@ -136,12 +176,111 @@ static void writeToSDCardTaskFn(void)
             Serial.println("' when trying to write data.");
         }
     }
+}
 
-    Time_GetTime(&s_lastSDTimestamp, TIME_PLATFORM);
+static TaskAction writeToSDCardTask(writeToSDCardTaskFn, 0, INFINITE_TICKS);
+
+/*
+ * writeBurstHeader
+ *
+ * Start a burst in the burst file with the trigger time and channel, then the column headers
+ */
+static void writeBurstHeader(FILE_HANDLE burstHandle, BurstCapture * pBurst)
+{
+    char buffer[30];
+    DATAFIELD_TIMESTAMP timestamp;
+    TM time;
+    uint8_t i;
+    uint32_t * channelNumbers = pBurst->getChannelNumbers();
+
+    s_sdCard->write(burstHandle, "Burst, ");
+    if (pBurst->getTriggerTime(&timestamp))
+    {
+        Time_FromUnixSeconds(timestamp.seconds, &time);
+        CSV_writeTimestampToBuffer(&time, buffer);
+        s_sdCard->write(burstHandle, buffer);
+        sprintf(buffer, ".%03u", (unsigned int)timestamp.millis);
+        s_sdCard->write(burstHandle, buffer);
+    }
+    sprintf(buffer, ", Trigger Ch%lu\r\n", (unsigned long)pBurst->triggerChannel());
+    s_sdCard->write(burstHandle, buffer);
 
+    s_sdCard->write(burstHandle, "Sample");
+    for (i = 0; i < pBurst->channelCount(); ++i)
+    {
+        sprintf(buffer, ", Ch%lu", (unsigned long)channelNumbers[i]);
+        s_sdCard->write(burstHandle, buffer);
+    }
+    s_sdCard->write(burstHandle, "\r\n");
 }
 
-static TaskAction writeToSDCardTask(writeToSDCardTaskFn, 0, INFINITE_TICKS);
+/*
+ * writeBurstTaskFn
+ *
+ * Append a captured burst of raw samples to Datalogger/Bursts.csv, a batch of scans at a time.
+ * Each line is the sample number relative to the trigger (negative before it), then the raw value of each channel.
+ * The burst is released for the next trigger once it has all been written.
+ */
+static void writeBurstTaskFn(void)
+{
+    char buffer[16];
+    char burstPath[50];
+    int32_t values[MAX_FIELDS];
+    uint16_t batchEnd;
+    uint8_t i;
+
+    BurstCapture * pBurst = APP_Data_GetBurstCapture();
+    if (!pBurst || !pBurst->ready()) { return; }
+
+    sprintf(burstPath, "%s/Bursts.csv", s_directory);
+    FILE_HANDLE burstHandle = s_sdCard->openFile(burstPath, true);
+
+    if (burstHandle == INVALID_HANDLE)
+    {
+        if (s_debugThisModule)
+        {
+            Serial.print("Could not open '");
+            Serial.print(burstPath);
+            Serial.println("' to write burst.");
+        }
+        return;
+    }
+
+    if (s_burstScansWritten == 0) { writeBurstHeader(burstHandle, pBurst); }
+
+    batchEnd = min(s_burstScansWritten + BURST_WRITE_BATCH_SCANS, pBurst->sampleCount());
+
+    for (; s_burstScansWritten < batchEnd; s_burstScansWritten++)
+    {
+        pBurst->getScan(s_burstScansWritten, values);
+
+        sprintf(buffer, "%d", (int)s_burstScansWritten - (int)pBurst->triggerIndex());
+        s_sdCard->write(burstHandle, buffer);
+
+        for (i = 0; i < pBurst->channelCount(); ++i)
+        {
+            sprintf(buffer, ", %ld", (long)values[i]);
+            s_sdCard->write(burstHandle, buffer);
+        }
+        s_sdCard->write(burstHandle, "\r\n");
+    }
+
+    s_sdCard->closeFile(burstHandle);
+
+    if (s_burstScansWritten == pBurst->sampleCount())
+    {
+        if (s_debugThisModule)
+        {
+            Serial.print("Burst of ");
+            Serial.print(s_burstScansWritten);
+            Serial.println(" samples written to file.");
+        }
+        s_burstScansWritten = 0;
+        pBurst->release();
+    }
+}
+
+static TaskAction writeBurstTask(writeBurstTaskFn, BURST_WRITE_INTERVAL_MS, INFINITE_TICKS);
 
 void APP_SD_Init(void)
 {
@@ -155,7 +294,6 @@ void APP_SD_Init(void)
 
 void APP_SD_Setup(unsigned long msInterval)
 {
-	Time_GetTime(&s_lastSDTimestamp, TIME_PLATFORM);
     s_sdCard->mkDir(s_directory);
     writeToSDCardTask.SetInterval(msInterval);
     writeToSDCardTask.ResetTime();
@@ -180,11 +318,13 @@ void createAndOpenNewFileForToday(void)
         Serial.println(pFilename);
     }
 
-    // Write Timestamp and Entry ID headers
+    // Write Timestamp and Entry ID headers (and Partial if windows are aligned)
     s_sdCard->write(s_fileHandle, "Timestamp, Entry ID, ");
+    if (APP_Data_WindowsAligned()) { s_sdCard->write(s_fileHandle, "Partial, "); }
 
-    char csvHeaders[200];
-    APP_Data_WriteHeadersToBuffer(csvHeaders, 200);
+    // Allow for statistics and percentile headers as well as field headers
+    static char csvHeaders[CSV_HEADERS_LENGTH];
+    APP_Data_WriteHeadersToBuffer(csvHeaders, CSV_HEADERS_LENGTH);
 
     s_sdCard->write(s_fileHandle, csvHeaders);
     s_entryID = 0;
@@ -214,11 +354,17 @@ void APP_SD_OpenDataFileForToday(void)
     }
 }
 
-void APP_SD_WriteTimestampToOpenFile(void)
+/*
+ * APP_SD_WriteTimestampToOpenFile
+ *
+ * Write the time a row was stored (the end of its averaging window)
+ */
+void APP_SD_WriteTimestampToOpenFile(DATAFIELD_TIMESTAMP const * timestamp)
 {
     char buffer[30];
-    time_increment_seconds(&s_lastSDTimestamp);
-    CSV_writeTimestampToBuffer(&s_lastSDTimestamp, buffer);
+    TM time;
+    Time_FromUnixSeconds(timestamp->seconds, &time);
+    CSV_writeTimestampToBuffer(&time, buffer);
     s_sdCard->write(s_fileHandle, buffer);
     s_sdCard->write(s_fileHandle, ", ");
 }
@@ -231,6 +377,67 @@ void APP_SD_WriteEntryIDToOpenFile(void)
     s_sdCard->write(s_fileHandle, buffer);
 }
 
+/*
+ * APP_SD_SpillRows
+ *
+ * Remove the oldest row from a full data manager and append it to the spill file for that manager
+ * (Datalogger/Spill_<name>.csv), so that it is not lost.
+ * Each line is the time the row was stored, the row index, then the data (including any statistics columns).
+ *
+ * pManager : The manager to remove the row from
+ * name : Name of the manager's data (used for the filename)
+ */
+void APP_SD_SpillRows(DataFieldManager * pManager, char const * const name)
+{
+    char buffer[30];
+    char spillPath[50];
+    float data[MAX_COLUMNS];
+    uint32_t index;
+    DATAFIELD_TIMESTAMP timestamp;
+    TM time;
+    uint8_t i;
+
+    uint8_t nColumns = pManager->columnCount();
+    if (pManager->count() == 0) { return; }
+
+    // The row is only removed once it can be written. If it cannot, the manager drops it (and counts the drop).
+    sprintf(spillPath, "%s/Spill_%s.csv", s_directory, name);
+    FILE_HANDLE spillHandle = s_sdCard->openFile(spillPath, true);
+
+    if (spillHandle == INVALID_HANDLE)
+    {
+        if (s_debugThisModule)
+        {
+            Serial.print("Could not open '");
+            Serial.print(spillPath);
+            Serial.println("' to spill data.");
+        }
+        return;
+    }
+
+    if (pManager->getDataRows(data, 1, APP_Data_ConversionEnabled(), true, &index, &timestamp) == 0)
+    {
+        s_sdCard->closeFile(spillHandle);
+        return;
+    }
+
+    Time_FromUnixSeconds(timestamp.seconds, &time);
+    CSV_writeTimestampToBuffer(&time, buffer);
+    s_sdCard->write(spillHandle, buffer);
+
+    sprintf(buffer, ", %lu", (unsigned long)index);
+    s_sdCard->write(spillHandle, buffer);
+
+    for (i = 0; i < nColumns; ++i)
+    {
+        sprintf(buffer, ", %.4f", data[i]);
+        s_sdCard->write(spillHandle, buffer);
+    }
+    s_sdCard->write(spillHandle, "\r\n");
+
+    s_sdCard->closeFile(spillHandle);
+}
+
 /*void APP_SD_ReadAllDataFromCurrentFile(char * buffer, uint32_t maxSize)
 {
     char const * const pFilename = Filename_get();
@@ -338,4 +545,5 @@ void APP_SD_EnableDebugging(void)
 void APP_SD_Tick(void)
 {
 	writeToSDCardTask.tick();
+	writeBurstTask.tick();
 }
\ No newline at end of file
@@ -12,9 +12,10 @@ void APP_SD_Setup(unsigned long msInterval);
 void APP_SD_CreateNewDataFile(void);
 void APP_SD_OpenDataFileForToday(void);
 void APP_SD_SetNewFilename(void);
-void APP_SD_WriteTimestampToOpenFile(void);
+void APP_SD_WriteTimestampToOpenFile(DATAFIELD_TIMESTAMP const * timestamp);
 void APP_SD_WriteEntryIDToOpenFile(void);
 void APP_SD_ReadAllDataFromCurrentFile(char * buffer, uint32_t maxSize);
+void APP_SD_SpillRows(DataFieldManager * pManager, char const * const name);
 
 void APP_SD_Tick(void);
 
@@ -5,7 +5,6 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
-#include <time.h>
 
 /*
  * Library Includes
@@ -23,14 +22,11 @@
  * Public Functions
  */
 
-bool APP_SerialRequestData_FormatArray(float * data, int n_fields, char * buffer, int buffer_length, TM * p_time)
+bool APP_SerialRequestData_FormatArray(float * data, int n_fields, char * buffer, int buffer_length, uint32_t timestamp)
 {
 	int i;
 	char sprintf_buffer[12];
 
-	time_t t;
-	t = mktime(p_time);
-	
 	if (!data) { return false; }
 	if (!buffer) { return false; }
 	if (n_fields == 0) { return false; }
@@ -39,7 +35,7 @@ bool APP_SerialRequestData_FormatArray(float * data, int n_fields, char * buffer
 		
 	accumulator.writeChar('s');
 
-	sprintf(sprintf_buffer, "%ld", t);
+	sprintf(sprintf_buffer, "%lu", (unsigned long)timestamp);
 	accumulator.writeString(sprintf_buffer);
 	accumulator.writeChar(',');
 	
@@ -1,6 +1,6 @@
 #ifndef _APP_SERIAL_REQUEST_DATA_H_
 #define _APP_SERIAL_REQUEST_DATA_H_
 
-bool APP_SerialRequestData_FormatArray(float * data, int n_fields, char * buffer, int length, TM * p_time);
+bool APP_SerialRequestData_FormatArray(float * data, int n_fields, char * buffer, int length, uint32_t timestamp);
 
 #endif
@@ -7,6 +7,9 @@ SRC_FILES += DLError/DLError.cpp
 
 SRC_FILES += DLDataField/DLDataField.cpp
 SRC_FILES += DLDataField/DLDataField.Manager.cpp
+SRC_FILES += DLDataField/DLDataField.ColumnarManager.cpp
+SRC_FILES += DLDataField/DLDataField.Aggregator.cpp
+SRC_FILES += DLDataField/DLDataField.Burst.cpp
 SRC_FILES += DLDataField/DLDataField.Numeric.cpp
 SRC_FILES += DLDataField/DLDataField.String.cpp
 SRC_FILES += DLDataField/DLDataField.Conversion.cpp
@@ -16,6 +19,7 @@ SRC_FILES += DLUtility/DLUtility.ArrayFunctions.cpp
 SRC_FILES += DLUtility/DLUtility.Averager.cpp
 SRC_FILES += DLUtility/DLUtility.Time.cpp
 SRC_FILES += DLUtility/DLUtility.PD.cpp
+SRC_FILES += DLUtility/DLUtility.FixedPoint.cpp DLUtility/DLUtility.Statistics.cpp DLUtility/DLUtility.Quantiles.cpp DLUtility/DLUtility.Reducers.cpp
 
 SRC_FILES += DLCSV/DLCSV.cpp
 
@@ -44,6 +48,9 @@ SRC_FILES += DLHTTP/DLHTTP.RequestBuilder.cpp
 SRC_FILES += DLHTTP/DLHTTP.ResponseParser.cpp
 
 SRC_FILES += DLSensor/DLSensor.Thermistor.cpp
+SRC_FILES += DLSensor/DLSensor.ADS1x1x.Scanner.cpp
+SRC_FILES += DLSensor/DLSensor.ADS1x1x.Topology.cpp
+SRC_FILES += DLSensor/DLSensor.I2C.cpp DLTest/DLTest.Mock.i2c.cpp
 
 SRC_FILES += DLTime/DLTime.cpp
 
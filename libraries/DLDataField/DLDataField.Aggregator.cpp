@@ -0,0 +1,516 @@
+/*
+ * DLDataField.Aggregator.cpp
+ *
+ * Provides shared multi-resolution averaging for several datafield managers
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+/*
+ * Datalogger Library Includes
+ */
+
+#include "DLUtility.FixedPoint.h"
+#include "DLUtility.Averager.h"
+#include "DLUtility.Statistics.h"
+#include "DLUtility.Reducers.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLDataField.Manager.h"
+#include "DLDataField.Aggregator.h"
+#include "DLUtility.h"
+#include "DLUtility.ArrayFunctions.h"
+
+/*
+ * Private Functions
+ */
+
+static void resetSums(int64_t * sums, uint8_t count)
+{
+    uint8_t i;
+    for (i = 0; i < count; i++)
+    {
+        sums[i] = 0;
+    }
+}
+
+static void resetStatistics(RUNNING_STATISTICS * stats, uint8_t count)
+{
+    uint8_t i;
+    for (i = 0; i < count; i++)
+    {
+        STATS_Reset(&stats[i]);
+    }
+}
+
+/*
+ * createReducer
+ *
+ * Returns a new reducer of the requested type for windows of size samples
+ * (or NULL for the mean, which the aggregator calculates itself from partial sums)
+ */
+static Reducer<int32_t> * createReducer(REDUCER_TYPE type, uint8_t parameter, uint16_t size)
+{
+    switch (type)
+    {
+    case REDUCER_MEDIAN:
+        return new MedianReducer<int32_t>(size);
+    case REDUCER_TRIMMED_MEAN:
+        return new TrimmedMeanReducer<int32_t>(size, parameter ? parameter : DEFAULT_TRIM_PERCENT);
+    case REDUCER_EMA:
+        return new EMAReducer<int32_t>(size);
+    case REDUCER_CIC:
+        return new CICReducer<int32_t>(size, parameter ? parameter : DEFAULT_CIC_ORDER);
+    case REDUCER_MEAN:
+    default:
+        return NULL;
+    }
+}
+
+/*
+ * DataFieldAggregator Class Functions
+ */
+
+DataFieldAggregator::DataFieldAggregator(uint16_t samplesPerPeriod)
+{
+    m_samplesPerPeriod = samplesPerPeriod ? samplesPerPeriod : 1;
+    m_baseCount = 0;
+    m_windowCount = 0;
+    m_fieldCount = 0;
+    m_baseStats = NULL;
+    m_statistics = NULL;
+    m_alignClock = NULL;
+
+    resetSums(m_baseSums, MAX_FIELDS);
+    fillArray(m_statisticsFields, false, MAX_FIELDS);
+    fillArray(m_reducedFields, false, MAX_FIELDS);
+    fillArray(m_percentileFields, false, MAX_FIELDS);
+}
+
+DataFieldAggregator::~DataFieldAggregator()
+{
+    uint8_t i;
+    for (i = 0; i < m_windowCount; i++)
+    {
+        freeWindow(&m_windows[i]);
+    }
+    delete[] m_baseStats;
+    delete[] m_statistics;
+}
+
+/*
+ * freeWindow
+ *
+ * Free everything allocated for a window (after addWindow fails, or on destruction)
+ */
+void DataFieldAggregator::freeWindow(AGGREGATOR_WINDOW * window)
+{
+    uint8_t field;
+
+    delete[] window->sums;
+    delete[] window->stats;
+
+    if (window->reducers)
+    {
+        for (field = 0; field < m_fieldCount; field++)
+        {
+            delete window->reducers[field];
+        }
+        delete[] window->reducers;
+    }
+
+    window->sums = NULL;
+    window->stats = NULL;
+    window->reducers = NULL;
+}
+
+/*
+ * addWindow
+ *
+ * Add a consumer that receives one average every periodsPerWindow base periods.
+ * The first consumer added sets the fields that are aggregated: the fields of
+ * any consumers added after that must match (same channels and sample divisors).
+ *
+ * consumer : The manager to push averages to. Its fields must already be set up.
+ * periodsPerWindow : Length of the averaging window in base periods
+ */
+bool DataFieldAggregator::addWindow(DataFieldManager * consumer, uint16_t periodsPerWindow)
+{
+    uint8_t field;
+
+    if (!consumer) { return false; }
+    if (periodsPerWindow == 0) { return false; }
+    if (m_windowCount == MAX_AGGREGATOR_WINDOWS) { return false; }
+
+    if (m_windowCount == 0)
+    {
+        m_fieldCount = consumer->fieldCount();
+        memcpy(m_dataIndexes, consumer->getDataIndexes(), m_fieldCount * sizeof(uint16_t));
+        memcpy(m_sampleDivisors, consumer->getSampleDivisors(), m_fieldCount * sizeof(uint8_t));
+
+        for (field = 0; field < m_fieldCount; field++)
+        {
+            if ((m_samplesPerPeriod % m_sampleDivisors[field]) != 0) { return false; }
+        }
+    }
+    else if (consumer->fieldCount() != m_fieldCount)
+    {
+        return false;
+    }
+    else if (memcmp(m_dataIndexes, consumer->getDataIndexes(), m_fieldCount * sizeof(uint16_t)) != 0)
+    {
+        return false;
+    }
+    else if (memcmp(m_sampleDivisors, consumer->getSampleDivisors(), m_fieldCount * sizeof(uint8_t)) != 0)
+    {
+        return false;
+    }
+
+    AGGREGATOR_WINDOW * window = &m_windows[m_windowCount];
+
+    window->consumer = consumer;
+    window->sums = new int64_t[m_fieldCount];
+    window->stats = NULL;
+    window->reducers = NULL;
+    window->count = 0;
+    window->periods = 0;
+    window->periodsPerWindow = periodsPerWindow;
+    window->boundary = 0;
+
+    if (!window->sums) { return false; }
+
+    resetSums(window->sums, m_fieldCount);
+
+    if (!setupStatistics(window) || !setupReducers(window))
+    {
+        freeWindow(window);
+        return false;
+    }
+
+    // Fields with percentiles enabled keep their own sketches, which get every raw sample
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        if (((NumericDataField*)consumer->getField(field))->hasPercentiles()) { m_percentileFields[field] = true; }
+    }
+
+    m_windowCount++;
+    return true;
+}
+
+/*
+ * setupStatistics
+ *
+ * If the window's consumer has any fields with statistics enabled, allocate running statistics for the window
+ * (and for the base period, if not already allocated). Statistics are only calculated for those fields.
+ */
+bool DataFieldAggregator::setupStatistics(AGGREGATOR_WINDOW * window)
+{
+    uint8_t field;
+    bool anyStatistics = false;
+
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        NumericDataField * pField = (NumericDataField*)window->consumer->getField(field);
+        if (pField->hasStatistics())
+        {
+            m_statisticsFields[field] = true;
+            anyStatistics = true;
+        }
+    }
+
+    if (!anyStatistics) { return true; }
+
+    window->stats = new RUNNING_STATISTICS[m_fieldCount];
+    if (!window->stats) { return false; }
+    resetStatistics(window->stats, m_fieldCount);
+
+    if (!m_baseStats)
+    {
+        m_baseStats = new RUNNING_STATISTICS[m_fieldCount];
+        m_statistics = new DATAFIELD_STATISTICS[m_fieldCount];
+        if (!m_baseStats || !m_statistics) { return false; }
+        resetStatistics(m_baseStats, m_fieldCount);
+    }
+
+    return true;
+}
+
+/*
+ * setupReducers
+ *
+ * Create a reducer for each of the window's consumer fields that does not use the mean.
+ * Reducers get every raw sample of the window, so the window must be at most 65535 samples long.
+ */
+bool DataFieldAggregator::setupReducers(AGGREGATOR_WINDOW * window)
+{
+    uint8_t field;
+    uint8_t i;
+    uint32_t samplesPerWindow = (uint32_t)window->periodsPerWindow * m_samplesPerPeriod;
+
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        NumericDataField * pField = (NumericDataField*)window->consumer->getField(field);
+        if (pField->getReducer() == REDUCER_MEAN) { continue; }
+
+        if (samplesPerWindow > 0xFFFF) { return false; }
+
+        if (!window->reducers)
+        {
+            window->reducers = new Reducer<int32_t> * [m_fieldCount];
+            if (!window->reducers) { return false; }
+            for (i = 0; i < m_fieldCount; i++) { window->reducers[i] = NULL; }
+        }
+
+        window->reducers[field] = createReducer(pField->getReducer(), pField->getReducerParameter(),
+            samplesPerWindow / m_sampleDivisors[field]);
+        if (!window->reducers[field]) { return false; }
+
+        m_reducedFields[field] = true;
+    }
+
+    return true;
+}
+
+/*
+ * alignToClock
+ *
+ * Close windows on multiples of their length in seconds of clock time (or on a count of base periods if clockFn is NULL).
+ * The base period must be one second.
+ */
+void DataFieldAggregator::alignToClock(DATAFIELD_CLOCK_FN * clockFn)
+{
+    uint8_t w;
+
+    m_alignClock = clockFn;
+    for (w = 0; w < m_windowCount; w++)
+    {
+        m_windows[w].boundary = 0;
+    }
+}
+
+uint8_t DataFieldAggregator::windowCount(void)
+{
+    return m_windowCount;
+}
+
+uint8_t DataFieldAggregator::fieldCount(void)
+{
+    return m_fieldCount;
+}
+
+/*
+ * sampleIsDue
+ *
+ * Returns true if fields with this sample divisor take a sample from the next scan.
+ * Channels that are not due can be left unread: their value in the scan array is ignored.
+ */
+bool DataFieldAggregator::sampleIsDue(uint8_t divisor)
+{
+    return DataField_SampleIsDue(m_baseCount, divisor);
+}
+
+/*
+ * storeDataArray
+ *
+ * Add a new scan of raw data. As with DataFieldManager::storeDataArray,
+ * the data array is for ALL channels on the platform (indexed by channel number - 1).
+ */
+void DataFieldAggregator::storeDataArray(int32_t * data)
+{
+    uint8_t field;
+    uint8_t w;
+    int32_t sample;
+
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        if (!DataField_SampleIsDue(m_baseCount, m_sampleDivisors[field])) { continue; }
+
+        sample = data[m_dataIndexes[field]];
+        m_baseSums[field] += sample;
+
+        if (m_statisticsFields[field])
+        {
+            STATS_Add(&m_baseStats[field], sample);
+        }
+
+        if (m_reducedFields[field])
+        {
+            for (w = 0; w < m_windowCount; w++)
+            {
+                if (m_windows[w].reducers && m_windows[w].reducers[field])
+                {
+                    m_windows[w].reducers[field]->newData(sample);
+                }
+            }
+        }
+
+        if (m_percentileFields[field])
+        {
+            for (w = 0; w < m_windowCount; w++)
+            {
+                ((NumericDataField*)m_windows[w].consumer->getField(field))->addPercentileSample(sample);
+            }
+        }
+    }
+
+    if (++m_baseCount == m_samplesPerPeriod)
+    {
+        closePeriod();
+    }
+}
+
+/*
+ * closePeriod
+ *
+ * Fold the base partial sums (and statistics) into each window, then start a new base period
+ */
+void DataFieldAggregator::closePeriod(void)
+{
+    uint8_t w;
+    uint8_t field;
+    AGGREGATOR_WINDOW * window;
+    DATAFIELD_TIMESTAMP now = {0, 0, 0};
+
+    if (m_alignClock) { m_alignClock(&now); }
+
+    for (w = 0; w < m_windowCount; w++)
+    {
+        window = &m_windows[w];
+
+        for (field = 0; field < m_fieldCount; field++)
+        {
+            window->sums[field] += m_baseSums[field];
+
+            if (window->stats && m_statisticsFields[field])
+            {
+                STATS_Merge(&window->stats[field], &m_baseStats[field]);
+            }
+        }
+        window->count += m_baseCount;
+
+        window->periods++;
+
+        if (windowIsDue(window, now.seconds))
+        {
+            closeWindow(window);
+        }
+    }
+
+    resetSums(m_baseSums, m_fieldCount);
+    if (m_baseStats) { resetStatistics(m_baseStats, m_fieldCount); }
+    m_baseCount = 0;
+}
+
+/*
+ * windowIsDue
+ *
+ * Returns true if a window should be closed at the end of the current base period.
+ * Unaligned windows (or aligned windows before the clock is valid) close after their number of base periods.
+ * Aligned windows close once the clock reaches their boundary. If the clock steps back by more than a window,
+ * the boundary is set again from the current time.
+ */
+bool DataFieldAggregator::windowIsDue(AGGREGATOR_WINDOW * window, uint32_t now)
+{
+    uint32_t length = window->periodsPerWindow;
+
+    if (!m_alignClock || (now == 0))
+    {
+        return window->periods >= window->periodsPerWindow;
+    }
+
+    if ((window->boundary == 0) || (window->boundary > (now + length)))
+    {
+        // The period that has just closed started one second ago
+        window->boundary = (((now - 1) / length) + 1) * length;
+    }
+
+    if (now < window->boundary) { return false; }
+
+    window->boundary = ((now / length) + 1) * length;
+    return true;
+}
+
+/*
+ * closeWindow
+ *
+ * Push the window averages (and statistics) to its consumer and start a new window.
+ * Fields with a reducer get the reducer's result instead of the mean.
+ * Windows shorter than their number of base periods (only possible when aligned) are flagged as partial.
+ */
+void DataFieldAggregator::closeWindow(AGGREGATOR_WINDOW * window)
+{
+    uint8_t field;
+    DATAFIELD_STATISTICS * stats = NULL;
+
+    if (window->stats)
+    {
+        for (field = 0; field < m_fieldCount; field++)
+        {
+            m_statistics[field].min = window->stats[field].min;
+            m_statistics[field].max = window->stats[field].max;
+            m_statistics[field].stddev = STATS_StdDev(&window->stats[field]);
+        }
+        stats = m_statistics;
+        resetStatistics(window->stats, m_fieldCount);
+    }
+
+    if (window->periods < window->periodsPerWindow)
+    {
+        window->consumer->flagNextRow(DATAFIELD_ROW_PARTIAL);
+    }
+
+    if (window->consumer->isFixedPoint())
+    {
+        for (field = 0; field < m_fieldCount; field++)
+        {
+            m_fixedAverages[field] = FIXED_Average(window->sums[field], window->count / m_sampleDivisors[field]);
+
+            if (window->reducers && window->reducers[field])
+            {
+                m_fixedAverages[field] = FIXED_FromFloat(window->reducers[field]->getFloatResult());
+            }
+        }
+
+        window->consumer->storeFixedAverageArray(m_fixedAverages, stats);
+    }
+    else
+    {
+        for (field = 0; field < m_fieldCount; field++)
+        {
+            m_averages[field] = (float)window->sums[field] / (float)(window->count / m_sampleDivisors[field]);
+
+            if (window->reducers && window->reducers[field])
+            {
+                m_averages[field] = window->reducers[field]->getFloatResult();
+            }
+        }
+
+        window->consumer->storeAverageArray(m_averages, stats);
+    }
+
+    if (window->reducers)
+    {
+        for (field = 0; field < m_fieldCount; field++)
+        {
+            if (window->reducers[field]) { window->reducers[field]->restart(); }
+        }
+    }
+
+    resetSums(window->sums, m_fieldCount);
+    window->count = 0;
+    window->periods = 0;
+}
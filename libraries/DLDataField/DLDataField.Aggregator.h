@@ -0,0 +1,94 @@
+#ifndef _DATAFIELD_AGGREGATOR_H_
+#define _DATAFIELD_AGGREGATOR_H_
+
+#define MAX_AGGREGATOR_WINDOWS 4
+
+/*
+ * DataFieldAggregator
+ *
+ * Averages raw data once for several DataFieldManagers ("consumers").
+ *
+ * Each raw sample is added to a single base accumulator per channel.
+ * When a base period closes (samplesPerPeriod samples), its partial sums
+ * are folded into every window. When a window has collected its number of
+ * base periods, its averages are pushed to that window's consumer.
+ *
+ * All consumers must have the same fields, in the same order.
+ * Consumers in fixed point mode get averages calculated with integer division.
+ *
+ * For fields with statistics enabled (in any consumer), running statistics are kept in the
+ * same way: per base period, then merged into each window that has statistics enabled.
+ *
+ * Fields with a reducer other than the mean (e.g. median) cannot be built from partial sums.
+ * Each window has its own reducer for these fields, which is given every raw sample.
+ * Likewise, fields with percentiles enabled are given every raw sample for their own sketch.
+ *
+ * Fields with a sample divisor (see NumericDataField::setSampleDivisor) are only given one scan in every divisor,
+ * so the divisor must divide samplesPerPeriod. sampleIsDue tells the caller which channels the next scan needs.
+ *
+ * Windows can be aligned to a clock (alignToClock) instead of counting base periods.
+ * The base period must then be one second: a window of N periods closes at the end of the period
+ * in which the clock reaches a multiple of N seconds (so 15 second windows close at :00, :15, :30 and :45).
+ * Windows that end with fewer than N periods (e.g. the first window) are flagged DATAFIELD_ROW_PARTIAL.
+ */
+
+struct running_statistics;
+template <typename T> class Reducer;
+
+struct aggregator_window
+{
+    DataFieldManager * consumer;
+    int64_t * sums;
+    struct running_statistics * stats; // NULL if the consumer has no statistics fields
+    Reducer<int32_t> ** reducers; // NULL if all the consumer's fields use the mean
+    uint32_t count;
+    uint16_t periods;
+    uint16_t periodsPerWindow;
+    uint32_t boundary; // Clock time the window closes at (aligned windows only, 0 until the first period closes)
+};
+typedef struct aggregator_window AGGREGATOR_WINDOW;
+
+class DataFieldAggregator
+{
+    public:
+        DataFieldAggregator(uint16_t samplesPerPeriod);
+        ~DataFieldAggregator();
+
+        bool addWindow(DataFieldManager * consumer, uint16_t periodsPerWindow);
+        void alignToClock(DATAFIELD_CLOCK_FN * clockFn);
+        uint8_t windowCount(void);
+        uint8_t fieldCount(void);
+        bool sampleIsDue(uint8_t divisor);
+
+        void storeDataArray(int32_t * data);
+
+    private:
+        void closePeriod(void);
+        void closeWindow(AGGREGATOR_WINDOW * window);
+        bool windowIsDue(AGGREGATOR_WINDOW * window, uint32_t now);
+        bool setupStatistics(AGGREGATOR_WINDOW * window);
+        bool setupReducers(AGGREGATOR_WINDOW * window);
+        void freeWindow(AGGREGATOR_WINDOW * window);
+
+        AGGREGATOR_WINDOW m_windows[MAX_AGGREGATOR_WINDOWS];
+        uint8_t m_windowCount;
+
+        uint16_t m_dataIndexes[MAX_FIELDS]; // Index of each field's sample in the scan array (from the first consumer)
+        uint8_t m_sampleDivisors[MAX_FIELDS];
+        uint8_t m_fieldCount;
+
+        int64_t m_baseSums[MAX_FIELDS];
+        struct running_statistics * m_baseStats;
+        bool m_statisticsFields[MAX_FIELDS];
+        DATAFIELD_STATISTICS * m_statistics;
+        bool m_reducedFields[MAX_FIELDS];
+        bool m_percentileFields[MAX_FIELDS];
+        uint16_t m_baseCount;
+        uint16_t m_samplesPerPeriod;
+        DATAFIELD_CLOCK_FN * m_alignClock;
+
+        float m_averages[MAX_FIELDS];
+        FIXED m_fixedAverages[MAX_FIELDS];
+};
+
+#endif
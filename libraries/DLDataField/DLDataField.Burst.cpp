@@ -0,0 +1,347 @@
+/*
+ * DLDataField.Burst.cpp
+ *
+ * Captures raw samples before and after a trigger event
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+/*
+ * Datalogger Library Includes
+ */
+
+#include "DLUtility.FixedPoint.h"
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLDataField.Manager.h"
+#include "DLDataField.Burst.h"
+
+/*
+ * BurstCapture Class Functions
+ */
+
+BurstCapture::BurstCapture(uint16_t preSamples, uint16_t postSamples)
+{
+    // The triggering scan is the first post-trigger sample, so there is always at least one
+    m_postSamples = postSamples ? postSamples : 1;
+    m_preSamples = ((uint32_t)preSamples + m_postSamples > 0xFFFF) ? (0xFFFF - m_postSamples) : preSamples;
+    m_length = m_preSamples + m_postSamples;
+
+    m_channelCount = 0;
+    m_havePrevious = false;
+    m_samples = NULL;
+    m_head = 0;
+    m_filled = 0;
+    m_remaining = 0;
+    m_start = 0;
+    m_triggerIndex = 0;
+    m_triggerField = 0;
+    m_state = BURST_IDLE;
+    m_clockFn = NULL;
+    m_triggerTime.seconds = 0;
+    m_triggerTime.millis = 0;
+    m_triggerTime.flags = 0;
+    m_missedTriggers = 0;
+}
+
+BurstCapture::~BurstCapture()
+{
+    delete[] m_samples;
+}
+
+/*
+ * addChannel
+ *
+ * Add a channel to capture. Every channel added is captured, but only those with a trigger
+ * (type other than TRIGGER_NONE) can start a burst. Channels must be added before allocate().
+ *
+ * channelNumber : The platform channel number (1-indexed, as for DataFieldManager::storeDataArray)
+ * type : The trigger condition for this channel
+ * level : Threshold (or change between consecutive samples for TRIGGER_RATE) in raw ADC counts
+ */
+bool BurstCapture::addChannel(uint32_t channelNumber, TRIGGER_TYPE type, int32_t level)
+{
+    if (m_samples) { return false; }
+    if (m_channelCount == MAX_FIELDS) { return false; }
+    if (channelNumber == 0) { return false; }
+    if (type >= INVALID_TRIGGER) { return false; }
+    if ((type == TRIGGER_RATE) && (level < 0)) { return false; }
+
+    m_channelNumbers[m_channelCount] = channelNumber;
+    m_dataIndexes[m_channelCount] = (uint16_t)(channelNumber - 1);
+    m_triggerTypes[m_channelCount] = type;
+    m_triggerLevels[m_channelCount] = level;
+    m_previous[m_channelCount] = 0;
+    m_active[m_channelCount] = false;
+    m_channelCount++;
+
+    return true;
+}
+
+uint8_t BurstCapture::channelCount(void)
+{
+    return m_channelCount;
+}
+
+uint32_t * BurstCapture::getChannelNumbers(void)
+{
+    return m_channelNumbers;
+}
+
+bool BurstCapture::hasTriggers(void)
+{
+    uint8_t i;
+    for (i = 0; i < m_channelCount; i++)
+    {
+        if (m_triggerTypes[i] != TRIGGER_NONE) { return true; }
+    }
+    return false;
+}
+
+/*
+ * setClock
+ *
+ * Record the time of each trigger using clockFn (or not, if clockFn is NULL)
+ */
+void BurstCapture::setClock(DATAFIELD_CLOCK_FN * clockFn)
+{
+    m_clockFn = clockFn;
+}
+
+/*
+ * allocate
+ *
+ * Allocate the sample ring (one value per channel for each of preSamples + postSamples scans).
+ * All channels must have been added.
+ */
+bool BurstCapture::allocate(void)
+{
+    if (m_samples) { return false; }
+    if (m_channelCount == 0) { return false; }
+
+    m_samples = new int32_t[(uint32_t)m_length * m_channelCount];
+    return m_samples != NULL;
+}
+
+/*
+ * checkTriggers
+ *
+ * Update the trigger state of each channel with a new scan.
+ * Returns the index of the first channel whose trigger fired on this scan, or -1 if none did.
+ */
+int8_t BurstCapture::checkTriggers(int32_t const * data)
+{
+    uint8_t i;
+    int8_t fired = -1;
+    int32_t sample;
+    int32_t change;
+    bool condition;
+
+    for (i = 0; i < m_channelCount; i++)
+    {
+        if (m_triggerTypes[i] == TRIGGER_NONE) { continue; }
+
+        sample = data[m_dataIndexes[i]];
+
+        switch (m_triggerTypes[i])
+        {
+        case TRIGGER_ABOVE:
+            condition = sample > m_triggerLevels[i];
+            break;
+        case TRIGGER_BELOW:
+            condition = sample < m_triggerLevels[i];
+            break;
+        case TRIGGER_RATE:
+            change = sample - m_previous[i];
+            if (change < 0) { change = -change; }
+            condition = m_havePrevious && (change > m_triggerLevels[i]);
+            break;
+        default:
+            condition = false;
+            break;
+        }
+
+        if (condition && !m_active[i] && (fired == -1))
+        {
+            fired = i;
+        }
+
+        m_active[i] = condition;
+        m_previous[i] = sample;
+    }
+
+    m_havePrevious = true;
+    return fired;
+}
+
+/*
+ * writeScan
+ *
+ * Copy the captured channels of a scan into the ring
+ */
+void BurstCapture::writeScan(int32_t const * data)
+{
+    uint8_t i;
+    int32_t * pScan = &m_samples[(uint32_t)m_head * m_channelCount];
+
+    for (i = 0; i < m_channelCount; i++)
+    {
+        pScan[i] = data[m_dataIndexes[i]];
+    }
+
+    m_head = (m_head + 1) % m_length;
+    if (m_filled < m_length) { m_filled++; }
+}
+
+/*
+ * storeDataArray
+ *
+ * Add a new scan of raw data. As with DataFieldManager::storeDataArray,
+ * the data array is for ALL channels on the platform (indexed by channel number - 1).
+ */
+void BurstCapture::storeDataArray(int32_t const * data)
+{
+    int8_t fired;
+    uint16_t triggerSlot;
+
+    if (!m_samples) { return; }
+
+    fired = checkTriggers(data);
+
+    switch (m_state)
+    {
+    case BURST_IDLE:
+        writeScan(data);
+        if (fired == -1) { break; }
+
+        // The burst starts up to preSamples scans before the triggering scan
+        m_triggerField = fired;
+        m_triggerIndex = (m_filled - 1) < m_preSamples ? (m_filled - 1) : m_preSamples;
+        triggerSlot = (m_head + m_length - 1) % m_length;
+        m_start = (triggerSlot + m_length - m_triggerIndex) % m_length;
+
+        if (m_clockFn) { m_clockFn(&m_triggerTime); }
+        m_triggerTime.flags = 0;
+
+        m_remaining = m_postSamples - 1;
+        m_state = (m_remaining == 0) ? BURST_READY : BURST_CAPTURING;
+        break;
+
+    case BURST_CAPTURING:
+        // Triggers during the capture are part of the same burst
+        writeScan(data);
+        if (--m_remaining == 0) { m_state = BURST_READY; }
+        break;
+
+    case BURST_READY:
+        // The previous burst has not been read yet, so this one is lost
+        if (fired != -1) { m_missedTriggers++; }
+        break;
+    }
+}
+
+BURST_STATE BurstCapture::state(void)
+{
+    return m_state;
+}
+
+bool BurstCapture::ready(void)
+{
+    return m_state == BURST_READY;
+}
+
+/*
+ * triggerChannel
+ *
+ * Returns the channel number that triggered the burst (0 if no burst is ready)
+ */
+uint32_t BurstCapture::triggerChannel(void)
+{
+    return ready() ? m_channelNumbers[m_triggerField] : 0;
+}
+
+/*
+ * sampleCount
+ *
+ * Returns the number of scans in the ready burst (0 if no burst is ready)
+ */
+uint16_t BurstCapture::sampleCount(void)
+{
+    return ready() ? (m_triggerIndex + m_postSamples) : 0;
+}
+
+/*
+ * triggerIndex
+ *
+ * Returns the index of the triggering scan in the ready burst (the number of pre-trigger scans)
+ */
+uint16_t BurstCapture::triggerIndex(void)
+{
+    return ready() ? m_triggerIndex : 0;
+}
+
+/*
+ * getScan
+ *
+ * Copy scan n of the ready burst (0 is the oldest) into values, one per channel in the order they were added
+ */
+bool BurstCapture::getScan(uint16_t n, int32_t * values)
+{
+    uint16_t slot;
+
+    if (!values) { return false; }
+    if (n >= sampleCount()) { return false; }
+
+    slot = (m_start + n) % m_length;
+    memcpy(values, &m_samples[(uint32_t)slot * m_channelCount], m_channelCount * sizeof(int32_t));
+    return true;
+}
+
+/*
+ * getTriggerTime
+ *
+ * Get the time the ready burst was triggered (returns false if there is no burst or no clock)
+ */
+bool BurstCapture::getTriggerTime(DATAFIELD_TIMESTAMP * timestamp)
+{
+    if (!timestamp || !ready() || !m_clockFn) { return false; }
+    *timestamp = m_triggerTime;
+    return true;
+}
+
+/*
+ * release
+ *
+ * Discard the ready burst and start filling the pre-trigger history again
+ */
+void BurstCapture::release(void)
+{
+    m_state = BURST_IDLE;
+    m_head = 0;
+    m_filled = 0;
+}
+
+/*
+ * missedTriggers
+ *
+ * Returns the number of triggers that fired while a burst was waiting to be read
+ */
+uint32_t BurstCapture::missedTriggers(void)
+{
+    return m_missedTriggers;
+}
@@ -0,0 +1,86 @@
+#ifndef _DATAFIELD_BURST_H_
+#define _DATAFIELD_BURST_H_
+
+/*
+ * BurstCapture
+ *
+ * Captures raw samples around a trigger event, at the full scan rate.
+ *
+ * Every scan of raw data is copied into a ring of (preSamples + postSamples) scans.
+ * When a channel's trigger condition becomes true, the capture continues for postSamples scans
+ * (including the triggering scan) and is then frozen until the application has read it out and
+ * called release(). The frozen burst holds up to preSamples scans from before the trigger.
+ *
+ * Triggers are edge sensitive: a level that stays above (or below) its threshold only fires once.
+ * Triggers that fire while a burst is waiting to be read are counted as missed.
+ *
+ * Storing a scan copies one value per channel and never waits on the reader,
+ * so it can be called from the same place as the averaging.
+ */
+
+enum burst_state
+{
+    BURST_IDLE,
+    BURST_CAPTURING,
+    BURST_READY
+};
+typedef enum burst_state BURST_STATE;
+
+class BurstCapture
+{
+    public:
+        BurstCapture(uint16_t preSamples, uint16_t postSamples);
+        ~BurstCapture();
+
+        bool addChannel(uint32_t channelNumber, TRIGGER_TYPE type, int32_t level);
+        uint8_t channelCount(void);
+        uint32_t * getChannelNumbers(void);
+        bool hasTriggers(void);
+        void setClock(DATAFIELD_CLOCK_FN * clockFn);
+
+        bool allocate(void);
+
+        void storeDataArray(int32_t const * data);
+
+        BURST_STATE state(void);
+        bool ready(void);
+        uint32_t triggerChannel(void);
+        uint16_t sampleCount(void);
+        uint16_t triggerIndex(void);
+        bool getScan(uint16_t n, int32_t * values);
+        bool getTriggerTime(DATAFIELD_TIMESTAMP * timestamp);
+        void release(void);
+
+        uint32_t missedTriggers(void);
+
+    private:
+        int8_t checkTriggers(int32_t const * data);
+        void writeScan(int32_t const * data);
+
+        uint32_t m_channelNumbers[MAX_FIELDS];
+        uint16_t m_dataIndexes[MAX_FIELDS];
+        TRIGGER_TYPE m_triggerTypes[MAX_FIELDS];
+        int32_t m_triggerLevels[MAX_FIELDS];
+        int32_t m_previous[MAX_FIELDS];
+        bool m_active[MAX_FIELDS];
+        bool m_havePrevious;
+        uint8_t m_channelCount;
+
+        int32_t * m_samples;
+        uint16_t m_preSamples;
+        uint16_t m_postSamples;
+        uint16_t m_length;
+        uint16_t m_head;
+        uint16_t m_filled;
+        uint16_t m_remaining;
+        uint16_t m_start;
+        uint16_t m_triggerIndex;
+        uint8_t m_triggerField;
+
+        BURST_STATE m_state;
+        DATAFIELD_CLOCK_FN * m_clockFn;
+        DATAFIELD_TIMESTAMP m_triggerTime;
+        uint32_t m_missedTriggers;
+};
+
+#endif
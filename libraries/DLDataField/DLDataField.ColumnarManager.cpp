@@ -0,0 +1,933 @@
+/*
+ * DLDataField.ColumnarManager.cpp
+ *
+ * Provides management of datafields with contiguous row storage
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+/*
+ * Datalogger Library Includes
+ */
+
+#include "DLUtility.FixedPoint.h"
+#include "DLUtility.Averager.h"
+#include "DLUtility.Statistics.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLDataField.Manager.h"
+#include "DLDataField.ColumnarManager.h"
+#include "DLUtility.h"
+#include "DLUtility.ArrayFunctions.h"
+
+/*
+ * Private Functions
+ */
+
+static uint8_t columnsForField(DataField * field)
+{
+    return 1 + ((NumericDataField*)field)->statisticsColumnCount();
+}
+
+static bool anyFieldHasStatistics(DataField ** fields, uint8_t fieldCount)
+{
+    uint8_t field;
+
+    for (field = 0; field < fieldCount; field++)
+    {
+        if (((NumericDataField*)fields[field])->hasStatistics()) { return true; }
+    }
+    return false;
+}
+
+static bool anyFieldHasDeadband(DataField ** fields, uint8_t fieldCount)
+{
+    uint8_t field;
+
+    for (field = 0; field < fieldCount; field++)
+    {
+        if (((NumericDataField*)fields[field])->hasDeadband()) { return true; }
+    }
+    return false;
+}
+
+/* Restart the fields' percentile sketches when a row is discarded */
+static void discardPercentiles(DataField ** fields, uint8_t fieldCount)
+{
+    uint8_t field;
+
+    for (field = 0; field < fieldCount; field++)
+    {
+        ((NumericDataField*)fields[field])->discardPercentiles();
+    }
+}
+
+static void singleSampleStatistics(DATAFIELD_STATISTICS * stats, float value)
+{
+    stats->min = value;
+    stats->max = value;
+    stats->stddev = 0.0f;
+}
+
+/*
+ * readStatistics, writeStatistics
+ *
+ * Copy a field's statistics and percentiles columns to or from stats.
+ * Values in stats without a column are zeroed by readStatistics.
+ */
+static void readStatistics(NumericDataField * field, float const * columns, DATAFIELD_STATISTICS * stats)
+{
+    uint8_t s;
+    memset(stats, 0, sizeof(DATAFIELD_STATISTICS));
+    for (s = 0; s < field->statisticsColumnCount(); s++)
+    {
+        DataField_SetStatistic(stats, field->statisticsColumn(s), columns[s]);
+    }
+}
+
+static void readFixedStatistics(NumericDataField * field, FIXED const * columns, DATAFIELD_STATISTICS * stats)
+{
+    uint8_t s;
+    memset(stats, 0, sizeof(DATAFIELD_STATISTICS));
+    for (s = 0; s < field->statisticsColumnCount(); s++)
+    {
+        DataField_SetStatistic(stats, field->statisticsColumn(s), FIXED_ToFloat(columns[s]));
+    }
+}
+
+static void writeStatistics(NumericDataField * field, DATAFIELD_STATISTICS const * stats, float * columns)
+{
+    uint8_t s;
+    for (s = 0; s < field->statisticsColumnCount(); s++)
+    {
+        columns[s] = DataField_GetStatistic(stats, field->statisticsColumn(s));
+    }
+}
+
+static void writeFixedStatistics(NumericDataField * field, DATAFIELD_STATISTICS const * stats, FIXED * columns)
+{
+    uint8_t s;
+    for (s = 0; s < field->statisticsColumnCount(); s++)
+    {
+        columns[s] = FIXED_FromFloat(DataField_GetStatistic(stats, field->statisticsColumn(s)));
+    }
+}
+
+/*
+ * ColumnarDataFieldManager Class Functions
+ */
+
+ColumnarDataFieldManager::ColumnarDataFieldManager(uint32_t dataSize, uint32_t averagerSize) :
+    DataFieldManager(dataSize, averagerSize)
+{
+    m_sums = NULL;
+    m_runningStats = NULL;
+    m_rows = NULL;
+    m_fixedRows = NULL;
+    m_columnCount = 0;
+    m_changedMasks = NULL;
+    m_deadbandsEnabled = false;
+    m_heartbeatRows = 0;
+    m_rowsSinceHeartbeat = 0;
+    m_averagerCount = 0;
+    m_write = 0;
+    m_read = 0;
+    m_rowCount = 0;
+    resetCounters();
+}
+
+ColumnarDataFieldManager::~ColumnarDataFieldManager() {}
+
+bool ColumnarDataFieldManager::addField(NumericDataField * field)
+{
+    return DataFieldManager::addField(field);
+}
+
+bool ColumnarDataFieldManager::addField(StringDataField * field)
+{
+    (void)field;
+    return false;
+}
+
+/*
+ * storageSize
+ *
+ * Data is stored by the manager, not the fields. The running sums for averaging
+ * and the rows share the arena: fieldCount int64_t sums, then (if any field has statistics enabled)
+ * running statistics for each field, followed by dataSize x columnCount floats
+ * (or Q16.16 values, which are the same size, in fixed point mode).
+ * If deadbands are enabled for any field, a mask of the changed fields in each row follows the rows.
+ */
+uint32_t ColumnarDataFieldManager::storageSize(void)
+{
+    uint32_t size = m_fieldCount * sizeof(int64_t);
+
+    if (anyFieldHasStatistics(m_fields, m_fieldCount)) { size += m_fieldCount * sizeof(RUNNING_STATISTICS); }
+
+    size += m_dataSize * columnCount() * sizeof(float);
+
+    if (m_deadbandsEnabled && anyFieldHasDeadband(m_fields, m_fieldCount)) { size += m_dataSize * sizeof(uint32_t); }
+
+    return size;
+}
+
+void ColumnarDataFieldManager::carveStorage(uint8_t * arena)
+{
+    uint8_t field;
+
+    m_columnCount = columnCount();
+    m_sums = (int64_t *)arena;
+    arena += m_fieldCount * sizeof(int64_t);
+
+    if (anyFieldHasStatistics(m_fields, m_fieldCount))
+    {
+        m_runningStats = (RUNNING_STATISTICS *)arena;
+        arena += m_fieldCount * sizeof(RUNNING_STATISTICS);
+
+        for (field = 0; field < m_fieldCount; field++)
+        {
+            STATS_Reset(&m_runningStats[field]);
+        }
+    }
+
+    m_rows = (float *)arena;
+    m_fixedRows = (FIXED *)m_rows;
+    arena += m_dataSize * m_columnCount * sizeof(float);
+
+    if (m_deadbandsEnabled && anyFieldHasDeadband(m_fields, m_fieldCount))
+    {
+        m_changedMasks = (uint32_t *)arena;
+    }
+}
+
+/*
+ * enableDeadbands
+ *
+ * Apply each field's deadband (see NumericDataField::setDeadband) to the rows stored.
+ * A row is only stored if a field with a deadband has moved outside it, and only those fields
+ * are marked as changed in the row. Fields without a deadband do not decide whether a row is
+ * stored, but are marked as changed in every row that is.
+ * Every heartbeatRows rows (0 for never), a row with all fields changed is stored anyway.
+ * Must be called before storage is allocated.
+ *
+ * Returns false if storage has already been allocated
+ */
+bool ColumnarDataFieldManager::enableDeadbands(uint16_t heartbeatRows)
+{
+    if (m_arena) { return false; }
+    m_deadbandsEnabled = true;
+    m_heartbeatRows = heartbeatRows;
+    return true;
+}
+
+/*
+ * changedFields
+ *
+ * Returns a mask of the fields to emit with a new row of raw averages (0 if the row can be skipped)
+ */
+uint32_t ColumnarDataFieldManager::changedFields(float const * averages)
+{
+    uint8_t field;
+    uint32_t mask = 0;
+    uint32_t noDeadbandMask = 0;
+    NumericDataField * pField;
+
+    if (!m_changedMasks) { return allFieldsMask(); }
+
+    if (m_heartbeatRows && (++m_rowsSinceHeartbeat >= m_heartbeatRows)) { return allFieldsMask(); }
+
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        pField = (NumericDataField*)m_fields[field];
+        if (!pField->hasDeadband()) { noDeadbandMask |= (1UL << field); }
+        else if (pField->outsideDeadband(averages[field])) { mask |= (1UL << field); }
+    }
+
+    // Only fields with a deadband decide whether the row is stored
+    return mask ? (mask | noDeadbandMask) : 0;
+}
+
+/*
+ * admitRow
+ *
+ * Decide whether a new row of raw averages is stored (see enableDeadbands) and if so, get the offset to write it to
+ * (see appendRow) and record the fields that changed in it.
+ * averages is only used if deadbands are enabled.
+ *
+ * Returns false if the row should not be stored
+ */
+bool ColumnarDataFieldManager::admitRow(float const * averages, uint32_t * offset)
+{
+    uint8_t field;
+    uint32_t mask = changedFields(averages);
+
+    if (mask == 0)
+    {
+        m_counters.suppressed++;
+        discardPercentiles(m_fields, m_fieldCount);
+        return false;
+    }
+
+    if (!appendRow(offset))
+    {
+        discardPercentiles(m_fields, m_fieldCount);
+        return false;
+    }
+
+    if (m_changedMasks)
+    {
+        m_changedMasks[(m_totalRows - 1) % m_dataSize] = mask;
+
+        for (field = 0; field < m_fieldCount; field++)
+        {
+            if (mask & (1UL << field)) { ((NumericDataField*)m_fields[field])->setEmitted(averages[field]); }
+        }
+
+        if (mask == allFieldsMask()) { m_rowsSinceHeartbeat = 0; }
+    }
+
+    return true;
+}
+
+/*
+ * appendRow
+ *
+ * Get the offset (into m_rows or m_fixedRows) of the next row to write.
+ * If all rows are used, the overflow policy decides whether to spill or discard the oldest row
+ * or discard the new row.
+ *
+ * Returns false if the new row should be discarded
+ */
+bool ColumnarDataFieldManager::appendRow(uint32_t * offset)
+{
+    spillIfFull();
+
+    if (m_rowCount == m_dataSize)
+    {
+        m_counters.drops++;
+
+        if (m_overflowPolicy == OVERFLOW_DROP_NEWEST)
+        {
+            m_nextRowFlags = 0;
+            return false;
+        }
+
+        incrementwithrollover(m_read, m_dataSize - 1);
+        m_rowCount--;
+    }
+
+    *offset = m_write * m_columnCount;
+
+    incrementwithrollover(m_write, m_dataSize - 1);
+    m_rowCount++;
+    stampRow(m_totalRows);
+    m_totalRows++;
+    m_counters.pushes++;
+
+    return true;
+}
+
+/*
+ * rowOffset
+ *
+ * Returns the offset (into m_rows or m_fixedRows) of the nth oldest row
+ */
+uint32_t ColumnarDataFieldManager::rowOffset(uint32_t n)
+{
+    return ((m_read + n) % m_dataSize) * m_columnCount;
+}
+
+/*
+ * finishRead
+ *
+ * Fill in row indexes, timestamps and changed fields and remove rows (if requested) after reading rowCount rows
+ */
+void ColumnarDataFieldManager::finishRead(uint32_t rowCount, bool alsoRemove, uint32_t * rowIndexes,
+    DATAFIELD_TIMESTAMP * timestamps, uint32_t * changedFields)
+{
+    uint32_t row;
+    uint32_t firstIndex = m_totalRows - m_rowCount;
+
+    if (rowIndexes)
+    {
+        for (row = 0; row < rowCount; row++)
+        {
+            rowIndexes[row] = firstIndex + row;
+        }
+    }
+
+    if (timestamps)
+    {
+        for (row = 0; row < rowCount; row++)
+        {
+            readTimestamp(firstIndex + row, &timestamps[row]);
+        }
+    }
+
+    if (changedFields)
+    {
+        for (row = 0; row < rowCount; row++)
+        {
+            changedFields[row] = m_changedMasks ? m_changedMasks[(firstIndex + row) % m_dataSize] : allFieldsMask();
+        }
+    }
+
+    if (alsoRemove)
+    {
+        m_read = (m_read + rowCount) % m_dataSize;
+        m_rowCount -= rowCount;
+        m_counters.pops += rowCount;
+    }
+}
+
+/*
+ * storeStatistics
+ *
+ * Write a field's statistics and percentiles into the columns starting at offset (as Q16.16 in fixed point mode)
+ */
+void ColumnarDataFieldManager::storeStatistics(uint32_t offset, NumericDataField * field, DATAFIELD_STATISTICS const * stats)
+{
+    uint8_t s;
+
+    for (s = 0; s < field->statisticsColumnCount(); s++)
+    {
+        float value = DataField_GetStatistic(stats, field->statisticsColumn(s));
+
+        if (m_fixedPoint)
+        {
+            m_fixedRows[offset + s] = FIXED_FromFloat(value);
+        }
+        else
+        {
+            m_rows[offset + s] = value;
+        }
+    }
+}
+
+/*
+ * convertRow, convertFixedRow
+ *
+ * Convert a row (in place) using each field's conversion settings
+ */
+void ColumnarDataFieldManager::convertRow(float * row)
+{
+    uint8_t field;
+    uint8_t column = 0;
+    DATAFIELD_STATISTICS stats;
+
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        NumericDataField * pField = (NumericDataField*)m_fields[field];
+        float rawAverage = row[column];
+
+        row[column++] = pField->convert(rawAverage);
+
+        if (pField->statisticsColumnCount())
+        {
+            readStatistics(pField, &row[column], &stats);
+            pField->convertStatistics(rawAverage, &stats);
+            writeStatistics(pField, &stats, &row[column]);
+            column += pField->statisticsColumnCount();
+        }
+    }
+}
+
+void ColumnarDataFieldManager::convertFixedRow(FIXED * row)
+{
+    uint8_t field;
+    uint8_t column = 0;
+    DATAFIELD_STATISTICS stats;
+
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        NumericDataField * pField = (NumericDataField*)m_fields[field];
+        FIXED rawAverage = row[column];
+
+        row[column++] = pField->convertFixed(rawAverage);
+
+        if (pField->statisticsColumnCount())
+        {
+            // Statistics are converted in floating point
+            readFixedStatistics(pField, &row[column], &stats);
+            pField->convertStatistics(FIXED_ToFloat(rawAverage), &stats);
+            writeFixedStatistics(pField, &stats, &row[column]);
+            column += pField->statisticsColumnCount();
+        }
+    }
+}
+
+/*
+ * readFixedRow, readRowAsFixed
+ *
+ * Copy a row that is stored as Q16.16 to floats (and vice versa), converting it if requested.
+ * Averages are converted with the conversion for their stored type, so the same data gives the same
+ * result from float and fixed point getters.
+ */
+void ColumnarDataFieldManager::readFixedRow(FIXED const * src, float * dst, bool converted)
+{
+    uint8_t field;
+    uint8_t column = 0;
+    DATAFIELD_STATISTICS stats;
+
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        NumericDataField * pField = (NumericDataField*)m_fields[field];
+        FIXED rawAverage = src[column];
+
+        dst[column] = FIXED_ToFloat(converted ? pField->convertFixed(rawAverage) : rawAverage);
+        column++;
+
+        if (pField->statisticsColumnCount())
+        {
+            readFixedStatistics(pField, &src[column], &stats);
+            if (converted) { pField->convertStatistics(FIXED_ToFloat(rawAverage), &stats); }
+            writeStatistics(pField, &stats, &dst[column]);
+            column += pField->statisticsColumnCount();
+        }
+    }
+}
+
+void ColumnarDataFieldManager::readRowAsFixed(float const * src, FIXED * dst, bool converted)
+{
+    uint8_t field;
+    uint8_t column = 0;
+    DATAFIELD_STATISTICS stats;
+
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        NumericDataField * pField = (NumericDataField*)m_fields[field];
+        float rawAverage = src[column];
+
+        dst[column] = FIXED_FromFloat(converted ? pField->convert(rawAverage) : rawAverage);
+        column++;
+
+        if (pField->statisticsColumnCount())
+        {
+            readStatistics(pField, &src[column], &stats);
+            if (converted) { pField->convertStatistics(rawAverage, &stats); }
+            writeFixedStatistics(pField, &stats, &dst[column]);
+            column += pField->statisticsColumnCount();
+        }
+    }
+}
+
+/*
+ * storeDataArray
+ *
+ * Add a scan to the running sums (and statistics and percentile sketches, for fields with them enabled).
+ * When averagerSize scans have been added, a row is stored.
+ * Fields with a sample divisor are only given the scans DataField_SampleIsDue selects.
+ */
+void ColumnarDataFieldManager::storeDataArray(int32_t * data)
+{
+    if (!allocate()) { return; }
+
+    uint8_t field;
+    int32_t sample;
+    uint32_t samples[MAX_FIELDS];
+
+    // The incoming data array is for ALL channels for the platform
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        if (!DataField_SampleIsDue(m_averagerCount, m_sampleDivisors[field])) { continue; }
+
+        sample = data[m_dataIndexes[field]];
+        m_sums[field] += sample;
+
+        if (m_runningStats && ((NumericDataField*)m_fields[field])->hasStatistics())
+        {
+            STATS_Add(&m_runningStats[field], sample);
+        }
+
+        // The fields keep their own sketches
+        ((NumericDataField*)m_fields[field])->addPercentileSample(sample);
+    }
+
+    if (++m_averagerCount == m_averagerSize)
+    {
+        uint32_t offset;
+        DATAFIELD_STATISTICS stats;
+        float averages[MAX_FIELDS];
+
+        // Fields with a sample divisor only had one sample in every divisor scans
+        for (field = 0; field < m_fieldCount; field++)
+        {
+            samples[field] = m_averagerCount / m_sampleDivisors[field];
+        }
+
+        if (m_changedMasks)
+        {
+            for (field = 0; field < m_fieldCount; field++)
+            {
+                averages[field] = (float)m_sums[field] / (float)samples[field];
+            }
+        }
+
+        if (admitRow(averages, &offset))
+        {
+            for (field = 0; field < m_fieldCount; field++)
+            {
+                NumericDataField * pField = (NumericDataField*)m_fields[field];
+                float average = (float)m_sums[field] / (float)samples[field];
+
+                if (m_fixedPoint)
+                {
+                    m_fixedRows[offset] = FIXED_Average(m_sums[field], samples[field]);
+                }
+                else
+                {
+                    m_rows[offset] = average;
+                }
+                offset++;
+
+                if (pField->statisticsColumnCount())
+                {
+                    singleSampleStatistics(&stats, average);
+                    if (pField->hasStatistics())
+                    {
+                        stats.min = m_runningStats[field].min;
+                        stats.max = m_runningStats[field].max;
+                        stats.stddev = STATS_StdDev(&m_runningStats[field]);
+                    }
+                    pField->takePercentiles(&stats, average);
+                    storeStatistics(offset, pField, &stats);
+                    offset += pField->statisticsColumnCount();
+                }
+            }
+        }
+
+        fillArray(m_sums, (int64_t)0, m_fieldCount);
+        if (m_runningStats)
+        {
+            for (field = 0; field < m_fieldCount; field++)
+            {
+                STATS_Reset(&m_runningStats[field]);
+            }
+        }
+        m_averagerCount = 0;
+    }
+}
+
+/*
+ * storeAverageArray, storeFixedAverageArray
+ *
+ * Store a row of already-averaged values (one per field), with optional statistics (one per field).
+ * Without statistics, each average is treated as a single sample.
+ * Percentiles are taken from samples added to each field with addPercentileSample.
+ */
+void ColumnarDataFieldManager::storeAverageArray(float * averages, DATAFIELD_STATISTICS const * stats)
+{
+    if (!allocate()) { return; }
+
+    uint8_t field;
+    uint32_t offset;
+    NumericDataField * pField;
+    DATAFIELD_STATISTICS fieldStats;
+
+    if (!admitRow(averages, &offset)) { return; }
+
+    if (!m_fixedPoint && (m_columnCount == m_fieldCount))
+    {
+        memcpy(&m_rows[offset], averages, m_fieldCount * sizeof(float));
+        return;
+    }
+
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        if (m_fixedPoint)
+        {
+            m_fixedRows[offset++] = FIXED_FromFloat(averages[field]);
+        }
+        else
+        {
+            m_rows[offset++] = averages[field];
+        }
+
+        pField = (NumericDataField*)m_fields[field];
+        if (pField->statisticsColumnCount())
+        {
+            singleSampleStatistics(&fieldStats, averages[field]);
+            if (stats) { fieldStats = stats[field]; }
+            pField->takePercentiles(&fieldStats, averages[field]);
+            storeStatistics(offset, pField, &fieldStats);
+            offset += pField->statisticsColumnCount();
+        }
+    }
+}
+
+void ColumnarDataFieldManager::storeFixedAverageArray(FIXED * averages, DATAFIELD_STATISTICS const * stats)
+{
+    if (!allocate()) { return; }
+
+    uint8_t field;
+    uint32_t offset;
+    NumericDataField * pField;
+    DATAFIELD_STATISTICS fieldStats;
+    float floatAverages[MAX_FIELDS];
+
+    // Deadbands are compared as floating point
+    if (m_changedMasks)
+    {
+        for (field = 0; field < m_fieldCount; field++)
+        {
+            floatAverages[field] = FIXED_ToFloat(averages[field]);
+        }
+    }
+
+    if (!admitRow(floatAverages, &offset)) { return; }
+
+    if (m_fixedPoint && (m_columnCount == m_fieldCount))
+    {
+        memcpy(&m_fixedRows[offset], averages, m_fieldCount * sizeof(FIXED));
+        return;
+    }
+
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        if (m_fixedPoint)
+        {
+            m_fixedRows[offset++] = averages[field];
+        }
+        else
+        {
+            m_rows[offset++] = FIXED_ToFloat(averages[field]);
+        }
+
+        pField = (NumericDataField*)m_fields[field];
+        if (pField->statisticsColumnCount())
+        {
+            singleSampleStatistics(&fieldStats, FIXED_ToFloat(averages[field]));
+            if (stats) { fieldStats = stats[field]; }
+            pField->takePercentiles(&fieldStats, FIXED_ToFloat(averages[field]));
+            storeStatistics(offset, pField, &fieldStats);
+            offset += pField->statisticsColumnCount();
+        }
+    }
+}
+
+/*
+ * getDataArray, getFixedDataArray
+ *
+ * Get the oldest average of each field (one value per field, without statistics)
+ */
+void ColumnarDataFieldManager::getDataArray(float * buffer, bool converted, bool alsoRemove)
+{
+    if (m_rowCount == 0)
+    {
+        fillArray(buffer, DATAFIELD_NO_DATA_VALUE, m_fieldCount);
+        return;
+    }
+
+    uint8_t field;
+    uint32_t offset = rowOffset(0);
+
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        NumericDataField * pField = (NumericDataField*)m_fields[field];
+
+        if (m_fixedPoint)
+        {
+            FIXED value = m_fixedRows[offset];
+            buffer[field] = FIXED_ToFloat(converted ? pField->convertFixed(value) : value);
+        }
+        else
+        {
+            float value = m_rows[offset];
+            buffer[field] = converted ? pField->convert(value) : value;
+        }
+
+        offset += columnsForField(pField);
+    }
+
+    finishRead(1, alsoRemove, NULL, NULL, NULL);
+}
+
+void ColumnarDataFieldManager::getFixedDataArray(FIXED * buffer, bool converted, bool alsoRemove)
+{
+    if (m_rowCount == 0)
+    {
+        fillArray(buffer, (FIXED)DATAFIELD_NO_FIXED_DATA_VALUE, m_fieldCount);
+        return;
+    }
+
+    uint8_t field;
+    uint32_t offset = rowOffset(0);
+
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        NumericDataField * pField = (NumericDataField*)m_fields[field];
+
+        if (m_fixedPoint)
+        {
+            FIXED value = m_fixedRows[offset];
+            buffer[field] = converted ? pField->convertFixed(value) : value;
+        }
+        else
+        {
+            float value = m_rows[offset];
+            buffer[field] = FIXED_FromFloat(converted ? pField->convert(value) : value);
+        }
+
+        offset += columnsForField(pField);
+    }
+
+    finishRead(1, alsoRemove, NULL, NULL, NULL);
+}
+
+/*
+ * getDataRows
+ *
+ * As DataFieldManager::getDataRows, but any number of rows can be read without removal.
+ * Raw rows are copied with at most two block copies (before and after the ring wraps).
+ * In fixed point mode, each value is converted from fixed point (using fixed point conversion).
+ */
+uint32_t ColumnarDataFieldManager::getDataRows(float * buffer, uint32_t maxRows, bool converted, bool alsoRemove, uint32_t * rowIndexes,
+    DATAFIELD_TIMESTAMP * timestamps, uint32_t * changedFields)
+{
+    if (!buffer) { return 0; }
+
+    uint32_t rowCount = min(maxRows, m_rowCount);
+    if (rowCount == 0) { return 0; }
+
+    uint32_t row;
+
+    if (m_fixedPoint)
+    {
+        for (row = 0; row < rowCount; row++)
+        {
+            readFixedRow(&m_fixedRows[rowOffset(row)], &buffer[row * m_columnCount], converted);
+        }
+    }
+    else
+    {
+        // Rows from the read index up to the end of the block, then any that have wrapped to the start
+        uint32_t rowsBeforeWrap = min(rowCount, m_dataSize - m_read);
+        uint32_t rowsAfterWrap = rowCount - rowsBeforeWrap;
+
+        memcpy(buffer, &m_rows[m_read * m_columnCount], rowsBeforeWrap * m_columnCount * sizeof(float));
+        memcpy(&buffer[rowsBeforeWrap * m_columnCount], m_rows, rowsAfterWrap * m_columnCount * sizeof(float));
+
+        if (converted)
+        {
+            for (row = 0; row < rowCount; row++)
+            {
+                convertRow(&buffer[row * m_columnCount]);
+            }
+        }
+    }
+
+    finishRead(rowCount, alsoRemove, rowIndexes, timestamps, changedFields);
+
+    return rowCount;
+}
+
+/*
+ * getFixedDataRows
+ *
+ * As getDataRows, with data in Q16.16.
+ * In fixed point mode, no floating point operations are used for raw, voltage or current data.
+ */
+uint32_t ColumnarDataFieldManager::getFixedDataRows(FIXED * buffer, uint32_t maxRows, bool converted, bool alsoRemove, uint32_t * rowIndexes,
+    DATAFIELD_TIMESTAMP * timestamps, uint32_t * changedFields)
+{
+    if (!buffer) { return 0; }
+
+    uint32_t rowCount = min(maxRows, m_rowCount);
+    if (rowCount == 0) { return 0; }
+
+    uint32_t row;
+
+    if (m_fixedPoint)
+    {
+        uint32_t rowsBeforeWrap = min(rowCount, m_dataSize - m_read);
+        uint32_t rowsAfterWrap = rowCount - rowsBeforeWrap;
+
+        memcpy(buffer, &m_fixedRows[m_read * m_columnCount], rowsBeforeWrap * m_columnCount * sizeof(FIXED));
+        memcpy(&buffer[rowsBeforeWrap * m_columnCount], m_fixedRows, rowsAfterWrap * m_columnCount * sizeof(FIXED));
+
+        if (converted)
+        {
+            for (row = 0; row < rowCount; row++)
+            {
+                convertFixedRow(&buffer[row * m_columnCount]);
+            }
+        }
+    }
+    else
+    {
+        for (row = 0; row < rowCount; row++)
+        {
+            readRowAsFixed(&m_rows[rowOffset(row)], &buffer[row * m_columnCount], converted);
+        }
+    }
+
+    finishRead(rowCount, alsoRemove, rowIndexes, timestamps, changedFields);
+
+    return rowCount;
+}
+
+/*
+ * peekRow, peekFixedRow
+ *
+ * Returns a pointer to the oldest row (columnCount() values) or NULL if there is no data.
+ * peekRow is only valid if not in fixed point mode, peekFixedRow only if in fixed point mode.
+ */
+float * ColumnarDataFieldManager::peekRow(void)
+{
+    return (m_rowCount && !m_fixedPoint) ? &m_rows[m_read * m_columnCount] : NULL;
+}
+
+FIXED * ColumnarDataFieldManager::peekFixedRow(void)
+{
+    return (m_rowCount && m_fixedPoint) ? &m_fixedRows[m_read * m_columnCount] : NULL;
+}
+
+void ColumnarDataFieldManager::removeRow(void)
+{
+    if (m_rowCount)
+    {
+        incrementwithrollover(m_read, m_dataSize - 1);
+        m_rowCount--;
+        m_counters.pops++;
+    }
+}
+
+bool ColumnarDataFieldManager::hasData(void)
+{
+    return m_rowCount > 0;
+}
+
+uint32_t ColumnarDataFieldManager::count(void)
+{
+    return m_rowCount;
+}
+
+bool ColumnarDataFieldManager::getCounters(uint8_t index, DATAFIELD_COUNTERS * counters)
+{
+    if ((index >= m_fieldCount) || !counters) { return false; }
+    *counters = m_counters;
+    return true;
+}
+
+void ColumnarDataFieldManager::resetCounters(void)
+{
+    m_counters.pushes = 0;
+    m_counters.pops = 0;
+    m_counters.drops = 0;
+    m_counters.suppressed = 0;
+    m_spills = 0;
+}
@@ -0,0 +1,90 @@
+#ifndef _DATAFIELD_COLUMNAR_MANAGER_H_
+#define _DATAFIELD_COLUMNAR_MANAGER_H_
+
+/*
+ * ColumnarDataFieldManager
+ *
+ * A DataFieldManager that stores data for all its fields in one contiguous block,
+ * laid out as rows x fields with a single head/tail shared by all fields.
+ * Storing a scan appends one row and reading data reads one row.
+ *
+ * Fields only provide type and conversion information: they have no storage of their own,
+ * so their getRawData/getConvData functions cannot be used. Use getDataArray or peekRow instead.
+ *
+ * Only numeric fields are supported. All fields must be added before any data is stored,
+ * which allocates the storage for all fields in one block.
+ * Each row has a column for each field's average, followed by columns for its statistics if enabled.
+ * In fixed point mode, rows are stored as Q16.16 instead of float.
+ * All fields share one ring, so the push/pop/drop counters are the same for every field.
+ *
+ * With deadbands enabled, a row is only stored if a field with a deadband has moved outside it
+ * (or a heartbeat is due), and each row records which fields were emitted (changed) in it.
+ * Fields without a deadband never cause a row to be stored, and are emitted in every row that is.
+ */
+
+class ColumnarDataFieldManager : public DataFieldManager
+{
+    public:
+        ColumnarDataFieldManager(uint32_t dataSize, uint32_t averagerSize);
+        ~ColumnarDataFieldManager();
+
+        bool addField(NumericDataField * field);
+        bool addField(StringDataField * field);
+
+        void storeDataArray(int32_t * data);
+        void storeAverageArray(float * averages, DATAFIELD_STATISTICS const * stats = NULL);
+        void storeFixedAverageArray(FIXED * averages, DATAFIELD_STATISTICS const * stats = NULL);
+        void getDataArray(float * buffer, bool converted, bool alsoRemove);
+        void getFixedDataArray(FIXED * buffer, bool converted, bool alsoRemove);
+        uint32_t getDataRows(float * buffer, uint32_t maxRows, bool converted, bool alsoRemove, uint32_t * rowIndexes,
+            DATAFIELD_TIMESTAMP * timestamps = NULL, uint32_t * changedFields = NULL);
+        uint32_t getFixedDataRows(FIXED * buffer, uint32_t maxRows, bool converted, bool alsoRemove, uint32_t * rowIndexes,
+            DATAFIELD_TIMESTAMP * timestamps = NULL, uint32_t * changedFields = NULL);
+
+        float * peekRow(void);
+        FIXED * peekFixedRow(void);
+        void removeRow(void);
+
+        bool hasData(void);
+        uint32_t count(void);
+
+        bool enableDeadbands(uint16_t heartbeatRows);
+
+        bool getCounters(uint8_t index, DATAFIELD_COUNTERS * counters);
+        void resetCounters(void);
+
+    protected:
+        uint32_t storageSize(void);
+        void carveStorage(uint8_t * arena);
+
+    private:
+        bool appendRow(uint32_t * offset);
+        bool admitRow(float const * averages, uint32_t * offset);
+        uint32_t changedFields(float const * averages);
+        uint32_t rowOffset(uint32_t n);
+        void finishRead(uint32_t rowCount, bool alsoRemove, uint32_t * rowIndexes, DATAFIELD_TIMESTAMP * timestamps,
+            uint32_t * changedFields);
+        void storeStatistics(uint32_t offset, NumericDataField * field, DATAFIELD_STATISTICS const * stats);
+        void convertRow(float * row);
+        void convertFixedRow(FIXED * row);
+        void readFixedRow(FIXED const * src, float * dst, bool converted);
+        void readRowAsFixed(float const * src, FIXED * dst, bool converted);
+
+        int64_t * m_sums;
+        struct running_statistics * m_runningStats;
+        float * m_rows;
+        FIXED * m_fixedRows;
+        uint8_t m_columnCount;
+        uint32_t * m_changedMasks; // NULL unless deadbands are enabled and any field has one
+        bool m_deadbandsEnabled;
+        uint16_t m_heartbeatRows;
+        uint16_t m_rowsSinceHeartbeat;
+
+        uint32_t m_averagerCount;
+        uint32_t m_write;
+        uint32_t m_read;
+        uint32_t m_rowCount;
+        DATAFIELD_COUNTERS m_counters;
+};
+
+#endif
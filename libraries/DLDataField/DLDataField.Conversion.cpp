@@ -1,7 +1,7 @@
 /*
- * DLDataField.String.cpp
+ * DLDataField.Conversion.cpp
  * 
- * Stores single item of string data and provides get/set functionality
+ * Converts raw data into real-world units
  *
  * Author: James Fowkes
  *
@@ -18,18 +18,30 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #endif
 
 /*
  * Datalogger Library Includes
  */
 
+#include "DLUtility.FixedPoint.h"
 #include "DLUtility.Averager.h"
 #include "DLUtility.PD.h"
 #include "DLSensor.Thermistor.h"
 #include "DLDataField.Types.h"
+#include "DLDataField.Conversion.h"
 #include "DLDataField.h"
 
+/*
+ * Defines and Typedefs
+ */
+
+/* Thermistor lookup tables only interpolate over this range.
+Outside it (and close to open/short circuit) the curve is too steep to interpolate accurately. */
+#define THERMISTOR_LUT_MIN_C (-40.0f)
+#define THERMISTOR_LUT_MAX_C (125.0f)
+
 /*
  * Private Functions
  */
@@ -50,6 +62,49 @@ static float mvToAmps(float mV, float mVperAmp, float mvAtZero)
 	return (mV - mvAtZero) / mVperAmp;
 }
 
+/* 
+ * celsiusFromThermistor
+ *
+ * Exact thermistor conversion (uses exp/log)
+ *
+ * thermistor: Thermistor created from conversionData
+ * raw: Raw ADC reading
+ * conversionData : Pointer to conversion data to use
+ */
+static float celsiusFromThermistor(Thermistor * thermistor, float raw, THERMISTORCHANNEL * conversionData)
+{
+	return thermistor->TemperatureFromADCReading(conversionData->otherR, raw, conversionData->maxADC);
+}
+
+/* 
+ * interpolateLUT
+ *
+ * Linearly interpolate between the two lookup table entries either side of raw.
+ * Segments outside the table, or with an entry outside the interpolated temperature
+ * range (stored as NAN), are not interpolated and the caller should calculate these exactly.
+ *
+ * raw: Raw ADC reading
+ * conversionData : Pointer to conversion data with a built lookup table
+ * entriesPerBit: lutSize / maxADC
+ * result: Interpolated temperature
+ *
+ * Returns false if raw is outside the interpolated range
+ */
+static bool interpolateLUT(float raw, THERMISTORCHANNEL * conversionData, float entriesPerBit, float * result)
+{
+	float position = raw * entriesPerBit;
+	int32_t index = (int32_t)position;
+
+	if ((position < 0.0f) || (index >= (int32_t)conversionData->lutSize)) { return false; }
+
+	float const * lut = conversionData->lut;
+	if (isnan(lut[index]) || isnan(lut[index+1])) { return false; }
+
+	float fraction = position - (float)index;
+	*result = lut[index] + (fraction * (lut[index+1] - lut[index]));
+	return true;
+}
+
 /*
  * Public Functions
  */
@@ -123,6 +178,280 @@ float CONV_AmpsFromRaw(float raw, CURRENTCHANNEL * conversionData)
  */
 float CONV_CelsiusFromRawThermistor(float raw, THERMISTORCHANNEL * conversionData)
 {
-    Thermistor thermistor = Thermistor(conversionData->B, conversionData->R25, conversionData->highside);
-    return thermistor.TemperatureFromADCReading(conversionData->otherR, raw, conversionData->maxADC);
+	float result;
+	if (conversionData->lut)
+	{
+		if (interpolateLUT(raw, conversionData, conversionData->lutSize / conversionData->maxADC, &result))
+		{
+			return result;
+		}
+	}
+
+	Thermistor thermistor = Thermistor(conversionData->B, conversionData->R25, conversionData->highside);
+	return celsiusFromThermistor(&thermistor, raw, conversionData);
+}
+
+/* 
+ * CONV_BuildThermistorLUT
+ *
+ * Build the lookup table for a thermistor channel, so that CONV_CelsiusFromRawThermistor
+ * interpolates instead of calculating exp/log for every reading.
+ * The table has lutSize + 1 entries evenly spaced from 0 to maxADC.
+ *
+ * Only segments between THERMISTOR_LUT_MIN_C and THERMISTOR_LUT_MAX_C are interpolated.
+ *
+ * Linear interpolation error over a segment of width h is at most (h^2 / 8) * max|T''(raw)|.
+ * The curvature is largest at the ends of the interpolated range, so the error is measured at the
+ * midpoint of every interpolated segment and the largest is stored in lutMaxError (in degrees C).
+ * The true maximum is within a few percent of this.
+ * As a guide, a 10k/B3000 divider on a 10-bit ADC has a maximum error of about 0.3C with
+ * 64 segments and 0.02C with 256 segments. Halving the segment width quarters the error.
+ *
+ * If lutSize is 0, no table is built. Any existing table is replaced.
+ *
+ * conversionData : Pointer to conversion data to use
+ *
+ * Returns false if the table could not be built
+ */
+bool CONV_BuildThermistorLUT(THERMISTORCHANNEL * conversionData)
+{
+	if (!conversionData) { return false; }
+
+	CONV_FreeThermistorLUT(conversionData);
+
+	if (conversionData->lutSize == 0) { return true; }
+	if (conversionData->lutSize < 2) { return false; }
+	if (conversionData->lutSize > MAX_THERMISTOR_LUT_SIZE) { return false; }
+	if (conversionData->maxADC <= 0.0f) { return false; }
+
+	float * lut = new float[conversionData->lutSize + 1];
+	if (!lut) { return false; }
+
+	uint16_t i;
+	float bitsPerEntry = conversionData->maxADC / conversionData->lutSize;
+	Thermistor thermistor = Thermistor(conversionData->B, conversionData->R25, conversionData->highside);
+
+	float t;
+	for (i = 0; i <= conversionData->lutSize; i++)
+	{
+		t = celsiusFromThermistor(&thermistor, i * bitsPerEntry, conversionData);
+		lut[i] = ((t >= THERMISTOR_LUT_MIN_C) && (t <= THERMISTOR_LUT_MAX_C)) ? t : NAN;
+	}
+
+	conversionData->lut = lut;
+
+	// Measure the interpolation error at the middle of each interpolated segment
+	float maxError = 0.0f;
+	float error;
+	float raw;
+	for (i = 0; i < conversionData->lutSize; i++)
+	{
+		raw = (i + 0.5f) * bitsPerEntry;
+		if (interpolateLUT(raw, conversionData, 1.0f / bitsPerEntry, &error))
+		{
+			error -= celsiusFromThermistor(&thermistor, raw, conversionData);
+			if (error < 0.0f) { error = -error; }
+			if (error > maxError) { maxError = error; }
+		}
+	}
+
+	conversionData->lutMaxError = maxError;
+
+	return true;
+}
+
+/* 
+ * CONV_FreeThermistorLUT
+ *
+ * Delete the lookup table for a thermistor channel (conversion reverts to exact calculation)
+ *
+ * conversionData : Pointer to conversion data to use
+ */
+void CONV_FreeThermistorLUT(THERMISTORCHANNEL * conversionData)
+{
+	if (!conversionData) { return; }
+
+	delete[] conversionData->lut;
+	conversionData->lut = NULL;
+	conversionData->lutMaxError = 0.0f;
+}
+
+/*
+ * CONV_GetVoltageCoefficients
+ *
+ * Fold mvPerBit, offset, multiplier and the R1/R2 divider of a VOLTAGECHANNEL
+ * into a single scale and offset, so that CONV_LinearArray gives the same result
+ * as CONV_VoltsFromRaw.
+ *
+ * conversionData : Pointer to conversion data to use
+ * coefficients : Coefficients to fill
+ */
+void CONV_GetVoltageCoefficients(VOLTAGECHANNEL * conversionData, CONVERSION_COEFFICIENTS * coefficients)
+{
+	if (!coefficients) { return; }
+
+	if (conversionData)
+	{
+		float dividerGain = (conversionData->R1 + conversionData->R2) / conversionData->R2;
+		float gain = conversionData->multiplier * dividerGain;
+		coefficients->scale = (conversionData->mvPerBit / 1000) * gain;
+		coefficients->offset = -conversionData->offset * gain;
+	}
+	else
+	{
+		coefficients->scale = 1.0f;
+		coefficients->offset = 0.0f;
+	}
+}
+
+/*
+ * CONV_GetCurrentCoefficients
+ *
+ * Fold mvPerBit, offset and mvPerAmp of a CURRENTCHANNEL into a single scale
+ * and offset, so that CONV_LinearArray gives the same result as CONV_AmpsFromRaw.
+ *
+ * conversionData : Pointer to conversion data to use
+ * coefficients : Coefficients to fill
+ */
+void CONV_GetCurrentCoefficients(CURRENTCHANNEL * conversionData, CONVERSION_COEFFICIENTS * coefficients)
+{
+	if (!coefficients) { return; }
+
+	if (conversionData)
+	{
+		coefficients->scale = conversionData->mvPerBit / conversionData->mvPerAmp;
+		coefficients->offset = -conversionData->offset / conversionData->mvPerAmp;
+	}
+	else
+	{
+		coefficients->scale = 1.0f;
+		coefficients->offset = 0.0f;
+	}
+}
+
+/*
+ * CONV_LinearArray
+ *
+ * Apply out = (raw * scale) + offset to an array of raw readings.
+ * The loop has no branches or calls so that the compiler can vectorise it.
+ * raw and out may be the same array.
+ *
+ * raw: Array of raw ADC readings
+ * out: Array for converted values
+ * n: Number of values to convert
+ * coefficients : Scale and offset to apply
+ */
+void CONV_LinearArray(float const * raw, float * out, uint32_t n, CONVERSION_COEFFICIENTS const * coefficients)
+{
+	uint32_t i;
+	float const scale = coefficients->scale;
+	float const offset = coefficients->offset;
+
+	for (i = 0; i < n; i++)
+	{
+		out[i] = (raw[i] * scale) + offset;
+	}
+}
+
+/*
+ * CONV_VoltsFromRawArray, CONV_AmpsFromRawArray
+ *
+ * Array versions of CONV_VoltsFromRaw and CONV_AmpsFromRaw
+ *
+ * raw: Array of raw ADC readings
+ * out: Array for converted values (may be the same as raw)
+ * n: Number of values to convert
+ * conversionData : Pointer to conversion data to use
+ */
+void CONV_VoltsFromRawArray(float const * raw, float * out, uint32_t n, VOLTAGECHANNEL * conversionData)
+{
+	CONVERSION_COEFFICIENTS coefficients;
+	CONV_GetVoltageCoefficients(conversionData, &coefficients);
+	CONV_LinearArray(raw, out, n, &coefficients);
+}
+
+void CONV_AmpsFromRawArray(float const * raw, float * out, uint32_t n, CURRENTCHANNEL * conversionData)
+{
+	CONVERSION_COEFFICIENTS coefficients;
+	CONV_GetCurrentCoefficients(conversionData, &coefficients);
+	CONV_LinearArray(raw, out, n, &coefficients);
+}
+
+/* 
+ * CONV_CelsiusFromRawThermistorArray
+ *
+ * Array version of CONV_CelsiusFromRawThermistor.
+ * The thermistor conversion is not linear, but the thermistor is only created once per array.
+ * If the channel has a lookup table, it is used for every reading.
+ *
+ * raw: Array of raw ADC readings
+ * out: Array for converted values (may be the same as raw)
+ * n: Number of values to convert
+ * conversionData : Pointer to conversion data to use
+ */
+void CONV_CelsiusFromRawThermistorArray(float const * raw, float * out, uint32_t n, THERMISTORCHANNEL * conversionData)
+{
+	uint32_t i;
+	Thermistor thermistor = Thermistor(conversionData->B, conversionData->R25, conversionData->highside);
+
+	if (conversionData->lut)
+	{
+		float entriesPerBit = conversionData->lutSize / conversionData->maxADC;
+		for (i = 0; i < n; i++)
+		{
+			if (!interpolateLUT(raw[i], conversionData, entriesPerBit, &out[i]))
+			{
+				out[i] = celsiusFromThermistor(&thermistor, raw[i], conversionData);
+			}
+		}
+	}
+	else
+	{
+		for (i = 0; i < n; i++)
+		{
+			out[i] = celsiusFromThermistor(&thermistor, raw[i], conversionData);
+		}
+	}
+}
+
+/*
+ * CONV_GetFixedCoefficients
+ *
+ * Convert linear conversion coefficients to fixed point, so that
+ * conversion can be done without floating point operations.
+ *
+ * coefficients : Coefficients from CONV_GetVoltageCoefficients or CONV_GetCurrentCoefficients
+ * fixedCoefficients : Fixed point coefficients to fill
+ */
+void CONV_GetFixedCoefficients(CONVERSION_COEFFICIENTS const * coefficients, CONVERSION_FIXED_COEFFICIENTS * fixedCoefficients)
+{
+	if (!coefficients || !fixedCoefficients) { return; }
+
+	FIXED_CoefficientFromFloat(coefficients->scale, &fixedCoefficients->scale);
+	fixedCoefficients->offset = FIXED_FromFloat(coefficients->offset);
+}
+
+/*
+ * CONV_LinearFixed, CONV_LinearFixedArray
+ *
+ * Fixed point versions of CONV_LinearArray: out = (raw * scale) + offset.
+ * raw and out may be the same array.
+ *
+ * raw: Raw reading (or array of readings) in Q16.16
+ * out: Array for converted values
+ * n: Number of values to convert
+ * coefficients : Fixed point scale and offset to apply
+ */
+FIXED CONV_LinearFixed(FIXED raw, CONVERSION_FIXED_COEFFICIENTS const * coefficients)
+{
+	return FIXED_Add(FIXED_MultiplyByCoefficient(raw, &coefficients->scale), coefficients->offset);
+}
+
+void CONV_LinearFixedArray(FIXED const * raw, FIXED * out, uint32_t n, CONVERSION_FIXED_COEFFICIENTS const * coefficients)
+{
+	uint32_t i;
+	for (i = 0; i < n; i++)
+	{
+		out[i] = CONV_LinearFixed(raw[i], coefficients);
+	}
 }
@@ -1,10 +1,53 @@
 #ifndef _DATAFIELD_CONVERSION_H_
 #define _DATAFIELD_CONVERSION_H_
 
+/* Voltage and current conversions are linear, so can be reduced to out = (raw * scale) + offset */
+struct conversion_coefficients
+{
+    float scale;
+    float offset;
+};
+typedef struct conversion_coefficients CONVERSION_COEFFICIENTS;
+
+/* Fixed point version of the linear conversion coefficients */
+struct conversion_fixed_coefficients
+{
+    FIXED_COEFFICIENT scale;
+    FIXED offset;
+};
+typedef struct conversion_fixed_coefficients CONVERSION_FIXED_COEFFICIENTS;
+
+/* The conversion functions for one type of field, chosen once when the field is created
+ (see NumericDataField and TypedNumericDataField). params is the field's conversion data. */
+struct datafield_converter
+{
+    float (*convert)(float raw, void * params);
+    void (*convertArray)(float const * raw, float * out, uint32_t n, void * params);
+    bool (*getCoefficients)(void * params, CONVERSION_COEFFICIENTS * coefficients); // NULL if the conversion is not linear
+    void (*prepare)(void * params); // Called before the field first uses params (NULL if nothing to do)
+    void (*printConfig)(char * buffer, void * params);
+};
+typedef struct datafield_converter DATAFIELD_CONVERTER;
+
 float CONV_ADCtoMillivolts(float in, float mvPerBit);
 
 float CONV_VoltsFromRaw(float raw, VOLTAGECHANNEL * conversionData);
 float CONV_AmpsFromRaw(float raw, CURRENTCHANNEL * conversionData);
 float CONV_CelsiusFromRawThermistor(float raw, THERMISTORCHANNEL * conversionData);
 
+bool CONV_BuildThermistorLUT(THERMISTORCHANNEL * conversionData);
+void CONV_FreeThermistorLUT(THERMISTORCHANNEL * conversionData);
+
+void CONV_GetVoltageCoefficients(VOLTAGECHANNEL * conversionData, CONVERSION_COEFFICIENTS * coefficients);
+void CONV_GetCurrentCoefficients(CURRENTCHANNEL * conversionData, CONVERSION_COEFFICIENTS * coefficients);
+
+void CONV_LinearArray(float const * raw, float * out, uint32_t n, CONVERSION_COEFFICIENTS const * coefficients);
+void CONV_VoltsFromRawArray(float const * raw, float * out, uint32_t n, VOLTAGECHANNEL * conversionData);
+void CONV_AmpsFromRawArray(float const * raw, float * out, uint32_t n, CURRENTCHANNEL * conversionData);
+void CONV_CelsiusFromRawThermistorArray(float const * raw, float * out, uint32_t n, THERMISTORCHANNEL * conversionData);
+
+void CONV_GetFixedCoefficients(CONVERSION_COEFFICIENTS const * coefficients, CONVERSION_FIXED_COEFFICIENTS * fixedCoefficients);
+FIXED CONV_LinearFixed(FIXED raw, CONVERSION_FIXED_COEFFICIENTS const * coefficients);
+void CONV_LinearFixedArray(FIXED const * raw, FIXED * out, uint32_t n, CONVERSION_FIXED_COEFFICIENTS const * coefficients);
+
 #endif
@@ -28,28 +28,93 @@
  * Datalogger Library Includes
  */
 
+#include "DLUtility.FixedPoint.h"
 #include "DLUtility.Averager.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
 #include "DLDataField.Manager.h"
+#include "DLDataField.Typed.h"
 #include "DLSettings.Reader.Errors.h"
 #include "DLSettings.DataChannels.h"
 #include "DLUtility.h"
-#include "DLUtility.ArrayFunctions.h"
 #include "DLPlatform.h"
 
+/*
+ * Defines and Typedefs
+ */
+
+// Row timestamps keep the milliseconds in the low 10 bits and the row flags above them
+#define TIMESTAMP_MILLIS_MASK (0x03FF)
+#define TIMESTAMP_FLAGS_SHIFT (10)
+
+/*
+ * Private Functions
+ */
+
+/*
+ * alignedSize
+ *
+ * Round a size up so that storage carved from the arena after it stays aligned for any type
+ */
+static uint32_t alignedSize(uint32_t size)
+{
+    return ((size + sizeof(int64_t) - 1) / sizeof(int64_t)) * sizeof(int64_t);
+}
+
+// Indexed by DATAFIELD_COLUMN
+static char const * const s_columnSuffixes[] = {"", " Min", " Max", " StdDev", " P5", " P50", " P95"};
+
+static uint8_t statisticsColumnCount(DataField * field)
+{
+    return field->isNumeric() ? ((NumericDataField*)field)->statisticsColumnCount() : 0;
+}
+
+/*
+ * Public Functions
+ */
+
+/*
+ * DataField_SampleIsDue
+ *
+ * Fields are sampled on the last scan of each group of divisor scans (counting scans from 0).
+ * If the divisor divides the number of scans in an average, every field's average then ends on the same scan.
+ */
+bool DataField_SampleIsDue(uint32_t scan, uint8_t divisor)
+{
+    return (divisor <= 1) || ((scan % divisor) == (uint32_t)(divisor - 1));
+}
+
 DataFieldManager::DataFieldManager(uint32_t dataSize, uint32_t averagerSize)
 {
     m_dataSize = dataSize;
     m_averagerSize = averagerSize;
     m_fieldCount = 0;
     m_dataCount = 0;
+    m_totalRows = 0;
+    m_fixedPoint = false;
+    m_arena = NULL;
+    m_arenaSize = 0;
+    m_overflowPolicy = OVERFLOW_DROP_OLDEST;
+    m_spillFn = NULL;
+    m_spills = 0;
+    m_clockFn = NULL;
+    m_timestampSeconds = NULL;
+    m_timestampMillis = NULL;
+    m_nextRowFlags = 0;
+    m_scanCount = 0;
 
     uint8_t i = 0;
     for (i = 0; i < MAX_FIELDS; i++)
     {
         m_fields[i] = NULL;
     }
+
+    memset(m_channelSlots, DATAFIELD_NO_SLOT, sizeof(m_channelSlots));
+}
+
+DataFieldManager::~DataFieldManager()
+{
+    delete[] m_arena;
 }
 
 uint8_t DataFieldManager::fieldCount()
@@ -61,8 +126,9 @@ uint8_t DataFieldManager::fieldCount()
  * addField
  *
  * Add a field to the manager.
- * Stores field pointer in next free location in m_fields.
- * Channel number is stored in m_channelNumbers.
+ * Stores field pointer in next free location in m_fields (see mapField).
+ * Fields cannot be added once storage has been allocated.
+ * A field's sample divisor must divide the averager size, so that all fields complete their averages together.
  */
 bool DataFieldManager::addField(NumericDataField * field)
 {
@@ -70,55 +136,481 @@ bool DataFieldManager::addField(NumericDataField * field)
 
     if (m_fieldCount == MAX_FIELDS) { return false; }
 
+    if (m_arena) { return false; }
+
+    if ((m_averagerSize % field->getSampleDivisor()) != 0) { return false; }
+
     // The field might need extra setup based on the datatype/sensor and platform.
     // The platform interface takes care of that.
     PLATFORM_specialFieldSetup(field);
 
-    field->setDataSizes(m_dataSize, m_averagerSize);
+    field->setFixedPoint(m_fixedPoint);
+    field->setOverflowPolicy(m_overflowPolicy);
+
+    mapField(field);
+    return true;
+}
+
+/*
+ * mapField
+ *
+ * Store a field in the next free location in m_fields, with its channel number in m_channelNumbers.
+ * The index of its sample in incoming scan arrays and its slot in the channel lookup table
+ * are worked out here, once, so that routing scans and looking up channels are just table reads.
+ * If several fields have the same channel number, getChannel finds the first.
+ */
+void DataFieldManager::mapField(DataField * field)
+{
+    uint32_t channel = field->getChannelNumber();
 
     m_fields[m_fieldCount] = field;
-    m_channelNumbers[m_fieldCount] = field->getChannelNumber();
+    m_channelNumbers[m_fieldCount] = channel;
+
+    // Scan arrays are for all channels on the platform, indexed by channel number - 1
+    m_dataIndexes[m_fieldCount] = channel ? (uint16_t)(channel - 1) : 0;
+    m_sampleDivisors[m_fieldCount] = field->isNumeric() ? ((NumericDataField*)field)->getSampleDivisor() : 1;
+
+    if ((channel <= MAX_CHANNEL_NUMBER) && (m_channelSlots[channel] == DATAFIELD_NO_SLOT))
+    {
+        m_channelSlots[channel] = m_fieldCount;
+    }
+
     m_fieldCount++;
+}
+
+/*
+ * setFixedPoint
+ *
+ * Select fixed point (Q16.16) averaging and storage for all fields.
+ * This must be done before any fields are added.
+ * Float and fixed point data functions can be used in either mode.
+ *
+ * Returns false if fields have already been added
+ */
+bool DataFieldManager::setFixedPoint(bool fixedPoint)
+{
+    if (m_fieldCount > 0) { return false; }
+    m_fixedPoint = fixedPoint;
+    return true;
+}
 
+bool DataFieldManager::isFixedPoint(void)
+{
+    return m_fixedPoint;
+}
+
+/*
+ * setClock
+ *
+ * Set the function called to timestamp each row as it is stored.
+ * The timestamps are kept in the arena alongside the rows (6 bytes per row),
+ * so this must be done before storage is allocated.
+ *
+ * Returns false if storage has already been allocated
+ */
+bool DataFieldManager::setClock(DATAFIELD_CLOCK_FN * clockFn)
+{
+    if (m_arena) { return false; }
+    m_clockFn = clockFn;
     return true;
 }
 
+/*
+ * allocate
+ *
+ * Allocate a single block (the arena) for the storage of all fields, and give each field its part of it.
+ * This avoids a separate heap allocation for each field.
+ * Storage is allocated automatically when data is first stored. After this, no more fields can be added.
+ *
+ * Returns false if there are no fields or the allocation failed
+ */
+bool DataFieldManager::allocate(void)
+{
+    if (m_arena) { return true; }
+    if ((m_fieldCount == 0) || (m_dataSize == 0) || (m_averagerSize == 0)) { return false; }
+
+    uint32_t fieldSize = alignedSize(storageSize());
+    uint32_t size = fieldSize;
+    if (size == 0) { return false; }
+
+    if (m_clockFn)
+    {
+        size += alignedSize(m_dataSize * (sizeof(uint32_t) + sizeof(uint16_t)));
+    }
+
+    m_arena = new int64_t[size / sizeof(int64_t)];
+    if (!m_arena) { return false; }
+
+    m_arenaSize = size;
+    memset(m_arena, 0, m_arenaSize);
+
+    carveStorage((uint8_t *)m_arena);
+
+    if (m_clockFn)
+    {
+        m_timestampSeconds = (uint32_t *)((uint8_t *)m_arena + fieldSize);
+        m_timestampMillis = (uint16_t *)&m_timestampSeconds[m_dataSize];
+    }
+
+    return true;
+}
+
+/*
+ * bytesUsed
+ *
+ * Returns the exact size in bytes of the storage allocated for field data (0 if not yet allocated)
+ */
+uint32_t DataFieldManager::bytesUsed(void)
+{
+    return m_arenaSize;
+}
+
+/*
+ * storageSize
+ *
+ * Returns the number of bytes of storage needed for all fields.
+ * Each field's storage is padded so the next field's storage is aligned.
+ */
+uint32_t DataFieldManager::storageSize(void)
+{
+    uint32_t size = 0;
+    uint8_t i;
+
+    for (i = 0; i < m_fieldCount; i++)
+    {
+        if (m_fields[i]->isNumeric())
+        {
+            size += alignedSize(((NumericDataField*)m_fields[i])->storageSize(m_dataSize));
+        }
+        else
+        {
+            size += alignedSize(((StringDataField*)m_fields[i])->storageSize());
+        }
+    }
+
+    return size;
+}
+
+/*
+ * carveStorage
+ *
+ * Give each field its part of the arena, in the same order and sizes as storageSize
+ */
+void DataFieldManager::carveStorage(uint8_t * arena)
+{
+    uint8_t i;
+
+    for (i = 0; i < m_fieldCount; i++)
+    {
+        if (m_fields[i]->isNumeric())
+        {
+            NumericDataField * field = (NumericDataField*)m_fields[i];
+            // Fields sampled less often than every scan have fewer samples in each average
+            field->setStorage(arena, m_dataSize, m_averagerSize / m_sampleDivisors[i]);
+            arena += alignedSize(field->storageSize(m_dataSize));
+        }
+        else
+        {
+            StringDataField * field = (StringDataField*)m_fields[i];
+            field->setStorage(arena);
+            arena += alignedSize(field->storageSize());
+        }
+    }
+}
+
 bool DataFieldManager::addField(StringDataField * field)
 {
     if (!field) { return false; }
 
     if (m_fieldCount == MAX_FIELDS) { return false; }
 
-    m_fields[m_fieldCount] = field;
-    m_channelNumbers[m_fieldCount] = field->getChannelNumber();
+    if (m_arena) { return false; }
 
-    m_fieldCount++;
+    field->setOverflowPolicy(m_overflowPolicy);
+
+    mapField(field);
     return true;
 }
 
+/*
+ * setOverflowPolicy
+ *
+ * Set what happens when a new row is stored and the manager is full:
+ * OVERFLOW_DROP_OLDEST: The oldest row is discarded (default)
+ * OVERFLOW_DROP_NEWEST: The new row is discarded
+ * OVERFLOW_SPILL: spillFn is called to remove rows. If it doesn't, the oldest row is discarded.
+ *
+ * Discarded rows are counted as drops (see getCounters).
+ */
+void DataFieldManager::setOverflowPolicy(OVERFLOW_POLICY policy, OVERFLOW_SPILL_FN * spillFn)
+{
+    m_overflowPolicy = policy;
+    m_spillFn = spillFn;
+
+    uint8_t i;
+    for (i = 0; i < m_fieldCount; i++)
+    {
+        m_fields[i]->setOverflowPolicy(policy);
+    }
+}
+
+OVERFLOW_POLICY DataFieldManager::getOverflowPolicy(void)
+{
+    return m_overflowPolicy;
+}
+
+/*
+ * getCounters
+ *
+ * Get the push, pop and drop counts for the field at index.
+ * Returns false if there is no field at index.
+ */
+bool DataFieldManager::getCounters(uint8_t index, DATAFIELD_COUNTERS * counters)
+{
+    if ((index >= m_fieldCount) || !counters) { return false; }
+    m_fields[index]->getCounters(counters);
+    return true;
+}
+
+void DataFieldManager::resetCounters(void)
+{
+    uint8_t i;
+    for (i = 0; i < m_fieldCount; i++)
+    {
+        m_fields[i]->resetCounters();
+    }
+    m_spills = 0;
+}
+
+/*
+ * spillCount
+ *
+ * Returns the number of rows removed by the spill function.
+ * These are also counted as pops by the fields.
+ */
+uint32_t DataFieldManager::spillCount(void)
+{
+    return m_spills;
+}
+
+/*
+ * spillIfFull
+ *
+ * With the OVERFLOW_SPILL policy, if the manager is full, let the spill function remove rows
+ */
+void DataFieldManager::spillIfFull(void)
+{
+    if ((m_overflowPolicy != OVERFLOW_SPILL) || !m_spillFn) { return; }
+
+    uint32_t countBefore = count();
+    if (countBefore < m_dataSize) { return; }
+
+    m_spillFn(this);
+
+    if (count() < countBefore)
+    {
+        m_spills += countBefore - count();
+    }
+}
+
 void DataFieldManager::storeDataArray(int32_t * data)
 {
+    if (!allocate()) { return; }
+
+    // A row might be completed by this data, so make room for it now
+    spillIfFull();
+
     uint16_t field = 0;
 
     // The data manager stores only the fields of interest, but 
     // the incoming data array is for ALL channels for the platform
-    // dataIndex is the correct index for the raw data array
-    uint16_t dataIndex;
+    // m_dataIndexes has the correct index in the raw data array for each field
 
     bool newAverageStored = false;
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        NumericDataField* pField = (NumericDataField*)m_fields[field];
+        if (pField && DataField_SampleIsDue(m_scanCount, m_sampleDivisors[field]))
+        {
+            newAverageStored |= pField->storeData( data[m_dataIndexes[field]] );
+        }
+    }
+    m_scanCount++;
+
+    if (newAverageStored)
+    {
+        rowStored();
+    }
+}
+
+/*
+ * rowStored
+ *
+ * Update row counts after a row is stored. If the manager was full, the fields dropped their oldest data,
+ * so the number of rows stays the same.
+ */
+void DataFieldManager::rowStored(void)
+{
+    stampRow(m_totalRows);
+    if (m_dataCount < m_dataSize) { m_dataCount++; }
+    m_totalRows++;
+}
+
+/*
+ * stampRow
+ *
+ * Record the current time and any flags against a new row (if a clock has been set).
+ * Rows are numbered as they are stored, so the slot for a row is its number modulo the buffer size.
+ * Milliseconds only need 10 bits, so the flags are kept in the top bits of the milliseconds.
+ */
+void DataFieldManager::stampRow(uint32_t rowNumber)
+{
+    DATAFIELD_TIMESTAMP timestamp;
+    uint8_t flags = m_nextRowFlags;
+
+    m_nextRowFlags = 0;
+
+    if (!m_clockFn || !m_timestampSeconds) { return; }
+
+    m_clockFn(&timestamp);
+    m_timestampSeconds[rowNumber % m_dataSize] = timestamp.seconds;
+    m_timestampMillis[rowNumber % m_dataSize] = (timestamp.millis & TIMESTAMP_MILLIS_MASK) | (flags << TIMESTAMP_FLAGS_SHIFT);
+}
+
+/*
+ * allFieldsMask
+ *
+ * Returns a mask with a bit set for each field (bit n for field n)
+ */
+uint32_t DataFieldManager::allFieldsMask(void)
+{
+    return (m_fieldCount >= 32) ? 0xFFFFFFFFUL : ((1UL << m_fieldCount) - 1);
+}
+
+void DataFieldManager::readTimestamp(uint32_t rowNumber, DATAFIELD_TIMESTAMP * timestamp)
+{
+    if (m_timestampSeconds)
+    {
+        timestamp->seconds = m_timestampSeconds[rowNumber % m_dataSize];
+        timestamp->millis = m_timestampMillis[rowNumber % m_dataSize] & TIMESTAMP_MILLIS_MASK;
+        timestamp->flags = m_timestampMillis[rowNumber % m_dataSize] >> TIMESTAMP_FLAGS_SHIFT;
+    }
+    else
+    {
+        timestamp->seconds = 0;
+        timestamp->millis = 0;
+        timestamp->flags = 0;
+    }
+}
+
+/*
+ * flagNextRow
+ *
+ * Set DATAFIELD_ROW_xxx flags for the next row stored. They are kept with the row's timestamp,
+ * so are only stored if a clock has been set.
+ */
+void DataFieldManager::flagNextRow(uint8_t flags)
+{
+    m_nextRowFlags = flags;
+}
+
+/*
+ * getTimestamp
+ *
+ * Get the time the nth oldest row was stored (i.e. the end of its averaging window)
+ *
+ * Returns false if there is no clock or no such row
+ */
+bool DataFieldManager::getTimestamp(uint32_t n, DATAFIELD_TIMESTAMP * timestamp)
+{
+    if (!timestamp || !m_timestampSeconds) { return false; }
+    if (n >= count()) { return false; }
+
+    readTimestamp(m_totalRows - count() + n, timestamp);
+    return true;
+}
+
+/*
+ * getLatestTimestamp
+ *
+ * Get the time the newest row was stored, even if it has since been read and removed
+ *
+ * Returns false if there is no clock or no row has been stored
+ */
+bool DataFieldManager::getLatestTimestamp(DATAFIELD_TIMESTAMP * timestamp)
+{
+    if (!timestamp || !m_timestampSeconds) { return false; }
+    if (m_totalRows == 0) { return false; }
+
+    readTimestamp(m_totalRows - 1, timestamp);
+    return true;
+}
+
+/*
+ * storeAverageArray
+ *
+ * Store one already-averaged value per field.
+ * Unlike storeDataArray, the array is indexed by field, not by channel number.
+ * stats (optional, also indexed by field) are stored for fields with statistics enabled.
+ */
+void DataFieldManager::storeAverageArray(float * averages, DATAFIELD_STATISTICS const * stats)
+{
+    if (!allocate()) { return; }
+
+    spillIfFull();
+
+    uint16_t field = 0;
+    bool stored = false;
+
+    for (field = 0; field < m_fieldCount; field++)
+    {
+        NumericDataField* pField = (NumericDataField*)m_fields[field];
+        if (pField)
+        {
+            stored |= pField->storeAverage( averages[field], stats ? &stats[field] : NULL );
+        }
+    }
+
+    if (stored)
+    {
+        rowStored();
+    }
+}
+
+/*
+ * storeFixedAverageArray
+ *
+ * As storeAverageArray, for averages in Q16.16
+ */
+void DataFieldManager::storeFixedAverageArray(FIXED * averages, DATAFIELD_STATISTICS const * stats)
+{
+    if (!allocate()) { return; }
+
+    spillIfFull();
+
+    uint16_t field = 0;
+    bool stored = false;
+
     for (field = 0; field < m_fieldCount; field++)
     {
         NumericDataField* pField = (NumericDataField*)m_fields[field];
         if (pField)
         {
-            dataIndex = m_channelNumbers[field] - 1;
-            newAverageStored |= pField->storeData( data[dataIndex] );
+            stored |= pField->storeFixedAverage( averages[field], stats ? &stats[field] : NULL );
         }
     }
 
-    if (newAverageStored) { m_dataCount++; }
+    if (stored)
+    {
+        rowStored();
+    }
 }
 
+/*
+ * getDataArray
+ *
+ * Get the oldest average of each field (one value per field, without statistics)
+ */
 void DataFieldManager::getDataArray(float * buffer, bool converted, bool alsoRemove)
 {
     uint16_t field;
@@ -133,13 +625,159 @@ void DataFieldManager::getDataArray(float * buffer, bool converted, bool alsoRem
             buffer[field] = ((NumericDataField*)m_fields[field])->getRawData(alsoRemove);
         }
     }
-    if (alsoRemove) { m_dataCount--; }
+    if (alsoRemove && m_dataCount) { m_dataCount--; }
+}
+
+/*
+ * getFixedDataArray
+ *
+ * As getDataArray, with data in Q16.16
+ */
+void DataFieldManager::getFixedDataArray(FIXED * buffer, bool converted, bool alsoRemove)
+{
+    uint16_t field;
+    for(field = 0; field < m_fieldCount; ++field)
+    {
+        if (converted)
+        {
+            buffer[field] = ((NumericDataField*)m_fields[field])->getConvFixed(alsoRemove);
+        }
+        else
+        {
+            buffer[field] = ((NumericDataField*)m_fields[field])->getRawFixed(alsoRemove);
+        }
+    }
+    if (alsoRemove && m_dataCount) { m_dataCount--; }
+}
+
+/*
+ * getRow, getFixedRow
+ *
+ * Get the oldest row: each field's average, followed by its statistics and percentiles if enabled
+ */
+void DataFieldManager::getRow(float * buffer, bool converted, bool alsoRemove)
+{
+    uint8_t field;
+    uint8_t s;
+    uint8_t column = 0;
+    DATAFIELD_STATISTICS stats;
+
+    for (field = 0; field < m_fieldCount; ++field)
+    {
+        NumericDataField * pField = (NumericDataField*)m_fields[field];
+
+        // Statistics have to be read before the average is removed
+        bool statsRead = pField->getStatistics(&stats, converted);
+
+        buffer[column++] = converted ? pField->getConvData(alsoRemove) : pField->getRawData(alsoRemove);
+
+        for (s = 0; s < pField->statisticsColumnCount(); s++)
+        {
+            buffer[column++] = statsRead ?
+                DataField_GetStatistic(&stats, pField->statisticsColumn(s)) : DATAFIELD_NO_DATA_VALUE;
+        }
+    }
+    if (alsoRemove && m_dataCount) { m_dataCount--; }
+}
+
+void DataFieldManager::getFixedRow(FIXED * buffer, bool converted, bool alsoRemove)
+{
+    uint8_t field;
+    uint8_t s;
+    uint8_t column = 0;
+    DATAFIELD_STATISTICS stats;
+
+    for (field = 0; field < m_fieldCount; ++field)
+    {
+        NumericDataField * pField = (NumericDataField*)m_fields[field];
+
+        bool statsRead = pField->getStatistics(&stats, converted);
+
+        buffer[column++] = converted ? pField->getConvFixed(alsoRemove) : pField->getRawFixed(alsoRemove);
+
+        for (s = 0; s < pField->statisticsColumnCount(); s++)
+        {
+            buffer[column++] = statsRead ?
+                FIXED_FromFloat(DataField_GetStatistic(&stats, pField->statisticsColumn(s))) : DATAFIELD_NO_FIXED_DATA_VALUE;
+        }
+    }
+    if (alsoRemove && m_dataCount) { m_dataCount--; }
+}
+
+/*
+ * getDataRows
+ *
+ * Copy up to maxRows complete rows (oldest first) into buffer in a single call.
+ * buffer is laid out as rows x columns, so must have space for maxRows * columnCount() values.
+ * Each row has each field's average, followed by its minimum, maximum and standard deviation
+ * if statistics are enabled for that field.
+ *
+ * rowIndexes (optional) receives the index of each row copied. Row indexes count up from zero
+ * as rows are stored, so gaps show where old rows were dropped from a full buffer.
+ * Rows discarded by the OVERFLOW_DROP_NEWEST policy are never stored, so are not given an index.
+ * timestamps (optional) receives the time each row was stored (see setClock). It is zeroed without a clock.
+ * changedFields (optional) receives a mask of the fields (bit n for field n) emitted in each row.
+ * Only ColumnarDataFieldManager applies deadbands, so here every field is always emitted.
+ *
+ * Each field stores its own data, so without alsoRemove only the oldest row can be read.
+ *
+ * Returns the number of rows copied.
+ */
+uint32_t DataFieldManager::getDataRows(float * buffer, uint32_t maxRows, bool converted, bool alsoRemove, uint32_t * rowIndexes,
+    DATAFIELD_TIMESTAMP * timestamps, uint32_t * changedFields)
+{
+    if (!buffer) { return 0; }
+
+    uint32_t rowCount = min(maxRows, count());
+    if (!alsoRemove) { rowCount = min(rowCount, 1); }
+
+    uint32_t firstIndex = m_totalRows - count();
+    uint32_t row;
+    uint8_t columns = columnCount();
+
+    for (row = 0; row < rowCount; row++)
+    {
+        getRow(&buffer[row * columns], converted, alsoRemove);
+        if (rowIndexes) { rowIndexes[row] = firstIndex + row; }
+        if (timestamps) { readTimestamp(firstIndex + row, &timestamps[row]); }
+        if (changedFields) { changedFields[row] = allFieldsMask(); }
+    }
+
+    return rowCount;
+}
+
+/*
+ * getFixedDataRows
+ *
+ * As getDataRows, with data in Q16.16
+ */
+uint32_t DataFieldManager::getFixedDataRows(FIXED * buffer, uint32_t maxRows, bool converted, bool alsoRemove, uint32_t * rowIndexes,
+    DATAFIELD_TIMESTAMP * timestamps, uint32_t * changedFields)
+{
+    if (!buffer) { return 0; }
+
+    uint32_t rowCount = min(maxRows, count());
+    if (!alsoRemove) { rowCount = min(rowCount, 1); }
+
+    uint32_t firstIndex = m_totalRows - count();
+    uint32_t row;
+    uint8_t columns = columnCount();
+
+    for (row = 0; row < rowCount; row++)
+    {
+        getFixedRow(&buffer[row * columns], converted, alsoRemove);
+        if (rowIndexes) { rowIndexes[row] = firstIndex + row; }
+        if (timestamps) { readTimestamp(firstIndex + row, &timestamps[row]); }
+        if (changedFields) { changedFields[row] = allFieldsMask(); }
+    }
+
+    return rowCount;
 }
 
 DataField * DataFieldManager::getChannel(uint8_t channel)
 {
-    int32_t actualIndex = indexOf(m_channelNumbers, (uint32_t)channel, m_fieldCount);
-    return actualIndex >= 0 ? m_fields[actualIndex] : NULL;
+    uint8_t slot = m_channelSlots[channel];
+    return (slot != DATAFIELD_NO_SLOT) ? m_fields[slot] : NULL;
 }
 
 DataField * DataFieldManager::getField(uint8_t index)
@@ -152,17 +790,82 @@ DataField ** DataFieldManager::getFields(void)
     return m_fields;
 }
 
-uint32_t DataFieldManager::writeHeadersToBuffer(char * buffer, uint8_t bufferLength)
+/*
+ * columnCount
+ *
+ * Returns the number of values in each row from getDataRows: one per field,
+ * plus three for each field with statistics enabled and three for each with percentiles enabled
+ */
+uint8_t DataFieldManager::columnCount(void)
+{
+    uint8_t i;
+    uint8_t columns = 0;
+
+    for (i = 0; i < m_fieldCount; ++i)
+    {
+        columns += 1 + statisticsColumnCount(m_fields[i]);
+    }
+
+    return columns;
+}
+
+/*
+ * getColumn
+ *
+ * Get the field index and type of value in a column of the rows from getDataRows.
+ * Returns false if there is no such column.
+ */
+bool DataFieldManager::getColumn(uint8_t column, uint8_t * field, DATAFIELD_COLUMN * type)
+{
+    uint8_t i;
+    uint8_t firstColumn = 0;
+
+    for (i = 0; i < m_fieldCount; ++i)
+    {
+        uint8_t columns = 1 + statisticsColumnCount(m_fields[i]);
+
+        if (column < (firstColumn + columns))
+        {
+            if (field) { *field = i; }
+            if (type)
+            {
+                *type = (column == firstColumn) ?
+                    COLUMN_AVERAGE : ((NumericDataField*)m_fields[i])->statisticsColumn(column - firstColumn - 1);
+            }
+            return true;
+        }
+
+        firstColumn += columns;
+    }
+
+    return false;
+}
+
+/*
+ * writeHeadersToBuffer
+ *
+ * Write the name of each column, in the same order as the rows from getDataRows
+ */
+uint32_t DataFieldManager::writeHeadersToBuffer(char * buffer, uint16_t bufferLength)
 {
     if (!buffer) { return 0; }
 
     uint8_t i;
+    uint8_t s;
 
     FixedLengthAccumulator headerAccumulator(buffer, bufferLength);
 
     for (i = 0; i < m_fieldCount; ++i)
     {
         headerAccumulator.writeString(m_fields[i]->getTypeString());
+
+        for (s = 0; s < statisticsColumnCount(m_fields[i]); s++)
+        {
+            headerAccumulator.writeString(", ");
+            headerAccumulator.writeString(m_fields[i]->getTypeString());
+            headerAccumulator.writeString(s_columnSuffixes[((NumericDataField*)m_fields[i])->statisticsColumn(s)]);
+        }
+
         if (!lastinloop(i, m_fieldCount))
         {
             headerAccumulator.writeString(", ");
@@ -179,7 +882,6 @@ void DataFieldManager::setupAllValidChannels(void)
     uint8_t ch;
     NumericDataField * field;
     FIELD_TYPE type;
-    void * data;
 
     uint32_t maxChannels = Settings_GetMaxChannels();
     for (ch = 1; ch < maxChannels; ch++)
@@ -187,24 +889,39 @@ void DataFieldManager::setupAllValidChannels(void)
         if (Settings_ChannelSettingIsValid(ch))
         {
             type = Settings_GetChannelType(ch);
-            data = Settings_GetData(ch);
 
+            // Fields with a conversion keep their own copy of the channel settings
             switch(type)
             {
             case VOLTAGE:
+                field = new TypedNumericDataField<VoltageConversion>(Settings_GetDataAsVoltage(ch), ch);
+                break;
             case CURRENT:
+                field = new TypedNumericDataField<CurrentConversion>(Settings_GetDataAsCurrent(ch), ch);
+                break;
             case TEMPERATURE_C:
+                field = new TypedNumericDataField<ThermistorConversion>((THERMISTORCHANNEL*)Settings_GetData(ch), ch);
+                break;
             case TEMPERATURE_K:
             case TEMPERATURE_F:
-                field = new NumericDataField(type, data, ch);
-                #ifdef TEST
-                std::cout << "Adding channel " << (int)ch << ", type " << field->getTypeString() << std::endl;
-                #endif
-                addField(field);
+                field = new NumericDataField(type, Settings_GetData(ch), ch);
                 break;
             default:
+                field = NULL;
                 break;
             }
+
+            if (!field) { continue; }
+
+            field->setStatistics(Settings_ChannelStatisticsEnabled(ch));
+            field->setPercentiles(Settings_GetChannelPercentiles(ch));
+            field->setDeadband(Settings_GetChannelDeadband(ch), Settings_GetChannelDeadbandPercent(ch));
+            field->setReducer(Settings_GetChannelReducer(ch), Settings_GetChannelReducerParameter(ch));
+            field->setSampleDivisor(Settings_GetChannelSampleDivisor(ch));
+            #ifdef TEST
+            std::cout << "Adding channel " << (int)ch << ", type " << field->getTypeString() << std::endl;
+            #endif
+            addField(field);
         }
     }
 }
@@ -228,4 +945,24 @@ uint32_t DataFieldManager::count(void)
 uint32_t * DataFieldManager::getChannelNumbers(void)
 {
     return m_channelNumbers;
+}
+
+/*
+ * getDataIndexes
+ *
+ * Get the index of each field's sample in the scan arrays passed to storeDataArray
+ */
+uint16_t const * DataFieldManager::getDataIndexes(void)
+{
+    return m_dataIndexes;
+}
+
+/*
+ * getSampleDivisors
+ *
+ * Get the sample divisor of each field (see NumericDataField::setSampleDivisor)
+ */
+uint8_t const * DataFieldManager::getSampleDivisors(void)
+{
+    return m_sampleDivisors;
 }
\ No newline at end of file
@@ -3,33 +3,118 @@
 
 #define MAX_FIELDS 32
 
+// Fields on channels up to this number can be found with getChannel (it takes an 8-bit channel number)
+#define MAX_CHANNEL_NUMBER (255)
+#define DATAFIELD_NO_SLOT (0xFF)
+
+// Each field has an average column, and statistics and percentile columns if enabled
+#define MAX_COLUMNS (MAX_FIELDS * (1 + DATAFIELD_STATISTICS_COLUMNS))
+
+/* Row flags (see DataFieldManager::flagNextRow) */
+#define DATAFIELD_ROW_PARTIAL (0x01) // The row's averaging window was shorter than usual
+
+/* Capture time of a row (see DataFieldManager::setClock) */
+struct datafield_timestamp
+{
+    uint32_t seconds; // UNIX time
+    uint16_t millis; // Milliseconds after seconds
+    uint8_t flags; // DATAFIELD_ROW_xxx flags of the row (ignored when returned by a clock function)
+};
+typedef struct datafield_timestamp DATAFIELD_TIMESTAMP;
+
+/* Called to get the current time when a row is stored */
+typedef void (DATAFIELD_CLOCK_FN)(DATAFIELD_TIMESTAMP * timestamp);
+
+/* Fields with a sample divisor of N are only sampled on scans where this returns true (one in every N) */
+bool DataField_SampleIsDue(uint32_t scan, uint8_t divisor);
+
+class DataFieldManager;
+
+/* Called when a manager with the OVERFLOW_SPILL policy is full and a new row is to be stored.
+The function should read out (and remove) one or more rows, e.g. to write them to SD card. */
+typedef void (OVERFLOW_SPILL_FN)(DataFieldManager * pManager);
+
 class DataFieldManager
 {
     public:
         DataFieldManager(uint32_t dataSize, uint32_t averagerSize);
+        virtual ~DataFieldManager();
         uint8_t fieldCount();
         bool addField(NumericDataField * field);
         bool addField(StringDataField * field);
         DataField * getField(uint8_t index);
         DataField * getChannel(uint8_t index);
         DataField ** getFields(void);
+        uint8_t columnCount(void);
+        bool getColumn(uint8_t column, uint8_t * field, DATAFIELD_COLUMN * type);
+
+        bool setFixedPoint(bool fixedPoint);
+        bool isFixedPoint(void);
+        bool setClock(DATAFIELD_CLOCK_FN * clockFn);
+        bool getTimestamp(uint32_t n, DATAFIELD_TIMESTAMP * timestamp);
+        bool getLatestTimestamp(DATAFIELD_TIMESTAMP * timestamp);
+        void flagNextRow(uint8_t flags);
 
-        void storeDataArray(int32_t * data);
-        void getDataArray(float * buffer, bool converted, bool alsoRemove);
-        uint32_t writeHeadersToBuffer(char * buffer, uint8_t bufferLength);
+        bool allocate(void);
+        uint32_t bytesUsed(void);
+
+        void setOverflowPolicy(OVERFLOW_POLICY policy, OVERFLOW_SPILL_FN * spillFn);
+        OVERFLOW_POLICY getOverflowPolicy(void);
+        virtual bool getCounters(uint8_t index, DATAFIELD_COUNTERS * counters);
+        virtual void resetCounters(void);
+        uint32_t spillCount(void);
+
+        virtual void storeDataArray(int32_t * data);
+        virtual void storeAverageArray(float * averages, DATAFIELD_STATISTICS const * stats = NULL);
+        virtual void storeFixedAverageArray(FIXED * averages, DATAFIELD_STATISTICS const * stats = NULL);
+        virtual void getDataArray(float * buffer, bool converted, bool alsoRemove);
+        virtual void getFixedDataArray(FIXED * buffer, bool converted, bool alsoRemove);
+        virtual uint32_t getDataRows(float * buffer, uint32_t maxRows, bool converted, bool alsoRemove, uint32_t * rowIndexes,
+            DATAFIELD_TIMESTAMP * timestamps = NULL, uint32_t * changedFields = NULL);
+        virtual uint32_t getFixedDataRows(FIXED * buffer, uint32_t maxRows, bool converted, bool alsoRemove, uint32_t * rowIndexes,
+            DATAFIELD_TIMESTAMP * timestamps = NULL, uint32_t * changedFields = NULL);
+        uint32_t writeHeadersToBuffer(char * buffer, uint16_t bufferLength);
 
         void setupAllValidChannels(void);
         uint32_t * getChannelNumbers(void);
-        bool hasData(void);
-        uint32_t count(void);
+        uint16_t const * getDataIndexes(void);
+        uint8_t const * getSampleDivisors(void);
+        virtual bool hasData(void);
+        virtual uint32_t count(void);
+
+    protected:
+        virtual uint32_t storageSize(void);
+        virtual void carveStorage(uint8_t * arena);
+        void spillIfFull(void);
+        void rowStored(void);
+        void stampRow(uint32_t rowNumber);
+        void readTimestamp(uint32_t rowNumber, DATAFIELD_TIMESTAMP * timestamp);
+        uint32_t allFieldsMask(void);
+        void mapField(DataField * field);
+        void getRow(float * buffer, bool converted, bool alsoRemove);
+        void getFixedRow(FIXED * buffer, bool converted, bool alsoRemove);
 
-    private:
         DataField * m_fields[MAX_FIELDS];
         uint8_t m_fieldCount;
         uint32_t m_dataCount;
+        uint32_t m_totalRows;
         uint32_t m_dataSize;
         uint32_t m_averagerSize;
         uint32_t m_channelNumbers[MAX_FIELDS];
+        uint16_t m_dataIndexes[MAX_FIELDS]; // Index of each field's sample in the incoming scan array
+        uint8_t m_channelSlots[MAX_CHANNEL_NUMBER + 1]; // Field index for each channel number (or DATAFIELD_NO_SLOT)
+        uint8_t m_sampleDivisors[MAX_FIELDS];
+        uint32_t m_scanCount;
+        bool m_fixedPoint;
+        int64_t * m_arena;
+        uint32_t m_arenaSize;
+        OVERFLOW_POLICY m_overflowPolicy;
+        OVERFLOW_SPILL_FN * m_spillFn;
+        uint32_t m_spills;
+        DATAFIELD_CLOCK_FN * m_clockFn;
+        uint32_t * m_timestampSeconds;
+        uint16_t * m_timestampMillis;
+        uint8_t m_nextRowFlags;
 };
 
 #endif
@@ -18,6 +18,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #endif
 
 #ifdef TEST
@@ -28,32 +29,181 @@
  * Local Application Includes
  */
 
+#include "DLUtility.FixedPoint.h"
 #include "DLUtility.Averager.h"
+#include "DLUtility.Statistics.h"
+#include "DLUtility.Quantiles.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.Conversion.h"
 #include "DLDataField.h"
+#include "DLDataField.Typed.h"
 #include "DLUtility.h"
 
 /*
  * Static file functions
  */
 
-static void printVoltageData(char * buffer, VOLTAGECHANNEL * data)
+static void printVoltageData(char * buffer, void * params)
 {
+    VOLTAGECHANNEL * data = (VOLTAGECHANNEL*)params;
     sprintf(buffer, "R1 = %.1f, R2 = %.1f, mVPerBit = %.4f, Offset = %.4f, Multipler = %.4f",
         data->R1, data->R2, data->mvPerBit, data->offset, data->multiplier);
 }
 
-static void printCurrentData(char * buffer, CURRENTCHANNEL * data)
+static void printCurrentData(char * buffer, void * params)
 {
+    CURRENTCHANNEL * data = (CURRENTCHANNEL*)params;
     sprintf(buffer, "Offset = %.1f, mvPerAmp = %.1f, mVPerBit = %.4f",
         data->offset, data->mvPerAmp, data->mvPerBit);
 }
 
-static void printThermistorData(char * buffer, THERMISTORCHANNEL * data)
+static void printThermistorData(char * buffer, void * params)
 {
-    sprintf(buffer, "Other R = %.1f, R25 = %.1f, B = %.1f, maxADC = %d, %s",
+    THERMISTORCHANNEL * data = (THERMISTORCHANNEL*)params;
+    int written = sprintf(buffer, "Other R = %.1f, R25 = %.1f, B = %.1f, maxADC = %d, %s",
         data->otherR, data->R25, data->B, (int)data->maxADC, data->highside ? "highside" : "lowside");
+
+    if (data->lut)
+    {
+        sprintf(buffer + written, ", LUT %d (+/-%.3fC)", (int)data->lutSize, data->lutMaxError);
+    }
+}
+
+/*
+ * Converter functions
+ *
+ * Adapt the conversion functions for each field type to the DATAFIELD_CONVERTER signatures
+ */
+static float convertVolts(float raw, void * params) { return CONV_VoltsFromRaw(raw, (VOLTAGECHANNEL*)params); }
+static float convertAmps(float raw, void * params) { return CONV_AmpsFromRaw(raw, (CURRENTCHANNEL*)params); }
+static float convertThermistor(float raw, void * params) { return CONV_CelsiusFromRawThermistor(raw, (THERMISTORCHANNEL*)params); }
+
+static void convertVoltsArray(float const * raw, float * out, uint32_t n, void * params)
+{
+    CONV_VoltsFromRawArray(raw, out, n, (VOLTAGECHANNEL*)params);
+}
+
+static void convertAmpsArray(float const * raw, float * out, uint32_t n, void * params)
+{
+    CONV_AmpsFromRawArray(raw, out, n, (CURRENTCHANNEL*)params);
+}
+
+static void convertThermistorArray(float const * raw, float * out, uint32_t n, void * params)
+{
+    CONV_CelsiusFromRawThermistorArray(raw, out, n, (THERMISTORCHANNEL*)params);
+}
+
+static bool voltageCoefficients(void * params, CONVERSION_COEFFICIENTS * coefficients)
+{
+    CONV_GetVoltageCoefficients((VOLTAGECHANNEL*)params, coefficients);
+    return true;
+}
+
+static bool currentCoefficients(void * params, CONVERSION_COEFFICIENTS * coefficients)
+{
+    CONV_GetCurrentCoefficients((CURRENTCHANNEL*)params, coefficients);
+    return true;
+}
+
+// Thermistor lookup tables are built once before the field uses them, rather than on each conversion
+static void prepareThermistor(void * params)
+{
+    if (!((THERMISTORCHANNEL*)params)->lut)
+    {
+        CONV_BuildThermistorLUT((THERMISTORCHANNEL*)params);
+    }
+}
+
+/*
+ * getConverter
+ *
+ * Get the converter for a field type (NULL if the type has no conversion)
+ */
+static DATAFIELD_CONVERTER const * getConverter(FIELD_TYPE type)
+{
+    switch (type)
+    {
+    case VOLTAGE: return &DataField_VoltageConverter;
+    case CURRENT: return &DataField_CurrentConverter;
+    case TEMPERATURE_C: return &DataField_ThermistorConverter;
+    default: return NULL;
+    }
+}
+
+/*
+ * decimalsFromFormat
+ *
+ * Get the precision from a printf float format (e.g. 4 from "%.4f"),
+ * so that fixed point data can be formatted to match. Defaults to 6, as printf does.
+ */
+static uint8_t decimalsFromFormat(char const * const fmt)
+{
+    char const * pPoint = fmt ? strchr(fmt, '.') : NULL;
+    if (!pPoint) { return 6; }
+
+    uint8_t decimals = 0;
+    pPoint++;
+    while ((*pPoint >= '0') && (*pPoint <= '9'))
+    {
+        decimals = (decimals * 10) + (*pPoint++ - '0');
+    }
+    return decimals;
+}
+
+/*
+ * statisticPointer
+ *
+ * Get the member of stats for a statistics column (NULL for COLUMN_AVERAGE)
+ */
+static float * statisticPointer(DATAFIELD_STATISTICS * stats, DATAFIELD_COLUMN column)
+{
+    switch (column)
+    {
+    case COLUMN_MIN: return &stats->min;
+    case COLUMN_MAX: return &stats->max;
+    case COLUMN_STDDEV: return &stats->stddev;
+    case COLUMN_P5: return &stats->p5;
+    case COLUMN_P50: return &stats->p50;
+    case COLUMN_P95: return &stats->p95;
+    default: return NULL;
+    }
+}
+
+/*
+ * Public Data
+ */
+
+DATAFIELD_CONVERTER const DataField_VoltageConverter = {
+    convertVolts, convertVoltsArray, voltageCoefficients, NULL, printVoltageData
+};
+
+DATAFIELD_CONVERTER const DataField_CurrentConverter = {
+    convertAmps, convertAmpsArray, currentCoefficients, NULL, printCurrentData
+};
+
+DATAFIELD_CONVERTER const DataField_ThermistorConverter = {
+    convertThermistor, convertThermistorArray, NULL, prepareThermistor, printThermistorData
+};
+
+/*
+ * Public Functions
+ */
+
+/*
+ * DataField_GetStatistic, DataField_SetStatistic
+ *
+ * Get or set the value in stats for a statistics column (see NumericDataField::statisticsColumn)
+ */
+float DataField_GetStatistic(DATAFIELD_STATISTICS const * stats, DATAFIELD_COLUMN column)
+{
+    float * pValue = stats ? statisticPointer((DATAFIELD_STATISTICS *)stats, column) : NULL;
+    return pValue ? *pValue : DATAFIELD_NO_DATA_VALUE;
+}
+
+void DataField_SetStatistic(DATAFIELD_STATISTICS * stats, DATAFIELD_COLUMN column, float value)
+{
+    float * pValue = stats ? statisticPointer(stats, column) : NULL;
+    if (pValue) { *pValue = value; }
 }
 
 /*
@@ -61,31 +211,381 @@ static void printThermistorData(char * buffer, THERMISTORCHANNEL * data)
  */
 NumericDataField::NumericDataField(FIELD_TYPE type, void * fieldData, uint32_t channelNumber) : DataField(type, channelNumber)
 {
-    m_conversionData = fieldData;
+    init();
+
+    // The converter is found once here, so conversions do not check the field type for each value
+    m_converter = getConverter(type);
+    if (fieldData)
+    {
+        prepareConversion(fieldData);
+        setConversionParams(fieldData);
+    }
+}
+
+NumericDataField::NumericDataField(DATAFIELD_CONVERTER const * converter, FIELD_TYPE type, uint32_t channelNumber) :
+    DataField(type, channelNumber)
+{
+    init();
+    m_converter = converter;
+}
+
+void NumericDataField::init(void)
+{
+    m_conversionData = NULL;
+    m_converter = NULL;
     m_altConversionFn = NULL;
+    m_data = NULL;
+    m_fixedData = NULL;
+    m_stats = NULL;
+    m_ownedStorage = NULL;
+    m_runningStats = NULL;
+    m_sketch = NULL;
+    m_hasLatestPercentiles = false;
+    m_sum = 0;
+    m_sampleCount = 0;
+    m_averagerSize = 0;
+    m_fixedPoint = false;
+    m_reducer = REDUCER_MEAN;
+    m_reducerParameter = 0;
+    m_sampleDivisor = 1;
+    m_deadband = 0.0f;
+    m_deadbandFraction = 0.0f;
+    m_lastEmitted = 0.0f;
+    m_hasEmitted = false;
+    m_fixedCoefficients = NULL;
+}
+
+/*
+ * prepareConversion
+ *
+ * Let the converter prepare conversion data before the field uses it (e.g. build a lookup table)
+ */
+void NumericDataField::prepareConversion(void * params)
+{
+    if (params && m_converter && m_converter->prepare)
+    {
+        m_converter->prepare(params);
+    }
+}
+
+/*
+ * setConversionParams
+ *
+ * Set the conversion data (must be called before setFixedPoint)
+ */
+void NumericDataField::setConversionParams(void * params)
+{
+    m_conversionData = params;
 }
 
 NumericDataField::~NumericDataField()
 {
-    delete[] m_data;
+    delete[] m_ownedStorage;
+    delete m_fixedCoefficients;
+    delete m_runningStats;
+    delete m_sketch;
 }
 
+/*
+ * setDataSizes
+ *
+ * Allocate storage for N averages of averagerN samples each.
+ * For fields owned by a DataFieldManager, the manager provides storage with setStorage instead.
+ */
 void NumericDataField::setDataSizes(uint32_t N, uint32_t averagerN)
 {
     if (N == 0 || averagerN == 0) { return; }
 
-    setSize(N);
+    // Fixed point data, float data and statistics are all made of four-byte values
+    float * storage = new float[storageSize(N) / sizeof(float)];
+
+    if (storage)
+    {
+        setStorage(storage, N, averagerN);
+        m_ownedStorage = storage;
+    }
+}
+
+/*
+ * storageSize
+ *
+ * Returns the number of bytes setStorage needs for N averages (and their statistics, if enabled).
+ * The averager is a running sum, so needs no storage of its own.
+ */
+uint32_t NumericDataField::storageSize(uint32_t N)
+{
+    uint32_t size = N * (m_fixedPoint ? sizeof(FIXED) : sizeof(float));
+    if (statisticsColumnCount()) { size += N * sizeof(DATAFIELD_STATISTICS); }
+    return size;
+}
+
+/*
+ * setStorage
+ *
+ * Use storage provided by the caller (of at least storageSize(N) bytes, aligned for float) for N averages
+ * of averagerN samples each. The storage is not freed by the field.
+ */
+void NumericDataField::setStorage(void * storage, uint32_t N, uint32_t averagerN)
+{
+    if (!storage || N == 0 || averagerN == 0) { return; }
 
-    m_data = new float[N];
+    setSize(N);
 
-    if (m_data)
+    if (m_fixedPoint)
+    {
+        m_fixedData = (FIXED *)storage;
+        fillArray(m_fixedData, (FIXED)0, N);
+    }
+    else
     {
+        m_data = (float *)storage;
         fillArray(m_data, 0.0f, N);
     }
 
-    m_averager = new Averager<int32_t>(averagerN);
+    if (statisticsColumnCount())
+    {
+        // Statistics follow the data (both are four-byte aligned)
+        m_stats = (DATAFIELD_STATISTICS *)((float *)storage + N);
+        memset(m_stats, 0, N * sizeof(DATAFIELD_STATISTICS));
+    }
+
+    m_averagerSize = averagerN;
+    m_sum = 0;
+    m_sampleCount = 0;
+    STATS_Reset(m_runningStats);
+}
+
+/*
+ * setFixedPoint
+ *
+ * In fixed point mode, averages are calculated and stored as Q16.16 and voltage/current
+ * conversions use integer arithmetic. Other conversions (thermistors, alternative conversion
+ * functions) still use floating point.
+ * Float getters work in both modes, as do fixed point getters.
+ *
+ * Must be called before setDataSizes, storageSize or setStorage.
+ */
+void NumericDataField::setFixedPoint(bool fixedPoint)
+{
+    m_fixedPoint = fixedPoint;
+
+    delete m_fixedCoefficients;
+    m_fixedCoefficients = NULL;
+
+    if (!m_fixedPoint || !m_conversionData || !m_converter || !m_converter->getCoefficients) { return; }
+
+    CONVERSION_COEFFICIENTS coefficients;
+    if (!m_converter->getCoefficients(m_conversionData, &coefficients)) { return; }
+
+    m_fixedCoefficients = new CONVERSION_FIXED_COEFFICIENTS;
+    CONV_GetFixedCoefficients(&coefficients, m_fixedCoefficients);
+}
+
+/*
+ * setStatistics
+ *
+ * With statistics enabled, the minimum, maximum and standard deviation of the samples in each average
+ * are stored alongside it. They are calculated in a single pass as samples are stored, so the samples
+ * are not kept. Statistics are always calculated and stored as floating point (even in fixed point mode).
+ *
+ * Must be called before setDataSizes, storageSize or setStorage.
+ */
+void NumericDataField::setStatistics(bool statistics)
+{
+    if (statistics && !m_runningStats)
+    {
+        m_runningStats = new RUNNING_STATISTICS;
+        STATS_Reset(m_runningStats);
+    }
+    else if (!statistics)
+    {
+        delete m_runningStats;
+        m_runningStats = NULL;
+    }
+}
+
+bool NumericDataField::hasStatistics(void)
+{
+    return m_runningStats != NULL;
+}
+
+/*
+ * setPercentiles
+ *
+ * With percentiles enabled, the 5th, 50th and 95th percentiles of the samples in each average are
+ * estimated by a streaming sketch and stored alongside it (as floating point, like statistics).
+ * The sketch uses fixed memory: about 16 bytes per unit of compression (0 disables percentiles).
+ * Higher compression is more accurate, especially for the P5 and P95.
+ *
+ * Must be called before setDataSizes, storageSize or setStorage.
+ */
+void NumericDataField::setPercentiles(uint8_t compression)
+{
+    delete m_sketch;
+    m_sketch = compression ? new QuantileSketch(compression) : NULL;
+    m_hasLatestPercentiles = false;
+}
+
+bool NumericDataField::hasPercentiles(void)
+{
+    return m_sketch != NULL;
+}
+
+/*
+ * statisticsColumnCount, statisticsColumn
+ *
+ * The number of values stored with each average (min, max and stddev if statistics are enabled,
+ * then P5, P50 and P95 if percentiles are enabled) and what the indexth of them is.
+ */
+uint8_t NumericDataField::statisticsColumnCount(void)
+{
+    return (hasStatistics() ? 3 : 0) + (hasPercentiles() ? 3 : 0);
 }
 
+DATAFIELD_COLUMN NumericDataField::statisticsColumn(uint8_t index)
+{
+    if (!hasStatistics()) { index += 3; }
+    return (DATAFIELD_COLUMN)(COLUMN_MIN + index);
+}
+
+/*
+ * addPercentileSample
+ *
+ * Add a sample to the percentile sketch only (if enabled).
+ * storeData does this itself: this is for when averaging is done elsewhere (e.g. by a DataFieldAggregator),
+ * and the percentiles are taken when the average is stored.
+ */
+void NumericDataField::addPercentileSample(int32_t sample)
+{
+    if (m_sketch) { m_sketch->add((float)sample); }
+}
+
+/*
+ * takePercentiles
+ *
+ * Fill in the raw percentiles of the samples added since the last average (if enabled) and restart the sketch.
+ * Without any samples, the average is the only sample.
+ */
+void NumericDataField::takePercentiles(DATAFIELD_STATISTICS * stats, float average)
+{
+    if (!m_sketch || !stats) { return; }
+
+    if (m_sketch->count())
+    {
+        stats->p5 = m_sketch->quantile(0.05f);
+        stats->p50 = m_sketch->quantile(0.5f);
+        stats->p95 = m_sketch->quantile(0.95f);
+    }
+    else
+    {
+        stats->p5 = average;
+        stats->p50 = average;
+        stats->p95 = average;
+    }
+
+    m_sketch->reset();
+    m_latestPercentiles = *stats;
+    m_hasLatestPercentiles = true;
+}
+
+/* Restart the sketch when an average is discarded, so its samples do not count towards the next one */
+void NumericDataField::discardPercentiles(void)
+{
+    if (m_sketch) { m_sketch->reset(); }
+}
+
+/*
+ * getLatestPercentiles
+ *
+ * Get the percentiles of the most recently stored average, optionally converted.
+ * Unlike getStatistics, this is still available once averages have been read and removed.
+ *
+ * Returns false if percentiles are not enabled or no average has been stored
+ */
+bool NumericDataField::getLatestPercentiles(DATAFIELD_STATISTICS * stats, bool converted)
+{
+    if (!stats || !m_sketch || !m_hasLatestPercentiles) { return false; }
+
+    *stats = m_latestPercentiles;
+    if (converted) { convertPercentiles(stats); }
+
+    return true;
+}
+
+/*
+ * setReducer
+ *
+ * Select how samples are reduced to each average (the default is the mean).
+ * Only used by DataFieldAggregator: fields averaging their own samples always use the mean.
+ *
+ * parameter: Reducer specific (0 for the default)
+ */
+void NumericDataField::setReducer(REDUCER_TYPE reducer, uint8_t parameter)
+{
+    m_reducer = (reducer < INVALID_REDUCER) ? reducer : REDUCER_MEAN;
+    m_reducerParameter = parameter;
+}
+
+/*
+ * setSampleDivisor
+ *
+ * Sample this field on one scan in every divisor scans (1, the default, is every scan).
+ * The scans a field is sampled on are set by DataField_SampleIsDue.
+ * Must be called before the field is added to a manager.
+ */
+void NumericDataField::setSampleDivisor(uint8_t divisor)
+{
+    m_sampleDivisor = divisor ? divisor : 1;
+}
+
+/*
+ * setDeadband
+ *
+ * Set how far this field's (converted) average must move from the last emitted average before it is emitted again.
+ * absolute: In converted units (0 for none)
+ * percent: Percentage of the last emitted value (0 for none)
+ * If both are set, moving outside either is enough. Deadbands are applied by ColumnarDataFieldManager::enableDeadbands.
+ */
+void NumericDataField::setDeadband(float absolute, float percent)
+{
+    m_deadband = (absolute > 0.0f) ? absolute : 0.0f;
+    m_deadbandFraction = (percent > 0.0f) ? (percent / 100.0f) : 0.0f;
+    m_hasEmitted = false;
+}
+
+bool NumericDataField::hasDeadband(void)
+{
+    return (m_deadband > 0.0f) || (m_deadbandFraction > 0.0f);
+}
+
+/*
+ * outsideDeadband
+ *
+ * Returns true if a raw average has moved outside the deadband around the last emitted average
+ * (or if there is no deadband, or nothing has been emitted yet)
+ */
+bool NumericDataField::outsideDeadband(float average)
+{
+    if (!hasDeadband() || !m_hasEmitted) { return true; }
+
+    float change = fabsf(convert(average) - m_lastEmitted);
+
+    if ((m_deadband > 0.0f) && (change > m_deadband)) { return true; }
+    if ((m_deadbandFraction > 0.0f) && (change > (m_deadbandFraction * fabsf(m_lastEmitted)))) { return true; }
+
+    return false;
+}
+
+/*
+ * setEmitted
+ *
+ * Record a raw average as emitted, so that the deadband is measured from it
+ */
+void NumericDataField::setEmitted(float average)
+{
+    m_lastEmitted = convert(average);
+    m_hasEmitted = true;
+}
 
 void NumericDataField::setAltConversion(APP_CONVERSION_FN * altConversionFn)
 {
@@ -96,7 +596,7 @@ float NumericDataField::getRawData(bool alsoRemove)
 {
     if (length() > 0)
     {
-        float data = m_data[ getTailIndex() ];
+        float data = m_fixedPoint ? FIXED_ToFloat(m_fixedData[ getTailIndex() ]) : m_data[ getTailIndex() ];
         if (alsoRemove) { pop(); }
         return data;
     }
@@ -108,8 +608,42 @@ float NumericDataField::getRawData(bool alsoRemove)
 
 float NumericDataField::getConvData(bool alsoRemove)
 {
-    float data = getRawData(alsoRemove);
+    if (m_fixedPoint)
+    {
+        // Convert using fixed point, so float and fixed point getters give the same result
+        return (length() > 0) ? FIXED_ToFloat(getConvFixed(alsoRemove)) : DATAFIELD_NO_DATA_VALUE;
+    }
+    return convert(getRawData(alsoRemove));
+}
+
+FIXED NumericDataField::getRawFixed(bool alsoRemove)
+{
+    if (length() > 0)
+    {
+        FIXED data = m_fixedPoint ? m_fixedData[ getTailIndex() ] : FIXED_FromFloat(m_data[ getTailIndex() ]);
+        if (alsoRemove) { pop(); }
+        return data;
+    }
+    else
+    {
+        return DATAFIELD_NO_FIXED_DATA_VALUE;
+    }
+}
+
+FIXED NumericDataField::getConvFixed(bool alsoRemove)
+{
+    if (length() == 0) { return DATAFIELD_NO_FIXED_DATA_VALUE; }
+    return convertFixed(getRawFixed(alsoRemove));
+}
 
+/*
+ * convert
+ *
+ * Converts a raw value using this field's conversion settings.
+ * The value need not be stored in this field.
+ */
+float NumericDataField::convert(float data)
+{
     if (m_conversionData)
     {
         if (m_altConversionFn)
@@ -117,50 +651,280 @@ float NumericDataField::getConvData(bool alsoRemove)
             // Conversion has been overriden for this field
             data = m_altConversionFn(data, (void*)m_conversionData);
         }
-        else
+        else if (m_converter)
         {
-            switch (m_fieldType)
-            {
-            case VOLTAGE:
-                data = CONV_VoltsFromRaw(data, (VOLTAGECHANNEL*)m_conversionData);
-                break;
-            case CURRENT:
-                data = CONV_AmpsFromRaw(data, (CURRENTCHANNEL*)m_conversionData);
-                break;
-            case TEMPERATURE_C:
-                data = CONV_CelsiusFromRawThermistor(data, (THERMISTORCHANNEL*)m_conversionData);
-            default:
-                break;
-            }
+            data = m_converter->convert(data, m_conversionData);
         }
     }
 
     return data;
 }
 
+/*
+ * convertArray
+ *
+ * Converts an array of raw values using this field's conversion settings.
+ * The converter is called once per array, and voltage/current
+ * conversions use the vectorisable linear array conversion.
+ */
+void NumericDataField::convertArray(float const * raw, float * out, uint32_t n)
+{
+    uint32_t i;
+
+    if (m_conversionData && m_converter && !m_altConversionFn)
+    {
+        m_converter->convertArray(raw, out, n, m_conversionData);
+        return;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        out[i] = convert(raw[i]);
+    }
+}
+
+/*
+ * convertFixed
+ *
+ * Fixed point version of convert. Voltage and current conversions use integer arithmetic
+ * if the field is in fixed point mode. Other conversions are done in floating point.
+ */
+FIXED NumericDataField::convertFixed(FIXED raw)
+{
+    if (m_fixedCoefficients && !m_altConversionFn)
+    {
+        return CONV_LinearFixed(raw, m_fixedCoefficients);
+    }
+
+    if (m_conversionData)
+    {
+        return FIXED_FromFloat(convert(FIXED_ToFloat(raw)));
+    }
+
+    return raw;
+}
+
+/*
+ * getStatistics
+ *
+ * Get the statistics of the oldest average, optionally converted.
+ * This does not remove the average, so must be called before getting (and removing) the average itself.
+ *
+ * Returns false if neither statistics nor percentiles are enabled or there is no data
+ */
+bool NumericDataField::getStatistics(DATAFIELD_STATISTICS * stats, bool converted)
+{
+    if (!stats || !m_stats || (length() == 0)) { return false; }
+
+    *stats = m_stats[ getTailIndex() ];
+
+    if (converted)
+    {
+        convertStatistics(getRawData(false), stats);
+    }
+
+    return true;
+}
+
+/*
+ * convertStatistics
+ *
+ * Converts raw statistics using this field's conversion settings.
+ * The minimum and maximum are converted directly (and swapped if the conversion is decreasing).
+ * The standard deviation is scaled by the slope of the conversion at the average, which is exact for
+ * linear (voltage and current) conversions and a good approximation for small deviations otherwise.
+ *
+ * rawAverage: The raw average the statistics belong to
+ * stats: The statistics to convert
+ */
+void NumericDataField::convertStatistics(float rawAverage, DATAFIELD_STATISTICS * stats)
+{
+    if (!stats) { return; }
+
+    float convertedMin = convert(stats->min);
+    float convertedMax = convert(stats->max);
+
+    stats->min = (convertedMin < convertedMax) ? convertedMin : convertedMax;
+    stats->max = (convertedMin < convertedMax) ? convertedMax : convertedMin;
+    stats->stddev = fabs(convert(rawAverage + stats->stddev) - convert(rawAverage));
+
+    convertPercentiles(stats);
+}
+
+/*
+ * convertPercentiles
+ *
+ * Converts raw percentiles (if enabled) using this field's conversion settings.
+ * Conversions are monotonic, so each percentile converts directly (P5 and P95 swap if the conversion is decreasing).
+ */
+void NumericDataField::convertPercentiles(DATAFIELD_STATISTICS * stats)
+{
+    if (!stats || !m_sketch) { return; }
+
+    float convertedP5 = convert(stats->p5);
+    float convertedP95 = convert(stats->p95);
+
+    stats->p5 = (convertedP5 < convertedP95) ? convertedP5 : convertedP95;
+    stats->p50 = convert(stats->p50);
+    stats->p95 = (convertedP5 < convertedP95) ? convertedP95 : convertedP5;
+}
+
+/*
+ * storeData
+ *
+ * Add a sample to the running sum (and statistics, if enabled). When averagerN samples have been added,
+ * their average is stored and the next sample starts a new average.
+ *
+ * Returns true if an average was stored (false if the average was discarded by the overflow policy)
+ */
 bool NumericDataField::storeData(int32_t data)
 {
-    bool dataStored = false;
-    m_averager->newData(data);
-    if (m_averager->full())
+    if (m_averagerSize == 0) { return false; }
+
+    m_sum += data;
+    STATS_Add(m_runningStats, data);
+    addPercentileSample(data);
+
+    if (++m_sampleCount < m_averagerSize) { return false; }
+
+    DATAFIELD_STATISTICS stats;
+    DATAFIELD_STATISTICS * pStats = NULL;
+    if (m_runningStats)
+    {
+        stats.min = m_runningStats->min;
+        stats.max = m_runningStats->max;
+        stats.stddev = STATS_StdDev(m_runningStats);
+        pStats = &stats;
+    }
+    // Percentiles are taken from the sketch when the average is stored
+
+    bool stored;
+    if (m_fixedPoint)
     {
-        prePush();
-        m_data[getWriteIndex()] = (float)m_averager->getFloatAverage();
-        postPush();
-        m_averager->reset(NULL);
-        dataStored = true;
+        stored = storeFixedAverage(FIXED_Average(m_sum, m_sampleCount), pStats);
     }
-    return dataStored;
+    else
+    {
+        stored = storeAverage((float)m_sum / (float)m_sampleCount, pStats);
+    }
+
+    m_sum = 0;
+    m_sampleCount = 0;
+    STATS_Reset(m_runningStats);
+
+    return stored;
+}
+
+/*
+ * storeAverage
+ *
+ * Stores an already-averaged value directly, bypassing the field's averager.
+ * Used when averaging is done elsewhere (e.g. by a DataFieldAggregator).
+ * If the field has statistics enabled, stats (raw values) are stored with the average.
+ * If stats is NULL, the average is treated as a single sample.
+ * If the field has percentiles enabled, they are taken from samples added with addPercentileSample.
+ *
+ * Returns false if the value was not stored (no storage, or discarded by the overflow policy)
+ */
+bool NumericDataField::storeAverage(float average)
+{
+    return storeAverage(average, NULL);
 }
 
+bool NumericDataField::storeAverage(float average, DATAFIELD_STATISTICS const * stats)
+{
+    if (m_fixedPoint)
+    {
+        return storeFixedAverage(FIXED_FromFloat(average), stats);
+    }
+
+    if (!m_data) { return false; }
+
+    if (!prePush()) { discardPercentiles(); return false; }
+    m_data[getWriteIndex()] = average;
+    storeStatistics(stats, average);
+    postPush();
+    return true;
+}
+
+/*
+ * storeFixedAverage
+ *
+ * As storeAverage, for an average in Q16.16
+ */
+bool NumericDataField::storeFixedAverage(FIXED average)
+{
+    return storeFixedAverage(average, NULL);
+}
+
+bool NumericDataField::storeFixedAverage(FIXED average, DATAFIELD_STATISTICS const * stats)
+{
+    if (!m_fixedPoint)
+    {
+        return storeAverage(FIXED_ToFloat(average), stats);
+    }
+
+    if (!m_fixedData) { return false; }
+
+    if (!prePush()) { discardPercentiles(); return false; }
+    m_fixedData[getWriteIndex()] = average;
+    storeStatistics(stats, FIXED_ToFloat(average));
+    postPush();
+    return true;
+}
+
+/*
+ * storeStatistics
+ *
+ * Store statistics and percentiles at the write index (if enabled).
+ * Without stats, the average is the only sample.
+ */
+void NumericDataField::storeStatistics(DATAFIELD_STATISTICS const * stats, float average)
+{
+    if (!m_stats) { return; }
+
+    DATAFIELD_STATISTICS * pStats = &m_stats[getWriteIndex()];
+
+    if (stats)
+    {
+        *pStats = *stats;
+    }
+    else
+    {
+        pStats->min = average;
+        pStats->max = average;
+        pStats->stddev = 0.0f;
+    }
+
+    takePercentiles(pStats, average);
+}
+
+/*
+ * getRawDataAsString, getConvDataAsString
+ *
+ * Write the oldest data point to buf, using printf format fmt.
+ * In fixed point mode, the data is written by integer routines with the precision from fmt.
+ */
 void NumericDataField::getRawDataAsString(char * buf, char const * const fmt, bool alsoRemove)
 {
+    if (m_fixedPoint)
+    {
+        FIXED_ToString(buf, getRawFixed(alsoRemove), decimalsFromFormat(fmt));
+        return;
+    }
+
     float data = getRawData(alsoRemove);
     sprintf(buf, fmt, data); // Write data point to buffer
 }
 
 void NumericDataField::getConvDataAsString(char * buf, char const * const fmt, bool alsoRemove)
 {
+    if (m_fixedPoint)
+    {
+        FIXED_ToString(buf, getConvFixed(alsoRemove), decimalsFromFormat(fmt));
+        return;
+    }
+
     float data = getConvData(alsoRemove);
     sprintf(buf, fmt, data); // Write data point to buffer
 }
@@ -170,21 +934,9 @@ void NumericDataField::getConfigString(char * buffer)
 {
     if (!buffer) { return; }
 
-    if (m_conversionData)
+    if (m_conversionData && m_converter)
     {
-        switch (m_fieldType)
-        {
-        case VOLTAGE:
-            printVoltageData(buffer, (VOLTAGECHANNEL*)m_conversionData);
-            break;
-        case CURRENT:
-            printCurrentData(buffer, (CURRENTCHANNEL*)m_conversionData);
-            break;
-        case TEMPERATURE_C:
-            printThermistorData(buffer, (THERMISTORCHANNEL*)m_conversionData);
-        default:
-            break;
-        }
+        m_converter->printConfig(buffer, m_conversionData);
     }
     else
     {
@@ -198,7 +950,7 @@ void NumericDataField::printContents(void)
     uint8_t i;
     for (i = 0; i <= m_maxIndex; ++i)
     {
-        std::cout << m_data[i] << ",";
+        std::cout << (m_fixedPoint ? FIXED_ToFloat(m_fixedData[i]) : m_data[i]) << ",";
     }
     std::cout << std::endl;
 }
@@ -28,59 +28,132 @@
  * Local Application Includes
  */
 
+#include "DLUtility.FixedPoint.h"
 #include "DLUtility.Averager.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
 #include "DLUtility.h"
 
+/*
+ * Public class Functions
+ */
+
 StringDataField::StringDataField(FIELD_TYPE type, uint8_t len, uint32_t N, uint32_t channelNumber) : DataField(type, channelNumber)
 {
-    
     setSize(N);
-    
-    m_data = new char*[N];
-    
-    if (m_data)
-    {
-        uint8_t i = 0;
-        for (i = 0; i < N; i++)
-        {
-            m_data[i] = new char[len];
-        }
-    }
-
     m_maxLength = len;
+    m_data = NULL;
+    m_ownsStorage = false;
 }
 
 StringDataField::~StringDataField()
 {
-    uint8_t i = 0;
-    for (i = 0; i < m_maxIndex; i++)
-    {
-        delete[] m_data[i];
-    }
+    if (m_ownsStorage) { delete[] m_data; }
+}
+
+/*
+ * storageSize
+ *
+ * Returns the number of bytes setStorage needs: N strings of the maximum length, one after the other
+ */
+uint32_t StringDataField::storageSize(void)
+{
+    return (m_maxIndex + 1) * m_maxLength;
+}
+
+/*
+ * setStorage
+ *
+ * Use storage provided by the caller (of at least storageSize() bytes).
+ * The storage is not freed by the field. If no storage is provided, the field allocates its own on first use.
+ */
+void StringDataField::setStorage(void * storage)
+{
+    if (!storage || m_data) { return; }
 
-    delete[] m_data;
+    m_data = (char *)storage;
+    memset(m_data, 0, storageSize());
 }
 
-void StringDataField::storeData(char const * data)
+/*
+ * allocate
+ *
+ * If the field has no storage, allocate it (as a single block)
+ */
+bool StringDataField::allocate(void)
 {
-    prePush();
-    strncpy_safe(m_data[getWriteIndex()], data, m_maxLength);
+    if (m_data) { return true; }
+
+    char * storage = new char[storageSize()];
+    setStorage(storage);
+    m_ownsStorage = (m_data != NULL);
+
+    return m_data != NULL;
+}
+
+/*
+ * slot
+ *
+ * Strings are stored at a fixed stride (the maximum length), so the nth string is at n * maxLength
+ */
+char * StringDataField::slot(uint32_t index)
+{
+    return &m_data[index * m_maxLength];
+}
+
+/*
+ * storeData
+ *
+ * Returns false if the string was not stored (no storage, or discarded by the overflow policy)
+ */
+bool StringDataField::storeData(char const * data)
+{
+    if (!allocate()) { return false; }
+
+    if (!prePush()) { return false; }
+    strncpy_safe(slot(getWriteIndex()), data, m_maxLength);
     postPush();
+    return true;
 }
 
 char * StringDataField::getData(bool alsoRemove)
 {
-    char * data = m_data[ getTailIndex() ];
+    if (!allocate()) { return NULL; }
+
+    char * data = slot(getTailIndex());
     if (alsoRemove) { pop(); }
     return data;
 }
 
 void StringDataField::copy(char * buf, bool alsoRemove)
 {
-    char * data = m_data[ getTailIndex() ];
-    strncpy_safe(buf, data, m_maxLength);
+    if (!allocate()) { return; }
+
+    strncpy_safe(buf, slot(getTailIndex()), m_maxLength);
     if (alsoRemove) { pop(); }
 }
 
+/*
+ * getView
+ *
+ * Get a pointer to the oldest string and its length, without copying it.
+ * The view stays valid until the string's slot is reused (after removal, by the next storeData
+ * once the field is full), so read it before storing more data.
+ *
+ * Returns false if the field has no data
+ */
+bool StringDataField::getView(STRING_VIEW * view, bool alsoRemove)
+{
+    if (!view || !hasData()) { return false; }
+
+    char const * data = slot(getTailIndex());
+
+    uint8_t length = 0;
+    while ((length < m_maxLength) && data[length]) { length++; }
+
+    view->data = data;
+    view->length = length;
+
+    if (alsoRemove) { pop(); }
+    return true;
+}
@@ -0,0 +1,66 @@
+#ifndef _DATAFIELD_TYPED_H_
+#define _DATAFIELD_TYPED_H_
+
+/* Converters for each type of field with a conversion (defined in DLDataField.Numeric.cpp) */
+extern struct datafield_converter const DataField_VoltageConverter;
+extern struct datafield_converter const DataField_CurrentConverter;
+extern struct datafield_converter const DataField_ThermistorConverter;
+
+/*
+ * Conversion policies for TypedNumericDataField.
+ * Each gives the field type, the type of its conversion parameters and the converter to use.
+ */
+struct VoltageConversion
+{
+    typedef VOLTAGECHANNEL PARAMS;
+    static FIELD_TYPE type(void) { return VOLTAGE; }
+    static struct datafield_converter const * converter(void) { return &DataField_VoltageConverter; }
+};
+
+struct CurrentConversion
+{
+    typedef CURRENTCHANNEL PARAMS;
+    static FIELD_TYPE type(void) { return CURRENT; }
+    static struct datafield_converter const * converter(void) { return &DataField_CurrentConverter; }
+};
+
+struct ThermistorConversion
+{
+    typedef THERMISTORCHANNEL PARAMS;
+    static FIELD_TYPE type(void) { return TEMPERATURE_C; }
+    static struct datafield_converter const * converter(void) { return &DataField_ThermistorConverter; }
+};
+
+/*
+ * TypedNumericDataField
+ *
+ * A NumericDataField with its conversion fixed at compile time by POLICY (e.g. VoltageConversion).
+ *
+ * The conversion parameters are copied into the field, rather than pointing to a separately
+ * allocated settings struct. Any preparation (e.g. building a thermistor lookup table) is done
+ * on the settings struct first, so anything it allocates is shared with the settings as before.
+ *
+ * params : The conversion parameters to copy (if NULL, the field has no conversion)
+ * channelNumber : The platform channel number
+ */
+template <class POLICY>
+class TypedNumericDataField : public NumericDataField
+{
+    public:
+        TypedNumericDataField(typename POLICY::PARAMS * params, uint32_t channelNumber) :
+            NumericDataField(POLICY::converter(), POLICY::type(), channelNumber)
+        {
+            if (!params) { return; }
+
+            prepareConversion(params);
+            m_params = *params;
+            setConversionParams(&m_params);
+        }
+
+        typename POLICY::PARAMS * getParams(void) { return &m_params; }
+
+    private:
+        typename POLICY::PARAMS m_params;
+};
+
+#endif
@@ -24,6 +24,37 @@ enum field_type
 };
 typedef enum field_type FIELD_TYPE;
 
+/* How the samples in each averaging window are reduced to one value.
+ The parameter (if set) is the percentage trimmed from each end for REDUCER_TRIMMED_MEAN
+ or the order for REDUCER_CIC. */
+enum reducer_type
+{
+    REDUCER_MEAN,
+    REDUCER_MEDIAN,
+    REDUCER_TRIMMED_MEAN,
+    REDUCER_EMA,
+    REDUCER_CIC,
+
+    INVALID_REDUCER
+};
+typedef enum reducer_type REDUCER_TYPE;
+
+#define DEFAULT_TRIM_PERCENT (10)
+#define DEFAULT_CIC_ORDER (2)
+
+/* Condition that starts a burst capture on a channel (see BurstCapture).
+ Levels are raw ADC counts. TRIGGER_RATE fires when a sample differs from the previous one by more than the level. */
+enum trigger_type
+{
+    TRIGGER_NONE,
+    TRIGGER_ABOVE,
+    TRIGGER_BELOW,
+    TRIGGER_RATE,
+
+    INVALID_TRIGGER
+};
+typedef enum trigger_type TRIGGER_TYPE;
+
 /* Each FIELD_TYPE has a data structure associated with it 
  * in order to perform conversions from raw values to units.
   In addition, the number of settings is #defined so that the
@@ -46,6 +77,10 @@ struct currentchannel
 };
 typedef struct currentchannel CURRENTCHANNEL;
 
+/* Thermistor conversion can optionally use a lookup table of lutSize segments (lutSize = 0 means no table).
+ The table itself is built from the other settings by CONV_BuildThermistorLUT. */
+#define MAX_THERMISTOR_LUT_SIZE (1024)
+
 struct thermistorchannel
 {
     float R25;
@@ -53,6 +88,9 @@ struct thermistorchannel
     float otherR;
     float maxADC;
     bool highside;
+    uint16_t lutSize;
+    float * lut;
+    float lutMaxError;
 }; 
 typedef struct thermistorchannel THERMISTORCHANNEL;
 
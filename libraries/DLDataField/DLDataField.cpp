@@ -28,6 +28,7 @@
  * Local Application Includes
  */
 
+#include "DLUtility.FixedPoint.h"
 #include "DLUtility.Averager.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
@@ -76,6 +77,8 @@ DataField::DataField(FIELD_TYPE fieldType, uint32_t channelNumber)
     m_index[H] = 0;
     m_maxIndex = 0;
     m_channelNumber = channelNumber;
+    m_overflowPolicy = OVERFLOW_DROP_OLDEST;
+    resetCounters();
 }
 
 DataField::~DataField() {}
@@ -95,17 +98,36 @@ void DataField::pop(void)
 	if (length())
 	{
 		m_index[T]++;
+		m_counters.pops++;
 	}
 }
 
-void DataField::prePush(void)
+/*
+ * prePush
+ *
+ * Make room for a new value if the buffer is full, according to the overflow policy.
+ * The spill policy needs a manager to spill data: a full field on its own drops the oldest value.
+ *
+ * Returns false if the new value should be discarded
+ */
+bool DataField::prePush(void)
 {
-	if (full()) { removeOldest(); }
+	if (!full()) { return true; }
+
+	if (m_overflowPolicy == OVERFLOW_DROP_NEWEST)
+	{
+		m_counters.drops++;
+		return false;
+	}
+
+	removeOldest();
+	return true;
 }
 
 void DataField::postPush(void)
 {
 	m_index[H]++;
+	m_counters.pushes++;
 }
 
 bool DataField::full(void)
@@ -160,6 +182,7 @@ void DataField::removeOldest(void)
 	if (length() > 0)
 	{
 		m_index[T]++;
+		m_counters.drops++;
 	}
 }
 
@@ -173,6 +196,29 @@ uint32_t DataField::getChannelNumber(void)
 	return m_channelNumber;
 }
 
+void DataField::setOverflowPolicy(OVERFLOW_POLICY policy)
+{
+	m_overflowPolicy = policy;
+}
+
+OVERFLOW_POLICY DataField::getOverflowPolicy(void)
+{
+	return m_overflowPolicy;
+}
+
+void DataField::getCounters(DATAFIELD_COUNTERS * counters)
+{
+	if (counters) { *counters = m_counters; }
+}
+
+void DataField::resetCounters(void)
+{
+	m_counters.pushes = 0;
+	m_counters.pops = 0;
+	m_counters.drops = 0;
+	m_counters.suppressed = 0;
+}
+
 void DataField::getConfigString(char * buffer)
 {
 	sprintf(buffer, "Base datafield object!");
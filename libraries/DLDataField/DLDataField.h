@@ -3,31 +3,92 @@
 
 // A datafield should return this value if data is requested when none exists
 #define DATAFIELD_NO_DATA_VALUE (float)(0xFFFFFFFF)
+#define DATAFIELD_NO_FIXED_DATA_VALUE (FIXED_MIN)
 
 typedef float (APP_CONVERSION_FN)(float, void *);
 
+/* What to do with new data when a field's buffer is full */
+enum overflow_policy
+{
+    OVERFLOW_DROP_OLDEST, // Discard the oldest data to make room (default)
+    OVERFLOW_DROP_NEWEST, // Discard the new data
+    OVERFLOW_SPILL // Let a spill function remove data (see DataFieldManager), then drop oldest if still full
+};
+typedef enum overflow_policy OVERFLOW_POLICY;
+
+/* Counts of data going through a field's buffer, for sizing buffers */
+struct datafield_counters
+{
+    uint32_t pushes; // Values stored
+    uint32_t pops; // Values read out and removed
+    uint32_t drops; // Values discarded because the buffer was full
+    uint32_t suppressed; // Values not stored because they were within a deadband (see ColumnarDataFieldManager::enableDeadbands)
+};
+typedef struct datafield_counters DATAFIELD_COUNTERS;
+
+/* Statistics of the samples in one average (see NumericDataField::setStatistics and setPercentiles) */
+struct datafield_statistics
+{
+    float min;
+    float max;
+    float stddev;
+    float p5;
+    float p50;
+    float p95;
+};
+typedef struct datafield_statistics DATAFIELD_STATISTICS;
+
+// Most values from DATAFIELD_STATISTICS a field can have (each is an extra column in a manager's data rows)
+#define DATAFIELD_STATISTICS_COLUMNS (6)
+
+/* What a column of a manager's data rows holds */
+enum datafield_column
+{
+    COLUMN_AVERAGE,
+    COLUMN_MIN,
+    COLUMN_MAX,
+    COLUMN_STDDEV,
+    COLUMN_P5,
+    COLUMN_P50,
+    COLUMN_P95
+};
+typedef enum datafield_column DATAFIELD_COLUMN;
+
+struct conversion_fixed_coefficients;
+struct datafield_converter;
+struct running_statistics;
+class QuantileSketch;
+
 class DataField
 {
     public:
         DataField(FIELD_TYPE fieldType, uint32_t channelNumber);
-        ~DataField();
+        virtual ~DataField();
 
         void setSize(uint32_t length);
         FIELD_TYPE getType(void);
         char const * getTypeString(void);
         virtual void getConfigString(char * buffer);
 
+        virtual bool isString(void) = 0;
+        virtual bool isNumeric(void) = 0;
+
         uint32_t length(void);
         bool hasData(void);
         void removeOldest(void);
 
         uint32_t getChannelNumber(void);
 
+        void setOverflowPolicy(OVERFLOW_POLICY policy);
+        OVERFLOW_POLICY getOverflowPolicy(void);
+        void getCounters(DATAFIELD_COUNTERS * counters);
+        void resetCounters(void);
+
     protected:
 
         //void incrementIndexes(void);
         void pop(void);
-        void prePush(void);
+        bool prePush(void);
         void postPush(void);
         bool full(void);
 
@@ -41,7 +102,8 @@ class DataField
         uint32_t m_index[2];
         uint32_t m_maxIndex;
         uint32_t m_channelNumber;
-        Averager<int32_t> * m_averager;
+        OVERFLOW_POLICY m_overflowPolicy;
+        DATAFIELD_COUNTERS m_counters;
 };
 
 class NumericDataField : public DataField
@@ -54,13 +116,48 @@ class NumericDataField : public DataField
         ~NumericDataField();
 
         void setDataSizes(uint32_t N, uint32_t averagerN);
+        uint32_t storageSize(uint32_t N);
+        void setStorage(void * storage, uint32_t N, uint32_t averagerN);
+        void setFixedPoint(bool fixedPoint);
+        bool isFixedPoint(void) { return m_fixedPoint; }
+        void setStatistics(bool statistics);
+        bool hasStatistics(void);
+        void setPercentiles(uint8_t compression);
+        bool hasPercentiles(void);
+        uint8_t statisticsColumnCount(void);
+        DATAFIELD_COLUMN statisticsColumn(uint8_t index);
+        void setReducer(REDUCER_TYPE reducer, uint8_t parameter);
+        REDUCER_TYPE getReducer(void) { return m_reducer; }
+        uint8_t getReducerParameter(void) { return m_reducerParameter; }
+        void setSampleDivisor(uint8_t divisor);
+        uint8_t getSampleDivisor(void) { return m_sampleDivisor; }
+        void setDeadband(float absolute, float percent);
+        bool hasDeadband(void);
+        bool outsideDeadband(float average);
+        void setEmitted(float average);
 
         bool storeData(int32_t data);
+        bool storeAverage(float average);
+        bool storeAverage(float average, DATAFIELD_STATISTICS const * stats);
+        bool storeFixedAverage(FIXED average);
+        bool storeFixedAverage(FIXED average, DATAFIELD_STATISTICS const * stats);
+        void addPercentileSample(int32_t sample);
+        void takePercentiles(DATAFIELD_STATISTICS * stats, float average);
+        void discardPercentiles(void);
 
         void setAltConversion(APP_CONVERSION_FN * altConversionFn);
 
         float getRawData(bool alsoRemove);
         float getConvData(bool alsoRemove);
+        float convert(float raw);
+        void convertArray(float const * raw, float * out, uint32_t n);
+        FIXED getRawFixed(bool alsoRemove);
+        FIXED getConvFixed(bool alsoRemove);
+        FIXED convertFixed(FIXED raw);
+        bool getStatistics(DATAFIELD_STATISTICS * stats, bool converted);
+        void convertStatistics(float rawAverage, DATAFIELD_STATISTICS * stats);
+        void convertPercentiles(DATAFIELD_STATISTICS * stats);
+        bool getLatestPercentiles(DATAFIELD_STATISTICS * stats, bool converted);
         void getRawDataAsString(char * buf, char const * const fmt, bool alsoRemove);
         void getConvDataAsString(char * buf, char const * const fmt, bool alsoRemove);
         void getConfigString(char * buffer);
@@ -69,15 +166,53 @@ class NumericDataField : public DataField
         bool isNumeric(void) { return true; }
 
         void * getConversionParams(void) { return m_conversionData; }
+
+    protected:
+        // For TypedNumericDataField, which sets its own conversion data
+        NumericDataField(struct datafield_converter const * converter, FIELD_TYPE type, uint32_t channelNumber);
+        void prepareConversion(void * params);
+        void setConversionParams(void * params);
+
     private:
+        void init(void);
+        void storeStatistics(DATAFIELD_STATISTICS const * stats, float average);
+
         float * m_data;
+        FIXED * m_fixedData;
+        DATAFIELD_STATISTICS * m_stats;
+        float * m_ownedStorage;
+        struct running_statistics * m_runningStats;
+        QuantileSketch * m_sketch;
+        DATAFIELD_STATISTICS m_latestPercentiles;
+        bool m_hasLatestPercentiles;
+        int64_t m_sum;
+        uint32_t m_sampleCount;
+        uint32_t m_averagerSize;
+        bool m_fixedPoint;
+        REDUCER_TYPE m_reducer;
+        uint8_t m_reducerParameter;
+        uint8_t m_sampleDivisor;
+        float m_deadband;
+        float m_deadbandFraction;
+        float m_lastEmitted;
+        bool m_hasEmitted;
+        struct conversion_fixed_coefficients * m_fixedCoefficients;
         void * m_conversionData;
+        struct datafield_converter const * m_converter;
         APP_CONVERSION_FN * m_altConversionFn;
         #ifdef TEST
         void printContents(void);
         #endif
 };
 
+/* A view of a string stored in a StringDataField, without copying it */
+struct string_view
+{
+    char const * data; // NULL-terminated string in the field's storage
+    uint8_t length; // Length, not including terminator
+};
+typedef struct string_view STRING_VIEW;
+
 class StringDataField : public DataField
 {
     public:
@@ -86,18 +221,29 @@ class StringDataField : public DataField
         StringDataField(FIELD_TYPE type, uint8_t len, uint32_t N, uint32_t channelNumber);
         ~StringDataField();
 
-        void storeData(char const * data);
+        uint32_t storageSize(void);
+        void setStorage(void * storage);
+
+        bool storeData(char const * data);
         char * getData(bool alsoRemove);
         void copy(char * buf, bool alsoRemove);
+        bool getView(STRING_VIEW * view, bool alsoRemove);
 
         bool isString(void) { return true; }
         bool isNumeric(void) { return false; }
 
     private:
-        char ** m_data;
+        bool allocate(void);
+        char * slot(uint32_t index);
+
+        char * m_data;
+        bool m_ownsStorage;
         uint8_t m_maxLength;
 };
 
+float DataField_GetStatistic(DATAFIELD_STATISTICS const * stats, DATAFIELD_COLUMN column);
+void DataField_SetStatistic(DATAFIELD_STATISTICS * stats, DATAFIELD_COLUMN column, float value);
+
 /* These functions are in-progress and don't really do the job they say they do quite right.
 uint32_t DataField_writeNumericDataToBuffer(
     char * buffer, NumericDataField datafields[], char const * const format, uint8_t arrayLength, uint8_t bufferLength);
@@ -0,0 +1,222 @@
+/*
+ * DLDataField.Conversion.Benchmark.cpp
+ *
+ * Compares per-value (scalar) conversion with array conversion
+ * for 32 channels x 10000 rows of raw data, and exact thermistor
+ * conversion with lookup table conversion.
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "DLUtility.FixedPoint.h"
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLDataField.Typed.h"
+#include "DLDataField.Conversion.h"
+
+#define CHANNELS 32
+#define ROWS 10000
+#define REPEATS 10
+
+static VOLTAGECHANNEL s_voltageChannelSettings = {
+    .mvPerBit = 0.125f,
+    .offset = 0.0f,
+    .multiplier = 1.0f,
+    .R1 = 200000.0f,
+    .R2 = 10000.0f,
+};
+
+static CURRENTCHANNEL s_currentChannelSettings = {
+    .mvPerBit = 0.125f,
+    .offset = 60.0f,
+    .mvPerAmp = 600.0f,
+};
+
+static THERMISTORCHANNEL s_thermistorChannelSettings = {
+    .R25 = 10000.0f,
+    .B = 4500.0f,
+    .otherR = 10000.0f,
+    .maxADC = 1023.0f,
+    .highside = true,
+    .lutSize = 0,
+    .lut = NULL,
+    .lutMaxError = 0.0f
+};
+
+static THERMISTORCHANNEL s_lutThermistorChannelSettings = {
+    .R25 = 10000.0f,
+    .B = 4500.0f,
+    .otherR = 10000.0f,
+    .maxADC = 1023.0f,
+    .highside = true,
+    .lutSize = 256,
+    .lut = NULL,
+    .lutMaxError = 0.0f
+};
+
+// Data is stored as one column of ROWS values per channel
+static float s_raw[CHANNELS][ROWS];
+static float s_scalarResult[CHANNELS][ROWS];
+static float s_arrayResult[CHANNELS][ROWS];
+
+static NumericDataField * s_fields[CHANNELS];
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static double runScalar(uint8_t firstChannel, uint8_t lastChannel)
+{
+    uint8_t ch;
+    uint32_t row;
+    uint8_t repeat;
+
+    Clock::time_point start = Clock::now();
+    for (repeat = 0; repeat < REPEATS; repeat++)
+    {
+        for (ch = firstChannel; ch <= lastChannel; ch++)
+        {
+            for (row = 0; row < ROWS; row++)
+            {
+                s_scalarResult[ch][row] = s_fields[ch]->convert(s_raw[ch][row]);
+            }
+        }
+    }
+    return elapsedMs(start) / REPEATS;
+}
+
+static double runArray(uint8_t firstChannel, uint8_t lastChannel)
+{
+    uint8_t ch;
+    uint8_t repeat;
+
+    Clock::time_point start = Clock::now();
+    for (repeat = 0; repeat < REPEATS; repeat++)
+    {
+        for (ch = firstChannel; ch <= lastChannel; ch++)
+        {
+            s_fields[ch]->convertArray(s_raw[ch], s_arrayResult[ch], ROWS);
+        }
+    }
+    return elapsedMs(start) / REPEATS;
+}
+
+static float maxDifference(uint8_t firstChannel, uint8_t lastChannel)
+{
+    uint8_t ch;
+    uint32_t row;
+    float maxDiff = 0.0f;
+
+    for (ch = firstChannel; ch <= lastChannel; ch++)
+    {
+        for (row = 0; row < ROWS; row++)
+        {
+            float diff = fabs(s_scalarResult[ch][row] - s_arrayResult[ch][row]);
+            if (diff > maxDiff) { maxDiff = diff; }
+        }
+    }
+    return maxDiff;
+}
+
+static void report(char const * name, uint8_t firstChannel, uint8_t lastChannel)
+{
+    double scalarMs = runScalar(firstChannel, lastChannel);
+    double arrayMs = runArray(firstChannel, lastChannel);
+
+    std::cout << name << " (" << (int)(lastChannel - firstChannel + 1) << " channels x " << ROWS << " rows): ";
+    std::cout << "scalar " << scalarMs << "ms, array " << arrayMs << "ms, ";
+    std::cout << "speedup " << (scalarMs / arrayMs) << "x, ";
+    std::cout << "max difference " << maxDifference(firstChannel, lastChannel) << std::endl;
+}
+
+static void reportThermistorLUT(uint8_t firstChannel, uint8_t lastChannel)
+{
+    uint8_t ch;
+    uint8_t repeat;
+    uint32_t row;
+
+    NumericDataField lutField = NumericDataField(TEMPERATURE_C, &s_lutThermistorChannelSettings, 0);
+
+    double exactMs = runArray(firstChannel, lastChannel);
+
+    Clock::time_point start = Clock::now();
+    for (repeat = 0; repeat < REPEATS; repeat++)
+    {
+        for (ch = firstChannel; ch <= lastChannel; ch++)
+        {
+            lutField.convertArray(s_raw[ch], s_scalarResult[ch], ROWS);
+        }
+    }
+    double lutMs = elapsedMs(start) / REPEATS;
+
+    // Only compare readings in the range the table interpolates
+    float maxDiff = 0.0f;
+    for (ch = firstChannel; ch <= lastChannel; ch++)
+    {
+        for (row = 0; row < ROWS; row++)
+        {
+            if ((s_arrayResult[ch][row] >= -40.0f) && (s_arrayResult[ch][row] <= 125.0f))
+            {
+                float diff = fabs(s_scalarResult[ch][row] - s_arrayResult[ch][row]);
+                if (diff > maxDiff) { maxDiff = diff; }
+            }
+        }
+    }
+
+    std::cout << "Thermistor LUT (" << s_lutThermistorChannelSettings.lutSize << " segments): ";
+    std::cout << "exact " << exactMs << "ms, LUT " << lutMs << "ms, ";
+    std::cout << "speedup " << (exactMs / lutMs) << "x, ";
+    std::cout << "max difference " << maxDiff << " (bound " << s_lutThermistorChannelSettings.lutMaxError << ")" << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+    (void)argc; (void)argv;
+
+    uint8_t ch;
+    uint32_t row;
+
+    // Channels 0-11 are voltages, 12-27 are currents and 28-31 are thermistors
+    for (ch = 0; ch < CHANNELS; ch++)
+    {
+        if (ch < 12)
+        {
+            s_fields[ch] = new TypedNumericDataField<VoltageConversion>(&s_voltageChannelSettings, ch + 1);
+        }
+        else if (ch < 28)
+        {
+            s_fields[ch] = new TypedNumericDataField<CurrentConversion>(&s_currentChannelSettings, ch + 1);
+        }
+        else
+        {
+            s_fields[ch] = new TypedNumericDataField<ThermistorConversion>(&s_thermistorChannelSettings, ch + 1);
+        }
+
+        for (row = 0; row < ROWS; row++)
+        {
+            // Thermistor readings must be in range of the 10-bit internal ADC
+            s_raw[ch][row] = (ch < 28) ? (float)(rand() % 32768) : (float)(1 + (rand() % 1022));
+        }
+    }
+
+    report("Voltage", 0, 11);
+    report("Current", 12, 27);
+    report("Thermistor", 28, 31);
+    report("All", 0, 31);
+    reportThermistorLUT(28, 31);
+
+    return 0;
+}
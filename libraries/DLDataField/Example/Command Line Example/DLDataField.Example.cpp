@@ -1,5 +1,6 @@
 #include <iostream>
 
+#include "DLUtility.FixedPoint.h"
 #include "DLUtility.Averager.h"
 #include "DLDataField.h"
 #include "DLDataField.Manager.h"
@@ -0,0 +1,396 @@
+/*
+ * DLDataField.Aggregator.Test.cpp
+ * 
+ * Tests the DataField aggregator class
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include <iostream>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.FixedPoint.h"
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLDataField.Manager.h"
+#include "DLDataField.Aggregator.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+static DataFieldAggregator * s_aggregator;
+static DataFieldManager * s_shortManager;
+static DataFieldManager * s_longManager;
+
+static void addFields(DataFieldManager * manager)
+{
+    manager->addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    manager->addField( new NumericDataField(VOLTAGE, NULL, 3) );
+}
+
+void setUp(void)
+{
+    // 2 samples per period, short window of 1 period, long window of 3 periods
+    s_aggregator = new DataFieldAggregator(2);
+    s_shortManager = new DataFieldManager(10, 1);
+    s_longManager = new DataFieldManager(10, 1);
+    addFields(s_shortManager);
+    addFields(s_longManager);
+}
+
+void tearDown(void)
+{
+    delete s_aggregator;
+}
+
+static void test_windowsCanBeAdded(void)
+{
+    TEST_ASSERT_TRUE(s_aggregator->addWindow(s_shortManager, 1));
+    TEST_ASSERT_TRUE(s_aggregator->addWindow(s_longManager, 3));
+    TEST_ASSERT_EQUAL(2, s_aggregator->windowCount());
+    TEST_ASSERT_EQUAL(2, s_aggregator->fieldCount());
+}
+
+static void test_windowWithMismatchedFieldsIsRejected(void)
+{
+    DataFieldManager * other = new DataFieldManager(10, 1);
+    other->addField( new NumericDataField(VOLTAGE, NULL, 1) );
+
+    TEST_ASSERT_TRUE(s_aggregator->addWindow(s_shortManager, 1));
+    TEST_ASSERT_FALSE(s_aggregator->addWindow(other, 1));
+    TEST_ASSERT_FALSE(s_aggregator->addWindow(s_longManager, 0));
+
+    // Same number of fields, but on different channels
+    other->addField( new NumericDataField(VOLTAGE, NULL, 2) );
+    TEST_ASSERT_FALSE(s_aggregator->addWindow(other, 1));
+
+    TEST_ASSERT_EQUAL(1, s_aggregator->windowCount());
+}
+
+static void test_windowsReceiveCorrectAverages(void)
+{
+    s_aggregator->addWindow(s_shortManager, 1);
+    s_aggregator->addWindow(s_longManager, 3);
+
+    // Channel 1 gets 1 to 6, channel 3 gets -10 to -60
+    int32_t scans[][3] = {
+        {1, 0, -10}, {2, 0, -20}, {3, 0, -30}, {4, 0, -40}, {5, 0, -50}, {6, 0, -60}
+    };
+
+    float actual[2];
+
+    uint8_t i;
+    for (i = 0; i < 6; i++)
+    {
+        s_aggregator->storeDataArray(scans[i]);
+    }
+
+    // Short window produces one average every two samples
+    TEST_ASSERT_EQUAL(3, s_shortManager->count());
+    s_shortManager->getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-15.0f, actual[1]);
+    s_shortManager->getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(3.5f, actual[0]);
+    s_shortManager->getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(5.5f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-55.0f, actual[1]);
+
+    // Long window produces one average every six samples
+    TEST_ASSERT_EQUAL(1, s_longManager->count());
+    s_longManager->getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(3.5f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-35.0f, actual[1]);
+}
+
+static void test_noAveragesUntilPeriodCloses(void)
+{
+    s_aggregator->addWindow(s_shortManager, 1);
+
+    int32_t scan[] = {100, 0, 100};
+    s_aggregator->storeDataArray(scan);
+    TEST_ASSERT_FALSE(s_shortManager->hasData());
+
+    s_aggregator->storeDataArray(scan);
+    TEST_ASSERT_TRUE(s_shortManager->hasData());
+}
+
+static void test_fixedPointWindowReceivesFixedAverages(void)
+{
+    DataFieldManager * fixedManager = new DataFieldManager(10, 1);
+    fixedManager->setFixedPoint(true);
+    addFields(fixedManager);
+
+    s_aggregator->addWindow(s_shortManager, 1);
+    s_aggregator->addWindow(fixedManager, 1);
+
+    int32_t scans[][3] = {{1, 0, -10}, {2, 0, -21}};
+    FIXED actual[2];
+
+    s_aggregator->storeDataArray(scans[0]);
+    s_aggregator->storeDataArray(scans[1]);
+
+    TEST_ASSERT_EQUAL(1, fixedManager->count());
+    fixedManager->getFixedDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL(FIXED_FromFloat(1.5f), actual[0]);
+    TEST_ASSERT_EQUAL(FIXED_FromFloat(-15.5f), actual[1]);
+}
+
+static void test_windowStatisticsCoverAllPeriods(void)
+{
+    DataFieldManager * statsManager = new DataFieldManager(10, 1);
+    NumericDataField * withStatistics = new NumericDataField(VOLTAGE, NULL, 1);
+    withStatistics->setStatistics(true);
+    statsManager->addField(withStatistics);
+    statsManager->addField( new NumericDataField(VOLTAGE, NULL, 3) );
+
+    s_aggregator->addWindow(s_shortManager, 1);
+    s_aggregator->addWindow(statsManager, 3);
+
+    // Channel 1 gets 1, 2, 3, 10, 4, 4 over three periods
+    int32_t scans[][3] = {{1, 0, 0}, {2, 0, 0}, {3, 0, 0}, {10, 0, 0}, {4, 0, 0}, {4, 0, 0}};
+
+    uint8_t i;
+    for (i = 0; i < 6; i++)
+    {
+        s_aggregator->storeDataArray(scans[i]);
+    }
+
+    // Mean is 4, standard deviation is sqrt((9 + 4 + 1 + 36 + 0 + 0) / 6)
+    float actual[5];
+    TEST_ASSERT_EQUAL(5, statsManager->columnCount());
+    TEST_ASSERT_EQUAL(1, statsManager->getDataRows(actual, 1, false, true, NULL));
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, actual[1]);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, actual[2]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, sqrtf(50.0f / 6.0f), actual[3]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, actual[4]);
+
+    // The window without statistics is unchanged
+    TEST_ASSERT_EQUAL(2, s_shortManager->columnCount());
+    TEST_ASSERT_EQUAL(3, s_shortManager->count());
+}
+
+static void test_windowReducerReplacesMean(void)
+{
+    DataFieldManager * medianManager = new DataFieldManager(10, 1);
+    NumericDataField * median = new NumericDataField(VOLTAGE, NULL, 1);
+    median->setReducer(REDUCER_MEDIAN, 0);
+    medianManager->addField(median);
+    medianManager->addField( new NumericDataField(VOLTAGE, NULL, 3) );
+
+    s_aggregator->addWindow(s_shortManager, 1);
+    s_aggregator->addWindow(medianManager, 3);
+
+    // Channel 1 has a glitch in the second window, which the median ignores
+    int32_t scans[][3] = {
+        {5, 0, 1}, {6, 0, 2}, {5, 0, 3}, {7, 0, 4}, {6, 0, 5}, {5, 0, 6},
+        {5, 0, 1}, {32767, 0, 1}, {5, 0, 1}, {6, 0, 1}, {6, 0, 1}, {6, 0, 1}
+    };
+
+    float actual[2];
+
+    uint8_t i;
+    for (i = 0; i < 12; i++)
+    {
+        s_aggregator->storeDataArray(scans[i]);
+    }
+
+    TEST_ASSERT_EQUAL(2, medianManager->count());
+    medianManager->getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(5.5f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(3.5f, actual[1]); // Other fields still use the mean
+    medianManager->getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(6.0f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, actual[1]);
+
+    // The short window still uses the mean for channel 1
+    s_shortManager->getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(5.5f, actual[0]);
+}
+
+static void test_windowPercentilesCoverAllSamples(void)
+{
+    DataFieldManager * percentileManager = new DataFieldManager(10, 1);
+    NumericDataField * withPercentiles = new NumericDataField(VOLTAGE, NULL, 1);
+    withPercentiles->setPercentiles(20);
+    percentileManager->addField(withPercentiles);
+    percentileManager->addField( new NumericDataField(VOLTAGE, NULL, 3) );
+
+    s_aggregator->addWindow(s_shortManager, 1);
+    s_aggregator->addWindow(percentileManager, 5);
+
+    // Channel 1 gets 1 to 10 over five periods
+    int32_t scan[3] = {0, 0, 0};
+    uint8_t i;
+    for (i = 1; i <= 10; i++)
+    {
+        scan[0] = i;
+        s_aggregator->storeDataArray(scan);
+    }
+
+    float actual[5];
+    TEST_ASSERT_EQUAL(5, percentileManager->columnCount());
+    TEST_ASSERT_EQUAL(1, percentileManager->getDataRows(actual, 1, false, true, NULL));
+    TEST_ASSERT_EQUAL_FLOAT(5.5f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, actual[1]);
+    TEST_ASSERT_EQUAL_FLOAT(5.5f, actual[2]);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, actual[3]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, actual[4]);
+}
+
+static uint32_t s_clockSeconds;
+
+static void fakeClock(DATAFIELD_TIMESTAMP * timestamp)
+{
+    timestamp->seconds = s_clockSeconds;
+    timestamp->millis = 0;
+}
+
+/* Store one base period of samples (each equal to the clock time at the end of the period) */
+static void storePeriodEndingAt(uint32_t seconds)
+{
+    int32_t data[] = {(int32_t)seconds, 0, (int32_t)seconds};
+    s_clockSeconds = seconds;
+    s_aggregator->storeDataArray(data);
+    s_aggregator->storeDataArray(data);
+}
+
+static void test_alignedWindowsCloseOnClockBoundaries(void)
+{
+    float averages[2];
+    DATAFIELD_TIMESTAMP timestamp;
+    uint32_t t;
+
+    s_longManager->setClock(fakeClock);
+    s_aggregator->addWindow(s_longManager, 5);
+    s_aggregator->alignToClock(fakeClock);
+
+    // Starting at 1003, the first window is only two periods long (closing at 1005)
+    storePeriodEndingAt(1004);
+    TEST_ASSERT_FALSE(s_longManager->hasData());
+    storePeriodEndingAt(1005);
+    TEST_ASSERT_EQUAL(1, s_longManager->count());
+
+    for (t = 1006; t <= 1010; t++) { storePeriodEndingAt(t); }
+    TEST_ASSERT_EQUAL(2, s_longManager->count());
+
+    // A late period skips over the next boundary, so that window closes late and short
+    storePeriodEndingAt(1012);
+    storePeriodEndingAt(1016);
+    TEST_ASSERT_EQUAL(3, s_longManager->count());
+
+    TEST_ASSERT_TRUE(s_longManager->getTimestamp(0, &timestamp));
+    TEST_ASSERT_EQUAL(1005, timestamp.seconds);
+    TEST_ASSERT_EQUAL(DATAFIELD_ROW_PARTIAL, timestamp.flags);
+    s_longManager->getDataArray(averages, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(1004.5f, averages[0]);
+
+    TEST_ASSERT_TRUE(s_longManager->getTimestamp(0, &timestamp));
+    TEST_ASSERT_EQUAL(1010, timestamp.seconds);
+    TEST_ASSERT_EQUAL(0, timestamp.flags);
+    s_longManager->getDataArray(averages, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(1008.0f, averages[1]);
+
+    TEST_ASSERT_TRUE(s_longManager->getTimestamp(0, &timestamp));
+    TEST_ASSERT_EQUAL(1016, timestamp.seconds);
+    TEST_ASSERT_EQUAL(DATAFIELD_ROW_PARTIAL, timestamp.flags);
+}
+
+static void addDividedFields(DataFieldManager * manager)
+{
+    NumericDataField * slow = new NumericDataField(VOLTAGE, NULL, 3);
+    slow->setSampleDivisor(2);
+
+    manager->addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    TEST_ASSERT_TRUE(manager->addField(slow));
+}
+
+static void test_dividedFieldsOnlyAverageTheirOwnScans(void)
+{
+    DataFieldManager * shortManager = new DataFieldManager(10, 2);
+    DataFieldManager * longManager = new DataFieldManager(10, 6);
+    float actual[2];
+
+    addDividedFields(shortManager);
+    addDividedFields(longManager);
+    TEST_ASSERT_TRUE(s_aggregator->addWindow(shortManager, 1));
+    TEST_ASSERT_TRUE(s_aggregator->addWindow(longManager, 3));
+
+    // Channel 3 is only read on every second scan: the other scans have values that should be ignored
+    int32_t scans[][3] = {
+        {1, 0, 999}, {2, 0, -20}, {3, 0, 999}, {4, 0, -40}, {5, 0, 999}, {6, 0, -60}
+    };
+
+    TEST_ASSERT_TRUE(s_aggregator->sampleIsDue(1));
+    TEST_ASSERT_FALSE(s_aggregator->sampleIsDue(2));
+
+    uint8_t i;
+    for (i = 0; i < 6; i++)
+    {
+        TEST_ASSERT_EQUAL(scans[i][2] != 999, s_aggregator->sampleIsDue(2));
+        s_aggregator->storeDataArray(scans[i]);
+    }
+
+    TEST_ASSERT_EQUAL(3, shortManager->count());
+    shortManager->getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-20.0f, actual[1]);
+
+    longManager->getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(3.5f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-40.0f, actual[1]);
+}
+
+static void test_divisorMustDivideSamplesPerPeriod(void)
+{
+    DataFieldManager * manager = new DataFieldManager(10, 3);
+    NumericDataField * field = new NumericDataField(VOLTAGE, NULL, 1);
+    field->setSampleDivisor(3);
+    manager->addField(field);
+
+    TEST_ASSERT_FALSE(s_aggregator->addWindow(manager, 1));
+
+    // Other consumers must have the same divisors as the first
+    TEST_ASSERT_TRUE(s_aggregator->addWindow(s_shortManager, 1));
+    manager = new DataFieldManager(10, 2);
+    addDividedFields(manager);
+    TEST_ASSERT_FALSE(s_aggregator->addWindow(manager, 1));
+}
+
+int main(void)
+{
+    UnityBegin("DLDataField.Aggregator.Test.cpp");
+
+    RUN_TEST(test_windowsCanBeAdded);
+    RUN_TEST(test_windowWithMismatchedFieldsIsRejected);
+    RUN_TEST(test_windowsReceiveCorrectAverages);
+    RUN_TEST(test_noAveragesUntilPeriodCloses);
+    RUN_TEST(test_fixedPointWindowReceivesFixedAverages);
+    RUN_TEST(test_windowStatisticsCoverAllPeriods);
+    RUN_TEST(test_windowReducerReplacesMean);
+    RUN_TEST(test_windowPercentilesCoverAllSamples);
+    RUN_TEST(test_alignedWindowsCloseOnClockBoundaries);
+    RUN_TEST(test_dividedFieldsOnlyAverageTheirOwnScans);
+    RUN_TEST(test_divisorMustDivideSamplesPerPeriod);
+
+    UnityEnd();
+    return 0;
+}
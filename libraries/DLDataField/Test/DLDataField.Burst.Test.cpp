@@ -0,0 +1,213 @@
+/*
+ * DLDataField.Burst.Test.cpp
+ *
+ * Tests the burst capture class
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.FixedPoint.h"
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLDataField.Manager.h"
+#include "DLDataField.Burst.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+static BurstCapture * s_burst;
+
+static uint32_t s_clockSeconds;
+
+static void testClock(DATAFIELD_TIMESTAMP * timestamp)
+{
+    timestamp->seconds = s_clockSeconds;
+    timestamp->millis = 250;
+}
+
+// Store a scan with channel 1 = value and channel 3 = value * 10 (channel 2 is not captured)
+static void storeScan(int32_t value)
+{
+    int32_t data[3] = {value, -1, value * 10};
+    s_burst->storeDataArray(data);
+}
+
+void setUp(void)
+{
+    // 3 scans before the trigger, 2 from the trigger onwards
+    s_burst = new BurstCapture(3, 2);
+    s_clockSeconds = 1000;
+}
+
+void tearDown(void)
+{
+    delete s_burst;
+}
+
+static void test_channelsCannotBeAddedAfterAllocation(void)
+{
+    TEST_ASSERT_FALSE(s_burst->allocate());
+    TEST_ASSERT_TRUE(s_burst->addChannel(1, TRIGGER_ABOVE, 100));
+    TEST_ASSERT_FALSE(s_burst->addChannel(0, TRIGGER_NONE, 0));
+    TEST_ASSERT_FALSE(s_burst->addChannel(2, INVALID_TRIGGER, 0));
+    TEST_ASSERT_TRUE(s_burst->allocate());
+    TEST_ASSERT_FALSE(s_burst->addChannel(3, TRIGGER_NONE, 0));
+    TEST_ASSERT_EQUAL(1, s_burst->channelCount());
+    TEST_ASSERT_TRUE(s_burst->hasTriggers());
+}
+
+static void test_burstHoldsPreAndPostTriggerSamples(void)
+{
+    int32_t values[2];
+    uint16_t i;
+
+    s_burst->addChannel(1, TRIGGER_ABOVE, 100);
+    s_burst->addChannel(3, TRIGGER_NONE, 0);
+    s_burst->setClock(testClock);
+    s_burst->allocate();
+
+    for (i = 1; i <= 6; i++) { storeScan(i); }
+    TEST_ASSERT_EQUAL(BURST_IDLE, s_burst->state());
+
+    s_clockSeconds = 1006;
+    storeScan(200);
+    TEST_ASSERT_EQUAL(BURST_CAPTURING, s_burst->state());
+    TEST_ASSERT_FALSE(s_burst->getScan(0, values));
+
+    s_clockSeconds = 1007;
+    storeScan(7);
+    TEST_ASSERT_TRUE(s_burst->ready());
+
+    // Later scans do not change the frozen burst
+    storeScan(8);
+
+    TEST_ASSERT_EQUAL(1, s_burst->triggerChannel());
+    TEST_ASSERT_EQUAL(5, s_burst->sampleCount());
+    TEST_ASSERT_EQUAL(3, s_burst->triggerIndex());
+
+    int32_t expected[] = {4, 5, 6, 200, 7};
+    for (i = 0; i < 5; i++)
+    {
+        TEST_ASSERT_TRUE(s_burst->getScan(i, values));
+        TEST_ASSERT_EQUAL(expected[i], values[0]);
+        TEST_ASSERT_EQUAL(expected[i] * 10, values[1]);
+    }
+    TEST_ASSERT_FALSE(s_burst->getScan(5, values));
+
+    DATAFIELD_TIMESTAMP timestamp;
+    TEST_ASSERT_TRUE(s_burst->getTriggerTime(&timestamp));
+    TEST_ASSERT_EQUAL(1006, timestamp.seconds);
+    TEST_ASSERT_EQUAL(250, timestamp.millis);
+}
+
+static void test_earlyTriggerHasShortPreTriggerHistory(void)
+{
+    int32_t values[1];
+
+    s_burst->addChannel(1, TRIGGER_BELOW, 0);
+    s_burst->allocate();
+
+    storeScan(5);
+    storeScan(-5);
+    storeScan(6);
+
+    TEST_ASSERT_TRUE(s_burst->ready());
+    TEST_ASSERT_EQUAL(3, s_burst->sampleCount());
+    TEST_ASSERT_EQUAL(1, s_burst->triggerIndex());
+    TEST_ASSERT_FALSE(s_burst->getTriggerTime(NULL));
+
+    s_burst->getScan(0, values);
+    TEST_ASSERT_EQUAL(5, values[0]);
+    s_burst->getScan(1, values);
+    TEST_ASSERT_EQUAL(-5, values[0]);
+}
+
+static void test_rateTriggerFiresOnLargeChanges(void)
+{
+    s_burst->addChannel(3, TRIGGER_RATE, 50);
+    s_burst->allocate();
+
+    // First sample has nothing to compare to, then changes of 40 and -40 are within the limit
+    storeScan(100);
+    storeScan(104);
+    storeScan(100);
+    TEST_ASSERT_EQUAL(BURST_IDLE, s_burst->state());
+
+    storeScan(94);
+    TEST_ASSERT_EQUAL(BURST_CAPTURING, s_burst->state());
+
+    storeScan(94);
+    TEST_ASSERT_EQUAL(3, s_burst->triggerChannel());
+}
+
+static void test_levelTriggersAreEdgeSensitive(void)
+{
+    s_burst->addChannel(1, TRIGGER_ABOVE, 100);
+    s_burst->allocate();
+
+    storeScan(200);
+    storeScan(200);
+    TEST_ASSERT_TRUE(s_burst->ready());
+
+    // Still above the threshold after release, so no new trigger until it drops below and rises again
+    s_burst->release();
+    storeScan(200);
+    storeScan(200);
+    TEST_ASSERT_EQUAL(BURST_IDLE, s_burst->state());
+
+    storeScan(50);
+    storeScan(200);
+    TEST_ASSERT_EQUAL(BURST_CAPTURING, s_burst->state());
+    TEST_ASSERT_EQUAL(0, s_burst->missedTriggers());
+}
+
+static void test_triggersWhileReadyAreCounted(void)
+{
+    s_burst->addChannel(1, TRIGGER_ABOVE, 100);
+    s_burst->allocate();
+
+    storeScan(200);
+    storeScan(50);
+    TEST_ASSERT_TRUE(s_burst->ready());
+
+    storeScan(200);
+    storeScan(50);
+    storeScan(200);
+    TEST_ASSERT_EQUAL(2, s_burst->missedTriggers());
+    TEST_ASSERT_TRUE(s_burst->ready());
+    TEST_ASSERT_EQUAL(0, s_burst->triggerIndex());
+}
+
+int main(void)
+{
+    UnityBegin("DLDataField.Burst.Test.cpp");
+
+    RUN_TEST(test_channelsCannotBeAddedAfterAllocation);
+    RUN_TEST(test_burstHoldsPreAndPostTriggerSamples);
+    RUN_TEST(test_earlyTriggerHasShortPreTriggerHistory);
+    RUN_TEST(test_rateTriggerFiresOnLargeChanges);
+    RUN_TEST(test_levelTriggersAreEdgeSensitive);
+    RUN_TEST(test_triggersWhileReadyAreCounted);
+
+    UnityEnd();
+    return 0;
+}
@@ -0,0 +1,17 @@
+SRC_FILES += DLDataField/DLDataField.Manager.cpp DLDataField/DLDataField.cpp DLDataField/DLDataField.String.cpp
+SRC_FILES += DLDataField/DLDataField.Numeric.cpp DLDataField/DLDataField.Conversion.cpp
+SRC_FILES += DLUtility/DLUtility.ArrayFunctions.cpp DLUtility/DLUtility.Strings.cpp
+SRC_FILES += DLUtility/DLUtility.Averager.cpp DLUtility/DLUtility.PD.cpp DLUtility/DLUtility.FixedPoint.cpp DLUtility/DLUtility.Statistics.cpp DLUtility/DLUtility.Quantiles.cpp DLUtility/DLUtility.Reducers.cpp
+
+SRC_FILES += DLSensor/DLSensor.Thermistor.cpp
+
+SRC_FILES += DLSettings/DLSettings.DataChannels.cpp DLSettings/DLSettings.DataChannels.Helper.cpp
+SRC_FILES += DLSettings/DLSettings.Reader.Errors.cpp
+
+SRC_FILES += DLPlatform/DLPlatform.cpp
+
+INC_DIRS += -IDLUtility -IDLSettings -IDLSensor -IDLSettings -IDLPlatform
+
+local_setup: ;
+
+local_teardown: ;
\ No newline at end of file
@@ -0,0 +1,599 @@
+/*
+ * DLDataField.ColumnarManager.Test.cpp
+ * 
+ * Tests the columnar DataField manager class
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.FixedPoint.h"
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLDataField.Manager.h"
+#include "DLDataField.ColumnarManager.h"
+#include "DLDataField.Aggregator.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+static ColumnarDataFieldManager * s_manager;
+
+static CURRENTCHANNEL s_currentChannelSettings = {
+    .mvPerBit = 0.125f,
+    .offset = 60.0f,
+    .mvPerAmp = 600.0f,
+};
+
+static VOLTAGECHANNEL s_voltageChannelSettings = {
+    .mvPerBit = 0.125f,
+    .offset = 0.0f,
+    .multiplier = 1.0f,
+    .R1 = 200000.0f,
+    .R2 = 10000.0f,
+};
+
+void setUp(void)
+{
+    // Three rows, averaging two samples each
+    s_manager = new ColumnarDataFieldManager(3, 2);
+    s_manager->addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    s_manager->addField( new NumericDataField(VOLTAGE, NULL, 3) );
+}
+
+void tearDown(void)
+{
+    delete s_manager;
+}
+
+static void test_stringFieldsCannotBeAdded(void)
+{
+    TEST_ASSERT_FALSE(s_manager->addField( new StringDataField(CARDINAL_DIRECTION, 3, 1, 0) ));
+    TEST_ASSERT_EQUAL(2, s_manager->fieldCount());
+}
+
+static void test_fieldsCannotBeAddedAfterDataIsStored(void)
+{
+    float row[] = {1.0f, 2.0f};
+    s_manager->storeAverageArray(row);
+    TEST_ASSERT_FALSE(s_manager->addField( new NumericDataField(VOLTAGE, NULL, 4) ));
+}
+
+static void test_bytesUsedIncludesSumsAndRows(void)
+{
+    TEST_ASSERT_EQUAL(0, s_manager->bytesUsed());
+    TEST_ASSERT_TRUE(s_manager->allocate());
+
+    // Two int64_t sums, then three rows of two values
+    TEST_ASSERT_EQUAL((2 * sizeof(int64_t)) + (3 * 2 * sizeof(float)), s_manager->bytesUsed());
+}
+
+static void test_storeDataArrayAveragesIntoRows(void)
+{
+    int32_t scan1[] = {10, 0, -10};
+    int32_t scan2[] = {20, 0, -30};
+    float actual[2];
+
+    s_manager->storeDataArray(scan1);
+    TEST_ASSERT_FALSE(s_manager->hasData());
+
+    s_manager->storeDataArray(scan2);
+    TEST_ASSERT_TRUE(s_manager->hasData());
+    TEST_ASSERT_EQUAL(1, s_manager->count());
+
+    s_manager->getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(15.0f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-20.0f, actual[1]);
+    TEST_ASSERT_FALSE(s_manager->hasData());
+}
+
+static void test_dividedFieldsAverageOnlyTheirOwnScans(void)
+{
+    ColumnarDataFieldManager manager(3, 4);
+    NumericDataField * slow = new NumericDataField(VOLTAGE, NULL, 3);
+    int32_t scans[][3] = {{1, 0, 999}, {2, 0, -10}, {3, 0, 999}, {4, 0, -30}};
+    float actual[2];
+
+    slow->setSampleDivisor(2);
+    manager.addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    TEST_ASSERT_TRUE(manager.addField(slow));
+
+    uint8_t i;
+    for (i = 0; i < 4; i++) { manager.storeDataArray(scans[i]); }
+
+    TEST_ASSERT_EQUAL(1, manager.count());
+    manager.getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-20.0f, actual[1]);
+}
+
+static void test_rowsAreContiguousAndOldestIsDroppedWhenFull(void)
+{
+    float rows[][2] = {{1.0f, 2.0f}, {3.0f, 4.0f}, {5.0f, 6.0f}, {7.0f, 8.0f}};
+
+    uint8_t i;
+    for (i = 0; i < 4; i++)
+    {
+        s_manager->storeAverageArray(rows[i]);
+    }
+
+    TEST_ASSERT_EQUAL(3, s_manager->count());
+
+    for (i = 1; i < 4; i++)
+    {
+        float * row = s_manager->peekRow();
+        TEST_ASSERT_NOT_NULL(row);
+        TEST_ASSERT_EQUAL_FLOAT(rows[i][0], row[0]);
+        TEST_ASSERT_EQUAL_FLOAT(rows[i][1], row[1]);
+        s_manager->removeRow();
+    }
+
+    TEST_ASSERT_NULL(s_manager->peekRow());
+    TEST_ASSERT_EQUAL(0, s_manager->count());
+}
+
+static void test_getDataArrayConvertsData(void)
+{
+    ColumnarDataFieldManager manager = ColumnarDataFieldManager(1, 1);
+    manager.addField( new NumericDataField(CURRENT, &s_currentChannelSettings, 1) );
+
+    float raw = 4800.0f; // 600mV, 1A
+    float actual;
+    manager.storeAverageArray(&raw);
+
+    manager.getDataArray(&actual, true, false);
+    TEST_ASSERT_EQUAL_FLOAT(0.9f, actual);
+    manager.getDataArray(&actual, false, false);
+    TEST_ASSERT_EQUAL_FLOAT(4800.0f, actual);
+}
+
+static void test_aggregatorCanFeedColumnarManager(void)
+{
+    DataFieldAggregator aggregator = DataFieldAggregator(2);
+    TEST_ASSERT_TRUE(aggregator.addWindow(s_manager, 1));
+
+    int32_t scan1[] = {1, 0, 2};
+    int32_t scan2[] = {3, 0, 4};
+    aggregator.storeDataArray(scan1);
+    aggregator.storeDataArray(scan2);
+
+    float * row = s_manager->peekRow();
+    TEST_ASSERT_NOT_NULL(row);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, row[0]);
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, row[1]);
+}
+
+static void test_getDataRowsCopiesWrappedRowsWithIndexes(void)
+{
+    float rows[][2] = {{1.0f, 2.0f}, {3.0f, 4.0f}, {5.0f, 6.0f}, {7.0f, 8.0f}};
+    float actual[3][2];
+    uint32_t indexes[3];
+
+    uint8_t i;
+    for (i = 0; i < 4; i++)
+    {
+        s_manager->storeAverageArray(rows[i]);
+    }
+
+    // First row was dropped, so the rows returned have indexes 1 to 3 and wrap around the block
+    TEST_ASSERT_EQUAL(2, s_manager->getDataRows(&actual[0][0], 2, false, false, indexes));
+    TEST_ASSERT_EQUAL(3, s_manager->count());
+
+    TEST_ASSERT_EQUAL(3, s_manager->getDataRows(&actual[0][0], 5, false, true, indexes));
+    TEST_ASSERT_EQUAL(0, s_manager->count());
+
+    for (i = 0; i < 3; i++)
+    {
+        TEST_ASSERT_EQUAL(i + 1, indexes[i]);
+        TEST_ASSERT_EQUAL_FLOAT(rows[i + 1][0], actual[i][0]);
+        TEST_ASSERT_EQUAL_FLOAT(rows[i + 1][1], actual[i][1]);
+    }
+
+    TEST_ASSERT_EQUAL(0, s_manager->getDataRows(&actual[0][0], 3, false, true, NULL));
+}
+
+static void test_fixedPointCannotBeChangedAfterFieldsAreAdded(void)
+{
+    TEST_ASSERT_FALSE(s_manager->setFixedPoint(true));
+    TEST_ASSERT_FALSE(s_manager->isFixedPoint());
+
+    ColumnarDataFieldManager manager = ColumnarDataFieldManager(1, 1);
+    TEST_ASSERT_TRUE(manager.setFixedPoint(true));
+    TEST_ASSERT_TRUE(manager.isFixedPoint());
+}
+
+static void test_fixedPointResultsMatchFloatingPoint(void)
+{
+    ColumnarDataFieldManager floatManager = ColumnarDataFieldManager(4, 3);
+    ColumnarDataFieldManager fixedManager = ColumnarDataFieldManager(4, 3);
+    fixedManager.setFixedPoint(true);
+
+    ColumnarDataFieldManager * managers[] = {&floatManager, &fixedManager};
+
+    uint8_t i;
+    for (i = 0; i < 2; i++)
+    {
+        managers[i]->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+        managers[i]->addField( new NumericDataField(CURRENT, &s_currentChannelSettings, 2) );
+    }
+
+    // Four rows of three scans each, some averages with a fractional part
+    int32_t scans[12][3] = {
+        {0, 1000, 4800}, {0, 1001, 4801}, {0, 1001, 4803},
+        {0, 2047, -4800}, {0, 2046, -4801}, {0, 2047, -4800},
+        {0, 32767, 0}, {0, 32766, 1}, {0, 32765, 1},
+        {0, -5, 12345}, {0, -4, 12346}, {0, -4, 12345},
+    };
+
+    for (i = 0; i < 12; i++)
+    {
+        floatManager.storeDataArray(scans[i]);
+        fixedManager.storeDataArray(scans[i]);
+    }
+
+    float floatRows[4][2];
+    float fixedRows[4][2];
+    FIXED fixedValues[4][2];
+
+    TEST_ASSERT_EQUAL(4, fixedManager.getFixedDataRows(&fixedValues[0][0], 4, true, false, NULL));
+    TEST_ASSERT_EQUAL(4, floatManager.getDataRows(&floatRows[0][0], 4, true, true, NULL));
+    TEST_ASSERT_EQUAL(4, fixedManager.getDataRows(&fixedRows[0][0], 4, true, true, NULL));
+
+    for (i = 0; i < 4; i++)
+    {
+        // Conversion with the fixed point coefficients is accurate to a few LSBs of the Q16.16 result
+        TEST_ASSERT_FLOAT_WITHIN(0.0005f, floatRows[i][0], fixedRows[i][0]);
+        TEST_ASSERT_FLOAT_WITHIN(0.0005f, floatRows[i][1], fixedRows[i][1]);
+        TEST_ASSERT_EQUAL_FLOAT(fixedRows[i][0], FIXED_ToFloat(fixedValues[i][0]));
+        TEST_ASSERT_EQUAL_FLOAT(fixedRows[i][1], FIXED_ToFloat(fixedValues[i][1]));
+    }
+}
+
+static void test_dropNewestPolicyKeepsOldestRows(void)
+{
+    float rows[][2] = {{1.0f, 2.0f}, {3.0f, 4.0f}, {5.0f, 6.0f}, {7.0f, 8.0f}};
+    DATAFIELD_COUNTERS counters;
+
+    s_manager->setOverflowPolicy(OVERFLOW_DROP_NEWEST, NULL);
+
+    uint8_t i;
+    for (i = 0; i < 4; i++)
+    {
+        s_manager->storeAverageArray(rows[i]);
+    }
+
+    TEST_ASSERT_EQUAL(3, s_manager->count());
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, s_manager->peekRow()[0]);
+
+    s_manager->removeRow();
+    TEST_ASSERT_TRUE(s_manager->getCounters(1, &counters));
+    TEST_ASSERT_EQUAL(3, counters.pushes);
+    TEST_ASSERT_EQUAL(1, counters.pops);
+    TEST_ASSERT_EQUAL(1, counters.drops);
+    TEST_ASSERT_FALSE(s_manager->getCounters(2, &counters));
+}
+
+static uint32_t s_spilledRows;
+static float s_spilled[2];
+
+static void spillOneRow(DataFieldManager * pManager)
+{
+    s_spilledRows += pManager->getDataRows(s_spilled, 1, false, true, NULL);
+}
+
+static void test_spillPolicyPassesOldestRowsToSpillFunction(void)
+{
+    float rows[][2] = {{1.0f, 2.0f}, {3.0f, 4.0f}, {5.0f, 6.0f}, {7.0f, 8.0f}, {9.0f, 10.0f}};
+    DATAFIELD_COUNTERS counters;
+
+    s_spilledRows = 0;
+    s_manager->setOverflowPolicy(OVERFLOW_SPILL, spillOneRow);
+
+    uint8_t i;
+    for (i = 0; i < 5; i++)
+    {
+        s_manager->storeAverageArray(rows[i]);
+    }
+
+    // Rows 0 and 1 were spilled, nothing was dropped
+    TEST_ASSERT_EQUAL(2, s_spilledRows);
+    TEST_ASSERT_EQUAL(2, s_manager->spillCount());
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, s_spilled[0]);
+    TEST_ASSERT_EQUAL(3, s_manager->count());
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, s_manager->peekRow()[0]);
+
+    s_manager->getCounters(0, &counters);
+    TEST_ASSERT_EQUAL(5, counters.pushes);
+    TEST_ASSERT_EQUAL(2, counters.pops);
+    TEST_ASSERT_EQUAL(0, counters.drops);
+}
+
+static void test_statisticsAreStoredInRows(void)
+{
+    ColumnarDataFieldManager manager = ColumnarDataFieldManager(3, 4);
+    NumericDataField * withStatistics = new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1);
+    withStatistics->setStatistics(true);
+    manager.addField(withStatistics);
+    manager.addField( new NumericDataField(VOLTAGE, NULL, 2) );
+
+    TEST_ASSERT_EQUAL(5, manager.columnCount());
+
+    int32_t scans[][2] = {{1, 5}, {2, 5}, {3, 5}, {10, 5}};
+    uint8_t i;
+    for (i = 0; i < 4; i++) { manager.storeDataArray(scans[i]); }
+
+    float * row = manager.peekRow();
+    TEST_ASSERT_NOT_NULL(row);
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, row[0]);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, row[1]);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, row[2]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, 3.535534f, row[3]);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, row[4]);
+
+    // Converted rows convert the statistics with the field
+    float converted[5];
+    TEST_ASSERT_EQUAL(1, manager.getDataRows(converted, 1, true, false, NULL));
+    TEST_ASSERT_EQUAL_FLOAT(withStatistics->convert(4.0f), converted[0]);
+    TEST_ASSERT_EQUAL_FLOAT(withStatistics->convert(1.0f), converted[1]);
+    TEST_ASSERT_EQUAL_FLOAT(withStatistics->convert(10.0f), converted[2]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, withStatistics->convert(4.0f + 3.535534f) - withStatistics->convert(4.0f), converted[3]);
+
+    // getDataArray only gets the averages
+    float averages[2];
+    manager.getDataArray(averages, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, averages[0]);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, averages[1]);
+}
+
+static void test_statisticsWithoutSamplesAreSingleValues(void)
+{
+    ColumnarDataFieldManager manager = ColumnarDataFieldManager(3, 1);
+    manager.setFixedPoint(true);
+    NumericDataField * withStatistics = new NumericDataField(VOLTAGE, NULL, 1);
+    withStatistics->setStatistics(true);
+    manager.addField(withStatistics);
+
+    float average = 2.5f;
+    DATAFIELD_STATISTICS stats = {1.0f, 4.0f, 0.5f, 0.0f, 0.0f, 0.0f};
+    manager.storeAverageArray(&average);
+    manager.storeAverageArray(&average, &stats);
+
+    FIXED rows[2][4];
+    TEST_ASSERT_EQUAL(2, manager.getFixedDataRows(&rows[0][0], 2, false, true, NULL));
+
+    TEST_ASSERT_EQUAL(FIXED_FromFloat(2.5f), rows[0][0]);
+    TEST_ASSERT_EQUAL(FIXED_FromFloat(2.5f), rows[0][1]);
+    TEST_ASSERT_EQUAL(FIXED_FromFloat(2.5f), rows[0][2]);
+    TEST_ASSERT_EQUAL(0, rows[0][3]);
+
+    TEST_ASSERT_EQUAL(FIXED_FromFloat(1.0f), rows[1][1]);
+    TEST_ASSERT_EQUAL(FIXED_FromFloat(4.0f), rows[1][2]);
+    TEST_ASSERT_EQUAL(FIXED_FromFloat(0.5f), rows[1][3]);
+}
+
+static void test_percentilesAreStoredInFixedPointRows(void)
+{
+    ColumnarDataFieldManager manager = ColumnarDataFieldManager(3, 20);
+    manager.setFixedPoint(true);
+    NumericDataField * withPercentiles = new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1);
+    withPercentiles->setPercentiles(20);
+    manager.addField(withPercentiles);
+
+    TEST_ASSERT_EQUAL(4, manager.columnCount());
+
+    // Steady readings with one spike, which moves the mean but not the median
+    int32_t scan[1];
+    uint8_t i;
+    for (i = 0; i < 20; i++)
+    {
+        scan[0] = (i == 10) ? 1000 : 100;
+        manager.storeDataArray(scan);
+    }
+
+    float raw[4];
+    TEST_ASSERT_EQUAL(1, manager.getDataRows(raw, 1, false, false, NULL));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, 145.0f, raw[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, 100.0f, raw[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, 100.0f, raw[2]);
+
+    float converted[4];
+    TEST_ASSERT_EQUAL(1, manager.getDataRows(converted, 1, true, true, NULL));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, withPercentiles->convert(raw[1]), converted[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, withPercentiles->convert(raw[2]), converted[2]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, withPercentiles->convert(raw[3]), converted[3]);
+}
+
+static uint32_t s_fakeSeconds;
+
+static void fakeClock(DATAFIELD_TIMESTAMP * timestamp)
+{
+    timestamp->seconds = s_fakeSeconds;
+    timestamp->millis = (uint16_t)(s_fakeSeconds % 1000);
+    s_fakeSeconds += 7;
+}
+
+static void test_rowsAreTimestampedWhenStored(void)
+{
+    ColumnarDataFieldManager manager = ColumnarDataFieldManager(3, 2);
+    manager.addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    TEST_ASSERT_TRUE(manager.setClock(fakeClock));
+
+    int32_t data[] = {1};
+    float actual[3];
+    DATAFIELD_TIMESTAMP timestamps[3];
+    DATAFIELD_TIMESTAMP latest;
+    uint8_t i;
+
+    TEST_ASSERT_FALSE(manager.getLatestTimestamp(&latest));
+
+    s_fakeSeconds = 1500000000;
+
+    // The clock is read once per row, when the window completes
+    for (i = 0; i < 8; i++) { manager.storeDataArray(data); }
+
+    TEST_ASSERT_FALSE(manager.setClock(NULL));
+    TEST_ASSERT_EQUAL(3, manager.count());
+
+    // The first row was dropped
+    TEST_ASSERT_TRUE(manager.getTimestamp(0, &timestamps[0]));
+    TEST_ASSERT_EQUAL(1500000007, timestamps[0].seconds);
+    TEST_ASSERT_FALSE(manager.getTimestamp(3, &timestamps[0]));
+
+    TEST_ASSERT_TRUE(manager.getLatestTimestamp(&latest));
+    TEST_ASSERT_EQUAL(1500000021, latest.seconds);
+
+    TEST_ASSERT_EQUAL(3, manager.getDataRows(actual, 3, false, true, NULL, timestamps));
+    for (i = 0; i < 3; i++)
+    {
+        TEST_ASSERT_EQUAL(1500000007 + (7 * i), timestamps[i].seconds);
+        TEST_ASSERT_EQUAL((1500000007 + (7 * i)) % 1000, timestamps[i].millis);
+    }
+
+    // The latest timestamp is still available after the rows are removed
+    TEST_ASSERT_TRUE(manager.getLatestTimestamp(&latest));
+    TEST_ASSERT_EQUAL(1500000021, latest.seconds);
+}
+
+static void test_rowsWithoutClockHaveZeroTimestamps(void)
+{
+    float rows[][2] = {{1.0f, 2.0f}, {3.0f, 4.0f}};
+    float actual[2][2];
+    DATAFIELD_TIMESTAMP timestamps[2] = {{1, 1, 0}, {1, 1, 0}};
+
+    s_manager->storeAverageArray(rows[0]);
+    s_manager->storeAverageArray(rows[1]);
+
+    TEST_ASSERT_FALSE(s_manager->getTimestamp(0, &timestamps[0]));
+    TEST_ASSERT_EQUAL(2, s_manager->getDataRows(&actual[0][0], 2, false, true, NULL, timestamps));
+    TEST_ASSERT_EQUAL(0, timestamps[1].seconds);
+    TEST_ASSERT_EQUAL(0, timestamps[1].millis);
+}
+
+static void test_deadbandsSuppressUnchangedRows(void)
+{
+    ColumnarDataFieldManager manager = ColumnarDataFieldManager(10, 1);
+    NumericDataField * absolute = new NumericDataField(VOLTAGE, NULL, 1);
+    NumericDataField * relative = new NumericDataField(VOLTAGE, NULL, 3);
+    absolute->setDeadband(5.0f, 0.0f);
+    relative->setDeadband(0.0f, 10.0f);
+    manager.addField(absolute);
+    manager.addField(relative);
+    TEST_ASSERT_TRUE(manager.enableDeadbands(3));
+
+    float rows[][2] = {{100.0f, 50.0f}, {103.0f, 52.0f}, {106.0f, 53.0f}, {106.0f, 54.0f}, {106.0f, 54.0f}};
+    uint32_t expectedChanged[] = {0x03, 0x01, 0x03};
+    float actual[3][2];
+    uint32_t changed[3];
+    DATAFIELD_COUNTERS counters;
+    uint8_t i;
+
+    // The first row is always stored, the second is within both deadbands,
+    // the third only moves the first field and the fourth is a heartbeat (every third row)
+    for (i = 0; i < 5; i++) { manager.storeAverageArray(rows[i]); }
+
+    TEST_ASSERT_FALSE(manager.enableDeadbands(0));
+    TEST_ASSERT_EQUAL(3, manager.count());
+
+    manager.getCounters(0, &counters);
+    TEST_ASSERT_EQUAL(3, counters.pushes);
+    TEST_ASSERT_EQUAL(2, counters.suppressed);
+
+    TEST_ASSERT_EQUAL(3, manager.getDataRows(&actual[0][0], 3, false, true, NULL, NULL, changed));
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expectedChanged, changed, 3);
+    TEST_ASSERT_EQUAL_FLOAT(106.0f, actual[1][0]);
+    TEST_ASSERT_EQUAL_FLOAT(53.0f, actual[1][1]);
+}
+
+static void test_fieldsWithoutDeadbandsDoNotStoreRows(void)
+{
+    ColumnarDataFieldManager manager = ColumnarDataFieldManager(10, 1);
+    NumericDataField * banded = new NumericDataField(VOLTAGE, NULL, 1);
+    banded->setDeadband(5.0f, 0.0f);
+    manager.addField(banded);
+    manager.addField(new NumericDataField(VOLTAGE, NULL, 3));
+    TEST_ASSERT_TRUE(manager.enableDeadbands(0));
+
+    float rows[][2] = {{100.0f, 1.0f}, {102.0f, 2.0f}, {106.0f, 3.0f}, {106.0f, 4.0f}};
+    uint32_t expectedChanged[] = {0x03, 0x03};
+    float actual[2][2];
+    uint32_t changed[2];
+    DATAFIELD_COUNTERS counters;
+    uint8_t i;
+
+    // The second field changes every row, but only the first field moving outside its deadband stores one
+    for (i = 0; i < 4; i++) { manager.storeAverageArray(rows[i]); }
+
+    TEST_ASSERT_EQUAL(2, manager.count());
+    manager.getCounters(0, &counters);
+    TEST_ASSERT_EQUAL(2, counters.suppressed);
+
+    TEST_ASSERT_EQUAL(2, manager.getDataRows(&actual[0][0], 2, false, true, NULL, NULL, changed));
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expectedChanged, changed, 2);
+    TEST_ASSERT_EQUAL_FLOAT(106.0f, actual[1][0]);
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, actual[1][1]);
+}
+
+static void test_allFieldsChangeWithoutDeadbands(void)
+{
+    float rows[][2] = {{1.0f, 2.0f}, {1.0f, 2.0f}};
+    float actual[2][2];
+    uint32_t changed[2];
+
+    ((NumericDataField*)s_manager->getField(0))->setDeadband(5.0f, 0.0f);
+
+    // Deadbands are only applied if enabled
+    s_manager->storeAverageArray(rows[0]);
+    s_manager->storeAverageArray(rows[1]);
+
+    TEST_ASSERT_EQUAL(2, s_manager->getDataRows(&actual[0][0], 2, false, true, NULL, NULL, changed));
+    TEST_ASSERT_EQUAL(0x03, changed[0]);
+    TEST_ASSERT_EQUAL(0x03, changed[1]);
+}
+
+int main(void)
+{
+    UnityBegin("DLDataField.ColumnarManager.Test.cpp");
+
+    RUN_TEST(test_stringFieldsCannotBeAdded);
+    RUN_TEST(test_fieldsCannotBeAddedAfterDataIsStored);
+    RUN_TEST(test_bytesUsedIncludesSumsAndRows);
+    RUN_TEST(test_storeDataArrayAveragesIntoRows);
+    RUN_TEST(test_dividedFieldsAverageOnlyTheirOwnScans);
+    RUN_TEST(test_rowsAreContiguousAndOldestIsDroppedWhenFull);
+    RUN_TEST(test_getDataArrayConvertsData);
+    RUN_TEST(test_aggregatorCanFeedColumnarManager);
+    RUN_TEST(test_getDataRowsCopiesWrappedRowsWithIndexes);
+    RUN_TEST(test_fixedPointCannotBeChangedAfterFieldsAreAdded);
+    RUN_TEST(test_fixedPointResultsMatchFloatingPoint);
+    RUN_TEST(test_dropNewestPolicyKeepsOldestRows);
+    RUN_TEST(test_spillPolicyPassesOldestRowsToSpillFunction);
+    RUN_TEST(test_statisticsAreStoredInRows);
+    RUN_TEST(test_statisticsWithoutSamplesAreSingleValues);
+    RUN_TEST(test_percentilesAreStoredInFixedPointRows);
+    RUN_TEST(test_rowsAreTimestampedWhenStored);
+    RUN_TEST(test_rowsWithoutClockHaveZeroTimestamps);
+    RUN_TEST(test_deadbandsSuppressUnchangedRows);
+    RUN_TEST(test_fieldsWithoutDeadbandsDoNotStoreRows);
+    RUN_TEST(test_allFieldsChangeWithoutDeadbands);
+
+    UnityEnd();
+    return 0;
+}
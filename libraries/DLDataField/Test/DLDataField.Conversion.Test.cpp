@@ -28,6 +28,7 @@
  * Local Application Includes
  */
 
+#include "DLUtility.FixedPoint.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.Conversion.h"
 
@@ -36,6 +37,8 @@ void test_ConversionToVoltsIsCorrect(void)
 	VOLTAGECHANNEL testChannel = 
 	{
 	    .mvPerBit = 0.125,
+	    .offset = 0,
+	    .multiplier = 1,
 	    .R1 = 10000,
 	    .R2 = 10000
 	};
@@ -78,7 +81,10 @@ void test_ConversionHighsideThermistorToTemperatureIsCorrect(void)
     	.B = 3000,
     	.otherR = 10000,
     	.maxADC = 1023,
-    	.highside = true
+    	.highside = true,
+    	.lutSize = 0,
+    	.lut = NULL,
+    	.lutMaxError = 0.0f
 	};
 
 	char message[128];
@@ -109,6 +115,188 @@ void test_ConversionHighsideThermistorToTemperatureIsCorrect(void)
 	TEST_ASSERT_FLOAT_WITHIN_MESSAGE(expected, actual, expected/100, message);
 }
 
+void test_VoltageArrayConversionMatchesScalarConversion(void)
+{
+	VOLTAGECHANNEL testChannel = 
+	{
+	    .mvPerBit = 0.125,
+	    .offset = 0.05,
+	    .multiplier = 1.1,
+	    .R1 = 200000,
+	    .R2 = 10000
+	};
+
+	float raw[] = {-32768.0f, -1.5f, 0.0f, 511.5f, 1023.0f, 4000.0f, 32767.0f};
+	float actual[7];
+	char message[128];
+
+	CONV_VoltsFromRawArray(raw, actual, 7, &testChannel);
+
+	uint8_t i;
+	for (i = 0; i < 7; i++)
+	{
+		float expected = CONV_VoltsFromRaw(raw[i], &testChannel);
+		sprintf(message, "Raw %.1f: expected %.6f, actual %.6f", raw[i], expected, actual[i]);
+		TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.0001f, expected, actual[i], message);
+	}
+}
+
+void test_CurrentArrayConversionMatchesScalarConversion(void)
+{
+	CURRENTCHANNEL testChannel = {
+    	.mvPerBit = 0.125,
+    	.offset = 600,
+    	.mvPerAmp = 60
+    };
+
+	float raw[] = {-32768.0f, 0.0f, 4800.0f, 5280.0f, 32767.0f};
+	float actual[5];
+	char message[128];
+
+	// Conversion in-place should also work
+	memcpy(actual, raw, sizeof(raw));
+	CONV_AmpsFromRawArray(actual, actual, 5, &testChannel);
+
+	uint8_t i;
+	for (i = 0; i < 5; i++)
+	{
+		float expected = CONV_AmpsFromRaw(raw[i], &testChannel);
+		sprintf(message, "Raw %.1f: expected %.6f, actual %.6f", raw[i], expected, actual[i]);
+		TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.0001f, expected, actual[i], message);
+	}
+}
+
+void test_ThermistorArrayConversionMatchesScalarConversion(void)
+{
+	THERMISTORCHANNEL testChannel = 
+	{
+    	.R25 = 10000,
+    	.B = 3000,
+    	.otherR = 10000,
+    	.maxADC = 1023,
+    	.highside = true,
+    	.lutSize = 0,
+    	.lut = NULL,
+    	.lutMaxError = 0.0f
+	};
+
+	float raw[] = {346.0f, 511.5f, 712.0f, 845.0f};
+	float actual[4];
+
+	CONV_CelsiusFromRawThermistorArray(raw, actual, 4, &testChannel);
+
+	uint8_t i;
+	for (i = 0; i < 4; i++)
+	{
+		TEST_ASSERT_EQUAL_FLOAT(CONV_CelsiusFromRawThermistor(raw[i], &testChannel), actual[i]);
+	}
+}
+
+void test_ThermistorLookupTableIsWithinItsErrorBound(void)
+{
+	THERMISTORCHANNEL testChannel = 
+	{
+    	.R25 = 10000,
+    	.B = 3000,
+    	.otherR = 10000,
+    	.maxADC = 1023,
+    	.highside = true,
+    	.lutSize = 256,
+    	.lut = NULL,
+    	.lutMaxError = 0.0f
+	};
+
+	THERMISTORCHANNEL exactChannel = testChannel;
+	exactChannel.lutSize = 0;
+
+	TEST_ASSERT_TRUE(CONV_BuildThermistorLUT(&testChannel));
+	TEST_ASSERT_NOT_NULL(testChannel.lut);
+	TEST_ASSERT_TRUE(testChannel.lutMaxError > 0.0f);
+	TEST_ASSERT_TRUE(testChannel.lutMaxError < 0.05f);
+
+	char message[128];
+	float raw;
+	float expected;
+	float actual;
+	for (raw = 1.0f; raw < 1023.0f; raw += 0.25f)
+	{
+		expected = CONV_CelsiusFromRawThermistor(raw, &exactChannel);
+		actual = CONV_CelsiusFromRawThermistor(raw, &testChannel);
+		sprintf(message, "Raw %.2f: expected %.3f, actual %.3f", raw, expected, actual);
+		TEST_ASSERT_FLOAT_WITHIN_MESSAGE(testChannel.lutMaxError * 1.01f, expected, actual, message);
+	}
+
+	// Table entries themselves are exact
+	TEST_ASSERT_EQUAL_FLOAT(CONV_CelsiusFromRawThermistor(511.5f, &exactChannel), CONV_CelsiusFromRawThermistor(511.5f, &testChannel));
+
+	CONV_FreeThermistorLUT(&testChannel);
+	TEST_ASSERT_NULL(testChannel.lut);
+}
+
+void test_SmallerThermistorLookupTableHasLargerError(void)
+{
+	THERMISTORCHANNEL testChannel = 
+	{
+    	.R25 = 10000,
+    	.B = 3000,
+    	.otherR = 10000,
+    	.maxADC = 1023,
+    	.highside = false,
+    	.lutSize = 256,
+    	.lut = NULL,
+    	.lutMaxError = 0.0f
+	};
+
+	TEST_ASSERT_TRUE(CONV_BuildThermistorLUT(&testChannel));
+	float error256 = testChannel.lutMaxError;
+
+	testChannel.lutSize = 64;
+	TEST_ASSERT_TRUE(CONV_BuildThermistorLUT(&testChannel));
+	float error64 = testChannel.lutMaxError;
+
+	// Error should scale with the square of the segment width
+	TEST_ASSERT_TRUE(error64 > error256 * 8.0f);
+
+	testChannel.lutSize = 0;
+	TEST_ASSERT_TRUE(CONV_BuildThermistorLUT(&testChannel));
+	TEST_ASSERT_NULL(testChannel.lut);
+
+	testChannel.lutSize = MAX_THERMISTOR_LUT_SIZE + 1;
+	TEST_ASSERT_FALSE(CONV_BuildThermistorLUT(&testChannel));
+	TEST_ASSERT_NULL(testChannel.lut);
+}
+
+void test_ThermistorLookupTableArrayConversionMatchesScalarConversion(void)
+{
+	THERMISTORCHANNEL testChannel = 
+	{
+    	.R25 = 10000,
+    	.B = 3000,
+    	.otherR = 10000,
+    	.maxADC = 1023,
+    	.highside = true,
+    	.lutSize = 128,
+    	.lut = NULL,
+    	.lutMaxError = 0.0f
+	};
+
+	TEST_ASSERT_TRUE(CONV_BuildThermistorLUT(&testChannel));
+
+	// Includes readings in the first and last segments, which are not interpolated
+	float raw[] = {0.5f, 3.0f, 346.0f, 511.5f, 712.0f, 845.0f, 1020.0f};
+	float actual[7];
+
+	CONV_CelsiusFromRawThermistorArray(raw, actual, 7, &testChannel);
+
+	uint8_t i;
+	for (i = 0; i < 7; i++)
+	{
+		TEST_ASSERT_EQUAL_FLOAT(CONV_CelsiusFromRawThermistor(raw[i], &testChannel), actual[i]);
+	}
+
+	CONV_FreeThermistorLUT(&testChannel);
+}
+
 int main(void)
 {
     UnityBegin("DLDataField.Conversion.cpp");
@@ -116,6 +304,12 @@ int main(void)
     RUN_TEST(test_ConversionToVoltsIsCorrect);
     RUN_TEST(test_ConversionToAmpsIsCorrect);
     RUN_TEST(test_ConversionHighsideThermistorToTemperatureIsCorrect);
+    RUN_TEST(test_VoltageArrayConversionMatchesScalarConversion);
+    RUN_TEST(test_CurrentArrayConversionMatchesScalarConversion);
+    RUN_TEST(test_ThermistorArrayConversionMatchesScalarConversion);
+    RUN_TEST(test_ThermistorLookupTableIsWithinItsErrorBound);
+    RUN_TEST(test_SmallerThermistorLookupTableHasLargerError);
+    RUN_TEST(test_ThermistorLookupTableArrayConversionMatchesScalarConversion);
 
     UnityEnd();
     return 0;
@@ -1,5 +1,6 @@
 SRC_FILES += DLSensor/DLSensor.Thermistor.cpp
 SRC_FILES += DLUtility/DLUtility.PD.cpp
+SRC_FILES += DLUtility/DLUtility.FixedPoint.cpp
 
 INC_DIRS += -IDLUtility -IDLSensor
 
@@ -21,6 +21,7 @@
  * Local Application Includes
  */
 
+#include "DLUtility.FixedPoint.h"
 #include "DLUtility.Averager.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
@@ -36,6 +37,8 @@ static DataFieldManager * s_manager;
 
 static VOLTAGECHANNEL s_voltageChannelSettings = {
     .mvPerBit = 0.125f,
+    .offset = 0.0f,
+    .multiplier = 1.0f,
     .R1 = 200000.0f,
     .R2= 10000.0f,
 };
@@ -113,6 +116,9 @@ static void test_hasDataRemainingReturnsTrueWhenAtLeastOneFieldHasData(void)
     s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 0) );
     TEST_ASSERT_FALSE(s_manager->hasData());
 
+    // Data is stored directly in the fields, so storage needs to be allocated first
+    TEST_ASSERT_TRUE(s_manager->allocate());
+
     ((NumericDataField*)(s_manager->getField(0)))->storeData(0);
     TEST_ASSERT_TRUE(s_manager->hasData());
 
@@ -145,7 +151,8 @@ void test_managerDataArrayCanBeAdded(void)
     s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 7) );
     s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 12) );
 
-    int32_t input[] = {34, 5432, 632, -532};
+    // The input array holds data for all channels, indexed by (channel number - 1)
+    int32_t input[] = {34, 0, 5432, 0, 0, 0, 632, 0, 0, 0, 0, -532};
     s_manager->storeDataArray(input);
 
     float actualFloats[] = {0.0, 0.0, 0.0, 0.0};
@@ -161,6 +168,290 @@ void test_managerDataArrayCanBeAdded(void)
     TEST_ASSERT_EQUAL_FLOAT_ARRAY_MESSAGE(expectedFloats, actualFloats, 4, message);
 }
 
+void test_managerDataRowsCanBeRead(void)
+{
+    DataFieldManager manager = DataFieldManager(10, 1);
+    manager.addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+    manager.addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 2) );
+
+    int32_t inputs[][2] = {{1, 2}, {3, 4}, {5, 6}};
+    float actual[3][2];
+    uint32_t indexes[3];
+
+    uint8_t i;
+    for (i = 0; i < 3; i++)
+    {
+        manager.storeDataArray(inputs[i]);
+    }
+
+    // Without removal, only the oldest row can be read
+    TEST_ASSERT_EQUAL(1, manager.getDataRows(&actual[0][0], 3, false, false, indexes));
+    TEST_ASSERT_EQUAL(3, manager.count());
+
+    TEST_ASSERT_EQUAL(3, manager.getDataRows(&actual[0][0], 3, false, true, indexes));
+    TEST_ASSERT_EQUAL(0, manager.count());
+
+    for (i = 0; i < 3; i++)
+    {
+        TEST_ASSERT_EQUAL(i, indexes[i]);
+        TEST_ASSERT_EQUAL_FLOAT((float)inputs[i][0], actual[i][0]);
+        TEST_ASSERT_EQUAL_FLOAT((float)inputs[i][1], actual[i][1]);
+    }
+}
+
+void test_statisticsColumnsFollowEachFieldWithStatistics(void)
+{
+    DataFieldManager manager = DataFieldManager(10, 2);
+    NumericDataField * withStatistics = new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1);
+    withStatistics->setStatistics(true);
+    manager.addField(withStatistics);
+    manager.addField( new NumericDataField(CURRENT, &s_currentChannelSettings, 2) );
+
+    TEST_ASSERT_EQUAL(5, manager.columnCount());
+
+    uint8_t field;
+    DATAFIELD_COLUMN type;
+    TEST_ASSERT_TRUE(manager.getColumn(3, &field, &type));
+    TEST_ASSERT_EQUAL(0, field);
+    TEST_ASSERT_EQUAL(COLUMN_STDDEV, type);
+    TEST_ASSERT_TRUE(manager.getColumn(4, &field, &type));
+    TEST_ASSERT_EQUAL(1, field);
+    TEST_ASSERT_EQUAL(COLUMN_AVERAGE, type);
+    TEST_ASSERT_FALSE(manager.getColumn(5, &field, &type));
+
+    char buffer[200];
+    manager.writeHeadersToBuffer(buffer, 200);
+    TEST_ASSERT_EQUAL_STRING(
+        "Voltage (V), Voltage (V) Min, Voltage (V) Max, Voltage (V) StdDev, Current (A)\r\n", buffer);
+
+    int32_t inputs[][2] = {{10, 1}, {20, 3}};
+    manager.storeDataArray(inputs[0]);
+    manager.storeDataArray(inputs[1]);
+
+    float expected[] = {15.0f, 10.0f, 20.0f, 5.0f, 2.0f};
+    float actual[5];
+    TEST_ASSERT_EQUAL(1, manager.getDataRows(actual, 1, false, true, NULL));
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(expected, actual, 5);
+}
+
+void test_percentileColumnsFollowStatisticsColumns(void)
+{
+    DataFieldManager manager = DataFieldManager(10, 4);
+    NumericDataField * both = new NumericDataField(VOLTAGE, NULL, 1);
+    both->setStatistics(true);
+    both->setPercentiles(20);
+    manager.addField(both);
+    NumericDataField * percentilesOnly = new NumericDataField(CURRENT, NULL, 2);
+    percentilesOnly->setPercentiles(20);
+    manager.addField(percentilesOnly);
+
+    TEST_ASSERT_EQUAL(11, manager.columnCount());
+
+    uint8_t field;
+    DATAFIELD_COLUMN type;
+    TEST_ASSERT_TRUE(manager.getColumn(4, &field, &type));
+    TEST_ASSERT_EQUAL(0, field);
+    TEST_ASSERT_EQUAL(COLUMN_P5, type);
+    TEST_ASSERT_TRUE(manager.getColumn(8, &field, &type));
+    TEST_ASSERT_EQUAL(1, field);
+    TEST_ASSERT_EQUAL(COLUMN_P5, type);
+
+    char buffer[300];
+    manager.writeHeadersToBuffer(buffer, 300);
+    TEST_ASSERT_EQUAL_STRING(
+        "Voltage (V), Voltage (V) Min, Voltage (V) Max, Voltage (V) StdDev, "
+        "Voltage (V) P5, Voltage (V) P50, Voltage (V) P95, "
+        "Current (A), Current (A) P5, Current (A) P50, Current (A) P95\r\n", buffer);
+
+    int32_t inputs[][2] = {{10, 7}, {10, 7}, {10, 7}, {10, 7}};
+    uint8_t i;
+    for (i = 0; i < 4; i++) { manager.storeDataArray(inputs[i]); }
+
+    float expected[] = {10.0f, 10.0f, 10.0f, 0.0f, 10.0f, 10.0f, 10.0f, 7.0f, 7.0f, 7.0f, 7.0f};
+    float actual[11];
+    TEST_ASSERT_EQUAL(1, manager.getDataRows(actual, 1, false, true, NULL));
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(expected, actual, 11);
+}
+
+void test_fieldStorageIsAllocatedFromOneBlock(void)
+{
+    NumericDataField * voltage = new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1);
+    NumericDataField * current = new NumericDataField(CURRENT, &s_currentChannelSettings, 2);
+    StringDataField * direction = new StringDataField(CARDINAL_DIRECTION, 3, 2, 3);
+
+    s_manager->addField(voltage);
+    s_manager->addField(current);
+    s_manager->addField(direction);
+
+    TEST_ASSERT_EQUAL(0, s_manager->bytesUsed());
+    TEST_ASSERT_TRUE(s_manager->allocate());
+
+    // Each field's storage is padded to 8 bytes
+    uint32_t stringBytes = 2 * 3;
+    uint32_t expected = (2 * 10 * sizeof(float)) + (((stringBytes + 7) / 8) * 8);
+    TEST_ASSERT_EQUAL(expected, s_manager->bytesUsed());
+
+    // No more fields can be added once the storage is allocated
+    TEST_ASSERT_FALSE(s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 4) ));
+    TEST_ASSERT_FALSE(s_manager->addField( new StringDataField(CARDINAL_DIRECTION, 3, 1, 5) ));
+
+    int32_t input[] = {10, 20, 0};
+    s_manager->storeDataArray(input);
+    direction->storeData("NE");
+    direction->storeData("SW");
+
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, voltage->getRawData(false));
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, current->getRawData(false));
+    TEST_ASSERT_EQUAL_STRING("NE", direction->getData(true));
+    TEST_ASSERT_EQUAL_STRING("SW", direction->getData(true));
+}
+
+void test_storageIsAllocatedWhenDataIsFirstStored(void)
+{
+    s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+
+    int32_t input[] = {10};
+    s_manager->storeDataArray(input);
+
+    TEST_ASSERT_EQUAL(10 * sizeof(float), s_manager->bytesUsed());
+    TEST_ASSERT_TRUE(s_manager->hasData());
+}
+
+void test_dropNewestPolicyDoesNotCountDiscardedRows(void)
+{
+    DataFieldManager manager = DataFieldManager(2, 1);
+    manager.addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+    manager.setOverflowPolicy(OVERFLOW_DROP_NEWEST, NULL);
+
+    int32_t inputs[] = {1, 2, 3};
+    float actual[2];
+    DATAFIELD_COUNTERS counters;
+
+    uint8_t i;
+    for (i = 0; i < 3; i++)
+    {
+        manager.storeDataArray(&inputs[i]);
+    }
+
+    TEST_ASSERT_EQUAL(2, manager.count());
+    TEST_ASSERT_EQUAL(2, manager.getDataRows(actual, 2, false, true, NULL));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, actual[1]);
+
+    TEST_ASSERT_TRUE(manager.getCounters(0, &counters));
+    TEST_ASSERT_EQUAL(2, counters.pushes);
+    TEST_ASSERT_EQUAL(2, counters.pops);
+    TEST_ASSERT_EQUAL(1, counters.drops);
+}
+
+void test_dropOldestPolicyKeepsCountAtDataSize(void)
+{
+    DataFieldManager manager = DataFieldManager(2, 1);
+    manager.addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+
+    int32_t inputs[] = {1, 2, 3};
+    float actual[2];
+    uint32_t indexes[2];
+
+    uint8_t i;
+    for (i = 0; i < 3; i++)
+    {
+        manager.storeDataArray(&inputs[i]);
+    }
+
+    TEST_ASSERT_EQUAL(2, manager.count());
+    TEST_ASSERT_EQUAL(2, manager.getDataRows(actual, 2, false, true, indexes));
+    TEST_ASSERT_EQUAL(1, indexes[0]);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, actual[1]);
+}
+
+static uint32_t s_fakeSeconds;
+
+static void fakeClock(DATAFIELD_TIMESTAMP * timestamp)
+{
+    timestamp->seconds = s_fakeSeconds++;
+    timestamp->millis = 250;
+}
+
+void test_managerRowsAreTimestamped(void)
+{
+    DataFieldManager manager = DataFieldManager(2, 1);
+    manager.addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+    manager.setClock(fakeClock);
+
+    int32_t inputs[] = {1};
+    float actual[2];
+    DATAFIELD_TIMESTAMP timestamps[2];
+
+    s_fakeSeconds = 100;
+
+    uint8_t i;
+    for (i = 0; i < 3; i++)
+    {
+        manager.storeDataArray(inputs);
+    }
+
+    // Oldest row (stored at 100) was dropped
+    TEST_ASSERT_EQUAL(2, manager.getDataRows(actual, 2, false, true, NULL, timestamps));
+    TEST_ASSERT_EQUAL(101, timestamps[0].seconds);
+    TEST_ASSERT_EQUAL(102, timestamps[1].seconds);
+    TEST_ASSERT_EQUAL(250, timestamps[1].millis);
+}
+
+void test_channelsAreLookedUpByNumber(void)
+{
+    NumericDataField * first = new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 3);
+    NumericDataField * second = new NumericDataField(CURRENT, &s_currentChannelSettings, 1);
+    NumericDataField * duplicate = new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 3);
+
+    s_manager->addField(first);
+    s_manager->addField(second);
+    s_manager->addField(duplicate);
+
+    TEST_ASSERT_EQUAL_PTR(first, s_manager->getChannel(3));
+    TEST_ASSERT_EQUAL_PTR(second, s_manager->getChannel(1));
+    TEST_ASSERT_EQUAL_PTR(NULL, s_manager->getChannel(2));
+    TEST_ASSERT_EQUAL_PTR(NULL, s_manager->getChannel(255));
+
+    uint16_t const * indexes = s_manager->getDataIndexes();
+    TEST_ASSERT_EQUAL(2, indexes[0]);
+    TEST_ASSERT_EQUAL(0, indexes[1]);
+    TEST_ASSERT_EQUAL(2, indexes[2]);
+}
+
+void test_dividedFieldsAreSampledLessOften(void)
+{
+    DataFieldManager manager(10, 4);
+    NumericDataField * fast = new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1);
+    NumericDataField * slow = new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 2);
+    NumericDataField invalid(VOLTAGE, &s_voltageChannelSettings, 3);
+    float actual[2];
+
+    slow->setSampleDivisor(2);
+    invalid.setSampleDivisor(3);
+
+    TEST_ASSERT_TRUE(manager.addField(fast));
+    TEST_ASSERT_TRUE(manager.addField(slow));
+    TEST_ASSERT_FALSE(manager.addField(&invalid));
+    TEST_ASSERT_EQUAL(2, manager.getSampleDivisors()[1]);
+
+    // Channel 2 is only sampled on the second and fourth scans
+    int32_t scans[][2] = {{1, 999}, {2, 10}, {3, 999}, {4, 30}};
+
+    uint8_t i;
+    for (i = 0; i < 4; i++)
+    {
+        TEST_ASSERT_FALSE(manager.hasData());
+        manager.storeDataArray(scans[i]);
+    }
+
+    TEST_ASSERT_EQUAL(1, manager.count());
+    manager.getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, actual[1]);
+}
+
 int main(void)
 {
     UnityBegin("DLDataField.Manager.Test.cpp");
@@ -173,6 +464,16 @@ int main(void)
     RUN_TEST(test_hasDataRemainingReturnsTrueWhenAtLeastOneFieldHasData);
     RUN_TEST(test_managerReturnsCorrectArrayOfChannelNumbers);
     RUN_TEST(test_managerDataArrayCanBeAdded);
+    RUN_TEST(test_managerDataRowsCanBeRead);
+    RUN_TEST(test_statisticsColumnsFollowEachFieldWithStatistics);
+    RUN_TEST(test_percentileColumnsFollowStatisticsColumns);
+    RUN_TEST(test_fieldStorageIsAllocatedFromOneBlock);
+    RUN_TEST(test_storageIsAllocatedWhenDataIsFirstStored);
+    RUN_TEST(test_dropNewestPolicyDoesNotCountDiscardedRows);
+    RUN_TEST(test_dropOldestPolicyKeepsCountAtDataSize);
+    RUN_TEST(test_managerRowsAreTimestamped);
+    RUN_TEST(test_channelsAreLookedUpByNumber);
+    RUN_TEST(test_dividedFieldsAreSampledLessOften);
 
     UnityEnd();
     return 0;
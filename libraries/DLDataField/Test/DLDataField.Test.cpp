@@ -14,6 +14,7 @@
 
 #include <stdint.h>
 #include <string.h>
+#include <math.h>
 
 #include <iostream>
 
@@ -21,10 +22,12 @@
  * Local Application Includes
  */
 
+#include "DLUtility.FixedPoint.h"
 #include "DLUtility.Averager.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
 #include "DLDataField.Conversion.h"
+#include "DLDataField.Typed.h"
 
 /*
  * Unity Test Framework
@@ -39,6 +42,8 @@ static char strDataArray[][5] = {"N","NE", "E", "SE", "S"};
 
 static VOLTAGECHANNEL s_voltageChannelSettings = {
 	.mvPerBit = 0.125f,
+	.offset = 0.0f,
+	.multiplier = 1.0f,
 	.R1 = 200000.0f,
 	.R2= 10000.0f,
 };
@@ -225,6 +230,30 @@ static void test_DatafieldStoreArrayOfStrings_BehavesAsCircularBuffer(void)
 	TEST_ASSERT_EQUAL_STRING("NW", dataField.getData(true));
 }
 
+static void test_DatafieldStringViewPointsAtStoredString(void)
+{
+	StringDataField dataField = StringDataField(CARDINAL_DIRECTION, 3, 5, 0);
+	STRING_VIEW view;
+
+	TEST_ASSERT_FALSE(dataField.getView(&view, true));
+
+	dataField.storeData((char*)"NE");
+	dataField.storeData((char*)"S");
+
+	TEST_ASSERT_TRUE(dataField.getView(&view, false));
+	TEST_ASSERT_EQUAL(2, view.length);
+	TEST_ASSERT_EQUAL_STRING("NE", view.data);
+
+	// The view is of the stored data (not a copy), and strings are stored at a fixed stride
+	TEST_ASSERT_EQUAL_PTR(dataField.getData(true), view.data);
+
+	TEST_ASSERT_TRUE(dataField.getView(&view, true));
+	TEST_ASSERT_EQUAL(1, view.length);
+	TEST_ASSERT_EQUAL_STRING("S", view.data);
+
+	TEST_ASSERT_FALSE(dataField.hasData());
+}
+
 static void test_GetFieldTypeString_ReturnsStringforValidIndexAndEmptyOtherwise(void)
 {
 	StringDataField dataField = StringDataField(DEGREES_DIRECTION, 3, 5, 0);
@@ -364,6 +393,153 @@ static void test_DatafieldUsesAlternativeConversionFunction(void)
 	TEST_ASSERT_EQUAL_FLOAT(s_expectedAverage * 2, voltsDataField.getConvData(0));
 }
 
+static void test_TypedDatafieldConvertsWithCopyOfSettings(void)
+{
+	VOLTAGECHANNEL settings = s_voltageChannelSettings;
+	TypedNumericDataField<VoltageConversion> typedField(&settings, 3);
+	NumericDataField untypedField = NumericDataField(VOLTAGE, (void*)&s_voltageChannelSettings, 3);
+	char typedConfig[100];
+	char untypedConfig[100];
+
+	TEST_ASSERT_EQUAL(VOLTAGE, typedField.getType());
+	TEST_ASSERT_EQUAL(3, typedField.getChannelNumber());
+	TEST_ASSERT_TRUE(typedField.getConversionParams() == typedField.getParams());
+
+	typedField.setDataSizes(10, 10);
+	untypedField.setDataSizes(10, 10);
+	fillWithTestIntData(&typedField);
+	fillWithTestIntData(&untypedField);
+
+	// Changing the settings after the field is created does not change the field's conversion
+	settings.mvPerBit = 1.0f;
+
+	TEST_ASSERT_EQUAL_FLOAT(untypedField.getConvData(false), typedField.getConvData(false));
+	typedField.getConfigString(typedConfig);
+	untypedField.getConfigString(untypedConfig);
+	TEST_ASSERT_EQUAL_STRING(untypedConfig, typedConfig);
+
+	TypedNumericDataField<CurrentConversion> noConversionField(NULL, 4);
+	TEST_ASSERT_EQUAL(CURRENT, noConversionField.getType());
+	TEST_ASSERT_EQUAL_FLOAT(s_expectedAverage, noConversionField.convert(s_expectedAverage));
+}
+
+static void test_DatafieldCountsPushesPopsAndDrops(void)
+{
+	NumericDataField dataField = NumericDataField(VOLTAGE, (void*)&s_voltageChannelSettings, 0);
+	dataField.setDataSizes(2, 1);
+
+	DATAFIELD_COUNTERS counters;
+
+	// Third value drops the first
+	dataField.storeData(1);
+	dataField.storeData(2);
+	dataField.storeData(3);
+	TEST_ASSERT_EQUAL_FLOAT(2.0f, dataField.getRawData(true));
+
+	dataField.getCounters(&counters);
+	TEST_ASSERT_EQUAL(3, counters.pushes);
+	TEST_ASSERT_EQUAL(1, counters.pops);
+	TEST_ASSERT_EQUAL(1, counters.drops);
+
+	dataField.resetCounters();
+	dataField.getCounters(&counters);
+	TEST_ASSERT_EQUAL(0, counters.pushes + counters.pops + counters.drops);
+}
+
+static void test_DatafieldDropNewestPolicyKeepsOldestData(void)
+{
+	NumericDataField dataField = NumericDataField(VOLTAGE, (void*)&s_voltageChannelSettings, 0);
+	dataField.setDataSizes(2, 1);
+	dataField.setOverflowPolicy(OVERFLOW_DROP_NEWEST);
+
+	TEST_ASSERT_TRUE(dataField.storeData(1));
+	TEST_ASSERT_TRUE(dataField.storeData(2));
+	TEST_ASSERT_FALSE(dataField.storeData(3));
+
+	TEST_ASSERT_EQUAL_FLOAT(1.0f, dataField.getRawData(true));
+	TEST_ASSERT_EQUAL_FLOAT(2.0f, dataField.getRawData(true));
+	TEST_ASSERT_FALSE(dataField.hasData());
+
+	DATAFIELD_COUNTERS counters;
+	dataField.getCounters(&counters);
+	TEST_ASSERT_EQUAL(2, counters.pushes);
+	TEST_ASSERT_EQUAL(2, counters.pops);
+	TEST_ASSERT_EQUAL(1, counters.drops);
+}
+
+static void test_DatafieldStatisticsAreStoredWithEachAverage(void)
+{
+	NumericDataField dataField = NumericDataField(VOLTAGE, (void*)&s_voltageChannelSettings, 0);
+	dataField.setStatistics(true);
+	dataField.setDataSizes(2, 4);
+
+	DATAFIELD_STATISTICS stats;
+	TEST_ASSERT_FALSE(dataField.getStatistics(&stats, false));
+
+	dataField.storeData(1);
+	dataField.storeData(2);
+	dataField.storeData(3);
+	dataField.storeData(10);
+
+	// Mean is 4, standard deviation is sqrt((9 + 4 + 1 + 36) / 4)
+	TEST_ASSERT_TRUE(dataField.getStatistics(&stats, false));
+	TEST_ASSERT_EQUAL_FLOAT(1.0f, stats.min);
+	TEST_ASSERT_EQUAL_FLOAT(10.0f, stats.max);
+	TEST_ASSERT_FLOAT_WITHIN(1e-5, sqrtf(12.5f), stats.stddev);
+
+	// Voltage conversion is linear, so the standard deviation scales with it (the offset does not apply)
+	TEST_ASSERT_TRUE(dataField.getStatistics(&stats, true));
+	TEST_ASSERT_EQUAL_FLOAT(dataField.convert(1.0f), stats.min);
+	TEST_ASSERT_EQUAL_FLOAT(dataField.convert(10.0f), stats.max);
+	TEST_ASSERT_FLOAT_WITHIN(1e-5, sqrtf(12.5f) * (dataField.convert(1.0f) - dataField.convert(0.0f)), stats.stddev);
+
+	TEST_ASSERT_EQUAL_FLOAT(4.0f, dataField.getRawData(true));
+	TEST_ASSERT_FALSE(dataField.getStatistics(&stats, false));
+
+	// A field without statistics enabled has none
+	NumericDataField plainField = NumericDataField(VOLTAGE, (void*)&s_voltageChannelSettings, 0);
+	plainField.setDataSizes(2, 1);
+	plainField.storeData(1);
+	TEST_ASSERT_FALSE(plainField.hasStatistics());
+	TEST_ASSERT_FALSE(plainField.getStatistics(&stats, false));
+}
+
+static void test_DatafieldPercentilesAreStoredWithEachAverage(void)
+{
+	NumericDataField dataField = NumericDataField(VOLTAGE, (void*)&s_voltageChannelSettings, 0);
+	dataField.setPercentiles(20);
+	dataField.setDataSizes(2, 100);
+
+	TEST_ASSERT_EQUAL(3, dataField.statisticsColumnCount());
+	TEST_ASSERT_EQUAL(COLUMN_P5, dataField.statisticsColumn(0));
+	TEST_ASSERT_EQUAL(COLUMN_P95, dataField.statisticsColumn(2));
+
+	DATAFIELD_STATISTICS stats;
+	TEST_ASSERT_FALSE(dataField.getLatestPercentiles(&stats, false));
+
+	int32_t i;
+	for (i = 1; i <= 100; i++) { dataField.storeData(i); }
+
+	TEST_ASSERT_TRUE(dataField.getStatistics(&stats, false));
+	TEST_ASSERT_FLOAT_WITHIN(1.0f, 5.5f, stats.p5);
+	TEST_ASSERT_FLOAT_WITHIN(1.0f, 50.5f, stats.p50);
+	TEST_ASSERT_FLOAT_WITHIN(1.0f, 95.5f, stats.p95);
+
+	// The latest percentiles are still available after the average is removed
+	dataField.getRawData(true);
+	DATAFIELD_STATISTICS converted;
+	TEST_ASSERT_TRUE(dataField.getLatestPercentiles(&converted, true));
+	TEST_ASSERT_EQUAL_FLOAT(dataField.convert(stats.p5), converted.p5);
+	TEST_ASSERT_EQUAL_FLOAT(dataField.convert(stats.p50), converted.p50);
+	TEST_ASSERT_EQUAL_FLOAT(dataField.convert(stats.p95), converted.p95);
+
+	// Each average has its own percentiles
+	for (i = 1; i <= 100; i++) { dataField.storeData(1000); }
+	TEST_ASSERT_TRUE(dataField.getStatistics(&stats, false));
+	TEST_ASSERT_EQUAL_FLOAT(1000.0f, stats.p5);
+	TEST_ASSERT_EQUAL_FLOAT(1000.0f, stats.p95);
+}
+
 /*static void test_writeNumericDataFieldsToBuffer_WritesCorrectValues(void)
 {
 	NumericDataField fieldArray[] = {
@@ -423,10 +599,17 @@ int main(void)
 
     RUN_TEST(test_DatafieldStoreArrayOfStrings_CorrectlyStoresStrings);
     RUN_TEST(test_DatafieldStoreArrayOfStrings_BehavesAsCircularBuffer);
+    RUN_TEST(test_DatafieldStringViewPointsAtStoredString);
 
     RUN_TEST(test_GetFieldTypeString_ReturnsStringforValidIndexAndEmptyOtherwise);
 
     RUN_TEST(test_DatafieldUsesAlternativeConversionFunction);
+    RUN_TEST(test_TypedDatafieldConvertsWithCopyOfSettings);
+
+    RUN_TEST(test_DatafieldCountsPushesPopsAndDrops);
+    RUN_TEST(test_DatafieldDropNewestPolicyKeepsOldestData);
+    RUN_TEST(test_DatafieldStatisticsAreStoredWithEachAverage);
+    RUN_TEST(test_DatafieldPercentilesAreStoredWithEachAverage);
     
     //RUN_TEST(test_writeNumericDataFieldsToBuffer_WritesCorrectValues);
     //RUN_TEST(test_writeStringDataFieldsToBuffer_WritesCorrectValues);
@@ -4,6 +4,7 @@ SRC_FILES += DLUtility/DLUtility.ArrayFunctions.cpp DLUtility/DLUtility.Strings.
 SRC_FILES += DLUtility/DLUtility.Averager.cpp
 
 SRC_FILES += DLUtility/DLUtility.PD.cpp
+SRC_FILES += DLUtility/DLUtility.FixedPoint.cpp DLUtility/DLUtility.Statistics.cpp DLUtility/DLUtility.Quantiles.cpp
 
 SRC_FILES += DLSensor/DLSensor.Thermistor.cpp
 
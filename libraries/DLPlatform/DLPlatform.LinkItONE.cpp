@@ -23,6 +23,7 @@
  */
 
 #include "DLUtility.PD.h" 
+#include "DLUtility.FixedPoint.h"
 #include "DLUtility.Averager.h"
 
 #include "DLDataField.Types.h"
@@ -22,6 +22,7 @@
  * Local Application Includes
  */
  
+#include "DLUtility.FixedPoint.h"
 #include "DLUtility.Averager.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
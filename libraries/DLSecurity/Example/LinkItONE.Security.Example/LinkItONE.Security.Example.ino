@@ -33,6 +33,7 @@
  * DataLogger Includes
  */
 
+#include "DLUtility.FixedPoint.h"
 #include "DLDataField.h"
 #include "DLUtility.h"
 #include "DLSettings.h"
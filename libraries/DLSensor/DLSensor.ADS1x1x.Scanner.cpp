@@ -0,0 +1,296 @@
+/*
+* DLSensor.ADS1x1x.Scanner.cpp
+*
+* Non-blocking single-ended reads from several ADS1x1x ADCs in parallel
+*
+* Author: James Fowkes
+*
+* www.re-innovation.co.uk
+*/
+
+/*
+* Arduino/C++ Library Includes
+*/
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <string.h>
+#endif
+
+/*
+* Local Application Includes
+*/
+
+#include "DLSensor.ADS1x1x.h"
+#include "DLSensor.ADS1x1x.Scanner.h"
+
+/*
+ * Class Functions
+ */
+
+ADS1x1xScanner::ADS1x1xScanner()
+{
+    uint8_t adc;
+
+    m_adcCount = 0;
+    m_busy = false;
+    m_failedResults = 0;
+
+    for (adc = 0; adc < MAX_SCANNER_ADCS; adc++)
+    {
+        m_adcs[adc] = NULL;
+        m_pending[adc] = 0;
+        m_converting[adc] = -1;
+        m_started[adc] = 0;
+        m_remaining[adc] = 0;
+        m_sums[adc] = 0;
+        m_goodReads[adc] = 0;
+        m_startFailed[adc] = false;
+    }
+
+    memset(m_results, 0, sizeof(m_results));
+    memset(m_configs, 0, sizeof(m_configs));
+    memset(m_conversionTimes, 0, sizeof(m_conversionTimes));
+    memset(m_oversample, 0, sizeof(m_oversample));
+}
+
+/*
+ * addADC
+ *
+ * Add an ADC to the scan. ADCs are numbered in the order they are added.
+ * The ADC must already be set up (begin, setGain): its channels are read with its gain
+ * and default data rate until they are configured. ADCs cannot be added during a scan.
+ */
+bool ADS1x1xScanner::addADC(ADS1x1x * adc)
+{
+    uint8_t channel;
+
+    if (!adc) { return false; }
+    if (m_busy) { return false; }
+    if (m_adcCount == MAX_SCANNER_ADCS) { return false; }
+
+    m_adcs[m_adcCount] = adc;
+
+    for (channel = 0; channel < adc->getMaxChannels(); channel++)
+    {
+        m_configs[m_adcCount][channel] = adc->getSingleEndedConfig(channel, adc->getGain(), 0);
+        m_conversionTimes[m_adcCount][channel] = adc->getConversionTime();
+        m_oversample[m_adcCount][channel] = 1;
+    }
+
+    m_adcCount++;
+    return true;
+}
+
+/*
+ * configureChannel
+ *
+ * Set the gain, data rate (samples per second, 0 for the default) and oversampling
+ * (conversions averaged for each result) of one channel.
+ * Returns false if the ADC does not have the channel or data rate, or if called during a scan.
+ */
+bool ADS1x1xScanner::configureChannel(uint8_t adc, uint8_t channel, ADS_GAIN gain, uint16_t samplesPerSecond, uint8_t oversample)
+{
+    uint16_t config;
+
+    if (m_busy) { return false; }
+    if (adc >= m_adcCount) { return false; }
+    if ((oversample == 0) || (oversample > MAX_SCANNER_OVERSAMPLE)) { return false; }
+
+    config = m_adcs[adc]->getSingleEndedConfig(channel, gain, samplesPerSecond);
+    if (config == 0) { return false; }
+
+    m_configs[adc][channel] = config;
+    m_conversionTimes[adc][channel] = m_adcs[adc]->getConversionTimeAt(samplesPerSecond);
+    m_oversample[adc][channel] = oversample;
+    return true;
+}
+
+/*
+ * scanTime
+ *
+ * Returns the longest time in milliseconds a scan of channelMask could take
+ * (each conversion is collected on the first tick after its conversion time)
+ */
+unsigned long ADS1x1xScanner::scanTime(uint16_t channelMask)
+{
+    uint8_t adc;
+    uint8_t channel;
+    unsigned long adcTime;
+    unsigned long longest = 0;
+
+    for (adc = 0; adc < m_adcCount; adc++)
+    {
+        adcTime = 0;
+        for (channel = 0; channel < m_adcs[adc]->getMaxChannels(); channel++)
+        {
+            if (channelMask & (1 << ((adc * ADS1x1x_SCAN_CHANNELS) + channel)))
+            {
+                adcTime += (unsigned long)m_oversample[adc][channel] * (m_conversionTimes[adc][channel] + 1);
+            }
+        }
+        if (adcTime > longest) { longest = adcTime; }
+    }
+
+    return longest;
+}
+
+uint8_t ADS1x1xScanner::adcCount(void)
+{
+    return m_adcCount;
+}
+
+/*
+ * start
+ *
+ * Start a scan of the channels in channelMask (bit (adc * ADS1x1x_SCAN_CHANNELS) + channel).
+ * Channels the ADC does not have are ignored.
+ * Returns false (and does not start a new scan) if the last scan has not finished.
+ *
+ * now : The current time in milliseconds (e.g. from millis())
+ */
+bool ADS1x1xScanner::start(uint16_t channelMask, unsigned long now)
+{
+    uint8_t adc;
+    uint8_t available;
+
+    if (m_busy) { return false; }
+
+    for (adc = 0; adc < m_adcCount; adc++)
+    {
+        available = (1 << m_adcs[adc]->getMaxChannels()) - 1;
+        m_pending[adc] = (channelMask >> (adc * ADS1x1x_SCAN_CHANNELS)) & available;
+        m_converting[adc] = -1;
+        startNext(adc, now);
+    }
+
+    m_busy = true;
+    return true;
+}
+
+/*
+ * startNext
+ *
+ * Start converting the next pending channel on an ADC (if there is one)
+ */
+void ADS1x1xScanner::startNext(uint8_t adc, unsigned long now)
+{
+    uint8_t channel;
+
+    m_converting[adc] = -1;
+
+    for (channel = 0; channel < ADS1x1x_SCAN_CHANNELS; channel++)
+    {
+        if (m_pending[adc] & (1 << channel))
+        {
+            m_pending[adc] &= ~(1 << channel);
+            m_converting[adc] = channel;
+            m_remaining[adc] = m_oversample[adc][channel];
+            m_sums[adc] = 0;
+            m_goodReads[adc] = 0;
+            startConversion(adc, now);
+            return;
+        }
+    }
+}
+
+/*
+ * startConversion
+ *
+ * Start the next conversion of the channel an ADC is converting
+ * (if the config cannot be written, the conversion is given up on the next tick)
+ */
+void ADS1x1xScanner::startConversion(uint8_t adc, unsigned long now)
+{
+    m_startFailed[adc] = !m_adcs[adc]->startADC_Config(m_configs[adc][m_converting[adc]]);
+    m_started[adc] = now;
+}
+
+/*
+ * tick
+ *
+ * Collect any finished conversions and start the next ones (or the next conversion of an oversampled channel).
+ * Call as often as possible during a scan.
+ * A conversion is collected once more than its conversion time has passed, as now only has millisecond resolution.
+ * Conversions that could not be started or read are left out of a channel's mean. If none of them
+ * could be, the channel keeps its previous result (see failedResults).
+ * Returns true when the scan has just finished (and false at any other time).
+ *
+ * now : The current time in milliseconds
+ */
+bool ADS1x1xScanner::tick(unsigned long now)
+{
+    uint8_t adc;
+    int16_t reading;
+    bool converting = false;
+
+    if (!m_busy) { return false; }
+
+    for (adc = 0; adc < m_adcCount; adc++)
+    {
+        if (m_converting[adc] == -1) { continue; }
+
+        if (m_startFailed[adc] || ((now - m_started[adc]) > m_conversionTimes[adc][m_converting[adc]]))
+        {
+            if (!m_startFailed[adc])
+            {
+                reading = m_adcs[adc]->readADC_SingleEndedResult();
+                if (!m_adcs[adc]->readFailed())
+                {
+                    m_sums[adc] += reading;
+                    m_goodReads[adc]++;
+                }
+            }
+
+            if (--m_remaining[adc])
+            {
+                startConversion(adc, now);
+            }
+            else
+            {
+                if (m_goodReads[adc])
+                {
+                    m_results[adc][m_converting[adc]] = m_sums[adc] / m_goodReads[adc];
+                }
+                else
+                {
+                    m_failedResults++;
+                }
+                startNext(adc, now);
+            }
+        }
+
+        converting |= (m_converting[adc] != -1);
+    }
+
+    m_busy = converting;
+    return !converting;
+}
+
+bool ADS1x1xScanner::busy(void)
+{
+    return m_busy;
+}
+
+/*
+ * failedResults
+ *
+ * Returns the number of channel results that could not be read at all (and kept their previous value)
+ */
+uint32_t ADS1x1xScanner::failedResults(void)
+{
+    return m_failedResults;
+}
+
+/*
+ * getResult
+ *
+ * Returns the last reading of a channel (0 if it has never been read)
+ */
+int16_t ADS1x1xScanner::getResult(uint8_t adc, uint8_t channel)
+{
+    if ((adc >= m_adcCount) || (channel >= ADS1x1x_SCAN_CHANNELS)) { return 0; }
+    return m_results[adc][channel];
+}
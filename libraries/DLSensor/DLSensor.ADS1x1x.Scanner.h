@@ -0,0 +1,70 @@
+#ifndef _DLSENSOR_ADS1x1x_SCANNER_H_
+#define _DLSENSOR_ADS1x1x_SCANNER_H_
+
+#define MAX_SCANNER_ADCS (4)
+
+// Each ADC has this many bits in a scan channel mask (bit (adc * 4) + channel), whatever its number of channels
+#define ADS1x1x_SCAN_CHANNELS (4)
+
+#define MAX_SCANNER_OVERSAMPLE (64)
+
+/*
+ * ADS1x1xScanner
+ *
+ * Reads single-ended channels from several ADS1x1x ADCs without waiting for their conversions.
+ *
+ * start() begins a conversion on every ADC that has channels to read, and returns straight away.
+ * Each later tick() collects the result of any conversion that has had its conversion time,
+ * and starts the next channel on that ADC. ADCs convert in parallel, so a scan of four channels
+ * on each of three ADCs takes about four conversion times rather than twelve.
+ *
+ * tick() returns true once, on the tick that collects the last result of the scan.
+ * Results of channels not in the scan keep their previous values.
+ *
+ * Each channel has its own gain, data rate and oversampling (see configureChannel).
+ * The config register value for each channel is built when it is configured, so a scan only writes it.
+ * An oversampled channel is converted several times in a row and its result is the mean.
+ * Conversions lost to i2c errors are left out (see tick).
+ */
+
+class ADS1x1xScanner
+{
+    public:
+        ADS1x1xScanner();
+
+        bool addADC(ADS1x1x * adc);
+        uint8_t adcCount(void);
+        bool configureChannel(uint8_t adc, uint8_t channel, ADS_GAIN gain, uint16_t samplesPerSecond, uint8_t oversample);
+        unsigned long scanTime(uint16_t channelMask);
+
+        bool start(uint16_t channelMask, unsigned long now);
+        bool tick(unsigned long now);
+        bool busy(void);
+
+        int16_t getResult(uint8_t adc, uint8_t channel);
+        uint32_t failedResults(void);
+
+    private:
+        void startNext(uint8_t adc, unsigned long now);
+        void startConversion(uint8_t adc, unsigned long now);
+
+        ADS1x1x * m_adcs[MAX_SCANNER_ADCS];
+        uint8_t m_adcCount;
+
+        uint8_t m_pending[MAX_SCANNER_ADCS]; // Mask of channels still to convert on each ADC
+        int8_t m_converting[MAX_SCANNER_ADCS]; // Channel each ADC is converting (-1 if none)
+        unsigned long m_started[MAX_SCANNER_ADCS];
+        uint8_t m_remaining[MAX_SCANNER_ADCS]; // Conversions still to do on the current channel
+        int32_t m_sums[MAX_SCANNER_ADCS];
+        uint8_t m_goodReads[MAX_SCANNER_ADCS]; // Conversions read without an i2c error on the current channel
+        bool m_startFailed[MAX_SCANNER_ADCS];
+
+        uint16_t m_configs[MAX_SCANNER_ADCS][ADS1x1x_SCAN_CHANNELS];
+        uint8_t m_conversionTimes[MAX_SCANNER_ADCS][ADS1x1x_SCAN_CHANNELS];
+        uint8_t m_oversample[MAX_SCANNER_ADCS][ADS1x1x_SCAN_CHANNELS];
+        int16_t m_results[MAX_SCANNER_ADCS][ADS1x1x_SCAN_CHANNELS];
+        bool m_busy;
+        uint32_t m_failedResults;
+};
+
+#endif
@@ -0,0 +1,210 @@
+/*
+* DLSensor.ADS1x1x.Topology.cpp
+*
+* Describes the ADS1x1x ADCs on an i2c bus from a settings string
+*
+* Author: James Fowkes
+*
+* www.re-innovation.co.uk
+*/
+
+/*
+* Arduino/C++ Library Includes
+*/
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#endif
+
+/*
+* Local Application Includes
+*/
+
+#include "DLSensor.ADS1x1x.h"
+#include "DLSensor.ADS1x1x.Topology.h"
+
+/*
+* Private Variables
+*/
+
+static char const * const s_partNames[] = {
+    // Values align with ADS1x1x_PART enumeration
+    "ADS1013",
+    "ADS1014",
+    "ADS1015",
+    "ADS1113",
+    "ADS1114",
+    "ADS1115"
+};
+
+/*
+* Private Functions
+*/
+
+static char const * skipSpaces(char const * p)
+{
+    while (isspace(*p)) { p++; }
+    return p;
+}
+
+/*
+* Public Functions
+*/
+
+/*
+ * ADS1x1x_ParsePart
+ *
+ * Returns the part with the name (e.g. "ADS1115", any case), or INVALID_ADS1x1x_PART
+ */
+ADS1x1x_PART ADS1x1x_ParsePart(char const * const name)
+{
+    uint8_t part;
+    uint8_t i;
+
+    if (!name) { return INVALID_ADS1x1x_PART; }
+
+    for (part = 0; part < INVALID_ADS1x1x_PART; part++)
+    {
+        for (i = 0; s_partNames[part][i]; i++)
+        {
+            if (toupper(name[i]) != s_partNames[part][i]) { break; }
+        }
+
+        if ((s_partNames[part][i] == '\0') && (name[i] == '\0')) { return (ADS1x1x_PART)part; }
+    }
+
+    return INVALID_ADS1x1x_PART;
+}
+
+/*
+ * ADS1x1x_PartChannels
+ *
+ * Returns the number of single-ended inputs of a part
+ */
+uint8_t ADS1x1x_PartChannels(ADS1x1x_PART part)
+{
+    switch (part)
+    {
+    case PART_ADS1015:
+    case PART_ADS1115:
+        return 4;
+    case PART_ADS1013:
+    case PART_ADS1014:
+    case PART_ADS1113:
+    case PART_ADS1114:
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+/*
+ * ADS1x1x_ParseTopology
+ *
+ * Parse a comma separated list of ADCs, each written as part@address or part@address:channel,
+ * e.g. "ADS1115@0x48, ADS1113@0x49:10".
+ * The channel is the platform channel number of the ADC's first input. If it is not given,
+ * the ADC's inputs follow on from the previous ADC in the list (or start at channel 1).
+ *
+ * chips : Space for MAX_ADS1x1x_CHIPS chips
+ * count : Set to the number of chips in the list
+ *
+ * Returns false if the list is empty or invalid (unknown part, address outside 0x48 to 0x4B,
+ * an address or channel used twice or more than MAX_ADS1x1x_CHIPS chips).
+ */
+bool ADS1x1x_ParseTopology(char const * const list, ADS1x1x_CHIP * chips, uint8_t * count)
+{
+    char const * p = list;
+    char * end;
+    char name[8];
+    uint8_t i;
+    uint8_t n = 0;
+    uint8_t channels;
+    long value;
+    uint16_t nextChannel = 1;
+    ADS1x1x_CHIP chip;
+
+    if (!list || !chips || !count) { return false; }
+
+    while (true)
+    {
+        p = skipSpaces(p);
+        if (*p == '\0') { break; }
+        if (n == MAX_ADS1x1x_CHIPS) { return false; }
+
+        // Part name, up to the '@'
+        for (i = 0; (i < sizeof(name) - 1) && p[i] && (p[i] != '@') && !isspace(p[i]); i++) { name[i] = p[i]; }
+        name[i] = '\0';
+        p = skipSpaces(p + i);
+        if (*p++ != '@') { return false; }
+
+        chip.part = ADS1x1x_ParsePart(name);
+        if (chip.part == INVALID_ADS1x1x_PART) { return false; }
+        channels = ADS1x1x_PartChannels(chip.part);
+
+        // Address (in any base strtol understands, e.g. 0x48 or 72)
+        value = strtol(p, &end, 0);
+        if ((end == p) || (value < ADS1x1x_FIRST_ADDRESS) || (value > ADS1x1x_LAST_ADDRESS)) { return false; }
+        chip.address = (uint8_t)value;
+        p = skipSpaces(end);
+
+        // Optional first channel number
+        value = nextChannel;
+        if (*p == ':')
+        {
+            p = skipSpaces(p + 1);
+            value = strtol(p, &end, 10);
+            if (end == p) { return false; }
+            p = skipSpaces(end);
+        }
+        if ((value < 1) || ((value + channels - 1) > 255)) { return false; }
+        chip.firstChannel = (uint8_t)value;
+
+        if ((*p != ',') && (*p != '\0')) { return false; }
+        if (*p == ',') { p++; }
+
+        for (i = 0; i < n; i++)
+        {
+            if (chips[i].address == chip.address) { return false; }
+
+            // Channel ranges must not overlap
+            if ((chip.firstChannel < (chips[i].firstChannel + ADS1x1x_PartChannels(chips[i].part))) &&
+                (chips[i].firstChannel < (chip.firstChannel + channels)))
+            {
+                return false;
+            }
+        }
+
+        chips[n++] = chip;
+        nextChannel = chip.firstChannel + channels;
+    }
+
+    *count = n;
+    return n > 0;
+}
+
+/*
+ * ADS1x1x_Create
+ *
+ * Create the ADS1x1x object for a chip (or returns NULL if the part is invalid)
+ */
+ADS1x1x * ADS1x1x_Create(ADS1x1x_CHIP const * const chip)
+{
+    if (!chip) { return NULL; }
+
+    switch (chip->part)
+    {
+    case PART_ADS1013: return new ADS1013(chip->address);
+    case PART_ADS1014: return new ADS1014(chip->address);
+    case PART_ADS1015: return new ADS1015(chip->address);
+    case PART_ADS1113: return new ADS1113(chip->address);
+    case PART_ADS1114: return new ADS1114(chip->address);
+    case PART_ADS1115: return new ADS1115(chip->address);
+    default: return NULL;
+    }
+}
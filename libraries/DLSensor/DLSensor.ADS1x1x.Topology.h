@@ -0,0 +1,37 @@
+#ifndef _DLSENSOR_ADS1x1x_TOPOLOGY_H_
+#define _DLSENSOR_ADS1x1x_TOPOLOGY_H_
+
+// ADS1x1x parts have four possible addresses, so there can be at most four on one i2c bus
+#define MAX_ADS1x1x_CHIPS (4)
+#define ADS1x1x_FIRST_ADDRESS (0x48)
+#define ADS1x1x_LAST_ADDRESS (0x4B)
+
+enum ads1x1x_part
+{
+    PART_ADS1013,
+    PART_ADS1014,
+    PART_ADS1015,
+    PART_ADS1113,
+    PART_ADS1114,
+    PART_ADS1115,
+
+    INVALID_ADS1x1x_PART
+};
+typedef enum ads1x1x_part ADS1x1x_PART;
+
+/* One ADC on the bus: its part, i2c address and the platform channel number of its first input
+ (its other inputs are on the following channel numbers) */
+struct ads1x1x_chip
+{
+    ADS1x1x_PART part;
+    uint8_t address;
+    uint8_t firstChannel;
+};
+typedef struct ads1x1x_chip ADS1x1x_CHIP;
+
+ADS1x1x_PART ADS1x1x_ParsePart(char const * const name);
+uint8_t ADS1x1x_PartChannels(ADS1x1x_PART part);
+bool ADS1x1x_ParseTopology(char const * const list, ADS1x1x_CHIP * chips, uint8_t * count);
+ADS1x1x * ADS1x1x_Create(ADS1x1x_CHIP const * const chip);
+
+#endif
@@ -14,7 +14,6 @@
 
 #ifdef ARDUINO
 #include <Arduino.h>
-#include <Wire.h>
 #else
 #include <stdint.h>
 #endif
@@ -24,9 +23,9 @@
 */
 
 #include "DLSensor.ADS1x1x.h"
+#include "DLSensor.I2C.h"
 
 #ifdef TEST
-#include "DLTest.Mock.i2c.h"
 #include "DLTest.Mock.delay.h"
 #endif
 
@@ -89,6 +88,7 @@ CONFIG REGISTER
 #define ADS1x1x_REG_CONFIG_DR_1600SPS   (0x0080)  // 1600 samples per second (default)
 #define ADS1x1x_REG_CONFIG_DR_2400SPS   (0x00A0)  // 2400 samples per second
 #define ADS1x1x_REG_CONFIG_DR_3300SPS   (0x00C0)  // 3300 samples per second
+#define ADS1x1x_REG_CONFIG_DR_FASTEST   (0x00E0)  // 3300 samples per second on ADS101x, 860 on ADS111x
 
 #define ADS1x1x_REG_CONFIG_CMODE_MASK   (0x0010)
 #define ADS1x1x_REG_CONFIG_CMODE_TRAD   (0x0000)  // Traditional comparator with hysteresis (default)
@@ -110,6 +110,15 @@ CONFIG REGISTER
 
 /*=========================================================================*/
 
+/*=========================================================================
+THRESHOLD REGISTERS
+-----------------------------------------------------------------------*/
+#define ADS1x1x_LOWTHRESH_DEFAULT       (0x8000)
+#define ADS1x1x_HITHRESH_DEFAULT        (0x7FFF)
+#define ADS1x1x_LOWTHRESH_CONV_READY    (0x0000)  // Lo_thresh MSB = 0 and Hi_thresh MSB = 1 turns
+#define ADS1x1x_HITHRESH_CONV_READY     (0x8000)  // ALERT/RDY into a conversion ready output
+/*=========================================================================*/
+
 /*
 * Private Variables
 */
@@ -131,6 +140,10 @@ static const uint16_t s_channels[] = {
     ADS1x1x_REG_CONFIG_MUX_SINGLE_3  // Only available on 1x15 parts
 };
 
+// Data rates (samples per second) in order of their config register values
+static const uint16_t s_dataRates101x[] = {128, 250, 490, 920, 1600, 2400, 3300};
+static const uint16_t s_dataRates111x[] = {8, 16, 32, 64, 128, 250, 475, 860};
+
 static const uint16_t s_differentialChannels[] = {
     ADS1x1x_REG_CONFIG_MUX_DIFF_0_1,
     ADS1x1x_REG_CONFIG_MUX_DIFF_2_3,
@@ -153,9 +166,12 @@ static const uint16_t ADS1x1x_DEFAULT_COMPARATOR_CONFIG =
     ADS1x1x_REG_CONFIG_MODE_CONTIN  | // Continuous conversion mode
     ADS1x1x_REG_CONFIG_MODE_CONTIN;   // Continuous conversion mode
 
-#ifdef TEST
-extern I2CMock Wire;
-#endif
+static const uint16_t ADS1x1x_DEFAULT_CONTINUOUS_CONFIG = 
+    ADS1x1x_REG_CONFIG_CLAT_NONLAT  | // Non-latching, so ALERT/RDY pulses once per conversion
+    ADS1x1x_REG_CONFIG_CPOL_ACTVLOW | // Alert/Rdy active low   (default val)
+    ADS1x1x_REG_CONFIG_CMODE_TRAD   | // Traditional comparator (default val)
+    ADS1x1x_REG_CONFIG_DR_FASTEST   | // Fastest data rate for the part
+    ADS1x1x_REG_CONFIG_MODE_CONTIN;   // Continuous conversion mode
 
 /*
 * Private Functions 
@@ -163,41 +179,12 @@ extern I2CMock Wire;
 
 /**************************************************************************/
 /*!
-@brief  Abstract away platform differences in Arduino wire library
+@brief  Writes 16-bits to the specified destination register.
+Returns false if the transaction failed (after retries).
 */
 /**************************************************************************/
-static uint8_t i2cread(void) {
-#if ARDUINO >= 100
-    return Wire.read();
-#else
-    return Wire.receive();
-#endif
-}
-
-/**************************************************************************/
-/*!
-@brief  Abstract away platform differences in Arduino wire library
-*/
-/**************************************************************************/
-static void i2cwrite(uint8_t x) {
-#if ARDUINO >= 100
-    Wire.write((uint8_t)x);
-#else
-    Wire.send(x);
-#endif
-}
-
-/**************************************************************************/
-/*!
-@brief  Writes 16-bits to the specified destination register
-*/
-/**************************************************************************/
-static void writeRegister(uint8_t i2cAddress, uint8_t reg, uint16_t value) {
-    Wire.beginTransmission(i2cAddress);
-    i2cwrite((uint8_t)reg);
-    i2cwrite((uint8_t)(value>>8));
-    i2cwrite((uint8_t)(value & 0xFF));
-    Wire.endTransmission();
+static bool writeRegister(uint8_t i2cAddress, uint8_t reg, uint16_t value) {
+    return I2C_WriteRegister16(i2cAddress, reg, value) == I2C_OK;
 }
 
 /**************************************************************************/
@@ -207,14 +194,14 @@ In BOTH differential and single-ended modes, this value is a signed 16-bit integ
 In single-ended mode, the value CAN drop below 0 due to noise etc. 
 However, the ADC input should not be DRIVEN below 0V.
 Therefore the effective range of the single ended mode in only 15 bits (0 to 32767)
+Returns false (and sets result to 0) if the transaction failed (after retries).
 */
 /**************************************************************************/
-static int16_t readConversionRegister(uint8_t i2cAddress) {
-    Wire.beginTransmission(i2cAddress);
-    i2cwrite(ADS1x1x_REG_POINTER_CONVERT);
-    Wire.endTransmission();
-    Wire.requestFrom(i2cAddress, (uint8_t)2);
-    return ((i2cread() << 8) | i2cread());  
+static bool readConversionRegister(uint8_t i2cAddress, int16_t * result) {
+    uint16_t value = 0;
+    bool success = I2C_ReadRegister16(i2cAddress, ADS1x1x_REG_POINTER_CONVERT, &value) == I2C_OK;
+    *result = (int16_t)value;
+    return success;
 }
 
 /**************************************************************************/
@@ -245,6 +232,33 @@ static void _startComparator_SingleEnded(ADS1x1x * pParent, uint8_t channel, int
     writeRegister(pParent->getAddress(), ADS1x1x_REG_POINTER_CONFIG, config);
 }
 
+/*
+* Public Functions
+*/
+
+/**************************************************************************/
+/*!
+@brief  Gets the gain for a full-scale input range in millivolts
+(6144, 4096, 2048, 1024, 512 or 256).
+Returns false if there is no gain for that range.
+*/
+/**************************************************************************/
+bool ADS1x1x_GainFromFullScale(uint16_t millivolts, ADS_GAIN * gain)
+{
+    if (!gain) { return false; }
+
+    switch (millivolts)
+    {
+    case 6144: *gain = GAIN_TWOTHIRDS; return true;
+    case 4096: *gain = GAIN_ONE; return true;
+    case 2048: *gain = GAIN_TWO; return true;
+    case 1024: *gain = GAIN_FOUR; return true;
+    case 512: *gain = GAIN_EIGHT; return true;
+    case 256: *gain = GAIN_SIXTEEN; return true;
+    default: return false;
+    }
+}
+
 /*
  * Class Functions 
  */
@@ -259,6 +273,14 @@ ADS1x1x::ADS1x1x(uint8_t i2cAddress)
     // Set defaults for the lowest performance ADC (ADS1013)
     m_i2cAddress = i2cAddress;
     m_gain = GAIN_TWOTHIRDS; /* +/- 6.144V range (limited to VDD +0.3V max!) */
+    m_startedChannel = 0;
+    m_continuous = false;
+    m_useReadyPin = false;
+    m_readyCount = 0;
+    m_readyTaken = 0;
+    m_lastSampleMicros = 0;
+    m_missedConversions = 0;
+    m_readFailed = false;
     m_fake = false;
     m_minFakeRead[0] = m_minFakeRead[1] = m_minFakeRead[2] = m_minFakeRead[3] = 0;
     m_maxFakeRead[0] = m_maxFakeRead[1] = m_maxFakeRead[2] = m_maxFakeRead[3] = 0;
@@ -289,7 +311,17 @@ void ADS1x1x::fake(uint8_t ch, uint16_t minFakeRead, uint16_t maxFakeRead)
 */
 /**************************************************************************/
 void ADS1x1x::begin() {
-    Wire.begin();
+    I2C_Begin();
+}
+
+/**************************************************************************/
+/*!
+@brief  Checks that the ADC acknowledges its address on the i2c bus
+*/
+/**************************************************************************/
+bool ADS1x1x::isPresent(void)
+{
+    return I2C_Probe(m_i2cAddress) == I2C_OK;
 }
 
 /**************************************************************************/
@@ -325,37 +357,133 @@ uint8_t ADS1x1x::getAddress()
 /**************************************************************************/
 /*!
 @brief  Gets a single-ended ADC reading from the specified channel
+(waits for the conversion to complete)
 */
 /**************************************************************************/
 int16_t ADS1x1x::readADC_SingleEnded(uint8_t channel)
 {
-    static int8_t lastChannel = -1;
+    if (!startADC_SingleEnded(channel))
+    {
+        return 0;
+    }
 
-    if (channel >= getMaxChannels())
+    delay(getConversionTime());
+    
+    return readADC_SingleEndedResult();
+}
+
+/**************************************************************************/
+/*!
+@brief  Starts a single-shot conversion of the specified channel and returns
+without waiting for it. The result can be read with readADC_SingleEndedResult
+once getConversionTime() milliseconds have passed.
+Returns false if the channel is not available on this part,
+or if the ADC is in continuous mode (see stopContinuous).
+*/
+/**************************************************************************/
+bool ADS1x1x::startADC_SingleEnded(uint8_t channel)
+{
+    uint16_t config = getSingleEndedConfig(channel, m_gain, 0);
+
+    return (config != 0) && startADC_Config(config);
+}
+
+/**************************************************************************/
+/*!
+@brief  Gets the config register value that starts a single-shot
+conversion of a channel with the given gain and data rate
+(0 uses the default data rate). Build this once and pass it to
+startADC_Config for each conversion.
+Returns 0 if the channel or data rate is not available on this part.
+*/
+/**************************************************************************/
+uint16_t ADS1x1x::getSingleEndedConfig(uint8_t channel, ADS_GAIN gain, uint16_t samplesPerSecond)
+{
+    uint8_t i;
+    uint8_t nRates;
+    uint16_t const * pRates;
+
+    if ((channel >= getMaxChannels()) || (gain > GAIN_SIXTEEN))
     {
         return 0;
     }
 
-    // Start with default values
-    uint16_t config = ADS1x1x_DEFAULT_ADC_CONFIG;
+    // Default values, PGA/voltage range, single-ended input channel and 'start single-conversion' bit
+    uint16_t config = ADS1x1x_DEFAULT_ADC_CONFIG | s_gainSettings[gain] | s_channels[channel] | ADS1x1x_REG_CONFIG_OS_SINGLE;
 
-    // Set PGA/voltage range
-    config |= s_gainSettings[m_gain];
+    if (samplesPerSecond == 0)
+    {
+        return config;
+    }
 
-    // Set single-ended input channel
-    config |= s_channels[channel];
+    pRates = (getResolution() == 12) ? s_dataRates101x : s_dataRates111x;
+    nRates = (getResolution() == 12) ? sizeof(s_dataRates101x) / sizeof(uint16_t) : sizeof(s_dataRates111x) / sizeof(uint16_t);
 
-    // Set 'start single-conversion' bit
-    config |= ADS1x1x_REG_CONFIG_OS_SINGLE;
+    for (i = 0; i < nRates; i++)
+    {
+        if (pRates[i] == samplesPerSecond)
+        {
+            return (config & ~ADS1x1x_REG_CONFIG_DR_MASK) | (i << 5);
+        }
+    }
+
+    return 0;
+}
+
+/**************************************************************************/
+/*!
+@brief  Gets the time in milliseconds to wait for a conversion at a
+data rate (0 is the default rate, the same as getConversionTime()).
+Allows for the data rate being up to 10% slow.
+*/
+/**************************************************************************/
+uint8_t ADS1x1x::getConversionTimeAt(uint16_t samplesPerSecond)
+{
+    if (samplesPerSecond == 0)
+    {
+        return getConversionTime();
+    }
+
+    return (1100 + samplesPerSecond - 1) / samplesPerSecond;
+}
+
+/**************************************************************************/
+/*!
+@brief  Starts a single-shot conversion using a config register value
+from getSingleEndedConfig, without building it again.
+Returns false if the ADC is in continuous mode (see stopContinuous),
+or if the config could not be written.
+*/
+/**************************************************************************/
+bool ADS1x1x::startADC_Config(uint16_t config)
+{
+    if (m_continuous)
+    {
+        return false;
+    }
+
+    // Write config register to the ADC to start the conversion
+    if (!writeRegister(m_i2cAddress, ADS1x1x_REG_POINTER_CONFIG, config))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/**************************************************************************/
+/*!
+@brief  Reads the result of the last single-ended conversion started
+(0 if it could not be read, see readFailed)
+*/
+/**************************************************************************/
+int16_t ADS1x1x::readADC_SingleEndedResult(void)
+{
+    int16_t result;
+    m_readFailed = !readConversionRegister(m_i2cAddress, &result);
 
-    // Write config register to the ADC and wait for conversion complete
-    //
-    writeRegister(m_i2cAddress, ADS1x1x_REG_POINTER_CONFIG, config);
-    delay(getConversionTime());
-    
-    // Read the conversion results
     // Shift 12-bit results right 4 bits for the ADS1x15
-    return readConversionRegister(m_i2cAddress) >> getBitShift();
+    return result >> getBitShift();
 }
 
 /**************************************************************************/
@@ -421,7 +549,9 @@ int16_t ADS1x1x::readADC_DifferentialWithConfig(uint16_t differentialConfig)
     // Read the conversion results
     uint8_t bitShift = getBitShift();
 
-    uint16_t res = readConversionRegister(m_i2cAddress) >> bitShift;
+    int16_t raw;
+    m_readFailed = !readConversionRegister(m_i2cAddress, &raw);
+    uint16_t res = raw >> bitShift;
     if (bitShift == 0)
     {
         return (int16_t)res;
@@ -453,7 +583,9 @@ int16_t ADS1x1x::getLastConversionResults()
 
 // Read the conversion results
     uint8_t bitShift = getBitShift();
-    uint16_t res = readConversionRegister(m_i2cAddress) >> bitShift;
+    int16_t raw;
+    m_readFailed = !readConversionRegister(m_i2cAddress, &raw);
+    uint16_t res = raw >> bitShift;
     if (bitShift == 0)
     {
         return (int16_t)res;
@@ -471,6 +603,17 @@ int16_t ADS1x1x::getLastConversionResults()
     }
 }
 
+/**************************************************************************/
+/*!
+@brief  Returns true if the conversion register could not be read the last
+time a result was read (on every attempt), in which case that result was 0
+*/
+/**************************************************************************/
+bool ADS1x1x::readFailed(void)
+{
+    return m_readFailed;
+}
+
 void ADS1x1x::startComparator_SingleEnded(uint8_t channel, int16_t threshold)
 {
     if (hasComparator())
@@ -478,4 +621,174 @@ void ADS1x1x::startComparator_SingleEnded(uint8_t channel, int16_t threshold)
         _startComparator_SingleEnded(this, channel, threshold);    
     }
     
-}
\ No newline at end of file
+}
+
+/**************************************************************************/
+/*!
+@brief  Starts continuous conversion of a single-ended channel at the
+fastest data rate of the part (getMaxSampleRate() samples per second).
+Each result is then read with readContinuous, without writing the config.
+
+If useReadyPin is true, ALERT/RDY is set up to pulse low at the end of
+each conversion, and the application must call conversionReady() from
+the interrupt on its falling edge. Parts without ALERT/RDY cannot do this.
+Otherwise, readContinuous polls, reading a result once every sample period.
+
+Returns false if the channel is not available, the pin cannot be used,
+or the ADC could not be set up.
+*/
+/**************************************************************************/
+bool ADS1x1x::startContinuous_SingleEnded(uint8_t channel, bool useReadyPin, unsigned long nowMicros)
+{
+    if (channel >= getMaxChannels())
+    {
+        return false;
+    }
+
+    if (useReadyPin && !hasComparator())
+    {
+        return false;
+    }
+
+    // Start with default values
+    uint16_t config = ADS1x1x_DEFAULT_CONTINUOUS_CONFIG;
+
+    // Set PGA/voltage range
+    config |= s_gainSettings[m_gain];
+
+    // Set single-ended input channel
+    config |= s_channels[channel];
+
+    if (useReadyPin)
+    {
+        // Assert ALERT/RDY after every conversion
+        config |= ADS1x1x_REG_CONFIG_CQUE_1CONV;
+        if (!writeRegister(m_i2cAddress, ADS1x1x_REG_POINTER_LOWTHRESH, ADS1x1x_LOWTHRESH_CONV_READY) ||
+            !writeRegister(m_i2cAddress, ADS1x1x_REG_POINTER_HITHRESH, ADS1x1x_HITHRESH_CONV_READY))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        config |= ADS1x1x_REG_CONFIG_CQUE_NONE;
+    }
+
+    // Write config register to the ADC to start converting
+    if (!writeRegister(m_i2cAddress, ADS1x1x_REG_POINTER_CONFIG, config))
+    {
+        return false;
+    }
+
+    m_continuous = true;
+    m_useReadyPin = useReadyPin;
+    m_readyTaken = m_readyCount;
+    m_lastSampleMicros = nowMicros;
+    m_missedConversions = 0;
+
+    return true;
+}
+
+/**************************************************************************/
+/*!
+@brief  Signals the end of a continuous conversion.
+Call from the ALERT/RDY falling edge interrupt: this only counts the edge,
+the conversion register is read by the next readContinuous.
+*/
+/**************************************************************************/
+void ADS1x1x::conversionReady(void)
+{
+    m_readyCount++;
+}
+
+/**************************************************************************/
+/*!
+@brief  Reads the latest continuous conversion into result, if there is
+a new one since the last read. Returns false if there is not, or if it
+could not be read (see readFailed).
+Conversions that finished without being read are counted as missed.
+
+nowMicros is the time in microseconds (e.g. from micros()),
+and is only used when polling.
+*/
+/**************************************************************************/
+bool ADS1x1x::readContinuous(int16_t * result, unsigned long nowMicros)
+{
+    uint8_t ready;
+    unsigned long period;
+    unsigned long elapsed;
+
+    if (!result || !m_continuous)
+    {
+        return false;
+    }
+
+    if (m_useReadyPin)
+    {
+        // Only conversionReady() writes m_readyCount, so there is no need to stop interrupts
+        ready = m_readyCount - m_readyTaken;
+        if (ready == 0) { return false; }
+        m_readyTaken += ready;
+        m_missedConversions += ready - 1;
+    }
+    else
+    {
+        period = 1000000UL / getMaxSampleRate();
+        elapsed = nowMicros - m_lastSampleMicros;
+        if (elapsed < period) { return false; }
+        m_missedConversions += (elapsed / period) - 1;
+        m_lastSampleMicros = nowMicros - (elapsed % period);
+    }
+
+    int16_t raw;
+    m_readFailed = !readConversionRegister(m_i2cAddress, &raw);
+    if (m_readFailed)
+    {
+        return false;
+    }
+
+    // Shift 12-bit results right 4 bits for the ADS1x15
+    *result = raw >> getBitShift();
+    return true;
+}
+
+/**************************************************************************/
+/*!
+@brief  Ends continuous conversion. The thresholds are put back to their
+defaults and the ADC powers down after its current conversion.
+*/
+/**************************************************************************/
+void ADS1x1x::stopContinuous(void)
+{
+    if (!m_continuous)
+    {
+        return;
+    }
+
+    if (m_useReadyPin)
+    {
+        writeRegister(m_i2cAddress, ADS1x1x_REG_POINTER_LOWTHRESH, ADS1x1x_LOWTHRESH_DEFAULT);
+        writeRegister(m_i2cAddress, ADS1x1x_REG_POINTER_HITHRESH, ADS1x1x_HITHRESH_DEFAULT);
+    }
+
+    writeRegister(m_i2cAddress, ADS1x1x_REG_POINTER_CONFIG, ADS1x1x_DEFAULT_ADC_CONFIG | s_gainSettings[m_gain]);
+
+    m_continuous = false;
+    m_useReadyPin = false;
+}
+
+bool ADS1x1x::isContinuous(void)
+{
+    return m_continuous;
+}
+
+/**************************************************************************/
+/*!
+@brief  Gets the number of continuous conversions that were not read
+before the next one finished (since continuous mode was started)
+*/
+/**************************************************************************/
+uint32_t ADS1x1x::missedConversions(void)
+{
+    return m_missedConversions;
+}
@@ -18,6 +18,8 @@ enum ads_gain
 };
 typedef enum ads_gain ADS_GAIN;
 
+bool ADS1x1x_GainFromFullScale(uint16_t millivolts, ADS_GAIN * gain);
+
 /* Generic class for all ADS1x1x ADCs */
 class ADS1x1x
 {
@@ -28,28 +30,57 @@ class ADS1x1x
 
         int16_t readADC_DifferentialWithConfig(uint16_t);
 
+        // Channel of the last conversion started (only used by the fake ADC in DLTest)
+        uint8_t m_startedChannel;
+
+        // Continuous conversion state
+        bool m_continuous;
+        bool m_useReadyPin;
+        volatile uint8_t m_readyCount; // Only written by conversionReady()
+        uint8_t m_readyTaken;
+        unsigned long m_lastSampleMicros;
+        uint32_t m_missedConversions;
+
+        bool m_readFailed;
+
         bool m_fake;
         uint16_t m_minFakeRead[4];
         uint16_t m_maxFakeRead[4];
 
     public:
         ADS1x1x(uint8_t i2cAddress = DEFAULT_ADS1x1x_ADDRESS);
+        virtual ~ADS1x1x() {}
 
         void      fake(uint8_t ch, uint16_t minFakeRead, uint16_t maxFakeRead);
         void      begin(void);
+        bool      isPresent(void);
         int16_t   readADC_SingleEnded(uint8_t channel);
+        bool      startADC_SingleEnded(uint8_t channel);
+        uint16_t  getSingleEndedConfig(uint8_t channel, ADS_GAIN gain, uint16_t samplesPerSecond);
+        uint8_t   getConversionTimeAt(uint16_t samplesPerSecond);
+        bool      startADC_Config(uint16_t config);
+        int16_t   readADC_SingleEndedResult(void);
         int16_t   readADC_Differential(uint8_t channel);
         int16_t   getLastConversionResults();
+        bool      readFailed(void);
         void      setGain(ADS_GAIN gain);
         ADS_GAIN  getGain(void);
         uint8_t   getAddress(void);
         void      startComparator_SingleEnded(uint8_t channel, int16_t threshold);
 
+        bool      startContinuous_SingleEnded(uint8_t channel, bool useReadyPin, unsigned long nowMicros);
+        void      conversionReady(void);
+        bool      readContinuous(int16_t * result, unsigned long nowMicros);
+        void      stopContinuous(void);
+        bool      isContinuous(void);
+        uint32_t  missedConversions(void);
+
         virtual uint8_t getMaxChannels(void) = 0;
         virtual uint8_t  getConversionTime(void) = 0;
         virtual uint8_t  getResolution(void) = 0;
         virtual bool hasComparator(void) = 0;
         virtual uint8_t getBitShift(void) = 0;
+        virtual uint16_t getMaxSampleRate(void) = 0;
 };
 
 class ADS1013 : public ADS1x1x
@@ -61,6 +92,7 @@ class ADS1013 : public ADS1x1x
         uint8_t getResolution(void) { return 12; };
         uint8_t getBitShift(void) { return 4; }
         uint8_t getConversionTime(void) { return 1; }
+        uint16_t getMaxSampleRate(void) { return 3300; }
 };
 
 class ADS1014 : public ADS1x1x
@@ -73,6 +105,7 @@ class ADS1014 : public ADS1x1x
         uint8_t getResolution(void) { return 12; };
         uint8_t getBitShift(void) { return 4; }
         uint8_t getConversionTime(void) { return 1; }
+        uint16_t getMaxSampleRate(void) { return 3300; }
 };
 
 class ADS1015 : public ADS1x1x
@@ -86,6 +119,7 @@ class ADS1015 : public ADS1x1x
         uint8_t getResolution(void) { return 12; };
         uint8_t getBitShift(void) { return 4; }
         uint8_t getConversionTime(void) { return 1; }
+        uint16_t getMaxSampleRate(void) { return 3300; }
 };
 
 class ADS1113 : public ADS1x1x
@@ -97,6 +131,7 @@ class ADS1113 : public ADS1x1x
         uint8_t getResolution(void) { return 16; };
         uint8_t getBitShift(void) { return 0; }
         uint8_t getConversionTime(void) { return 12; }
+        uint16_t getMaxSampleRate(void) { return 860; }
 };
 
 class ADS1114 : public ADS1x1x
@@ -109,6 +144,7 @@ class ADS1114 : public ADS1x1x
         uint8_t getResolution(void) { return 16; };
         uint8_t getBitShift(void) { return 0; }
         uint8_t getConversionTime(void) { return 12; }
+        uint16_t getMaxSampleRate(void) { return 860; }
 };
 
 class ADS1115 : public ADS1x1x
@@ -122,5 +158,6 @@ class ADS1115 : public ADS1x1x
         uint8_t getResolution(void) { return 16; };
         uint8_t getBitShift(void) { return 0; }
         uint8_t getConversionTime(void) { return 12; }
+        uint16_t getMaxSampleRate(void) { return 860; }
 };
 #endif
\ No newline at end of file
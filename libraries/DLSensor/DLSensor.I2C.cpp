@@ -0,0 +1,387 @@
+/*
+* DLSensor.I2C.cpp
+*
+* i2c register transactions with timeouts, retries and per-device counters
+*
+* Author: James Fowkes
+*
+* www.re-innovation.co.uk
+*/
+
+/*
+* Arduino/C++ Library Includes
+*/
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <Wire.h>
+#else
+#include <stdint.h>
+#include <string.h>
+#endif
+
+/*
+* Local Application Includes
+*/
+
+#include "DLSensor.I2C.h"
+
+#ifdef TEST
+#include "DLTest.Mock.i2c.h"
+extern I2CMock Wire;
+#endif
+
+/*
+* Defines and Typedefs
+*/
+
+// The register pointer of a device is not known (e.g. after a failed transaction)
+#define UNKNOWN_POINTER (0xFF)
+
+/*
+* Private Variables
+*/
+
+static I2C_DEVICE_STATS s_devices[MAX_I2C_DEVICES];
+static uint8_t s_pointers[MAX_I2C_DEVICES];
+static uint8_t s_deviceCount = 0;
+
+// Transactions with devices that do not fit in s_devices
+static I2C_DEVICE_STATS s_otherDevices;
+
+#ifdef ARDUINO
+static unsigned long arduinoMicros(void) { return micros(); }
+static I2C_CLOCK_FN * s_clockFn = arduinoMicros;
+#else
+static I2C_CLOCK_FN * s_clockFn = NULL;
+#endif
+
+static unsigned long s_timeout = I2C_DEFAULT_TIMEOUT_US;
+static uint8_t s_attempts = I2C_DEFAULT_ATTEMPTS;
+
+/*
+* Private Functions
+*/
+
+/*
+ * i2cread, i2cwrite
+ *
+ * Abstract away platform differences in Arduino wire library
+ */
+static uint8_t i2cread(void)
+{
+#if ARDUINO >= 100
+    return Wire.read();
+#else
+    return Wire.receive();
+#endif
+}
+
+static void i2cwrite(uint8_t x)
+{
+#if ARDUINO >= 100
+    Wire.write((uint8_t)x);
+#else
+    Wire.send(x);
+#endif
+}
+
+static unsigned long now(void)
+{
+    return s_clockFn ? s_clockFn() : 0;
+}
+
+/*
+ * timedOut
+ *
+ * Returns true if more than the timeout has passed since start (never with no clock)
+ */
+static bool timedOut(unsigned long start)
+{
+    return s_clockFn ? ((s_clockFn() - start) > s_timeout) : false;
+}
+
+/*
+ * getDevice
+ *
+ * Returns the index of a device in s_devices, adding it if there is space (-1 if there is not)
+ */
+static int8_t getDevice(uint8_t address)
+{
+    uint8_t i;
+
+    for (i = 0; i < s_deviceCount; i++)
+    {
+        if (s_devices[i].address == address) { return i; }
+    }
+
+    if (s_deviceCount == MAX_I2C_DEVICES) { return -1; }
+
+    memset(&s_devices[s_deviceCount], 0, sizeof(I2C_DEVICE_STATS));
+    s_devices[s_deviceCount].address = address;
+    s_pointers[s_deviceCount] = UNKNOWN_POINTER;
+    return s_deviceCount++;
+}
+
+/*
+ * resultFromWireStatus
+ *
+ * Converts an endTransmission status (0 success, 2 address NACK, 3 data NACK,
+ * 5 timeout on platforms that have one, anything else a bus error)
+ */
+static I2C_RESULT resultFromWireStatus(uint8_t status)
+{
+    switch (status)
+    {
+    case 0:
+        return I2C_OK;
+    case 2:
+    case 3:
+        return I2C_NACK;
+    case 5:
+        return I2C_TIMEOUT;
+    default:
+        return I2C_BUS_ERROR;
+    }
+}
+
+/*
+ * attempt
+ *
+ * One attempt at a transaction: write nWrite bytes, then read nRead bytes.
+ * If there is both a write and a read, the bus is not released between them.
+ */
+static I2C_RESULT attempt(uint8_t address, uint8_t const * toWrite, uint8_t nWrite, uint8_t * toRead, uint8_t nRead)
+{
+    uint8_t i;
+    uint8_t status;
+    unsigned long start = now();
+
+    if (nWrite || !nRead)
+    {
+        Wire.beginTransmission(address);
+        for (i = 0; i < nWrite; i++)
+        {
+            i2cwrite(toWrite[i]);
+        }
+        status = Wire.endTransmission(nRead ? 0 : 1);
+        if (status != 0) { return resultFromWireStatus(status); }
+    }
+
+    if (nRead)
+    {
+        if (Wire.requestFrom(address, nRead) == 0) { return I2C_NACK; }
+
+        // Some platforms return before all the data has arrived (with no clock, there is no waiting for it)
+        if (s_clockFn)
+        {
+            while ((Wire.available() < nRead) && !timedOut(start)) {}
+        }
+        if (Wire.available() < nRead) { return I2C_TIMEOUT; }
+
+        for (i = 0; i < nRead; i++)
+        {
+            toRead[i] = i2cread();
+        }
+    }
+
+    return I2C_OK;
+}
+
+/*
+ * transaction
+ *
+ * Attempt a transaction until it succeeds or all attempts fail, updating the device counters.
+ * For a register read (pointer is not UNKNOWN_POINTER), the pointer write is left out
+ * if the device's pointer is already on that register.
+ */
+static I2C_RESULT transaction(uint8_t address, uint8_t pointer, uint8_t const * toWrite, uint8_t nWrite, uint8_t * toRead, uint8_t nRead)
+{
+    uint8_t n;
+    uint8_t writeCount;
+    unsigned long start = now();
+    unsigned long attemptStart;
+    unsigned long latency;
+    I2C_RESULT result = I2C_BUS_ERROR;
+
+    int8_t index = getDevice(address);
+    I2C_DEVICE_STATS * pStats = (index >= 0) ? &s_devices[index] : &s_otherDevices;
+
+    for (n = 0; n < s_attempts; n++)
+    {
+        if (n > 0) { pStats->retries++; }
+
+        writeCount = nWrite;
+        if ((index >= 0) && (pointer != UNKNOWN_POINTER) && (s_pointers[index] == pointer))
+        {
+            writeCount = 0;
+        }
+
+        attemptStart = now();
+        result = attempt(address, toWrite, writeCount, toRead, nRead);
+
+        // A failed transaction could have left the pointer anywhere
+        if (index >= 0)
+        {
+            if (result != I2C_OK) { s_pointers[index] = UNKNOWN_POINTER; }
+            else if (nWrite) { s_pointers[index] = toWrite[0]; }
+        }
+
+        if (result == I2C_OK)
+        {
+            // The wire library has no timeout of its own on most platforms, so a slow attempt is
+            // only seen once it has finished: its data is good, so it is counted rather than failed
+            if ((now() - attemptStart) > s_timeout) { pStats->overruns++; }
+            break;
+        }
+
+        switch (result)
+        {
+        case I2C_NACK:
+            pStats->nacks++;
+            break;
+        case I2C_TIMEOUT:
+            pStats->timeouts++;
+            break;
+        default:
+            pStats->busErrors++;
+            break;
+        }
+    }
+
+    latency = now() - start;
+    pStats->transactions++;
+    pStats->lastLatency = latency;
+    pStats->totalLatency += latency;
+    if (latency > pStats->maxLatency) { pStats->maxLatency = latency; }
+    if (result != I2C_OK) { pStats->failures++; }
+
+    return result;
+}
+
+/*
+* Public Functions
+*/
+
+void I2C_Begin(void)
+{
+    Wire.begin();
+}
+
+/*
+ * I2C_SetClock
+ *
+ * Set the function that gives the time in microseconds (micros() by default on Arduino).
+ * With no clock (NULL), reads do not wait for data that has not arrived yet, and latencies are not measured.
+ */
+void I2C_SetClock(I2C_CLOCK_FN * clockFn)
+{
+    s_clockFn = clockFn;
+}
+
+void I2C_SetTimeout(unsigned long timeoutMicros)
+{
+    s_timeout = timeoutMicros;
+}
+
+/*
+ * I2C_SetAttempts
+ *
+ * Set the number of times each transaction is tried (1 to I2C_MAX_ATTEMPTS)
+ */
+bool I2C_SetAttempts(uint8_t attempts)
+{
+    if ((attempts == 0) || (attempts > I2C_MAX_ATTEMPTS)) { return false; }
+    s_attempts = attempts;
+    return true;
+}
+
+/*
+ * I2C_Probe
+ *
+ * Check that a device acknowledges its address (with an empty write)
+ */
+I2C_RESULT I2C_Probe(uint8_t address)
+{
+    return transaction(address, UNKNOWN_POINTER, NULL, 0, NULL, 0);
+}
+
+/*
+ * I2C_WriteRegister16
+ *
+ * Write a 16-bit register, most significant byte first (this leaves the device's pointer on reg)
+ */
+I2C_RESULT I2C_WriteRegister16(uint8_t address, uint8_t reg, uint16_t value)
+{
+    uint8_t toWrite[] = {reg, (uint8_t)(value >> 8), (uint8_t)(value & 0xFF)};
+    return transaction(address, UNKNOWN_POINTER, toWrite, 3, NULL, 0);
+}
+
+/*
+ * I2C_ReadRegister16
+ *
+ * Read a 16-bit register, most significant byte first.
+ * value is only written if the read succeeds.
+ */
+I2C_RESULT I2C_ReadRegister16(uint8_t address, uint8_t reg, uint16_t * value)
+{
+    uint8_t toRead[2];
+    I2C_RESULT result;
+
+    if (!value) { return I2C_BUS_ERROR; }
+
+    result = transaction(address, reg, &reg, 1, toRead, 2);
+    if (result == I2C_OK)
+    {
+        *value = ((uint16_t)toRead[0] << 8) | toRead[1];
+    }
+    return result;
+}
+
+uint8_t I2C_GetDeviceCount(void)
+{
+    return s_deviceCount;
+}
+
+/*
+ * I2C_GetDeviceStats
+ *
+ * Returns the counters of each device in the order they were first used (NULL past the last)
+ */
+I2C_DEVICE_STATS const * I2C_GetDeviceStats(uint8_t index)
+{
+    return (index < s_deviceCount) ? &s_devices[index] : NULL;
+}
+
+/*
+ * I2C_GetStats
+ *
+ * Returns the counters for an address (NULL if it has not been used, or does not have its own counters)
+ */
+I2C_DEVICE_STATS const * I2C_GetStats(uint8_t address)
+{
+    uint8_t i;
+
+    for (i = 0; i < s_deviceCount; i++)
+    {
+        if (s_devices[i].address == address) { return &s_devices[i]; }
+    }
+    return NULL;
+}
+
+uint32_t I2C_MeanLatency(I2C_DEVICE_STATS const * pStats)
+{
+    if (!pStats || (pStats->transactions == 0)) { return 0; }
+    return pStats->totalLatency / pStats->transactions;
+}
+
+/*
+ * I2C_ResetStats
+ *
+ * Forget all devices and their counters (register pointers are also forgotten, so the next read of each writes it)
+ */
+void I2C_ResetStats(void)
+{
+    s_deviceCount = 0;
+    memset(&s_otherDevices, 0, sizeof(I2C_DEVICE_STATS));
+}
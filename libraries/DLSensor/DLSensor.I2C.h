@@ -0,0 +1,68 @@
+#ifndef _DLSENSOR_I2C_H_
+#define _DLSENSOR_I2C_H_
+
+// Devices with their own counters (transactions with any others are counted together, as address 0)
+#define MAX_I2C_DEVICES (8)
+
+#define I2C_DEFAULT_TIMEOUT_US (5000)
+#define I2C_DEFAULT_ATTEMPTS (3)
+#define I2C_MAX_ATTEMPTS (10)
+
+enum i2c_result
+{
+    I2C_OK,
+    I2C_NACK,
+    I2C_TIMEOUT,
+    I2C_BUS_ERROR
+};
+typedef enum i2c_result I2C_RESULT;
+
+/* Counters for one device since startup (or I2C_ResetStats). Latencies are in microseconds,
+ for the whole transaction including any retries. */
+struct i2c_device_stats
+{
+    uint8_t address;
+    uint32_t transactions;
+    uint32_t failures; // Transactions that failed on every attempt
+    uint32_t nacks;
+    uint32_t timeouts;
+    uint32_t busErrors;
+    uint32_t retries;
+    uint32_t overruns; // Successful attempts that took longer than the timeout
+    uint32_t lastLatency;
+    uint32_t maxLatency;
+    uint32_t totalLatency;
+};
+typedef struct i2c_device_stats I2C_DEVICE_STATS;
+
+typedef unsigned long (I2C_CLOCK_FN)(void);
+
+/*
+ * i2c transactions
+ *
+ * Each transaction is attempted up to the set number of times. An attempt fails if the device
+ * does not acknowledge, the bus reports an error, or the data read has not all arrived within the timeout.
+ * An attempt that succeeds but takes longer than the timeout is not failed (its data is good),
+ * but is counted as an overrun.
+ *
+ * Register reads are for devices with a register pointer that keeps its value (like the ADS1x1x).
+ * The pointer is written and the register read in one transaction (with a repeated start),
+ * and the pointer is not written at all if the last transaction with the device left it on that register.
+ */
+
+void I2C_Begin(void);
+void I2C_SetClock(I2C_CLOCK_FN * clockFn);
+void I2C_SetTimeout(unsigned long timeoutMicros);
+bool I2C_SetAttempts(uint8_t attempts);
+
+I2C_RESULT I2C_Probe(uint8_t address);
+I2C_RESULT I2C_WriteRegister16(uint8_t address, uint8_t reg, uint16_t value);
+I2C_RESULT I2C_ReadRegister16(uint8_t address, uint8_t reg, uint16_t * value);
+
+uint8_t I2C_GetDeviceCount(void);
+I2C_DEVICE_STATS const * I2C_GetDeviceStats(uint8_t index);
+I2C_DEVICE_STATS const * I2C_GetStats(uint8_t address);
+uint32_t I2C_MeanLatency(I2C_DEVICE_STATS const * pStats);
+void I2C_ResetStats(void);
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * LinkIT ONE
+ *
+ * ADS1115 continuous conversion example on the LinkItONE platform.
+ *
+ * Basic summary:
+ *
+ * - Samples one channel of an ADS1115 at its full data rate (860 samples per second).
+ * - ALERT/RDY is connected to D2 and signals the end of each conversion.
+ * - Sends the mean, minimum and maximum of each second of samples to the serial port.
+ * - Set USE_READY_PIN to 0 to poll instead (if ALERT/RDY is not connected).
+ */
+
+/*
+ * Standard Library Includes
+ */
+#include <stdint.h>
+
+/*
+ * Arduino Library Includes
+ */
+
+#include <Wire.h>
+
+/*
+ * LinkIt One Includes
+ */
+
+/*
+ * DataLogger Includes
+ */
+
+#include "DLUtility.h"
+#include "DLSettings.h"
+#include "DLSensor.ADS1x1x.h"
+#include "DLDataField.h"
+
+#define USE_READY_PIN 1
+#define READY_INTERRUPT 0 // D2
+
+static ADS1115 s_adc(0x48);
+
+static int32_t s_sum = 0;
+static int16_t s_min = 32767;
+static int16_t s_max = -32768;
+static uint16_t s_count = 0;
+
+static void readyISR(void)
+{
+    s_adc.conversionReady();
+}
+
+void setup()
+{
+    // setup Serial port
+    Serial.begin(115200);
+
+    s_adc.begin();
+    s_adc.setGain(GAIN_ONE);
+
+    #if USE_READY_PIN
+    attachInterrupt(READY_INTERRUPT, readyISR, FALLING);
+    #endif
+
+    s_adc.startContinuous_SingleEnded(0, USE_READY_PIN, micros());
+}
+
+void loop()
+{
+    int16_t result;
+
+    if (!s_adc.readContinuous(&result, micros())) { return; }
+
+    s_sum += result;
+    s_min = min(s_min, result);
+    s_max = max(s_max, result);
+
+    if (++s_count == s_adc.getMaxSampleRate())
+    {
+        Serial.print("Mean: "); Serial.print(s_sum / s_count);
+        Serial.print(", Min: "); Serial.print(s_min);
+        Serial.print(", Max: "); Serial.print(s_max);
+        Serial.print(", Missed: "); Serial.println(s_adc.missedConversions());
+
+        s_sum = 0;
+        s_min = 32767;
+        s_max = -32768;
+        s_count = 0;
+    }
+}
@@ -0,0 +1,224 @@
+/*
+ * DLSensor.ADS1x1x.Scanner.Test.cpp
+ *
+ * Tests the non-blocking ADS1x1x scanner
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <iostream>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLSensor.ADS1x1x.h"
+#include "DLSensor.ADS1x1x.Scanner.h"
+#include "DLSensor.I2C.h"
+#include "DLTest.Mock.i2c.h"
+
+/*
+ * Private Test Objects/Variables
+ */
+
+extern I2CMock Wire;
+
+static uint8_t s_sendBuffer[64];
+static uint8_t s_recvdBuffer[32];
+
+static ADS1115 s_adc0(0x48);
+static ADS1115 s_adc1(0x49);
+static ADS1113 s_adc2(0x4A);
+
+static ADS1x1xScanner * s_scanner;
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+void setUp()
+{
+    uint8_t i;
+
+    // Each conversion read returns the next value: 1, 2, 3...
+    for (i = 0; i < 16; i++)
+    {
+        s_recvdBuffer[i * 2] = 0;
+        s_recvdBuffer[(i * 2) + 1] = i + 1;
+    }
+
+    Wire.setSentBuffer(s_sendBuffer);
+    Wire.setRecvdBuffer(s_recvdBuffer);
+
+    s_scanner = new ADS1x1xScanner();
+    s_scanner->addADC(&s_adc0);
+    s_scanner->addADC(&s_adc1);
+    s_scanner->addADC(&s_adc2);
+}
+
+void tearDown()
+{
+    delete s_scanner;
+}
+
+void test_ConversionsStartOnAllADCsTogether()
+{
+    TEST_ASSERT_TRUE(s_scanner->start(0x0FFF, 1000));
+    TEST_ASSERT_TRUE(s_scanner->busy());
+
+    // Three config register writes (pointer + two bytes each), no reads
+    TEST_ASSERT_EQUAL(9, Wire.sentCount());
+    TEST_ASSERT_EQUAL(0, Wire.recvdCount());
+
+    // A scan cannot be started while one is in progress
+    TEST_ASSERT_FALSE(s_scanner->start(0x0FFF, 1001));
+
+    // Nothing is read until the conversion time has passed
+    TEST_ASSERT_FALSE(s_scanner->tick(1012));
+    TEST_ASSERT_EQUAL(9, Wire.sentCount());
+
+    // Then each ADC is read and starts its next channel
+    TEST_ASSERT_FALSE(s_scanner->tick(1013));
+    TEST_ASSERT_EQUAL(9 + (3 * 4), Wire.sentCount());
+    TEST_ASSERT_EQUAL(6, Wire.recvdCount());
+}
+
+void test_ScanTakesOneConversionTimePerChannel()
+{
+    unsigned long now = 1000;
+    uint8_t finished = 0;
+
+    s_scanner->start(0x0FFF, now);
+
+    // The ADS1113 only has two channels, so the ADS1115s take longest (four conversions)
+    for (now = 1000; now <= 1100; now++)
+    {
+        if (s_scanner->tick(now))
+        {
+            finished++;
+            TEST_ASSERT_EQUAL(1000 + (4 * 13), now);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(1, finished);
+    TEST_ASSERT_FALSE(s_scanner->busy());
+
+    // Results are read in turn from each ADC at each step
+    TEST_ASSERT_EQUAL(1, s_scanner->getResult(0, 0));
+    TEST_ASSERT_EQUAL(2, s_scanner->getResult(1, 0));
+    TEST_ASSERT_EQUAL(3, s_scanner->getResult(2, 0));
+    TEST_ASSERT_EQUAL(4, s_scanner->getResult(0, 1));
+    TEST_ASSERT_EQUAL(6, s_scanner->getResult(2, 1));
+    TEST_ASSERT_EQUAL(0, s_scanner->getResult(2, 2));
+    TEST_ASSERT_EQUAL(7, s_scanner->getResult(0, 2));
+    TEST_ASSERT_EQUAL(8, s_scanner->getResult(1, 2));
+    TEST_ASSERT_EQUAL(9, s_scanner->getResult(0, 3));
+    TEST_ASSERT_EQUAL(10, s_scanner->getResult(1, 3));
+}
+
+void test_OnlyMaskedChannelsAreRead()
+{
+    // Channel 1 of the second ADC, and channel 3 of the third (which it does not have)
+    s_scanner->start(0x0820, 1000);
+    TEST_ASSERT_EQUAL(3, Wire.sentCount());
+
+    TEST_ASSERT_TRUE(s_scanner->tick(1013));
+    TEST_ASSERT_EQUAL(2, Wire.recvdCount());
+    TEST_ASSERT_EQUAL(1, s_scanner->getResult(1, 1));
+    TEST_ASSERT_EQUAL(0, s_scanner->getResult(1, 0));
+}
+
+void test_EmptyScanFinishesOnFirstTick()
+{
+    TEST_ASSERT_TRUE(s_scanner->start(0, 1000));
+    TEST_ASSERT_EQUAL(0, Wire.sentCount());
+    TEST_ASSERT_TRUE(s_scanner->tick(1000));
+    TEST_ASSERT_FALSE(s_scanner->tick(1001));
+}
+
+void test_ChannelsAreConvertedWithTheirOwnConfig()
+{
+    // Gain of 16 at 860 samples per second takes at most 2ms
+    TEST_ASSERT_TRUE(s_scanner->configureChannel(0, 0, GAIN_SIXTEEN, 860, 1));
+
+    s_scanner->start(0x0001, 1000);
+    TEST_ASSERT_EQUAL(3, Wire.sentCount());
+    TEST_ASSERT_EQUAL_UINT8(0xCB, s_sendBuffer[1]);
+    TEST_ASSERT_EQUAL_UINT8(0xE3, s_sendBuffer[2]);
+
+    TEST_ASSERT_FALSE(s_scanner->tick(1002));
+    TEST_ASSERT_TRUE(s_scanner->tick(1003));
+    TEST_ASSERT_EQUAL(3, s_scanner->scanTime(0x0001));
+}
+
+void test_OversampledChannelsAreAveraged()
+{
+    unsigned long now;
+
+    // Channel 0 of the third ADC, converted four times (readings 1 to 4)
+    TEST_ASSERT_TRUE(s_scanner->configureChannel(2, 0, GAIN_ONE, 0, 4));
+    TEST_ASSERT_EQUAL(4 * 13, s_scanner->scanTime(0x0100));
+
+    s_scanner->start(0x0100, 1000);
+    for (now = 1000; now < 1000 + (4 * 13); now++)
+    {
+        TEST_ASSERT_FALSE(s_scanner->tick(now));
+    }
+    TEST_ASSERT_TRUE(s_scanner->tick(now));
+
+    // Four config writes and four conversion register reads
+    TEST_ASSERT_EQUAL(4 * (3 + 1), Wire.sentCount());
+    TEST_ASSERT_EQUAL(4 * 2, Wire.recvdCount());
+    TEST_ASSERT_EQUAL(2, s_scanner->getResult(2, 0));
+}
+
+void test_InvalidChannelConfigsAreRejected()
+{
+    // 3300 samples per second is only available on ADS101x parts
+    TEST_ASSERT_FALSE(s_scanner->configureChannel(0, 0, GAIN_ONE, 3300, 1));
+    TEST_ASSERT_FALSE(s_scanner->configureChannel(0, 0, GAIN_ONE, 0, 0));
+    TEST_ASSERT_FALSE(s_scanner->configureChannel(0, 0, GAIN_ONE, 0, MAX_SCANNER_OVERSAMPLE + 1));
+    TEST_ASSERT_FALSE(s_scanner->configureChannel(2, 2, GAIN_ONE, 0, 1));
+    TEST_ASSERT_FALSE(s_scanner->configureChannel(3, 0, GAIN_ONE, 0, 1));
+}
+
+void test_ChannelsKeepTheirResultIfItCannotBeRead()
+{
+    s_scanner->start(0x0001, 1000);
+    TEST_ASSERT_TRUE(s_scanner->tick(1013));
+    TEST_ASSERT_EQUAL(1, s_scanner->getResult(0, 0));
+
+    // Every attempt to read the next result is NACKed
+    s_scanner->start(0x0001, 2000);
+    Wire.failNext(I2C_DEFAULT_ATTEMPTS, 2);
+    TEST_ASSERT_TRUE(s_scanner->tick(2013));
+    TEST_ASSERT_EQUAL(1, s_scanner->getResult(0, 0));
+    TEST_ASSERT_EQUAL(1, s_scanner->failedResults());
+}
+
+int main(void)
+{
+    UnityBegin("DLSensor.ADS1x1x.Scanner.Test.cpp");
+
+    RUN_TEST(test_ConversionsStartOnAllADCsTogether);
+    RUN_TEST(test_ScanTakesOneConversionTimePerChannel);
+    RUN_TEST(test_OnlyMaskedChannelsAreRead);
+    RUN_TEST(test_EmptyScanFinishesOnFirstTick);
+    RUN_TEST(test_ChannelsAreConvertedWithTheirOwnConfig);
+    RUN_TEST(test_OversampledChannelsAreAveraged);
+    RUN_TEST(test_InvalidChannelConfigsAreRejected);
+    RUN_TEST(test_ChannelsKeepTheirResultIfItCannotBeRead);
+
+    UnityEnd();
+    return 0;
+}
@@ -24,6 +24,7 @@
  */
 
 #include "../DLSensor.ADS1x1x.h"
+#include "../DLSensor.I2C.h"
 #include "../../DLTest/DLTest.Mock.i2c.h"
 
 /*
@@ -170,6 +171,144 @@ void test_ADS1x15_WillReadFromAllChannels()
     TEST_ASSERT_EQUAL(8, Wire.recvdCount());
 }
 
+void test_ADS1x1xIsPresentIfItsAddressIsAcknowledged()
+{
+    ADS1115 adc48 = ADS1115(0x48);
+    ADS1115 adc49 = ADS1115(0x49);
+
+    Wire.setNackAddress(0x49);
+    TEST_ASSERT_TRUE(adc48.isPresent());
+    TEST_ASSERT_FALSE(adc49.isPresent());
+    Wire.setNackAddress(0);
+}
+
+void test_ADS1x1xReportsReadsThatFail()
+{
+    ADS1115 adc = ADS1115();
+
+    s_recvdBuffer[0] = 0x12; s_recvdBuffer[1] = 0x34;
+
+    // A config write that fails on every attempt does not start a conversion
+    Wire.failNext(I2C_DEFAULT_ATTEMPTS, 3);
+    TEST_ASSERT_FALSE(adc.startADC_SingleEnded(0));
+
+    TEST_ASSERT_TRUE(adc.startADC_SingleEnded(0));
+    Wire.failNext(I2C_DEFAULT_ATTEMPTS, 2);
+    TEST_ASSERT_EQUAL(0, adc.readADC_SingleEndedResult());
+    TEST_ASSERT_TRUE(adc.readFailed());
+
+    TEST_ASSERT_EQUAL(0x1234, adc.readADC_SingleEndedResult());
+    TEST_ASSERT_FALSE(adc.readFailed());
+}
+
+void test_ConfigIsBuiltForEachDataRate()
+{
+    ADS1015 adc1015 = ADS1015();
+    ADS1115 adc1115 = ADS1115();
+
+    // Default rate, gain 1, AIN2, single-shot
+    TEST_ASSERT_EQUAL_UINT16(0xE383, adc1115.getSingleEndedConfig(2, GAIN_ONE, 0));
+    TEST_ASSERT_EQUAL_UINT16(0xE303, adc1115.getSingleEndedConfig(2, GAIN_ONE, 8));
+    TEST_ASSERT_EQUAL_UINT16(0xE3C3, adc1115.getSingleEndedConfig(2, GAIN_ONE, 475));
+    TEST_ASSERT_EQUAL_UINT16(0xE3C3, adc1015.getSingleEndedConfig(2, GAIN_ONE, 3300));
+
+    TEST_ASSERT_EQUAL(0, adc1115.getSingleEndedConfig(2, GAIN_ONE, 3300));
+    TEST_ASSERT_EQUAL(0, adc1015.getSingleEndedConfig(2, GAIN_ONE, 860));
+    TEST_ASSERT_EQUAL(0, adc1115.getSingleEndedConfig(4, GAIN_ONE, 0));
+
+    TEST_ASSERT_EQUAL(138, adc1115.getConversionTimeAt(8));
+    TEST_ASSERT_EQUAL(2, adc1115.getConversionTimeAt(860));
+    TEST_ASSERT_EQUAL(1, adc1015.getConversionTimeAt(3300));
+    TEST_ASSERT_EQUAL(adc1115.getConversionTime(), adc1115.getConversionTimeAt(0));
+}
+
+void test_ContinuousModeSetsUpConversionReadyPin()
+{
+    ADS1115 adc = ADS1115();
+    uint8_t expected[] = {
+        0x02, 0x00, 0x00, // Lo_thresh MSB = 0
+        0x03, 0x80, 0x00, // Hi_thresh MSB = 1
+        0x01, 0x50, 0xE0  // AIN1, continuous, 860SPS, assert after one conversion
+    };
+
+    TEST_ASSERT_TRUE(adc.startContinuous_SingleEnded(1, true, 0));
+    TEST_ASSERT_TRUE(adc.isContinuous());
+    TEST_ASSERT_EQUAL(9, Wire.sentCount());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, s_sendBuffer, 9);
+
+    // Single-shot conversions would take the ADC out of continuous mode
+    TEST_ASSERT_FALSE(adc.startADC_SingleEnded(0));
+    TEST_ASSERT_EQUAL(9, Wire.sentCount());
+}
+
+void test_ContinuousResultIsOnlyReadAfterReadyEdge()
+{
+    ADS1115 adc = ADS1115();
+    int16_t result = 0;
+
+    s_recvdBuffer[0] = 0x12; s_recvdBuffer[1] = 0x34;
+    s_recvdBuffer[2] = 0x00; s_recvdBuffer[3] = 0x56;
+
+    adc.startContinuous_SingleEnded(0, true, 0);
+    TEST_ASSERT_FALSE(adc.readContinuous(&result, 100000));
+    TEST_ASSERT_EQUAL(0, Wire.recvdCount());
+
+    // Reading the result writes the pointer register, but never the config
+    adc.conversionReady();
+    TEST_ASSERT_TRUE(adc.readContinuous(&result, 0));
+    TEST_ASSERT_EQUAL(0x1234, result);
+    TEST_ASSERT_EQUAL(10, Wire.sentCount());
+    TEST_ASSERT_FALSE(adc.readContinuous(&result, 0));
+
+    adc.conversionReady();
+    adc.conversionReady();
+    TEST_ASSERT_TRUE(adc.readContinuous(&result, 0));
+    TEST_ASSERT_EQUAL(0x56, result);
+    TEST_ASSERT_EQUAL(1, adc.missedConversions());
+}
+
+void test_ContinuousModePollsWithoutReadyPin()
+{
+    ADS1013 adc = ADS1013();
+    int16_t result = 0;
+
+    s_recvdBuffer[0] = 0x12; s_recvdBuffer[1] = 0x30;
+
+    // The ADS1x13 has no ALERT/RDY pin
+    TEST_ASSERT_FALSE(adc.startContinuous_SingleEnded(0, true, 0));
+
+    TEST_ASSERT_TRUE(adc.startContinuous_SingleEnded(0, false, 1000));
+    TEST_ASSERT_EQUAL(3, Wire.sentCount());
+
+    // 3300 samples per second is one every 303us
+    TEST_ASSERT_FALSE(adc.readContinuous(&result, 1302));
+    TEST_ASSERT_TRUE(adc.readContinuous(&result, 1303));
+    TEST_ASSERT_EQUAL(0x123, result);
+    TEST_ASSERT_EQUAL(0, adc.missedConversions());
+
+    TEST_ASSERT_FALSE(adc.readContinuous(&result, 1605));
+    TEST_ASSERT_TRUE(adc.readContinuous(&result, 1303 + (303 * 3)));
+    TEST_ASSERT_EQUAL(2, adc.missedConversions());
+}
+
+void test_StoppingContinuousModeRestoresThresholds()
+{
+    ADS1115 adc = ADS1115();
+    uint8_t expected[] = {
+        0x02, 0x80, 0x00,
+        0x03, 0x7F, 0xFF,
+        0x01, 0x01, 0x83  // Single-shot, comparator disabled
+    };
+
+    adc.startContinuous_SingleEnded(0, true, 0);
+    adc.stopContinuous();
+    TEST_ASSERT_FALSE(adc.isContinuous());
+    TEST_ASSERT_EQUAL(18, Wire.sentCount());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, &s_sendBuffer[9], 9);
+
+    TEST_ASSERT_TRUE(adc.startADC_SingleEnded(0));
+}
+
 int main(void)
 {
     UnityBegin("DLSensor.ADS1x1x.cpp");
@@ -189,6 +328,15 @@ int main(void)
 
     RUN_TEST(test_ADS1x15_WillReadFromAllChannels);
 
+    RUN_TEST(test_ADS1x1xIsPresentIfItsAddressIsAcknowledged);
+    RUN_TEST(test_ADS1x1xReportsReadsThatFail);
+    RUN_TEST(test_ConfigIsBuiltForEachDataRate);
+
+    RUN_TEST(test_ContinuousModeSetsUpConversionReadyPin);
+    RUN_TEST(test_ContinuousResultIsOnlyReadAfterReadyEdge);
+    RUN_TEST(test_ContinuousModePollsWithoutReadyPin);
+    RUN_TEST(test_StoppingContinuousModeRestoresThresholds);
+
     UnityEnd();
     return 0;
 }
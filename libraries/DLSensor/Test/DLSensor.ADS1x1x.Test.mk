@@ -1,2 +1,7 @@
+SRC_FILES += DLSensor/DLSensor.I2C.cpp
 SRC_FILES += DLTest/DLTest.Mock.i2c.cpp
-SRC_FILES += DLTest/DLTest.Mock.delay.cpp
\ No newline at end of file
+SRC_FILES += DLTest/DLTest.Mock.delay.cpp
+
+local_setup: ;
+
+local_teardown: ;
\ No newline at end of file
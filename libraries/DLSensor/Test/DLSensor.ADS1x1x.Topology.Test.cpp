@@ -0,0 +1,129 @@
+/*
+ * DLSensor.ADS1x1x.Topology.Test.cpp
+ *
+ * Tests parsing the list of ADS1x1x ADCs on the bus
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <iostream>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLSensor.ADS1x1x.h"
+#include "DLSensor.ADS1x1x.Topology.h"
+
+/*
+ * Private Test Objects/Variables
+ */
+
+static ADS1x1x_CHIP s_chips[MAX_ADS1x1x_CHIPS];
+static uint8_t s_count;
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+void setUp()
+{
+    memset(s_chips, 0, sizeof(s_chips));
+    s_count = 0;
+}
+
+void test_PartsAreParsedInAnyCase()
+{
+    TEST_ASSERT_EQUAL(PART_ADS1013, ADS1x1x_ParsePart("ADS1013"));
+    TEST_ASSERT_EQUAL(PART_ADS1115, ADS1x1x_ParsePart("ads1115"));
+    TEST_ASSERT_EQUAL(INVALID_ADS1x1x_PART, ADS1x1x_ParsePart("ADS111"));
+    TEST_ASSERT_EQUAL(INVALID_ADS1x1x_PART, ADS1x1x_ParsePart("ADS11155"));
+    TEST_ASSERT_EQUAL(INVALID_ADS1x1x_PART, ADS1x1x_ParsePart(""));
+}
+
+void test_ChannelsFollowOnFromThePreviousADC()
+{
+    TEST_ASSERT_TRUE(ADS1x1x_ParseTopology("ADS1115@0x48, ADS1113@0x49,ADS1015 @ 74", s_chips, &s_count));
+    TEST_ASSERT_EQUAL(3, s_count);
+
+    TEST_ASSERT_EQUAL(PART_ADS1115, s_chips[0].part);
+    TEST_ASSERT_EQUAL(0x48, s_chips[0].address);
+    TEST_ASSERT_EQUAL(1, s_chips[0].firstChannel);
+
+    TEST_ASSERT_EQUAL(PART_ADS1113, s_chips[1].part);
+    TEST_ASSERT_EQUAL(0x49, s_chips[1].address);
+    TEST_ASSERT_EQUAL(5, s_chips[1].firstChannel);
+
+    TEST_ASSERT_EQUAL(PART_ADS1015, s_chips[2].part);
+    TEST_ASSERT_EQUAL(0x4A, s_chips[2].address);
+    TEST_ASSERT_EQUAL(7, s_chips[2].firstChannel);
+}
+
+void test_FirstChannelCanBeSet()
+{
+    TEST_ASSERT_TRUE(ADS1x1x_ParseTopology("ADS1114@0x4B:20, ADS1114@0x48, ADS1115@0x49:1", s_chips, &s_count));
+    TEST_ASSERT_EQUAL(3, s_count);
+    TEST_ASSERT_EQUAL(20, s_chips[0].firstChannel);
+    TEST_ASSERT_EQUAL(22, s_chips[1].firstChannel);
+    TEST_ASSERT_EQUAL(1, s_chips[2].firstChannel);
+}
+
+void test_InvalidTopologiesAreRejected()
+{
+    TEST_ASSERT_FALSE(ADS1x1x_ParseTopology("", s_chips, &s_count));
+    TEST_ASSERT_FALSE(ADS1x1x_ParseTopology("ADS1116@0x48", s_chips, &s_count));
+    TEST_ASSERT_FALSE(ADS1x1x_ParseTopology("ADS1115 0x48", s_chips, &s_count));
+    TEST_ASSERT_FALSE(ADS1x1x_ParseTopology("ADS1115@0x47", s_chips, &s_count));
+    TEST_ASSERT_FALSE(ADS1x1x_ParseTopology("ADS1115@0x4C", s_chips, &s_count));
+    TEST_ASSERT_FALSE(ADS1x1x_ParseTopology("ADS1115@0x48:0", s_chips, &s_count));
+    TEST_ASSERT_FALSE(ADS1x1x_ParseTopology("ADS1115@0x48:253", s_chips, &s_count));
+    TEST_ASSERT_FALSE(ADS1x1x_ParseTopology("ADS1115@0x48 ADS1115@0x49", s_chips, &s_count));
+
+    // Addresses and channels cannot be used twice
+    TEST_ASSERT_FALSE(ADS1x1x_ParseTopology("ADS1115@0x48, ADS1115@0x48", s_chips, &s_count));
+    TEST_ASSERT_FALSE(ADS1x1x_ParseTopology("ADS1115@0x48:5, ADS1113@0x49:7", s_chips, &s_count));
+    TEST_ASSERT_FALSE(ADS1x1x_ParseTopology("ADS1115@0x48:5, ADS1115@0x49:2", s_chips, &s_count));
+
+    // There are only four addresses
+    TEST_ASSERT_FALSE(ADS1x1x_ParseTopology("ADS1115@0x48, ADS1115@0x49, ADS1115@0x4A, ADS1115@0x4B, ADS1115@0x4B", s_chips, &s_count));
+}
+
+void test_ADCsAreCreatedForEachPart()
+{
+    ADS1x1x_CHIP chip = {PART_ADS1113, 0x4A, 1};
+    ADS1x1x * adc = ADS1x1x_Create(&chip);
+
+    TEST_ASSERT_NOT_NULL(adc);
+    TEST_ASSERT_EQUAL(0x4A, adc->getAddress());
+    TEST_ASSERT_EQUAL(2, adc->getMaxChannels());
+    TEST_ASSERT_EQUAL(16, adc->getResolution());
+    TEST_ASSERT_FALSE(adc->hasComparator());
+    delete adc;
+
+    chip.part = INVALID_ADS1x1x_PART;
+    TEST_ASSERT_NULL(ADS1x1x_Create(&chip));
+}
+
+int main(void)
+{
+    UnityBegin("DLSensor.ADS1x1x.Topology.Test.cpp");
+
+    RUN_TEST(test_PartsAreParsedInAnyCase);
+    RUN_TEST(test_ChannelsFollowOnFromThePreviousADC);
+    RUN_TEST(test_FirstChannelCanBeSet);
+    RUN_TEST(test_InvalidTopologiesAreRejected);
+    RUN_TEST(test_ADCsAreCreatedForEachPart);
+
+    UnityEnd();
+    return 0;
+}
@@ -0,0 +1,8 @@
+SRC_FILES += DLSensor/DLSensor.ADS1x1x.cpp
+SRC_FILES += DLSensor/DLSensor.I2C.cpp
+SRC_FILES += DLTest/DLTest.Mock.i2c.cpp
+SRC_FILES += DLTest/DLTest.Mock.delay.cpp
+
+local_setup: ;
+
+local_teardown: ;
\ No newline at end of file
@@ -0,0 +1,221 @@
+/*
+ * DLSensor.I2C.Test.cpp
+ *
+ * Tests the i2c transaction layer
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <iostream>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLSensor.I2C.h"
+#include "DLTest.Mock.i2c.h"
+
+/*
+ * Private Test Objects/Variables
+ */
+
+extern I2CMock Wire;
+
+static uint8_t s_sendBuffer[32];
+static uint8_t s_recvdBuffer[32];
+
+static unsigned long mockMicros(void)
+{
+    return Wire.micros();
+}
+
+// A clock that moves on each time it is read (for waiting on data that never arrives)
+static unsigned long s_tickingMicros;
+static unsigned long tickingMicros(void)
+{
+    return (s_tickingMicros += 500);
+}
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+void setUp()
+{
+    uint8_t i;
+
+    for (i = 0; i < 32; i++)
+    {
+        s_recvdBuffer[i] = i + 1;
+    }
+
+    Wire.reset();
+    Wire.setSentBuffer(s_sendBuffer);
+    Wire.setRecvdBuffer(s_recvdBuffer);
+
+    s_tickingMicros = 0;
+
+    I2C_ResetStats();
+    I2C_SetClock(NULL);
+    I2C_SetTimeout(I2C_DEFAULT_TIMEOUT_US);
+    I2C_SetAttempts(I2C_DEFAULT_ATTEMPTS);
+}
+
+void tearDown() {}
+
+void test_RegisterWriteIsOneTransaction()
+{
+    uint8_t expected[] = {0x01, 0x85, 0x83};
+
+    TEST_ASSERT_EQUAL(I2C_OK, I2C_WriteRegister16(0x48, 0x01, 0x8583));
+    TEST_ASSERT_EQUAL(3, Wire.sentCount());
+    TEST_ASSERT_EQUAL(1, Wire.stopCount());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, s_sendBuffer, 3);
+    TEST_ASSERT_EQUAL(1, I2C_GetStats(0x48)->transactions);
+}
+
+void test_RegisterReadWritesThePointerOnlyWhenItHasMoved()
+{
+    uint16_t value = 0;
+
+    // The pointer write and read share one stop
+    TEST_ASSERT_EQUAL(I2C_OK, I2C_ReadRegister16(0x48, 0x00, &value));
+    TEST_ASSERT_EQUAL_UINT16(0x0102, value);
+    TEST_ASSERT_EQUAL(1, Wire.sentCount());
+    TEST_ASSERT_EQUAL(2, Wire.recvdCount());
+    TEST_ASSERT_EQUAL(1, Wire.stopCount());
+
+    // The pointer is still on the register
+    TEST_ASSERT_EQUAL(I2C_OK, I2C_ReadRegister16(0x48, 0x00, &value));
+    TEST_ASSERT_EQUAL_UINT16(0x0304, value);
+    TEST_ASSERT_EQUAL(1, Wire.sentCount());
+
+    // Writing another register moves it
+    I2C_WriteRegister16(0x48, 0x01, 0x0000);
+    TEST_ASSERT_EQUAL(I2C_OK, I2C_ReadRegister16(0x48, 0x00, &value));
+    TEST_ASSERT_EQUAL(1 + 3 + 1, Wire.sentCount());
+
+    // Each device has its own pointer
+    TEST_ASSERT_EQUAL(I2C_OK, I2C_ReadRegister16(0x49, 0x00, &value));
+    TEST_ASSERT_EQUAL(1 + 3 + 1 + 1, Wire.sentCount());
+}
+
+void test_FailedAttemptsAreRetried()
+{
+    // Two address NACKs, then success on the third attempt
+    Wire.failNext(2, 2);
+    TEST_ASSERT_EQUAL(I2C_OK, I2C_WriteRegister16(0x48, 0x01, 0x1234));
+
+    I2C_DEVICE_STATS const * pStats = I2C_GetStats(0x48);
+    TEST_ASSERT_EQUAL(1, pStats->transactions);
+    TEST_ASSERT_EQUAL(2, pStats->nacks);
+    TEST_ASSERT_EQUAL(2, pStats->retries);
+    TEST_ASSERT_EQUAL(0, pStats->failures);
+}
+
+void test_TransactionFailsAfterAllAttempts()
+{
+    uint16_t value = 0xAAAA;
+
+    I2C_SetAttempts(2);
+    Wire.failNext(2, 4);
+    TEST_ASSERT_EQUAL(I2C_BUS_ERROR, I2C_ReadRegister16(0x48, 0x00, &value));
+    TEST_ASSERT_EQUAL_UINT16(0xAAAA, value);
+
+    I2C_DEVICE_STATS const * pStats = I2C_GetStats(0x48);
+    TEST_ASSERT_EQUAL(2, pStats->busErrors);
+    TEST_ASSERT_EQUAL(1, pStats->retries);
+    TEST_ASSERT_EQUAL(1, pStats->failures);
+
+    // The pointer could be anywhere after a failure, so it is written again
+    TEST_ASSERT_EQUAL(I2C_OK, I2C_ReadRegister16(0x48, 0x00, &value));
+    TEST_ASSERT_EQUAL(3, Wire.sentCount());
+
+    TEST_ASSERT_FALSE(I2C_SetAttempts(0));
+    TEST_ASSERT_FALSE(I2C_SetAttempts(I2C_MAX_ATTEMPTS + 1));
+}
+
+void test_SlowTransactionsAreOverruns()
+{
+    uint16_t value = 0;
+
+    I2C_SetClock(mockMicros);
+    I2C_SetTimeout(2000);
+    Wire.setTransferMicros(1500);
+
+    // A write is one transfer, a read is two: the read is slow, but its data is still good
+    TEST_ASSERT_EQUAL(I2C_OK, I2C_WriteRegister16(0x48, 0x01, 0x1234));
+    TEST_ASSERT_EQUAL(I2C_OK, I2C_ReadRegister16(0x48, 0x00, &value));
+    TEST_ASSERT_EQUAL_UINT16(0x0102, value);
+
+    I2C_DEVICE_STATS const * pStats = I2C_GetStats(0x48);
+    TEST_ASSERT_EQUAL(2, pStats->transactions);
+    TEST_ASSERT_EQUAL(1, pStats->overruns);
+    TEST_ASSERT_EQUAL(0, pStats->timeouts);
+    TEST_ASSERT_EQUAL(0, pStats->retries);
+    TEST_ASSERT_EQUAL(0, pStats->failures);
+    TEST_ASSERT_EQUAL(3000, pStats->lastLatency);
+    TEST_ASSERT_EQUAL(3000, pStats->maxLatency);
+    TEST_ASSERT_EQUAL((1500 + 3000) / 2, I2C_MeanLatency(pStats));
+}
+
+void test_MissingDataTimesOut()
+{
+    uint16_t value = 0;
+
+    // The first read returns one byte of two: with no clock, it fails without waiting
+    Wire.shortNext(1);
+    TEST_ASSERT_EQUAL(I2C_OK, I2C_ReadRegister16(0x48, 0x00, &value));
+    TEST_ASSERT_EQUAL(1, I2C_GetStats(0x48)->timeouts);
+    TEST_ASSERT_EQUAL(1, I2C_GetStats(0x48)->retries);
+
+    // With a clock, it fails once the timeout has passed
+    I2C_SetClock(tickingMicros);
+    Wire.shortNext(1);
+    TEST_ASSERT_EQUAL(I2C_OK, I2C_ReadRegister16(0x48, 0x00, &value));
+    TEST_ASSERT_EQUAL(2, I2C_GetStats(0x48)->timeouts);
+    TEST_ASSERT_EQUAL(2, I2C_GetStats(0x48)->retries);
+    TEST_ASSERT_EQUAL(0, I2C_GetStats(0x48)->overruns);
+}
+
+void test_DevicesAreCountedSeparately()
+{
+    Wire.setNackAddress(0x49);
+
+    TEST_ASSERT_EQUAL(I2C_OK, I2C_Probe(0x48));
+    TEST_ASSERT_EQUAL(I2C_NACK, I2C_Probe(0x49));
+
+    TEST_ASSERT_EQUAL(2, I2C_GetDeviceCount());
+    TEST_ASSERT_EQUAL(0x48, I2C_GetDeviceStats(0)->address);
+    TEST_ASSERT_EQUAL(0, I2C_GetDeviceStats(0)->nacks);
+    TEST_ASSERT_EQUAL(0x49, I2C_GetDeviceStats(1)->address);
+    TEST_ASSERT_EQUAL(I2C_DEFAULT_ATTEMPTS, I2C_GetDeviceStats(1)->nacks);
+    TEST_ASSERT_NULL(I2C_GetDeviceStats(2));
+    TEST_ASSERT_NULL(I2C_GetStats(0x4A));
+}
+
+int main(void)
+{
+    UnityBegin("DLSensor.I2C.Test.cpp");
+
+    RUN_TEST(test_RegisterWriteIsOneTransaction);
+    RUN_TEST(test_RegisterReadWritesThePointerOnlyWhenItHasMoved);
+    RUN_TEST(test_FailedAttemptsAreRetried);
+    RUN_TEST(test_TransactionFailsAfterAllAttempts);
+    RUN_TEST(test_SlowTransactionsAreOverruns);
+    RUN_TEST(test_MissingDataTimesOut);
+    RUN_TEST(test_DevicesAreCountedSeparately);
+
+    UnityEnd();
+    return 0;
+}
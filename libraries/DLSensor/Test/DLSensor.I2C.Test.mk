@@ -0,0 +1,5 @@
+SRC_FILES += DLTest/DLTest.Mock.i2c.cpp
+
+local_setup: ;
+
+local_teardown: ;
\ No newline at end of file
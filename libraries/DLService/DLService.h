@@ -26,6 +26,8 @@ class ServiceInterface
         	char * buffer, float * data,  uint32_t * channels, uint8_t nFields, uint16_t maxSize) = 0;
         virtual uint16_t createPostAPICall(
         	char * buffer, float * data,  uint32_t * channels, uint8_t nFields, uint16_t maxSize, char const * const time) = 0;
+        virtual uint16_t createPostAPICall(
+        	char * buffer, float * data, char const * const * keys, uint8_t nValues, uint16_t maxSize, char const * const time) = 0;
         
         virtual void createBulkUploadCall(
         	char * buffer, uint16_t maxSize, const char * csvData, const char * filename, uint8_t nFields) = 0;
@@ -43,22 +43,32 @@ const char Thingspeak::THINGSPEAK_MULTIPART_BOUNDARY[] = __THINGSPEAK_MULTIPART_
 static RequestBuilder builder;
 static char * s_body = NULL;
 
+/*
+ * Private Functions
+ */
+
+/*
+ * fitsInBody
+ *
+ * Returns true if snprintf wrote all of its output into a body of maxSize with index already used
+ */
+static bool fitsInBody(int written, uint16_t index, uint16_t maxSize)
+{
+    return (written >= 0) && ((uint16_t)written < (maxSize - index));
+}
+
 /*
  * Public Class Functions
  */
 
 Thingspeak::Thingspeak(char const * const url, char const * const key)
 {
-    if (url)
-    {
-        memcpy(m_url, url, strlen(url));   
-    }
-    else
-    {
-        memcpy(m_url, THINGSPEAK_DEFAULT_URL, strlen(THINGSPEAK_DEFAULT_URL));   
-    }
+    // strncpy pads with NULs, so the last character is always the terminator
+    strncpy(m_url, url ? url : THINGSPEAK_DEFAULT_URL, _MAX_URL_LENGTH - 1);
+    m_url[_MAX_URL_LENGTH - 1] = '\0';
 
-    memcpy(m_key, key, strlen(key)); 
+    strncpy(m_key, key ? key : "", _MAX_API_KEY_LENGTH - 1);
+    m_key[_MAX_API_KEY_LENGTH - 1] = '\0';
 }
 
 Thingspeak::~Thingspeak() {}
@@ -78,37 +88,90 @@ uint16_t Thingspeak::createPostAPICall(
     char * buffer, float * data,  uint32_t * channels, uint8_t nFields, uint16_t maxSize, char const * const pTime)
 {
     if (!buffer) { return 0; }
-    if (!m_key) { return 0; }
+    if (!m_key[0]) { return 0; }
     
     char m_body[maxSize];
-    
-    builder.reset();
-    builder.setMethodAndURL("POST", THINGSPEAK_UPDATE_PATH);
-
-    builder.putHeader("Host", m_url);
-    builder.putHeader("Connection", "Close");
-    builder.putHeader("X-THINGSPEAKAPIKEY", m_key);
-    builder.putHeader("Content-Type", "application/x-www-form-urlencoded");
+    m_body[0] = '\0';
 
     uint8_t field = 0;
-    uint8_t index = 0;
+    uint16_t index = 0;
+    int written;
     for (field = 0; field < nFields; field++)
     {
         // Make the data string
-        index += sprintf(&m_body[index], "%d=%.5f", channels[field], data[field]);
-        if (!lastinloop(field, nFields))
-        {
-            m_body[index++] = '&';
-        }
+        written = snprintf(&m_body[index], maxSize - index, "%s%d=%.5f", index ? "&" : "", (int)channels[field], data[field]);
+        if (!fitsInBody(written, index, maxSize)) { buffer[0] = '\0'; return 0; }
+        index += written;
     }
 
-    // Copy the time into the buffer (if provided)
+    return writePostAPICall(buffer, m_body, index, maxSize, pTime);
+}
+
+/* Creates a post call with a key for each value (e.g. for values that are not one per channel)
+ * Args:
+    buffer - the buffer into which the request is written
+    data - the values to post
+    keys - the key for each value
+    nValues - the number of values (and keys)
+    maxSize - the maximum size of the buffer
+    pTime - the created_at time (or NULL)
+ Returns the length of the body, or 0 (with an empty buffer) if the body does not fit in maxSize
+*/
+uint16_t Thingspeak::createPostAPICall(
+    char * buffer, float * data, char const * const * keys, uint8_t nValues, uint16_t maxSize, char const * const pTime)
+{
+    if (!buffer) { return 0; }
+    if (!m_key[0]) { return 0; }
+    if (!keys) { return 0; }
+    
+    char m_body[maxSize];
+    m_body[0] = '\0';
+
+    uint8_t value = 0;
+    uint16_t index = 0;
+    int written;
+    for (value = 0; value < nValues; value++)
+    {
+        written = snprintf(&m_body[index], maxSize - index, "%s%s=%.5f", index ? "&" : "", keys[value], data[value]);
+        if (!fitsInBody(written, index, maxSize)) { buffer[0] = '\0'; return 0; }
+        index += written;
+    }
+
+    return writePostAPICall(buffer, m_body, index, maxSize, pTime);
+}
+
+uint16_t Thingspeak::writePostAPICall(char * buffer, char * body, uint16_t index, uint16_t maxSize, char const * const pTime)
+{
+    // Copy the time into the body (if provided), encoding spaces as the body is form-encoded
     if (pTime)
     {
-        index += sprintf(&m_body[index], "created_at=%s", pTime);
+        int written = snprintf(&body[index], maxSize - index, "%screated_at=", index ? "&" : "");
+        if (!fitsInBody(written, index, maxSize)) { buffer[0] = '\0'; return 0; }
+        index += written;
+
+        char const * pChar;
+        uint8_t length;
+        for (pChar = pTime; *pChar; pChar++)
+        {
+            length = (*pChar == ' ') ? 3 : 1;
+            if ((index + length) >= maxSize) { buffer[0] = '\0'; return 0; }
+
+            if (*pChar == ' ') { memcpy(&body[index], "%20", 3); }
+            else { body[index] = *pChar; }
+            index += length;
+        }
+        body[index] = '\0';
     }
 
-    builder.putBody(m_body);
+    builder.reset();
+    builder.setMethodAndURL("POST", THINGSPEAK_UPDATE_PATH);
+
+    builder.putHeader("Host", m_url);
+    builder.putHeader("Connection", "Close");
+    builder.putHeader("X-THINGSPEAKAPIKEY", m_key);
+    builder.putHeader("Content-Type", "application/x-www-form-urlencoded");
+
+    builder.putBody(body);
 
     builder.writeToBuffer(buffer, maxSize, true);
 
@@ -127,7 +190,7 @@ uint16_t Thingspeak::createPostAPICall(
 void Thingspeak::createBulkUploadCall(char * buffer, uint16_t maxSize, const char * csvData, const char * filename, uint8_t nFields)
 {
     if (!buffer) { return; }
-    if (!m_key) { return; }
+    if (!m_key[0]) { return; }
 
     /* Creates the HTTP headers for the bulk upload */
     if (!s_body)
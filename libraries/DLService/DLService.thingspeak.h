@@ -19,11 +19,15 @@ class Thingspeak : public ServiceInterface
             char * buffer, float * data, uint32_t * channels, uint8_t nFields, uint16_t maxSize);
         uint16_t createPostAPICall(
             char * buffer, float * data, uint32_t * channels, uint8_t nFields, uint16_t maxSize, char const * const time);
+        uint16_t createPostAPICall(
+            char * buffer, float * data, char const * const * keys, uint8_t nValues, uint16_t maxSize, char const * const time);
 
         void createBulkUploadCall(char * buffer, uint16_t maxSize, const char * csvData, const char * filename, uint8_t nFields);
 
     private:
 
+        uint16_t writePostAPICall(char * buffer, char * body, uint16_t index, uint16_t maxSize, char const * const pTime);
+
         void putCSVUploadHeaders(FixedLengthAccumulator * accumulator, uint8_t nFields);
         
         static const char THINGSPEAK_UPDATE_PATH[];
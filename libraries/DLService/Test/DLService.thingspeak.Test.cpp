@@ -22,10 +22,8 @@
  * Local Application Includes
  */
 
-#include "DLSettings.h"
-#include "DLUtility.h"
 #include "DLService.h"
-#include "DLService.Thingspeak.h"
+#include "DLService.thingspeak.h"
 
 /*
  * Unity Test Framework
@@ -68,14 +66,14 @@ std::vector<std::string> requestStrings;
 
 uint8_t s_testLine;
 
+static Thingspeak s_thingspeak("api.thingspeak.com", "IZ2O45C3BM257VCH");
+
+static float s_values[] = {1.5f, 2.5f};
+static char const * const s_keys[] = {"field1", "field2"};
+
 void createRequest()
 {
-    Settings_setString(THINGSPEAK_URL, "api.thingspeak.com");
-    Settings_setString(THINGSPEAK_API_KEY, "IZ2O45C3BM257VCH");
-    
-    ServiceInterface * thingspeak = Service_GetService(SERVICE_THINGSPEAK);
-
-    thingspeak->createBulkUploadCall(requestBuffer, 1024, csvData, "example.csv", 6);
+    s_thingspeak.createBulkUploadCall(requestBuffer, 1024, csvData, "example.csv", 6);
 
     // Go through request buffer and split into strings    
 	size_t pos = 0;
@@ -105,6 +103,43 @@ void test_BulkUploadRequestLineIsCorrect()
 	TEST_ASSERT_EQUAL_STRING_MESSAGE(expectedResponseLines[s_testLine], requestStrings[s_testLine].c_str(), msg);
 }
 
+static char const * getBody(void)
+{
+    char const * pBody = strstr(requestBuffer, "\r\n\r\n");
+    return pBody ? pBody + 4 : "";
+}
+
+void test_KeyedPostSeparatesValuesAndEncodesTime(void)
+{
+    char const * expected = "field1=1.50000&field2=2.50000&created_at=2026-10-18%2012:00:00\r\n";
+    uint16_t length = s_thingspeak.createPostAPICall(requestBuffer, s_values, s_keys, 2, 1024, "2026-10-18 12:00:00");
+
+    TEST_ASSERT_EQUAL_STRING(expected, getBody());
+    TEST_ASSERT_EQUAL(strlen(expected) - 2, length);
+}
+
+void test_KeyedPostWithNoValuesHasOnlyTime(void)
+{
+    s_thingspeak.createPostAPICall(requestBuffer, s_values, s_keys, 0, 1024, "2026-10-18 12:00:00");
+    TEST_ASSERT_EQUAL_STRING("created_at=2026-10-18%2012:00:00\r\n", getBody());
+}
+
+void test_KeyedPostWithNoTimeHasOnlyValues(void)
+{
+    s_thingspeak.createPostAPICall(requestBuffer, s_values, s_keys, 2, 1024, NULL);
+    TEST_ASSERT_EQUAL_STRING("field1=1.50000&field2=2.50000\r\n", getBody());
+}
+
+void test_KeyedPostThatDoesNotFitIsRejected(void)
+{
+    // The values fit, but the time does not
+    TEST_ASSERT_EQUAL(0, s_thingspeak.createPostAPICall(requestBuffer, s_values, s_keys, 2, 40, "2026-10-18 12:00:00"));
+    TEST_ASSERT_EQUAL_STRING("", requestBuffer);
+
+    TEST_ASSERT_EQUAL(0, s_thingspeak.createPostAPICall(requestBuffer, s_values, s_keys, 2, 20, NULL));
+    TEST_ASSERT_EQUAL_STRING("", requestBuffer);
+}
+
 int main(void)
 {
     UnityBegin("DLService.Thingspeak.cpp");
@@ -119,5 +154,12 @@ int main(void)
  		RUN_TEST(test_BulkUploadRequestLineIsCorrect);
  	}
 
+    RUN_TEST(test_KeyedPostSeparatesValuesAndEncodesTime);
+    RUN_TEST(test_KeyedPostWithNoValuesHasOnlyTime);
+    RUN_TEST(test_KeyedPostWithNoTimeHasOnlyValues);
+    RUN_TEST(test_KeyedPostThatDoesNotFitIsRejected);
+
+    UnityEnd();
+
     return 0;
 }
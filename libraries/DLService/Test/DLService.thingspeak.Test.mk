@@ -1,15 +1,14 @@
 SRC_FILES += DLUtility/DLUtility.Strings.cpp
 SRC_FILES += DLUtility/DLUtility.ArrayFunctions.cpp
-SRC_FILES += DLService/DLService.cpp
-SRC_FILES += DLSettings/DLSettings.cpp
-SRC_FILES += DLDataField/DLDataField.cpp
 SRC_FILES += DLHTTP/DLHTTP.RequestBuilder.cpp
 SRC_FILES += DLHTTP/DLHTTP.Header.cpp
+SRC_FILES += DLTest/DLTest.Mock.Serial.cpp
 
 INC_DIRS += -IDLService
 INC_DIRS += -IDLUtility
-INC_DIRS += -IDLDataField
-INC_DIRS += -IDLSettings
 INC_DIRS += -IDLHTTP
 
-SYMBOLS += -D_MAX_FIELDS=6
\ No newline at end of file
+
+local_setup: ;
+
+local_teardown: ;
\ No newline at end of file
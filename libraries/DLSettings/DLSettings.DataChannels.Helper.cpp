@@ -39,6 +39,15 @@ static const char * s_channelTypes[] = {
     "temperature_c"
 };
 
+// In the same order as REDUCER_TYPE
+static const char * s_reducerTypes[] = {
+    "mean",
+    "median",
+    "trimmedmean",
+    "ema",
+    "cic"
+};
+
 /*
  * Private Functions
  */
@@ -126,6 +135,24 @@ FIELD_TYPE Setting_parseSettingAsType(char const * const setting)
     return INVALID_TYPE;
 }
 
+REDUCER_TYPE Setting_parseSettingAsReducer(char const * const setting)
+{
+    uint8_t i;
+    char lcaseSetting[31];
+    strncpy_safe(lcaseSetting, setting, 31);
+    toLowerStr(lcaseSetting);
+
+    for (i = 0; i < N_ELE(s_reducerTypes); ++i)
+    {
+        if (0 == strncmp(lcaseSetting, s_reducerTypes[i], strlen(s_reducerTypes[i])))
+        {
+            return (REDUCER_TYPE)i;
+        }
+    }
+
+    return INVALID_REDUCER;
+}
+
 bool Setting_parseSettingAsInt(int32_t * pResult, char const * const setting)
 {
 
@@ -18,6 +18,7 @@
  * DataLogger Includes
  */
 
+#include "DLUtility.FixedPoint.h"
 #include "DLUtility.Averager.h"
 #include "DLLocalStorage.h"
 #include "DLDataField.Types.h"
@@ -38,12 +38,35 @@
 
 #define MAX_LINE_LENGTH (200)
 
+/* Storage for the conversion settings of one channel, whatever its type */
+union channel_settings
+{
+    VOLTAGECHANNEL voltage;
+    CURRENTCHANNEL current;
+    THERMISTORCHANNEL thermistor;
+};
+typedef union channel_settings CHANNEL_SETTINGS;
+
 /*
  * Private Variables
  */
 
 static void * s_channels[MAX_CHANNELS];
+static CHANNEL_SETTINGS s_channelSettings[MAX_CHANNELS];
 static FIELD_TYPE s_fieldTypes[MAX_CHANNELS];
+static bool s_statistics[MAX_CHANNELS];
+static REDUCER_TYPE s_reducers[MAX_CHANNELS];
+static uint8_t s_reducerParameters[MAX_CHANNELS];
+static uint8_t s_percentiles[MAX_CHANNELS];
+static float s_deadbands[MAX_CHANNELS];
+static float s_deadbandPercents[MAX_CHANNELS];
+static TRIGGER_TYPE s_triggerTypes[MAX_CHANNELS];
+static int32_t s_triggerLevels[MAX_CHANNELS];
+static uint8_t s_sampleDivisors[MAX_CHANNELS];
+static uint16_t s_fullScales[MAX_CHANNELS];
+static uint16_t s_dataRates[MAX_CHANNELS];
+static uint8_t s_oversample[MAX_CHANNELS];
+static uint8_t s_resolutions[MAX_CHANNELS];
 
 /*
  * For each of the channels that can be stored,
@@ -66,14 +89,13 @@ static void setupChannel(uint8_t ch, FIELD_TYPE type)
     switch(type)    
     {
     case VOLTAGE:
-        s_channels[ch] = new VOLTAGECHANNEL();
-        break;
     case CURRENT:
-        s_channels[ch] = new CURRENTCHANNEL();
     case TEMPERATURE_C:
     case TEMPERATURE_F:
     case TEMPERATURE_K:
-        s_channels[ch] = new THERMISTORCHANNEL();
+        // Settings are stored in place (fields with a conversion take a copy when they are created)
+        memset(&s_channelSettings[ch], 0, sizeof(CHANNEL_SETTINGS));
+        s_channels[ch] = &s_channelSettings[ch];
         break;
     default:
     case INVALID_TYPE:
@@ -81,6 +103,36 @@ static void setupChannel(uint8_t ch, FIELD_TYPE type)
     }
 }
 
+/*
+ * When a channel has a gain set, its millivolts per bit follows from the ADC full-scale range and resolution
+ * (the full scale is +/- fullScale mV, so a reading of 2^(bits-1) is full scale).
+ */
+static float mvPerBitFromGain(uint8_t ch)
+{
+    return (float)s_fullScales[ch] / (float)(1UL << (s_resolutions[ch] - 1));
+}
+
+static bool setMvPerBit(uint8_t ch, float setting)
+{
+    // An explicit mvPerBit is ignored if there is a gain, so the two cannot disagree
+    if (s_fullScales[ch]) { setting = mvPerBitFromGain(ch); }
+
+    switch (s_fieldTypes[ch])
+    {
+    case VOLTAGE:
+        ((VOLTAGECHANNEL*)s_channels[ch])->mvPerBit = setting;
+        break;
+    case CURRENT:
+        ((CURRENTCHANNEL*)s_channels[ch])->mvPerBit = setting;
+        break;
+    default:
+        return false;
+    }
+
+    s_valuesSetBitFields[ch] |= 0x01;
+    return true;
+}
+
 static bool voltageChannelIsValid(uint8_t channel)
 {
     return s_valuesSetBitFields[channel] == 0x1F; // Voltage needs five values set   
@@ -105,8 +157,7 @@ static SETTINGS_READER_RESULT tryParseAsVoltageSetting(uint8_t ch, char * pSetti
     if (0 == strncmp(pSettingName, "mvperbit", 8))
     {
         if (!settingParsedAsFloat) { return invalidSettingError(lineNo, pSettingName); }
-        ((VOLTAGECHANNEL*)s_channels[ch])->mvPerBit = setting;
-        s_valuesSetBitFields[ch] |= 0x01;
+        setMvPerBit(ch, setting);
         return noError();
     }
 
@@ -154,8 +205,7 @@ static SETTINGS_READER_RESULT tryParseAsCurrentSetting(uint8_t ch, char * pSetti
     if (0 == strncmp(pSettingName, "mvperbit", 8))
     {
         if (!settingParsedAsFloat) { return invalidSettingError(lineNo, pSettingName); }
-        ((CURRENTCHANNEL*)s_channels[ch])->mvPerBit = setting;
-        s_valuesSetBitFields[ch] |= 0x01;
+        setMvPerBit(ch, setting);
         return noError();
     }
     
@@ -223,6 +273,19 @@ static SETTINGS_READER_RESULT tryParseAsThermistorSetting(uint8_t ch, char * pSe
         return noError();
     }
 
+    // Lookup table size is optional (no table is used if not set)
+    if (0 == strncmp(pSettingName, "lutsize", 7))
+    {
+        int32_t lutSize;
+        if (!Setting_parseSettingAsInt(&lutSize, pValueString)) { return invalidSettingError(lineNo, pSettingName); }
+        if ((lutSize < 0) || (lutSize == 1) || (lutSize > MAX_THERMISTOR_LUT_SIZE))
+        {
+            return invalidSettingError(lineNo, pSettingName);
+        }
+        ((THERMISTORCHANNEL*)s_channels[ch])->lutSize = (uint16_t)lutSize;
+        return noError();
+    }
+
     return unknownSettingError(lineNo, pSettingName);
 }
 
@@ -238,6 +301,19 @@ void Settings_InitDataChannels(void)
         s_channels[i] = NULL;
         s_valuesSetBitFields[i] = 0x00;
         s_fieldTypes[i] = INVALID_TYPE;
+        s_statistics[i] = false;
+        s_reducers[i] = REDUCER_MEAN;
+        s_reducerParameters[i] = 0;
+        s_percentiles[i] = 0;
+        s_deadbands[i] = 0.0f;
+        s_deadbandPercents[i] = 0.0f;
+        s_triggerTypes[i] = TRIGGER_NONE;
+        s_triggerLevels[i] = 0;
+        s_sampleDivisors[i] = 1;
+        s_fullScales[i] = 0;
+        s_dataRates[i] = 0;
+        s_oversample[i] = 1;
+        s_resolutions[i] = 16;
     }
 }
 
@@ -283,6 +359,147 @@ SETTINGS_READER_RESULT Settings_parseDataChannelSetting(char const * const setti
         return noError();
     }
 
+    // Statistics (min/max/standard deviation per average) are optional for any channel type
+    if (0 == strncmp(pChannelSettingString, "statistics", 10))
+    {
+        if (s_fieldTypes[ch] == INVALID_TYPE) { return channelNotSetError(lineNo, ch); }
+        s_statistics[ch] = (*pValueString != '0');
+        return noError();
+    }
+
+    // Percentiles (P5/P50/P95 per average) are optional for any channel type.
+    // The value is the sketch compression: 0 disables them, higher values are more accurate but use more memory.
+    if (0 == strncmp(pChannelSettingString, "percentiles", 11))
+    {
+        int32_t compression;
+        if (s_fieldTypes[ch] == INVALID_TYPE) { return channelNotSetError(lineNo, ch); }
+        if (!Setting_parseSettingAsInt(&compression, pValueString)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        if ((compression < 0) || (compression > 255)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        s_percentiles[ch] = (uint8_t)compression;
+        return noError();
+    }
+
+    // Deadbands (in converted units, or as a percentage of the last value stored) are optional for any channel type.
+    // The percentage is checked first, as "deadband" is also the start of its name.
+    if (0 == strncmp(pChannelSettingString, "deadbandpercent", 15))
+    {
+        float percent;
+        if (s_fieldTypes[ch] == INVALID_TYPE) { return channelNotSetError(lineNo, ch); }
+        if (!Setting_parseSettingAsFloat(&percent, pValueString)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        if (percent < 0.0f) { return invalidSettingError(lineNo, pChannelSettingString); }
+        s_deadbandPercents[ch] = percent;
+        return noError();
+    }
+
+    if (0 == strncmp(pChannelSettingString, "deadband", 8))
+    {
+        float deadband;
+        if (s_fieldTypes[ch] == INVALID_TYPE) { return channelNotSetError(lineNo, ch); }
+        if (!Setting_parseSettingAsFloat(&deadband, pValueString)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        if (deadband < 0.0f) { return invalidSettingError(lineNo, pChannelSettingString); }
+        s_deadbands[ch] = deadband;
+        return noError();
+    }
+
+    // Burst capture triggers (in raw ADC counts) are optional for any channel type. Only one trigger can be set per channel.
+    if (0 == strncmp(pChannelSettingString, "trigger", 7))
+    {
+        int32_t level;
+        TRIGGER_TYPE trigger = INVALID_TRIGGER;
+        if (s_fieldTypes[ch] == INVALID_TYPE) { return channelNotSetError(lineNo, ch); }
+
+        if (0 == strncmp(pChannelSettingString, "triggerabove", 12)) { trigger = TRIGGER_ABOVE; }
+        else if (0 == strncmp(pChannelSettingString, "triggerbelow", 12)) { trigger = TRIGGER_BELOW; }
+        else if (0 == strncmp(pChannelSettingString, "triggerrate", 11)) { trigger = TRIGGER_RATE; }
+
+        if (trigger == INVALID_TRIGGER) { return unknownSettingError(lineNo, pChannelSettingString); }
+        if (!Setting_parseSettingAsInt(&level, pValueString)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        if ((trigger == TRIGGER_RATE) && (level < 0)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        s_triggerTypes[ch] = trigger;
+        s_triggerLevels[ch] = level;
+        return noError();
+    }
+
+    // Sampling slower than the ADC scan rate is optional for any channel type.
+    // The channel is read on one scan in every sampledivisor scans (1 is every scan).
+    if (0 == strncmp(pChannelSettingString, "sampledivisor", 13))
+    {
+        int32_t divisor;
+        if (s_fieldTypes[ch] == INVALID_TYPE) { return channelNotSetError(lineNo, ch); }
+        if (!Setting_parseSettingAsInt(&divisor, pValueString)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        if ((divisor < 1) || (divisor > 255)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        s_sampleDivisors[ch] = (uint8_t)divisor;
+        return noError();
+    }
+
+    // ADC gain (2/3, 1, 2, 4, 8 or 16) is optional for any channel type. The ADC default is used if it is not set.
+    // Voltage and current channels with a gain get their mvPerBit from it, and do not need to set mvPerBit.
+    if (0 == strncmp(pChannelSettingString, "gain", 4))
+    {
+        int32_t gain;
+        if (s_fieldTypes[ch] == INVALID_TYPE) { return channelNotSetError(lineNo, ch); }
+
+        if (0 == strncmp(pValueString, "2/3", 3))
+        {
+            s_fullScales[ch] = 6144;
+        }
+        else if (Setting_parseSettingAsInt(&gain, pValueString) && (gain > 0) && (gain <= 16) && ((gain & (gain - 1)) == 0))
+        {
+            s_fullScales[ch] = 4096 / gain;
+        }
+        else
+        {
+            return invalidSettingError(lineNo, pChannelSettingString);
+        }
+
+        setMvPerBit(ch, 0.0f);
+        return noError();
+    }
+
+    // ADC data rate (samples per second) is optional for any channel type. The ADC default is used if it is not set.
+    // Whether the ADC supports the rate is checked when the ADCs are set up.
+    if (0 == strncmp(pChannelSettingString, "datarate", 8))
+    {
+        int32_t rate;
+        if (s_fieldTypes[ch] == INVALID_TYPE) { return channelNotSetError(lineNo, ch); }
+        if (!Setting_parseSettingAsInt(&rate, pValueString)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        if ((rate < 1) || (rate > 0xFFFF)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        s_dataRates[ch] = (uint16_t)rate;
+        return noError();
+    }
+
+    // Oversampling is optional for any channel type: each reading is the mean of this many ADC conversions.
+    if (0 == strncmp(pChannelSettingString, "oversample", 10))
+    {
+        int32_t oversample;
+        if (s_fieldTypes[ch] == INVALID_TYPE) { return channelNotSetError(lineNo, ch); }
+        if (!Setting_parseSettingAsInt(&oversample, pValueString)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        if ((oversample < 1) || (oversample > 255)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        s_oversample[ch] = (uint8_t)oversample;
+        return noError();
+    }
+
+    // Averaging (mean, median, trimmedmean, ema or cic) is optional for any channel type.
+    // The parameter is checked first, as "averaging" is also the start of its name.
+    if (0 == strncmp(pChannelSettingString, "averagingparameter", 18))
+    {
+        int32_t parameter;
+        if (s_fieldTypes[ch] == INVALID_TYPE) { return channelNotSetError(lineNo, ch); }
+        if (!Setting_parseSettingAsInt(&parameter, pValueString)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        if ((parameter < 0) || (parameter > 255)) { return invalidSettingError(lineNo, pChannelSettingString); }
+        s_reducerParameters[ch] = (uint8_t)parameter;
+        return noError();
+    }
+
+    if (0 == strncmp(pChannelSettingString, "averaging", 9))
+    {
+        if (s_fieldTypes[ch] == INVALID_TYPE) { return channelNotSetError(lineNo, ch); }
+        REDUCER_TYPE reducer = Setting_parseSettingAsReducer(pValueString);
+        if (reducer == INVALID_REDUCER) { return invalidSettingError(lineNo, pChannelSettingString); }
+        s_reducers[ch] = reducer;
+        return noError();
+    }
+
     /* If processing got this far, the setting needs to be interpreted based on the channel datatype */
     switch (s_fieldTypes[ch])
     {
@@ -331,6 +548,96 @@ bool Settings_ChannelSettingIsValid(CHANNELNUMBER channel)
     }
 }
 
+bool Settings_ChannelStatisticsEnabled(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return false; }
+    return s_statistics[channel-1];
+}
+
+REDUCER_TYPE Settings_GetChannelReducer(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return REDUCER_MEAN; }
+    return s_reducers[channel-1];
+}
+
+uint8_t Settings_GetChannelReducerParameter(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return 0; }
+    return s_reducerParameters[channel-1];
+}
+
+uint8_t Settings_GetChannelPercentiles(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return 0; }
+    return s_percentiles[channel-1];
+}
+
+float Settings_GetChannelDeadband(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return 0.0f; }
+    return s_deadbands[channel-1];
+}
+
+float Settings_GetChannelDeadbandPercent(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return 0.0f; }
+    return s_deadbandPercents[channel-1];
+}
+
+TRIGGER_TYPE Settings_GetChannelTrigger(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return TRIGGER_NONE; }
+    return s_triggerTypes[channel-1];
+}
+
+int32_t Settings_GetChannelTriggerLevel(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return 0; }
+    return s_triggerLevels[channel-1];
+}
+
+uint8_t Settings_GetChannelSampleDivisor(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return 1; }
+    return s_sampleDivisors[channel-1];
+}
+
+/*
+ * Settings_GetChannelFullScale
+ *
+ * Returns the ADC full-scale range (in millivolts) set by the channel gain, or 0 if no gain is set
+ */
+uint16_t Settings_GetChannelFullScale(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return 0; }
+    return s_fullScales[channel-1];
+}
+
+uint16_t Settings_GetChannelDataRate(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return 0; }
+    return s_dataRates[channel-1];
+}
+
+uint8_t Settings_GetChannelOversample(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return 1; }
+    return s_oversample[channel-1];
+}
+
+/*
+ * Settings_SetChannelResolution
+ *
+ * Set the resolution (in bits, including sign) of the ADC that reads a channel, for mvPerBit to be derived from gain.
+ * The default is 16 bits. This must be set before channel settings are read.
+ */
+void Settings_SetChannelResolution(CHANNELNUMBER channel, uint8_t bits)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return; }
+    if ((bits < 2) || (bits > 24)) { return; }
+    s_resolutions[channel-1] = bits;
+}
+
 void * Settings_GetData(CHANNELNUMBER channel)
 {
     if (channel > MAX_CHANNELS || channel == 0) { return NULL; }
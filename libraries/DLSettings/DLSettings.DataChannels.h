@@ -15,6 +15,20 @@ SETTINGS_READER_RESULT Settings_parseDataChannelSetting(char const * const setti
 
 FIELD_TYPE Settings_GetChannelType(CHANNELNUMBER channel);
 bool Settings_ChannelSettingIsValid(CHANNELNUMBER channel);
+bool Settings_ChannelStatisticsEnabled(CHANNELNUMBER channel);
+REDUCER_TYPE Settings_GetChannelReducer(CHANNELNUMBER channel);
+uint8_t Settings_GetChannelReducerParameter(CHANNELNUMBER channel);
+uint8_t Settings_GetChannelPercentiles(CHANNELNUMBER channel);
+float Settings_GetChannelDeadband(CHANNELNUMBER channel);
+float Settings_GetChannelDeadbandPercent(CHANNELNUMBER channel);
+TRIGGER_TYPE Settings_GetChannelTrigger(CHANNELNUMBER channel);
+int32_t Settings_GetChannelTriggerLevel(CHANNELNUMBER channel);
+uint8_t Settings_GetChannelSampleDivisor(CHANNELNUMBER channel);
+uint16_t Settings_GetChannelFullScale(CHANNELNUMBER channel);
+uint16_t Settings_GetChannelDataRate(CHANNELNUMBER channel);
+uint8_t Settings_GetChannelOversample(CHANNELNUMBER channel);
+
+void Settings_SetChannelResolution(CHANNELNUMBER channel, uint8_t bits);
 
 void * Settings_GetData(CHANNELNUMBER channel);
 VOLTAGECHANNEL * Settings_GetDataAsVoltage(CHANNELNUMBER channel);
@@ -28,7 +28,8 @@
     STRING(MAINTENANCE_PHONE_NUMBER_2) \
     STRING(MAINTENANCE_PHONE_NUMBER_3) \
     STRING(MAINTENANCE_PHONE_NUMBER_4) \
-    STRING(DISABLE_MODULES)
+    STRING(DISABLE_MODULES) \
+    STRING(ADC_CHIPS)
 
 /* Define each int setting for the application */
 
@@ -40,7 +41,19 @@
     INT(SERIAL_DATA_INTERVAL_SECS) \
     INT(BATTERY_WARN_INTERVAL_MINUTES) \
     INT(BATTERY_WARN_LEVEL) \
-    INT(ENABLE_DATA_DEBUG)
+    INT(ENABLE_DATA_DEBUG) \
+    INT(ENABLE_FIXED_POINT) \
+    INT(STORAGE_OVERFLOW_POLICY) \
+    INT(UPLOAD_OVERFLOW_POLICY) \
+    INT(ALIGN_AVERAGING_WINDOWS) \
+    INT(DEADBAND_HEARTBEAT_SECS) \
+    INT(BURST_PRE_SAMPLES) \
+    INT(BURST_POST_SAMPLES) \
+    INT(ADC_PROBE) \
+    INT(INTERNAL_ADC_COUNT) \
+    INT(INTERNAL_ADC_FIRST_CHANNEL) \
+    INT(I2C_TIMEOUT_US) \
+    INT(I2C_ATTEMPTS)
     
 #define GENERATE_ENUM(ENUM) ENUM, // This turns each setting into an enum entry
 #define GENERATE_STRING(STRING) #STRING, // This turns each setting into a string in an array
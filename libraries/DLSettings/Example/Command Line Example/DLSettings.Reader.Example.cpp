@@ -11,6 +11,7 @@ Reads from "datalogger.settings" and echoes those settings back to the command l
 #include <fstream>
 #include <string>
 
+#include "DLUtility.FixedPoint.h"
 #include "DLUtility.Averager.h"
 #include "DLDataField.h"
 #include "DLDataField.Manager.h"
@@ -33,6 +33,7 @@
  */
 
 #include "DLSettings.h"
+#include "DLUtility.FixedPoint.h"
 #include "DLDataField.h"
 #include "DLUtility.h"
 #include "DLLocalStorage.h"
@@ -206,6 +206,192 @@ void test_ValidCurrentSettingsAreParsedCorrectly(void)
     TEST_ASSERT_EQUAL_FLOAT(0.125, Settings_GetDataAsCurrent(1)->mvPerBit);
 }
 
+void test_ValidThermistorSettingsAreParsedCorrectly(void)
+{
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.Type = Temperature_C", 17));
+    TEST_ASSERT_EQUAL(TEMPERATURE_C, Settings_GetChannelType(1));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.maxADC = 1023", 18));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.B = 4500", 19));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.R25 = 10000.0", 20));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.otherR = 10000.0", 21));
+    TEST_ASSERT_FALSE(Settings_ChannelSettingIsValid(1));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.highside = 1", 22));
+    TEST_ASSERT_TRUE(Settings_ChannelSettingIsValid(1));
+
+    THERMISTORCHANNEL * pChannel = (THERMISTORCHANNEL*)Settings_GetData(1);
+    TEST_ASSERT_EQUAL_FLOAT(1023.0, pChannel->maxADC);
+    TEST_ASSERT_EQUAL_FLOAT(4500.0, pChannel->B);
+    TEST_ASSERT_EQUAL_FLOAT(10000.0, pChannel->R25);
+    TEST_ASSERT_EQUAL_FLOAT(10000.0, pChannel->otherR);
+    TEST_ASSERT_TRUE(pChannel->highside);
+    TEST_ASSERT_EQUAL(0, pChannel->lutSize); // Lookup table is optional
+}
+
+void test_ThermistorLookupTableSizeIsParsedAndChecked(void)
+{
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.Type = Temperature_C", 23));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.LUTSize = 256", 24));
+    TEST_ASSERT_EQUAL(256, ((THERMISTORCHANNEL*)Settings_GetData(1))->lutSize);
+
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch1.LUTSize = 1", 25));
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch1.LUTSize = -4", 26));
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch1.LUTSize = 100000", 27));
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch1.LUTSize = big", 28));
+}
+
+void test_StatisticsSettingIsParsedForAnyChannelType(void)
+{
+    TEST_ASSERT_FALSE(Settings_ChannelStatisticsEnabled(1));
+    TEST_ASSERT_EQUAL(ERR_READER_CHANNEL_TYPE_NOT_SET, Settings_parseDataChannelSetting("ch1.Statistics = 1", 29));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.Type = Voltage", 30));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.Statistics = 1", 31));
+    TEST_ASSERT_TRUE(Settings_ChannelStatisticsEnabled(1));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch2.Type = Temperature_C", 32));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch2.Statistics = 0", 33));
+    TEST_ASSERT_FALSE(Settings_ChannelStatisticsEnabled(2));
+}
+
+void test_AveragingSettingsAreParsedForAnyChannelType(void)
+{
+    TEST_ASSERT_EQUAL(REDUCER_MEAN, Settings_GetChannelReducer(1));
+    TEST_ASSERT_EQUAL(ERR_READER_CHANNEL_TYPE_NOT_SET, Settings_parseDataChannelSetting("ch1.Averaging = Median", 34));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.Type = Voltage", 35));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.Averaging = Median", 36));
+    TEST_ASSERT_EQUAL(REDUCER_MEDIAN, Settings_GetChannelReducer(1));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch2.Type = Temperature_C", 37));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch2.Averaging = TrimmedMean", 38));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch2.AveragingParameter = 20", 39));
+    TEST_ASSERT_EQUAL(REDUCER_TRIMMED_MEAN, Settings_GetChannelReducer(2));
+    TEST_ASSERT_EQUAL(20, Settings_GetChannelReducerParameter(2));
+
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch2.Averaging = Mode", 40));
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch2.AveragingParameter = 256", 41));
+    TEST_ASSERT_EQUAL(REDUCER_TRIMMED_MEAN, Settings_GetChannelReducer(2));
+}
+
+void test_PercentilesSettingIsParsedForAnyChannelType(void)
+{
+    TEST_ASSERT_EQUAL(0, Settings_GetChannelPercentiles(1));
+    TEST_ASSERT_EQUAL(ERR_READER_CHANNEL_TYPE_NOT_SET, Settings_parseDataChannelSetting("ch1.Percentiles = 50", 42));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.Type = Current", 43));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.Percentiles = 50", 44));
+    TEST_ASSERT_EQUAL(50, Settings_GetChannelPercentiles(1));
+
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch1.Percentiles = 300", 45));
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch1.Percentiles = many", 46));
+    TEST_ASSERT_EQUAL(50, Settings_GetChannelPercentiles(1));
+}
+
+void test_DeadbandSettingsAreParsedForAnyChannelType(void)
+{
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, Settings_GetChannelDeadband(1));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, Settings_GetChannelDeadbandPercent(1));
+    TEST_ASSERT_EQUAL(ERR_READER_CHANNEL_TYPE_NOT_SET, Settings_parseDataChannelSetting("ch1.Deadband = 0.5", 42));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.Type = Voltage", 43));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.Deadband = 0.5", 44));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch1.DeadbandPercent = 2.5", 45));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, Settings_GetChannelDeadband(1));
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, Settings_GetChannelDeadbandPercent(1));
+
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch1.Deadband = -1", 46));
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch1.DeadbandPercent = lots", 47));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, Settings_GetChannelDeadband(1));
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, Settings_GetChannelDeadbandPercent(1));
+}
+
+void test_TriggerSettingsAreParsedForAnyChannelType(void)
+{
+    TEST_ASSERT_EQUAL(TRIGGER_NONE, Settings_GetChannelTrigger(2));
+    TEST_ASSERT_EQUAL(ERR_READER_CHANNEL_TYPE_NOT_SET, Settings_parseDataChannelSetting("ch2.TriggerAbove = 900", 50));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch2.Type = Voltage", 51));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch2.TriggerAbove = 900", 52));
+    TEST_ASSERT_EQUAL(TRIGGER_ABOVE, Settings_GetChannelTrigger(2));
+    TEST_ASSERT_EQUAL(900, Settings_GetChannelTriggerLevel(2));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch2.TriggerBelow = -20", 53));
+    TEST_ASSERT_EQUAL(TRIGGER_BELOW, Settings_GetChannelTrigger(2));
+    TEST_ASSERT_EQUAL(-20, Settings_GetChannelTriggerLevel(2));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch2.TriggerRate = 50", 54));
+    TEST_ASSERT_EQUAL(TRIGGER_RATE, Settings_GetChannelTrigger(2));
+    TEST_ASSERT_EQUAL(50, Settings_GetChannelTriggerLevel(2));
+
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch2.TriggerRate = -5", 55));
+    TEST_ASSERT_EQUAL(ERR_READER_UNKNOWN_SETTING, Settings_parseDataChannelSetting("ch2.TriggerSideways = 5", 56));
+    TEST_ASSERT_EQUAL(50, Settings_GetChannelTriggerLevel(2));
+}
+
+void test_SampleDivisorIsParsedForAnyChannelType(void)
+{
+    TEST_ASSERT_EQUAL(1, Settings_GetChannelSampleDivisor(3));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch3.Type = TEMPERATURE_C", 60));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch3.SampleDivisor = 10", 61));
+    TEST_ASSERT_EQUAL(10, Settings_GetChannelSampleDivisor(3));
+
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch3.SampleDivisor = 0", 62));
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch3.SampleDivisor = 256", 63));
+    TEST_ASSERT_EQUAL(10, Settings_GetChannelSampleDivisor(3));
+}
+
+void test_ADCSettingsAreParsedForAnyChannelType(void)
+{
+    TEST_ASSERT_EQUAL(0, Settings_GetChannelFullScale(4));
+    TEST_ASSERT_EQUAL(0, Settings_GetChannelDataRate(4));
+    TEST_ASSERT_EQUAL(1, Settings_GetChannelOversample(4));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch4.Type = TEMPERATURE_C", 70));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch4.Gain = 2/3", 71));
+    TEST_ASSERT_EQUAL(6144, Settings_GetChannelFullScale(4));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch4.Gain = 16", 72));
+    TEST_ASSERT_EQUAL(256, Settings_GetChannelFullScale(4));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch4.DataRate = 860", 73));
+    TEST_ASSERT_EQUAL(860, Settings_GetChannelDataRate(4));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch4.Oversample = 8", 74));
+    TEST_ASSERT_EQUAL(8, Settings_GetChannelOversample(4));
+
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch4.Gain = 3", 75));
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch4.Gain = 32", 76));
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch4.DataRate = 0", 77));
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch4.Oversample = 0", 78));
+    TEST_ASSERT_EQUAL(256, Settings_GetChannelFullScale(4));
+    TEST_ASSERT_EQUAL(8, Settings_GetChannelOversample(4));
+}
+
+void test_MvPerBitIsDerivedFromGain(void)
+{
+    VOLTAGECHANNEL * voltage;
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch5.Type = Voltage", 80));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch5.mvPerBit = 0.5", 81));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch5.Gain = 1", 82));
+    voltage = Settings_GetDataAsVoltage(5);
+    TEST_ASSERT_EQUAL_FLOAT(0.125f, voltage->mvPerBit);
+
+    // An explicit mvPerBit does not override the gain
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch5.mvPerBit = 0.5", 83));
+    TEST_ASSERT_EQUAL_FLOAT(0.125f, voltage->mvPerBit);
+
+    // 12-bit ADCs have 2048 counts full scale, and a current channel is complete without mvPerBit
+    Settings_SetChannelResolution(6, 12);
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch6.Type = Current", 84));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch6.Gain = 4", 85));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch6.offset = 0", 86));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch6.mvPerAmp = 40", 87));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, Settings_GetDataAsCurrent(6)->mvPerBit);
+    TEST_ASSERT_TRUE(Settings_ChannelSettingIsValid(6));
+}
+
 int main(void)
 {
     UnityBegin("DLSettings.DataChannels.Test.cpp");
@@ -229,6 +415,16 @@ int main(void)
 
     RUN_TEST(test_ValidVoltageSettingsAreParsedCorrectly);
     RUN_TEST(test_ValidCurrentSettingsAreParsedCorrectly);
+    RUN_TEST(test_ValidThermistorSettingsAreParsedCorrectly);
+    RUN_TEST(test_ThermistorLookupTableSizeIsParsedAndChecked);
+    RUN_TEST(test_StatisticsSettingIsParsedForAnyChannelType);
+    RUN_TEST(test_AveragingSettingsAreParsedForAnyChannelType);
+    RUN_TEST(test_PercentilesSettingIsParsedForAnyChannelType);
+    RUN_TEST(test_DeadbandSettingsAreParsedForAnyChannelType);
+    RUN_TEST(test_TriggerSettingsAreParsedForAnyChannelType);
+    RUN_TEST(test_SampleDivisorIsParsedForAnyChannelType);
+    RUN_TEST(test_ADCSettingsAreParsedForAnyChannelType);
+    RUN_TEST(test_MvPerBitIsDerivedFromGain);
 
   	UnityEnd();
   	return 0;
@@ -7,6 +7,22 @@
 #include "DLSensor.ADS1x1x.h"
 #include "DLTest.Mock.random.h"
 
+bool ADS1x1x_GainFromFullScale(uint16_t millivolts, ADS_GAIN * gain)
+{
+    if (!gain) { return false; }
+
+    switch (millivolts)
+    {
+    case 6144: *gain = GAIN_TWOTHIRDS; return true;
+    case 4096: *gain = GAIN_ONE; return true;
+    case 2048: *gain = GAIN_TWO; return true;
+    case 1024: *gain = GAIN_FOUR; return true;
+    case 512: *gain = GAIN_EIGHT; return true;
+    case 256: *gain = GAIN_SIXTEEN; return true;
+    default: return false;
+    }
+}
+
 /**************************************************************************/
 /*!
 @brief  Instantiates a new ADS1x1x class w/appropriate properties
@@ -17,6 +33,14 @@ ADS1x1x::ADS1x1x(uint8_t i2cAddress)
     // Set defaults for the lowest performance ADC (ADS1013)
     m_i2cAddress = i2cAddress;
     m_gain = GAIN_TWOTHIRDS; /* +/- 6.144V range (limited to VDD +0.3V max!) */
+    m_startedChannel = 0;
+    m_continuous = false;
+    m_useReadyPin = false;
+    m_readyCount = 0;
+    m_readyTaken = 0;
+    m_lastSampleMicros = 0;
+    m_missedConversions = 0;
+    m_readFailed = false;
 
     m_minFakeRead[0] = m_minFakeRead[1] = m_minFakeRead[2] = m_minFakeRead[3] = 0;
     m_maxFakeRead[0] = m_maxFakeRead[1] = m_maxFakeRead[2] = m_maxFakeRead[3] = 1;
@@ -33,6 +57,11 @@ void ADS1x1x::begin()
 {
 }
 
+bool ADS1x1x::isPresent(void)
+{
+    return true;
+}
+
 void ADS1x1x::fake(uint8_t ch, uint16_t minFakeRead, uint16_t maxFakeRead)
 {
     m_minFakeRead[ch] = minFakeRead;
@@ -59,6 +88,38 @@ int16_t ADS1x1x::readADC_SingleEnded(uint8_t channel)
     return random(m_minFakeRead[channel], m_maxFakeRead[channel]);
 }
 
+bool ADS1x1x::startADC_SingleEnded(uint8_t channel)
+{
+    if ((channel >= getMaxChannels()) || m_continuous) { return false; }
+    m_startedChannel = channel;
+    return true;
+}
+
+uint16_t ADS1x1x::getSingleEndedConfig(uint8_t channel, ADS_GAIN gain, uint16_t samplesPerSecond)
+{
+    (void)gain; (void)samplesPerSecond;
+    if (channel >= getMaxChannels()) { return 0; }
+    // Only the channel is needed by startADC_Config
+    return 0x4000 + (channel << 12);
+}
+
+uint8_t ADS1x1x::getConversionTimeAt(uint16_t samplesPerSecond)
+{
+    return samplesPerSecond ? (1100 + samplesPerSecond - 1) / samplesPerSecond : getConversionTime();
+}
+
+bool ADS1x1x::startADC_Config(uint16_t config)
+{
+    if (m_continuous) { return false; }
+    m_startedChannel = (config - 0x4000) >> 12;
+    return true;
+}
+
+int16_t ADS1x1x::readADC_SingleEndedResult(void)
+{
+    return random(m_minFakeRead[m_startedChannel], m_maxFakeRead[m_startedChannel]);
+}
+
 int16_t ADS1x1x::readADC_Differential(uint8_t channel)
 {
     return random(m_minFakeRead[channel], m_maxFakeRead[channel]);
@@ -85,7 +146,61 @@ int16_t ADS1x1x::getLastConversionResults()
 	return random(m_minFakeRead[0], m_maxFakeRead[0]);
 }
 
+bool ADS1x1x::readFailed(void)
+{
+    return m_readFailed;
+}
+
 void ADS1x1x::startComparator_SingleEnded(uint8_t channel, int16_t threshold)
 {
 	(void)channel; (void)threshold;
+}
+
+bool ADS1x1x::startContinuous_SingleEnded(uint8_t channel, bool useReadyPin, unsigned long nowMicros)
+{
+    if (channel >= getMaxChannels()) { return false; }
+    if (useReadyPin && !hasComparator()) { return false; }
+    m_startedChannel = channel;
+    m_continuous = true;
+    m_useReadyPin = useReadyPin;
+    m_readyTaken = m_readyCount;
+    m_lastSampleMicros = nowMicros;
+    m_missedConversions = 0;
+    return true;
+}
+
+void ADS1x1x::conversionReady(void)
+{
+    m_readyCount++;
+}
+
+bool ADS1x1x::readContinuous(int16_t * result, unsigned long nowMicros)
+{
+    // There is no ALERT/RDY pin on the host, so always poll at the part's sample rate
+    unsigned long period = 1000000UL / getMaxSampleRate();
+    unsigned long elapsed = nowMicros - m_lastSampleMicros;
+
+    if (!result || !m_continuous) { return false; }
+    if (elapsed < period) { return false; }
+
+    m_missedConversions += (elapsed / period) - 1;
+    m_lastSampleMicros = nowMicros - (elapsed % period);
+    *result = random(m_minFakeRead[m_startedChannel], m_maxFakeRead[m_startedChannel]);
+    return true;
+}
+
+void ADS1x1x::stopContinuous(void)
+{
+    m_continuous = false;
+    m_useReadyPin = false;
+}
+
+bool ADS1x1x::isContinuous(void)
+{
+    return m_continuous;
+}
+
+uint32_t ADS1x1x::missedConversions(void)
+{
+    return m_missedConversions;
 }
\ No newline at end of file
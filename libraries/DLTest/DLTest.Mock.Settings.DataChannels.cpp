@@ -46,6 +46,71 @@ bool Settings_ChannelSettingIsValid(uint8_t channel)
     (void)channel; return true;
 }
 
+bool Settings_ChannelStatisticsEnabled(uint8_t channel)
+{
+    (void)channel; return false;
+}
+
+REDUCER_TYPE Settings_GetChannelReducer(uint8_t channel)
+{
+    (void)channel; return REDUCER_MEAN;
+}
+
+uint8_t Settings_GetChannelReducerParameter(uint8_t channel)
+{
+    (void)channel; return 0;
+}
+
+uint8_t Settings_GetChannelPercentiles(uint8_t channel)
+{
+    (void)channel; return 0;
+}
+
+float Settings_GetChannelDeadband(uint8_t channel)
+{
+    (void)channel; return 0.0f;
+}
+
+float Settings_GetChannelDeadbandPercent(uint8_t channel)
+{
+    (void)channel; return 0.0f;
+}
+
+TRIGGER_TYPE Settings_GetChannelTrigger(uint8_t channel)
+{
+    (void)channel; return TRIGGER_NONE;
+}
+
+int32_t Settings_GetChannelTriggerLevel(uint8_t channel)
+{
+    (void)channel; return 0;
+}
+
+uint8_t Settings_GetChannelSampleDivisor(uint8_t channel)
+{
+    (void)channel; return 1;
+}
+
+uint16_t Settings_GetChannelFullScale(uint8_t channel)
+{
+    (void)channel; return 0;
+}
+
+uint16_t Settings_GetChannelDataRate(uint8_t channel)
+{
+    (void)channel; return 0;
+}
+
+uint8_t Settings_GetChannelOversample(uint8_t channel)
+{
+    (void)channel; return 1;
+}
+
+void Settings_SetChannelResolution(uint8_t channel, uint8_t bits)
+{
+    (void)channel; (void)bits;
+}
+
 void * Settings_GetData(uint8_t channel)
 {
     (void)channel; return (void*)&s_voltageChannelSettings;
@@ -8,13 +8,51 @@
 
 void I2CMock::begin(void) {}
 void I2CMock::beginTransmission(uint8_t addr) { m_addr = addr; }
-void I2CMock::endTransmission(void) {}
 
-void I2CMock::requestFrom(uint8_t addr, uint8_t qty) {(void)addr; (void)qty; }
+bool I2CMock::injectFault(void)
+{
+	m_micros += m_transferMicros;
+
+	if (m_failCount)
+	{
+		m_failCount--;
+		return true;
+	}
+	return false;
+}
+
+uint8_t I2CMock::endTransmission(uint8_t sendStop)
+{
+	if (sendStop) { m_stops++; }
+
+	if (injectFault()) { return m_failStatus; }
+
+	// 2 is the Wire library's "NACK on transmit of address" result
+	return (m_nackAddress && (m_addr == m_nackAddress)) ? 2 : 0;
+}
+
+uint8_t I2CMock::requestFrom(uint8_t addr, uint8_t qty)
+{
+	m_stops++;
+	m_available = 0;
+
+	if (injectFault()) { return 0; }
+	if (m_nackAddress && (addr == m_nackAddress)) { return 0; }
+
+	if (m_shortCount)
+	{
+		m_shortCount--;
+		qty--;
+	}
+
+	m_available = qty;
+	return qty;
+}
 
 uint8_t I2CMock::receive(void)
 {
 	m_recvd++;
+	if (m_available) { m_available--; }
 	return m_recvdBuffer ?  *m_recvdBuffer++ : 0;
 }
 
@@ -28,4 +66,16 @@ void I2CMock::send(uint8_t toSend)
 
 }
 
-I2CMock Wire;
\ No newline at end of file
+void I2CMock::reset(void)
+{
+	m_stops = 0;
+	m_nackAddress = 0;
+	m_failCount = 0;
+	m_failStatus = 0;
+	m_shortCount = 0;
+	m_available = 0;
+	m_transferMicros = 0;
+	m_micros = 0;
+}
+
+I2CMock Wire;
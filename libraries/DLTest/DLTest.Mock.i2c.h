@@ -7,9 +7,10 @@ class I2CMock
 
 		void begin(void);
 		void beginTransmission(uint8_t);
-		void endTransmission(void);
+		uint8_t endTransmission(uint8_t sendStop = 1);
 
-		void requestFrom(uint8_t, uint8_t);
+		uint8_t requestFrom(uint8_t, uint8_t);
+		int available(void) { return m_available; }
 		uint8_t receive(void);
 		void send(uint8_t);
 
@@ -19,12 +20,40 @@ class I2CMock
 		uint8_t sentCount(void) { return m_sent; }
 		uint8_t recvdCount(void) { return m_recvd; }
 
+		// The number of transactions ended with a stop (a write then read with a repeated start is one transaction)
+		uint8_t stopCount(void) { return m_stops; }
+
+		// Transmissions to this address are not acknowledged (0 acknowledges all addresses)
+		void setNackAddress(uint8_t addr) { m_nackAddress = addr; }
+
+		// Fault injection: the next count transmissions or reads fail with a wire library status
+		// (reads return no data), or the next count reads return one byte less than requested
+		void failNext(uint8_t count, uint8_t status) { m_failCount = count; m_failStatus = status; }
+		void shortNext(uint8_t count) { m_shortCount = count; }
+
+		// Each transmission and read advances micros() by this much
+		void setTransferMicros(unsigned long us) { m_transferMicros = us; }
+		unsigned long micros(void) { return m_micros; }
+
+		// Clears all faults and delays (and the NACK address)
+		void reset(void);
+
 	private:
+		bool injectFault(void);
+
 		uint8_t * m_sentBuffer;
 		uint8_t * m_recvdBuffer;
 		uint8_t m_addr;
 		uint8_t m_sent;
 		uint8_t m_recvd;
+		uint8_t m_stops;
+		uint8_t m_nackAddress;
+		uint8_t m_failCount;
+		uint8_t m_failStatus;
+		uint8_t m_shortCount;
+		int m_available;
+		unsigned long m_transferMicros;
+		unsigned long m_micros;
 		
 };
 
@@ -53,3 +53,29 @@ void Time_PrintDate(TM * pTime, bool endwithCRLF)
 
     if (endwithCRLF) { Serial.println(); }
 }
+
+/*
+ * Time_ToUnixSeconds
+ *
+ * Convert a platform time to UNIX seconds.
+ * Platform times have months 1 to 12 and no day in year, so adjust a copy before converting.
+ */
+UNIX_TIMESTAMP Time_ToUnixSeconds(TM const * pTime)
+{
+    TM time = *pTime;
+    time.tm_mon -= 1;
+    time.tm_yday = calculate_days_into_year(&time);
+    return time_to_unix_seconds(&time);
+}
+
+/*
+ * Time_FromUnixSeconds
+ *
+ * Convert UNIX seconds to a platform time (months 1 to 12)
+ */
+void Time_FromUnixSeconds(UNIX_TIMESTAMP seconds, TM * pTime)
+{
+    unix_seconds_to_time(seconds, pTime);
+    pTime->tm_mon += 1;
+    pTime->tm_isdst = false;
+}
@@ -24,4 +24,7 @@ void Time_SetPlatformTime(TM *);
 void Time_PrintTime(TM * pTime, bool endwithCRLF = false);
 void Time_PrintDate(TM * pTime, bool endwithCRLF = false);
 
+UNIX_TIMESTAMP Time_ToUnixSeconds(TM const * pTime);
+void Time_FromUnixSeconds(UNIX_TIMESTAMP seconds, TM * pTime);
+
 #endif
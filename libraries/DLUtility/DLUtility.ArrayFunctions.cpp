@@ -96,6 +96,7 @@ template void fillArray(uint16_t * array, uint16_t value, uint16_t size);
 template void fillArray(int16_t * array, int16_t value, uint16_t size);
 template void fillArray(uint32_t * array, uint32_t value, uint16_t size);
 template void fillArray(int32_t * array, int32_t value, uint16_t size);
+template void fillArray(int64_t * array, int64_t value, uint16_t size);
 template void fillArray(float * array, float value, uint16_t size);
 template void fillArray(bool * array, bool value, uint16_t size);
 
@@ -34,14 +34,22 @@
  */
 
 template <typename T>
-Averager<T>::Averager(uint16_t size)
+Averager<T>::Averager(uint16_t size, bool keepSamples)
 {
-	m_data = new T[size];
+	m_data = keepSamples ? new T[size] : NULL;
+	m_sum = 0;
+	m_count = 0;
 	m_write = 0;
 	m_maxIndex = size -1;
 	m_full = false;
 }
 
+template <typename T>
+Averager<T>::~Averager()
+{
+	delete[] m_data;
+}
+
 template <typename T>
 uint16_t Averager<T>::size(void)
 {
@@ -59,81 +67,86 @@ void Averager<T>::reset(T * value)
 {
 	/* The value is passed as a pointer so that NULL can
 	represent resetting to zero length (rather than resetting to full of zeroes) */
-	if (!value)
-	{
-		fillArray(m_data, (T)0, size());
-	}
-	else
-	{
-		fillArray(m_data, *value, size());
-	}
+	T fillValue = value ? *value : (T)0;
+
+	fillArray(m_data, fillValue, size());
 
 	m_write = 0;
-	m_full = (value != NULL); 
+	m_full = (value != NULL);
+	m_count = m_full ? size() : 0;
+	m_sum = (typename AveragerSum<T>::type)fillValue * m_count;
 }
 
 template <typename T>
 uint16_t Averager<T>::N(void)
 {
-	return m_full ? m_maxIndex : m_write;
+	return m_count;
 }
 
 template <typename T>
 float Averager<T>::getFloatAverage(void)
 {
-	float sum = 0;
-	uint16_t count = 0;
-
-	if (m_write || m_full)
-	{
-		uint16_t n = 0;
-		count = m_full ? m_maxIndex : m_write - 1;
-		for (n = 0; n <= count; n++)
-		{
-			sum += m_data[n];
-		}
-	}
-	else
-	{
-		sum = 0;
-	}
-
-	sum = sum / (float)(count+1.0f);
-	return sum;
+	if (m_count == 0) { return 0.0f; }
+	return (float)m_sum / (float)m_count;
 }
 
 template <typename T>
 T Averager<T>::getAverage(void)
 {
-	int64_t sum = 0;
-	uint16_t count = 0;
+	if (m_count == 0) { return 0; }
+	typename AveragerSum<T>::type sum = m_sum;
+	typename AveragerSum<T>::type count = m_count;
+	return div_round(sum, count);
+}
+
+/*
+ * sum
+ *
+ * Returns the running sum of the samples, so that callers can average in other ways
+ * (e.g. to fixed point)
+ */
+template <typename T>
+typename AveragerSum<T>::type Averager<T>::sum(void)
+{
+	return m_sum;
+}
 
-	if (m_write || m_full)
+/*
+ * newData
+ *
+ * Adds a sample to the running sum. With a sample array, a full averager
+ * slides: the oldest sample is subtracted back out. Without one, a full
+ * averager starts a new window. Either way, the cost is O(1).
+ */
+template <typename T>
+void Averager<T>::newData(T newData)
+{
+	if (m_data)
 	{
-		uint16_t n = 0;
-		count = m_full ? m_maxIndex : m_write - 1;
-		for (n = 0; n <= count; n++)
-		{
-			sum += m_data[n];
-		}
+		if (m_full) { m_sum -= m_data[m_write]; }
+		m_data[m_write] = newData;
 	}
-	else
+	else if (m_full)
 	{
-		sum = 0;
+		m_sum = 0;
+		m_count = 0;
+		m_full = false;
 	}
 
-	sum = div_round(sum, count+1);
-	return sum;
-}
+	m_sum += newData;
+	if (!m_full) { m_count++; }
 
-template <typename T>
-void Averager<T>::newData(T newData)
-{
-	m_data[m_write] = newData;
 	m_full |= (m_write == m_maxIndex);
 	incrementwithrollover(m_write, m_maxIndex);
 }
 
+/* For floats, rounding the average makes no sense: it is the same as the float average */
+template <>
+float Averager<float>::getAverage(void)
+{
+	return getFloatAverage();
+}
+
 #ifdef TEST
 template <typename T>
 void Averager<T>::fillFromArray(T * array, uint16_t size)
@@ -5,15 +5,31 @@
  * Defines and Typedefs
  */
 
+/*
+ * AveragerSum
+ *
+ * Running sums are kept in a wider type than the samples so that they cannot overflow:
+ * int64_t for all integer types, double for floats.
+ */
+template <typename T>
+struct AveragerSum { typedef int64_t type; };
+
+template <>
+struct AveragerSum<float> { typedef double type; };
+
 template <typename T>
 class Averager
 {
 	public:
-		Averager(uint16_t size);
+		/* keepSamples: if false, no sample array is allocated and the averager
+		 * acts as a pure boxcar - once full, the next sample starts a new window */
+		Averager(uint16_t size, bool keepSamples = true);
+		~Averager();
 		void reset(T * value);
 		uint16_t size(void);
 		float getFloatAverage(void);
 		T getAverage(void);
+		typename AveragerSum<T>::type sum(void);
 		void newData(T NewData);
 		uint16_t N(void);
 		bool full(void);
@@ -24,9 +40,15 @@ class Averager
 
 	private:
 		T * m_data;
+		typename AveragerSum<T>::type m_sum;
+		uint16_t m_count;
 		uint16_t m_write;
 		uint16_t m_maxIndex;
 		bool m_full;
+
+		// Not copyable: the destructor frees m_data (declared but not defined)
+		Averager(Averager const &);
+		Averager & operator=(Averager const &);
 };
 
 #endif
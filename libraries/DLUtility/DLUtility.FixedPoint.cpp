@@ -0,0 +1,261 @@
+/*
+ * DLUtility.FixedPoint.cpp
+ *
+ * Q16.16 fixed point arithmetic and formatting, for processing data
+ * without floating point operations
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Standard Library Includes
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+/*
+ * Local Includes
+ */
+
+#include "DLUtility.FixedPoint.h"
+
+/*
+ * Private Functions
+ */
+
+/*
+ * saturate
+ *
+ * Limit a 64-bit intermediate result to the FIXED range
+ */
+static FIXED saturate(int64_t value)
+{
+	if (value > (int64_t)FIXED_MAX) { return FIXED_MAX; }
+	if (value < (int64_t)FIXED_MIN) { return FIXED_MIN; }
+	return (FIXED)value;
+}
+
+/*
+ * writeDigits
+ *
+ * Write exactly nDigits decimal digits of value (with leading zeroes)
+ */
+static void writeDigits(char * buffer, uint64_t value, uint8_t nDigits)
+{
+	while (nDigits)
+	{
+		buffer[--nDigits] = '0' + (value % 10);
+		value /= 10;
+	}
+}
+
+/*
+ * countDigits
+ *
+ * Number of decimal digits needed to write value (at least one)
+ */
+static uint8_t countDigits(uint64_t value)
+{
+	uint8_t nDigits = 1;
+	while (value >= 10)
+	{
+		value /= 10;
+		nDigits++;
+	}
+	return nDigits;
+}
+
+/*
+ * Public Functions
+ */
+
+/*
+ * FIXED_FromInt
+ *
+ * Convert an integer to fixed point (saturates outside -32768 to 32767)
+ */
+FIXED FIXED_FromInt(int32_t value)
+{
+	return saturate((int64_t)value * FIXED_ONE);
+}
+
+/*
+ * FIXED_FromFloat
+ *
+ * Convert a float to fixed point, rounding to the nearest 1/65536 (saturates outside FIXED range)
+ */
+FIXED FIXED_FromFloat(float value)
+{
+	double scaled = (double)value * FIXED_ONE;
+	scaled += (scaled < 0.0) ? -0.5 : 0.5;
+
+	if (scaled >= (double)FIXED_MAX) { return FIXED_MAX; }
+	if (scaled <= (double)FIXED_MIN) { return FIXED_MIN; }
+	return (FIXED)scaled;
+}
+
+/*
+ * FIXED_ToFloat
+ *
+ * Convert fixed point to float
+ */
+float FIXED_ToFloat(FIXED value)
+{
+	return (float)value / (float)FIXED_ONE;
+}
+
+/*
+ * FIXED_Add
+ *
+ * Add two fixed point values (saturates instead of overflowing)
+ */
+FIXED FIXED_Add(FIXED a, FIXED b)
+{
+	return saturate((int64_t)a + b);
+}
+
+/*
+ * FIXED_Average
+ *
+ * Get the average of integer samples as fixed point, from their sum and count,
+ * rounding to the nearest 1/65536. Only integer division is used.
+ * The sum * 65536 must fit into an int64_t (i.e. |sum| < 2^47).
+ *
+ * sum: Sum of the samples
+ * count: Number of samples
+ */
+FIXED FIXED_Average(int64_t sum, uint32_t count)
+{
+	if (count == 0) { return 0; }
+
+	int64_t scaled = sum * FIXED_ONE;
+	int64_t half = count / 2;
+
+	// Round half away from zero
+	scaled = (scaled >= 0) ? (scaled + half) : (scaled - half);
+
+	return saturate(scaled / (int64_t)count);
+}
+
+/*
+ * FIXED_CoefficientFromFloat
+ *
+ * Convert a float coefficient into a mantissa and shift, keeping 30 significant bits.
+ * Coefficients too large to represent saturate, and coefficients too small are set to zero.
+ *
+ * value: The coefficient to convert
+ * coefficient: The converted coefficient
+ */
+void FIXED_CoefficientFromFloat(float value, FIXED_COEFFICIENT * coefficient)
+{
+	if (!coefficient) { return; }
+
+	int exponent;
+	double fraction = frexp((double)value, &exponent); // value = fraction * 2^exponent, 0.5 <= |fraction| < 1
+	int shift = 30 - exponent;
+
+	if ((value == 0.0f) || (shift > 62))
+	{
+		coefficient->mantissa = 0;
+		coefficient->shift = 0;
+	}
+	else if (shift < 0)
+	{
+		coefficient->mantissa = (value > 0.0f) ? FIXED_MAX : -FIXED_MAX;
+		coefficient->shift = 0;
+	}
+	else
+	{
+		double scaled = ldexp(fraction, 30);
+		coefficient->mantissa = (int32_t)(scaled + ((scaled < 0.0) ? -0.5 : 0.5));
+		coefficient->shift = (uint8_t)shift;
+	}
+}
+
+/*
+ * FIXED_MultiplyByCoefficient
+ *
+ * Multiply a fixed point value by a coefficient, rounding to the nearest 1/65536.
+ * The intermediate product is 64-bit so cannot overflow. The result saturates.
+ *
+ * value: Fixed point value
+ * coefficient: Coefficient to multiply by
+ */
+FIXED FIXED_MultiplyByCoefficient(FIXED value, FIXED_COEFFICIENT const * coefficient)
+{
+	int64_t product = (int64_t)value * coefficient->mantissa;
+
+	if (coefficient->shift > 0)
+	{
+		product += (int64_t)1 << (coefficient->shift - 1);
+		product >>= coefficient->shift;
+	}
+
+	return saturate(product);
+}
+
+/*
+ * FIXED_ToString
+ *
+ * Write a fixed point value as a decimal string, like printf("%.nf"),
+ * using only integer operations.
+ *
+ * buffer: Buffer to write to (needs space for sign, 5 integer digits, point, decimals and terminator)
+ * value: Value to write
+ * decimals: Number of decimal places (up to FIXED_MAX_DECIMALS)
+ *
+ * Returns the length of the string written
+ */
+uint8_t FIXED_ToString(char * buffer, FIXED value, uint8_t decimals)
+{
+	if (!buffer) { return 0; }
+
+	if (decimals > FIXED_MAX_DECIMALS) { decimals = FIXED_MAX_DECIMALS; }
+
+	uint8_t length = 0;
+	uint64_t magnitude = (value < 0) ? (uint64_t)(-(int64_t)value) : (uint64_t)value;
+
+	uint64_t scale = 1;
+	uint8_t i;
+	for (i = 0; i < decimals; i++) { scale *= 10; }
+
+	// Round the fractional part to the requested number of decimal places.
+	// Fixed point values are exact, so ties are possible: like printf, round these to even.
+	uint64_t integer = magnitude >> FIXED_FRACTIONAL_BITS;
+	uint64_t scaledFraction = (magnitude & (FIXED_ONE - 1)) * scale;
+	uint64_t fraction = scaledFraction >> FIXED_FRACTIONAL_BITS;
+	uint64_t remainder = scaledFraction & (FIXED_ONE - 1);
+	bool lastDigitIsOdd = ((integer * scale) + fraction) & 1;
+
+	if ((remainder > (FIXED_ONE / 2)) || ((remainder == (FIXED_ONE / 2)) && lastDigitIsOdd))
+	{
+		fraction++;
+	}
+
+	if (fraction >= scale)
+	{
+		integer++;
+		fraction -= scale;
+	}
+
+	if (value < 0) { buffer[length++] = '-'; }
+
+	uint8_t nDigits = countDigits(integer);
+	writeDigits(&buffer[length], integer, nDigits);
+	length += nDigits;
+
+	if (decimals)
+	{
+		buffer[length++] = '.';
+		writeDigits(&buffer[length], fraction, decimals);
+		length += decimals;
+	}
+
+	buffer[length] = '\0';
+
+	return length;
+}
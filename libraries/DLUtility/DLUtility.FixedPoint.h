@@ -0,0 +1,46 @@
+#ifndef _DL_FIXEDPOINT_H_
+#define _DL_FIXEDPOINT_H_
+
+/*
+ * Defines and Typedefs
+ */
+
+/* Q16.16 fixed point: signed 16-bit integer part, 16-bit fractional part.
+Range is -32768.0 to +32767.99998, resolution is 1/65536 (about 0.000015) */
+typedef int32_t FIXED;
+
+#define FIXED_FRACTIONAL_BITS (16)
+#define FIXED_ONE ((FIXED)1 << FIXED_FRACTIONAL_BITS)
+
+#define FIXED_MAX ((FIXED)0x7FFFFFFF)
+#define FIXED_MIN (-FIXED_MAX - 1)
+
+// Most decimal places FIXED_ToString will write
+#define FIXED_MAX_DECIMALS (9)
+
+/* Q16.16 does not have enough resolution for small multipliers (e.g. mV per bit / 1000),
+so coefficients are stored as a 31-bit mantissa and shift: value = mantissa / 2^shift */
+struct fixed_coefficient
+{
+	int32_t mantissa;
+	uint8_t shift;
+};
+typedef struct fixed_coefficient FIXED_COEFFICIENT;
+
+/*
+ * Public Functions
+ */
+
+FIXED FIXED_FromInt(int32_t value);
+FIXED FIXED_FromFloat(float value);
+float FIXED_ToFloat(FIXED value);
+
+FIXED FIXED_Add(FIXED a, FIXED b);
+FIXED FIXED_Average(int64_t sum, uint32_t count);
+
+void FIXED_CoefficientFromFloat(float value, FIXED_COEFFICIENT * coefficient);
+FIXED FIXED_MultiplyByCoefficient(FIXED value, FIXED_COEFFICIENT const * coefficient);
+
+uint8_t FIXED_ToString(char * buffer, FIXED value, uint8_t decimals);
+
+#endif
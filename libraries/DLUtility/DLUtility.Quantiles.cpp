@@ -0,0 +1,214 @@
+/*
+ * DLUtility.Quantiles.cpp
+ *
+ * Streaming quantile estimation in fixed memory (merging t-digest)
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Standard Library Includes
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+ * Generic Library Includes
+ */
+
+#include "DLUtility.Quantiles.h"
+
+/*
+ * Private Functions
+ */
+
+static int compareCentroids(const void * a, const void * b)
+{
+	float x = ((CENTROID const *)a)->mean;
+	float y = ((CENTROID const *)b)->mean;
+	return (x > y) - (x < y);
+}
+
+/*
+ * QuantileSketch Class Definition
+ */
+
+QuantileSketch::QuantileSketch(uint8_t compression)
+{
+	if (compression < MIN_QUANTILE_COMPRESSION) { compression = MIN_QUANTILE_COMPRESSION; }
+
+	m_compression = compression;
+	m_size = 2 * ((uint16_t)compression + 1);
+	m_centroids = new CENTROID[m_size];
+	reset();
+}
+
+QuantileSketch::~QuantileSketch()
+{
+	delete[] m_centroids;
+}
+
+void QuantileSketch::reset(void)
+{
+	m_used = 0;
+	m_merged = 0;
+	m_count = 0;
+	m_min = 0.0f;
+	m_max = 0.0f;
+}
+
+/*
+ * add
+ *
+ * New samples are buffered after the merged centroids, and merged in when the buffer is full
+ */
+void QuantileSketch::add(float value)
+{
+	if (!m_centroids) { return; }
+
+	if (m_used == m_size) { compress(); }
+
+	if (m_count == 0)
+	{
+		m_min = value;
+		m_max = value;
+	}
+	else
+	{
+		if (value < m_min) { m_min = value; }
+		if (value > m_max) { m_max = value; }
+	}
+
+	m_centroids[m_used].mean = value;
+	m_centroids[m_used].weight = 1;
+	m_used++;
+	m_count++;
+}
+
+/*
+ * scale, inverseScale
+ *
+ * The t-digest k1 scale function, k(q) = C/2pi * asin(2q - 1), and its inverse.
+ * A centroid can span at most one unit of k, so centroids are smallest where the scale is steepest
+ * (the tails) and the total range of C/2 units bounds the number of centroids at C + 1.
+ */
+float QuantileSketch::scale(float q)
+{
+	return m_compression * asinf((2.0f * q) - 1.0f) / (2.0f * (float)M_PI);
+}
+
+float QuantileSketch::inverseScale(float k)
+{
+	if (k >= m_compression / 4.0f) { return 1.0f; }
+	return (sinf(k * 2.0f * (float)M_PI / m_compression) + 1.0f) / 2.0f;
+}
+
+/*
+ * compress
+ *
+ * Sort the merged centroids and buffered samples together, then merge neighbours
+ * (in place: a centroid is only ever written at or before the position it was read from)
+ * while they fit within one unit of the scale function.
+ */
+void QuantileSketch::compress(void)
+{
+	if (m_used == m_merged) { return; }
+
+	uint16_t i;
+	uint16_t out = 0;
+	uint32_t weightSoFar = 0;
+	CENTROID current;
+	float qLimit;
+
+	qsort(m_centroids, m_used, sizeof(CENTROID), compareCentroids);
+
+	current = m_centroids[0];
+	qLimit = inverseScale(scale(0.0f) + 1.0f);
+
+	for (i = 1; i < m_used; i++)
+	{
+		uint32_t proposed = current.weight + m_centroids[i].weight;
+
+		if ((float)(weightSoFar + proposed) / (float)m_count <= qLimit)
+		{
+			current.mean += (m_centroids[i].mean - current.mean) * m_centroids[i].weight / proposed;
+			current.weight = proposed;
+		}
+		else
+		{
+			weightSoFar += current.weight;
+			m_centroids[out++] = current;
+			qLimit = inverseScale(scale((float)weightSoFar / (float)m_count) + 1.0f);
+			current = m_centroids[i];
+		}
+	}
+
+	m_centroids[out++] = current;
+	m_used = out;
+	m_merged = out;
+}
+
+/*
+ * quantile
+ *
+ * Estimate the qth quantile (0 to 1) of the samples added since the last reset.
+ * Each centroid's mean is taken to be at the middle of its weight, with linear interpolation
+ * between centroids (and out to the exact minimum and maximum at the ends).
+ *
+ * Returns 0 if there are no samples
+ */
+float QuantileSketch::quantile(float q)
+{
+	if (m_count == 0) { return 0.0f; }
+
+	compress();
+
+	if (q <= 0.0f) { return m_min; }
+	if (q >= 1.0f) { return m_max; }
+
+	uint16_t i;
+	float index = q * (float)m_count;
+	float left = 0.0f;
+	float centre;
+	float nextCentre;
+
+	centre = m_centroids[0].weight / 2.0f;
+	if (index < centre)
+	{
+		return m_min + ((m_centroids[0].mean - m_min) * index / centre);
+	}
+
+	for (i = 0; i < (m_used - 1); i++)
+	{
+		nextCentre = left + m_centroids[i].weight + (m_centroids[i + 1].weight / 2.0f);
+
+		if (index < nextCentre)
+		{
+			return m_centroids[i].mean +
+				((m_centroids[i + 1].mean - m_centroids[i].mean) * (index - centre) / (nextCentre - centre));
+		}
+
+		left += m_centroids[i].weight;
+		centre = nextCentre;
+	}
+
+	// Between the last centroid's centre and the maximum
+	return m_centroids[i].mean +
+		((m_max - m_centroids[i].mean) * (index - centre) / ((float)m_count - centre));
+}
+
+uint32_t QuantileSketch::count(void)
+{
+	return m_count;
+}
+
+uint16_t QuantileSketch::centroidCount(void)
+{
+	compress();
+	return m_used;
+}
@@ -0,0 +1,55 @@
+#ifndef _DL_QUANTILES_H_
+#define _DL_QUANTILES_H_
+
+/*
+ * Defines and Typedefs
+ */
+
+// Compressions below this are raised to it (the sketch is too coarse to be useful)
+#define MIN_QUANTILE_COMPRESSION (10)
+
+struct centroid
+{
+	float mean;
+	uint32_t weight;
+};
+typedef struct centroid CENTROID;
+
+/*
+ * QuantileSketch
+ *
+ * Streaming quantile estimate in fixed memory (a merging t-digest).
+ * Samples are clustered into centroids, which are kept small near the ends of the distribution
+ * and allowed to grow near the middle, so tail quantiles stay accurate.
+ * With compression C, there are at most C + 1 centroids: storage is 2 * (C + 1) centroids
+ * (half as a buffer for new samples), 8 bytes each. Higher compression is more accurate.
+ */
+class QuantileSketch
+{
+	public:
+		QuantileSketch(uint8_t compression);
+		~QuantileSketch();
+
+		void add(float value);
+		float quantile(float q);
+		void reset(void);
+
+		uint32_t count(void);
+		uint16_t centroidCount(void);
+
+	private:
+		void compress(void);
+		float scale(float q);
+		float inverseScale(float k);
+
+		CENTROID * m_centroids;
+		uint16_t m_size;
+		uint16_t m_used;
+		uint16_t m_merged;
+		uint32_t m_count;
+		float m_min;
+		float m_max;
+		float m_compression;
+};
+
+#endif
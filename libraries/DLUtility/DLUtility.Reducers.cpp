@@ -0,0 +1,538 @@
+/*
+ * DLUtility.Reducers.cpp
+ *
+ * Alternatives to the boxcar mean for reducing a window of samples to one value:
+ * median, trimmed mean, exponential moving average and CIC decimation
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Standard Library Includes
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Generic Library Includes
+ */
+
+#include "DLUtility.Averager.h"
+#include "DLUtility.Reducers.h"
+#include "DLUtility.HelperMacros.h"
+
+/*
+ * Defines and Typedefs
+ */
+
+#define NO_NODE (0xFFFF)
+
+/*
+ * OrderStatisticTree Class Definition
+ */
+
+template <typename T>
+OrderStatisticTree<T>::OrderStatisticTree(uint16_t capacity)
+{
+	m_values = new T[capacity];
+	m_sums = new typename AveragerSum<T>::type[capacity];
+	m_left = new uint16_t[capacity];
+	m_right = new uint16_t[capacity];
+	m_sizes = new uint16_t[capacity];
+	m_priorities = new uint16_t[capacity];
+	m_random = 2463534242UL;
+	clear();
+}
+
+template <typename T>
+OrderStatisticTree<T>::~OrderStatisticTree()
+{
+	delete[] m_values;
+	delete[] m_sums;
+	delete[] m_left;
+	delete[] m_right;
+	delete[] m_sizes;
+	delete[] m_priorities;
+}
+
+template <typename T>
+void OrderStatisticTree<T>::clear(void)
+{
+	m_root = NO_NODE;
+}
+
+/* Nodes are ordered by value, then by node number (so that every node has a unique position) */
+template <typename T>
+bool OrderStatisticTree<T>::less(uint16_t a, uint16_t b)
+{
+	return (m_values[a] < m_values[b]) || ((m_values[a] == m_values[b]) && (a < b));
+}
+
+template <typename T>
+uint16_t OrderStatisticTree<T>::size(uint16_t node)
+{
+	return (node == NO_NODE) ? 0 : m_sizes[node];
+}
+
+template <typename T>
+typename AveragerSum<T>::type OrderStatisticTree<T>::sum(uint16_t node)
+{
+	return (node == NO_NODE) ? 0 : m_sums[node];
+}
+
+template <typename T>
+void OrderStatisticTree<T>::update(uint16_t node)
+{
+	m_sizes[node] = 1 + size(m_left[node]) + size(m_right[node]);
+	m_sums[node] = m_values[node] + sum(m_left[node]) + sum(m_right[node]);
+}
+
+/*
+ * merge
+ *
+ * Join two trees, where every node in left is less than every node in right
+ */
+template <typename T>
+uint16_t OrderStatisticTree<T>::merge(uint16_t left, uint16_t right)
+{
+	if (left == NO_NODE) { return right; }
+	if (right == NO_NODE) { return left; }
+
+	if (m_priorities[left] > m_priorities[right])
+	{
+		m_right[left] = merge(m_right[left], right);
+		update(left);
+		return left;
+	}
+	else
+	{
+		m_left[right] = merge(left, m_left[right]);
+		update(right);
+		return right;
+	}
+}
+
+/*
+ * split
+ *
+ * Split a tree into the nodes less than node (left) and the rest (right)
+ */
+template <typename T>
+void OrderStatisticTree<T>::split(uint16_t tree, uint16_t node, uint16_t * left, uint16_t * right)
+{
+	if (tree == NO_NODE)
+	{
+		*left = NO_NODE;
+		*right = NO_NODE;
+		return;
+	}
+
+	if (less(tree, node))
+	{
+		split(m_right[tree], node, &m_right[tree], right);
+		*left = tree;
+	}
+	else
+	{
+		split(m_left[tree], node, left, &m_left[tree]);
+		*right = tree;
+	}
+	update(tree);
+}
+
+template <typename T>
+uint16_t OrderStatisticTree<T>::erase(uint16_t tree, uint16_t node)
+{
+	if (tree == NO_NODE) { return NO_NODE; }
+
+	if (tree == node)
+	{
+		return merge(m_left[tree], m_right[tree]);
+	}
+
+	if (less(node, tree))
+	{
+		m_left[tree] = erase(m_left[tree], node);
+	}
+	else
+	{
+		m_right[tree] = erase(m_right[tree], node);
+	}
+	update(tree);
+	return tree;
+}
+
+/*
+ * insert
+ *
+ * Add a value as the given node (which must not already be in the tree)
+ */
+template <typename T>
+void OrderStatisticTree<T>::insert(uint16_t node, T value)
+{
+	uint16_t left;
+	uint16_t right;
+
+	// Random priorities keep the tree balanced (xorshift32)
+	m_random ^= m_random << 13;
+	m_random ^= m_random >> 17;
+	m_random ^= m_random << 5;
+
+	m_values[node] = value;
+	m_priorities[node] = (uint16_t)(m_random >> 16);
+	m_left[node] = NO_NODE;
+	m_right[node] = NO_NODE;
+	update(node);
+
+	split(m_root, node, &left, &right);
+	m_root = merge(merge(left, node), right);
+}
+
+template <typename T>
+void OrderStatisticTree<T>::remove(uint16_t node)
+{
+	m_root = erase(m_root, node);
+}
+
+template <typename T>
+uint16_t OrderStatisticTree<T>::count(void)
+{
+	return size(m_root);
+}
+
+/*
+ * select
+ *
+ * Returns the value of the given rank (0 is the smallest value)
+ */
+template <typename T>
+T OrderStatisticTree<T>::select(uint16_t rank)
+{
+	uint16_t node = m_root;
+
+	while (node != NO_NODE)
+	{
+		uint16_t leftSize = size(m_left[node]);
+		if (rank < leftSize)
+		{
+			node = m_left[node];
+		}
+		else if (rank == leftSize)
+		{
+			return m_values[node];
+		}
+		else
+		{
+			rank -= leftSize + 1;
+			node = m_right[node];
+		}
+	}
+	return 0;
+}
+
+/*
+ * sumSmallest
+ *
+ * Returns the sum of the n smallest values
+ */
+template <typename T>
+typename AveragerSum<T>::type OrderStatisticTree<T>::sumSmallest(uint16_t n)
+{
+	typename AveragerSum<T>::type total = 0;
+	uint16_t node = m_root;
+
+	while ((node != NO_NODE) && n)
+	{
+		uint16_t leftSize = size(m_left[node]);
+		if (n <= leftSize)
+		{
+			node = m_left[node];
+		}
+		else
+		{
+			total += sum(m_left[node]) + m_values[node];
+			n -= leftSize + 1;
+			node = m_right[node];
+		}
+	}
+	return total;
+}
+
+/*
+ * OrderStatisticReducer Class Definition
+ */
+
+template <typename T>
+OrderStatisticReducer<T>::OrderStatisticReducer(uint16_t size) : m_tree(size)
+{
+	m_write = 0;
+	m_maxIndex = size - 1;
+}
+
+/*
+ * newData
+ *
+ * Each sample is a tree node numbered by its position in the window,
+ * so a full window replaces the oldest sample's node. O(log N).
+ */
+template <typename T>
+void OrderStatisticReducer<T>::newData(T sample)
+{
+	if (m_tree.count() == (m_maxIndex + 1)) { m_tree.remove(m_write); }
+	m_tree.insert(m_write, sample);
+	incrementwithrollover(m_write, m_maxIndex);
+}
+
+template <typename T>
+void OrderStatisticReducer<T>::restart(void)
+{
+	m_tree.clear();
+	m_write = 0;
+}
+
+template <typename T>
+uint16_t OrderStatisticReducer<T>::N(void)
+{
+	return m_tree.count();
+}
+
+/*
+ * MedianReducer Class Definition
+ */
+
+template <typename T>
+MedianReducer<T>::MedianReducer(uint16_t size) : OrderStatisticReducer<T>(size) {}
+
+template <typename T>
+float MedianReducer<T>::getFloatResult(void)
+{
+	uint16_t count = this->m_tree.count();
+	if (count == 0) { return 0.0f; }
+
+	if (count & 1)
+	{
+		return (float)this->m_tree.select(count / 2);
+	}
+	else
+	{
+		return ((float)this->m_tree.select((count / 2) - 1) + (float)this->m_tree.select(count / 2)) / 2.0f;
+	}
+}
+
+/*
+ * TrimmedMeanReducer Class Definition
+ */
+
+template <typename T>
+TrimmedMeanReducer<T>::TrimmedMeanReducer(uint16_t size, uint8_t trimPercent) : OrderStatisticReducer<T>(size)
+{
+	m_trimPercent = min(trimPercent, 49);
+}
+
+template <typename T>
+float TrimmedMeanReducer<T>::getFloatResult(void)
+{
+	uint16_t count = this->m_tree.count();
+	if (count == 0) { return 0.0f; }
+
+	uint16_t trim = ((uint32_t)count * m_trimPercent) / 100;
+	typename AveragerSum<T>::type sum = this->m_tree.sumSmallest(count - trim) - this->m_tree.sumSmallest(trim);
+
+	return (float)sum / (float)(count - (2 * trim));
+}
+
+/*
+ * EMAReducer Class Definition
+ */
+
+template <typename T>
+EMAReducer<T>::EMAReducer(uint16_t size)
+{
+	m_alpha = 2.0f / ((float)size + 1.0f);
+	m_value = 0.0f;
+	m_count = 0;
+	m_started = false;
+}
+
+template <typename T>
+void EMAReducer<T>::newData(T sample)
+{
+	if (m_started)
+	{
+		m_value += m_alpha * ((float)sample - m_value);
+	}
+	else
+	{
+		// Start from the first sample rather than from zero
+		m_value = (float)sample;
+		m_started = true;
+	}
+	if (m_count < 0xFFFF) { m_count++; }
+}
+
+template <typename T>
+float EMAReducer<T>::getFloatResult(void)
+{
+	return m_value;
+}
+
+template <typename T>
+void EMAReducer<T>::restart(void)
+{
+	m_count = 0;
+}
+
+template <typename T>
+uint16_t EMAReducer<T>::N(void)
+{
+	return m_count;
+}
+
+/*
+ * CICReducer Class Definition
+ */
+
+template <typename T>
+CICReducer<T>::CICReducer(uint16_t decimation, uint8_t order)
+{
+	uint8_t stage;
+
+	m_decimation = decimation ? decimation : 1;
+	m_order = (order < 1) ? 1 : min(order, MAX_CIC_ORDER);
+	m_phase = 0;
+	m_count = 0;
+	m_outputs = 0;
+	m_result = 0.0f;
+
+	m_gain = 1.0;
+	for (stage = 0; stage < m_order; stage++)
+	{
+		m_gain *= m_decimation;
+		m_integrators[stage] = 0;
+		m_combs[stage] = 0;
+		m_startupIntegrators[stage] = 0;
+		m_startupCombs[stage] = 0;
+	}
+}
+
+/*
+ * newData
+ *
+ * Integrate the sample through each stage: O(order).
+ * Integrators are unsigned so that they wrap instead of overflowing: the comb stages
+ * undo the wrapping, as long as the final result fits.
+ */
+template <typename T>
+void CICReducer<T>::newData(T sample)
+{
+	uint8_t stage;
+	uint64_t value = (uint64_t)(int64_t)sample;
+
+	for (stage = 0; stage < m_order; stage++)
+	{
+		m_integrators[stage] += value;
+		value = m_integrators[stage];
+	}
+
+	/* Until the filter has seen order * decimation samples, its gain is less than decimation^order.
+	The actual gain is found by filtering a constant 1 alongside the samples. */
+	if (m_outputs < m_order)
+	{
+		value = 1;
+		for (stage = 0; stage < m_order; stage++)
+		{
+			m_startupIntegrators[stage] += value;
+			value = m_startupIntegrators[stage];
+		}
+	}
+
+	if (m_count < 0xFFFF) { m_count++; }
+
+	if (++m_phase == m_decimation)
+	{
+		m_phase = 0;
+		decimate();
+	}
+}
+
+template <typename T>
+void CICReducer<T>::decimate(void)
+{
+	uint8_t stage;
+	uint64_t delayed;
+	uint64_t value = m_integrators[m_order - 1];
+	double gain = m_gain;
+
+	for (stage = 0; stage < m_order; stage++)
+	{
+		delayed = m_combs[stage];
+		m_combs[stage] = value;
+		value -= delayed;
+	}
+
+	if (m_outputs < m_order)
+	{
+		uint64_t startupGain = m_startupIntegrators[m_order - 1];
+		for (stage = 0; stage < m_order; stage++)
+		{
+			delayed = m_startupCombs[stage];
+			m_startupCombs[stage] = startupGain;
+			startupGain -= delayed;
+		}
+		gain = (double)startupGain;
+		m_outputs++;
+	}
+
+	m_result = (float)((double)(int64_t)value / gain);
+}
+
+template <typename T>
+float CICReducer<T>::getFloatResult(void)
+{
+	return m_result;
+}
+
+template <typename T>
+void CICReducer<T>::restart(void)
+{
+	m_count = 0;
+}
+
+template <typename T>
+uint16_t CICReducer<T>::N(void)
+{
+	return m_count;
+}
+
+template class OrderStatisticTree<float>;
+template class OrderStatisticTree<int16_t>;
+template class OrderStatisticTree<uint16_t>;
+template class OrderStatisticTree<int32_t>;
+
+template class OrderStatisticReducer<float>;
+template class OrderStatisticReducer<int16_t>;
+template class OrderStatisticReducer<uint16_t>;
+template class OrderStatisticReducer<int32_t>;
+
+template class MedianReducer<float>;
+template class MedianReducer<int16_t>;
+template class MedianReducer<uint16_t>;
+template class MedianReducer<int32_t>;
+
+template class TrimmedMeanReducer<float>;
+template class TrimmedMeanReducer<int16_t>;
+template class TrimmedMeanReducer<uint16_t>;
+template class TrimmedMeanReducer<int32_t>;
+
+template class EMAReducer<float>;
+template class EMAReducer<int16_t>;
+template class EMAReducer<uint16_t>;
+template class EMAReducer<int32_t>;
+
+template class CICReducer<int16_t>;
+template class CICReducer<uint16_t>;
+template class CICReducer<int32_t>;
@@ -0,0 +1,163 @@
+#ifndef _DL_REDUCERS_H_
+#define _DL_REDUCERS_H_
+
+/*
+ * Defines and Typedefs
+ */
+
+/* Reducers use AveragerSum (DLUtility.Averager.h) for sums of samples */
+
+// Highest order of CIC decimator. With 16-bit samples, order * log2(decimation) must be less than 48.
+#define MAX_CIC_ORDER (3)
+
+/*
+ * Reducer
+ *
+ * Common interface for reducing a window of samples to a single value.
+ * Samples are added one at a time, the result can be read at any time
+ * and restart begins a new window.
+ */
+template <typename T>
+class Reducer
+{
+	public:
+		virtual ~Reducer() {}
+		virtual void newData(T sample) = 0;
+		virtual float getFloatResult(void) = 0;
+		virtual void restart(void) = 0;
+		virtual uint16_t N(void) = 0;
+};
+
+/*
+ * OrderStatisticTree
+ *
+ * Up to capacity values kept in order in a treap, where each node also holds the size and sum
+ * of its subtree. Insert, remove, select (nth smallest value) and sumSmallest are O(log N).
+ * Nodes are numbered by the caller (e.g. the position of the sample in a window),
+ * so nothing is allocated after construction.
+ */
+template <typename T>
+class OrderStatisticTree
+{
+	public:
+		OrderStatisticTree(uint16_t capacity);
+		~OrderStatisticTree();
+
+		void clear(void);
+		void insert(uint16_t node, T value);
+		void remove(uint16_t node);
+
+		uint16_t count(void);
+		T select(uint16_t rank);
+		typename AveragerSum<T>::type sumSmallest(uint16_t n);
+
+	private:
+		bool less(uint16_t a, uint16_t b);
+		uint16_t size(uint16_t node);
+		typename AveragerSum<T>::type sum(uint16_t node);
+		void update(uint16_t node);
+		uint16_t merge(uint16_t left, uint16_t right);
+		void split(uint16_t tree, uint16_t node, uint16_t * left, uint16_t * right);
+		uint16_t erase(uint16_t tree, uint16_t node);
+
+		T * m_values;
+		typename AveragerSum<T>::type * m_sums;
+		uint16_t * m_left;
+		uint16_t * m_right;
+		uint16_t * m_sizes;
+		uint16_t * m_priorities;
+		uint16_t m_root;
+		uint32_t m_random;
+};
+
+/*
+ * OrderStatisticReducer
+ *
+ * Base for reducers that need the window's samples in order. Like Averager, once size samples
+ * have been added, each new sample replaces the oldest.
+ */
+template <typename T>
+class OrderStatisticReducer : public Reducer<T>
+{
+	public:
+		OrderStatisticReducer(uint16_t size);
+		void newData(T sample);
+		void restart(void);
+		uint16_t N(void);
+
+	protected:
+		OrderStatisticTree<T> m_tree;
+
+	private:
+		uint16_t m_write;
+		uint16_t m_maxIndex;
+};
+
+template <typename T>
+class MedianReducer : public OrderStatisticReducer<T>
+{
+	public:
+		MedianReducer(uint16_t size);
+		float getFloatResult(void);
+};
+
+/* Mean of the samples after discarding trimPercent of them from each end */
+template <typename T>
+class TrimmedMeanReducer : public OrderStatisticReducer<T>
+{
+	public:
+		TrimmedMeanReducer(uint16_t size, uint8_t trimPercent);
+		float getFloatResult(void);
+
+	private:
+		uint8_t m_trimPercent;
+};
+
+/* Exponential moving average with the same smoothing as a size-sample window (alpha = 2 / (size + 1)).
+The filter runs continuously: restarting only resets the sample count. */
+template <typename T>
+class EMAReducer : public Reducer<T>
+{
+	public:
+		EMAReducer(uint16_t size);
+		void newData(T sample);
+		float getFloatResult(void);
+		void restart(void);
+		uint16_t N(void);
+
+	private:
+		float m_alpha;
+		float m_value;
+		uint16_t m_count;
+		bool m_started;
+};
+
+/* Cascaded integrator-comb decimator: the result is updated once every decimation samples.
+Integer types only. The filter runs continuously: restarting only resets the sample count. */
+template <typename T>
+class CICReducer : public Reducer<T>
+{
+	public:
+		CICReducer(uint16_t decimation, uint8_t order);
+		void newData(T sample);
+		float getFloatResult(void);
+		void restart(void);
+		uint16_t N(void);
+
+	private:
+		void decimate(void);
+
+		uint64_t m_integrators[MAX_CIC_ORDER];
+		uint64_t m_combs[MAX_CIC_ORDER];
+		uint64_t m_startupIntegrators[MAX_CIC_ORDER];
+		uint64_t m_startupCombs[MAX_CIC_ORDER];
+		double m_gain;
+		float m_result;
+		uint16_t m_decimation;
+		uint16_t m_phase;
+		uint16_t m_count;
+		uint8_t m_order;
+		uint8_t m_outputs;
+};
+
+#endif
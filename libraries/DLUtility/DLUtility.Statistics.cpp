@@ -0,0 +1,118 @@
+/*
+ * DLUtility.Statistics.cpp
+ *
+ * Single-pass running statistics (min, max, mean and standard deviation)
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Standard Library Includes
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+/*
+ * Local Includes
+ */
+
+#include "DLUtility.Statistics.h"
+
+/*
+ * Public Functions
+ */
+
+void STATS_Reset(RUNNING_STATISTICS * stats)
+{
+	if (!stats) { return; }
+
+	stats->count = 0;
+	stats->min = 0;
+	stats->max = 0;
+	stats->mean = 0.0;
+	stats->m2 = 0.0;
+}
+
+/*
+ * STATS_Add
+ *
+ * Add a sample. The mean and sum of squared differences are updated incrementally,
+ * which does not lose precision like subtracting a sum of squares would.
+ */
+void STATS_Add(RUNNING_STATISTICS * stats, int32_t sample)
+{
+	if (!stats) { return; }
+
+	if (stats->count == 0)
+	{
+		stats->min = sample;
+		stats->max = sample;
+	}
+	else
+	{
+		if (sample < stats->min) { stats->min = sample; }
+		if (sample > stats->max) { stats->max = sample; }
+	}
+
+	stats->count++;
+
+	double delta = (double)sample - stats->mean;
+	stats->mean += delta / stats->count;
+	stats->m2 += delta * ((double)sample - stats->mean);
+}
+
+/*
+ * STATS_Merge
+ *
+ * Combine the statistics of another set of samples into stats,
+ * as if all of those samples had been added to stats.
+ *
+ * stats: The statistics to update
+ * other: The statistics to add (unchanged)
+ */
+void STATS_Merge(RUNNING_STATISTICS * stats, RUNNING_STATISTICS const * other)
+{
+	if (!stats || !other) { return; }
+	if (other->count == 0) { return; }
+
+	if (stats->count == 0)
+	{
+		*stats = *other;
+		return;
+	}
+
+	if (other->min < stats->min) { stats->min = other->min; }
+	if (other->max > stats->max) { stats->max = other->max; }
+
+	uint32_t count = stats->count + other->count;
+	double delta = other->mean - stats->mean;
+
+	stats->mean += delta * other->count / count;
+	stats->m2 += other->m2 + (delta * delta * stats->count * other->count / count);
+	stats->count = count;
+}
+
+float STATS_Mean(RUNNING_STATISTICS const * stats)
+{
+	return (stats && stats->count) ? (float)stats->mean : 0.0f;
+}
+
+/*
+ * STATS_Variance, STATS_StdDev
+ *
+ * The variance and standard deviation of all samples added
+ * (these are population values: all the samples are known)
+ */
+float STATS_Variance(RUNNING_STATISTICS const * stats)
+{
+	return (stats && stats->count) ? (float)(stats->m2 / stats->count) : 0.0f;
+}
+
+float STATS_StdDev(RUNNING_STATISTICS const * stats)
+{
+	return sqrtf(STATS_Variance(stats));
+}
@@ -0,0 +1,32 @@
+#ifndef _DL_STATISTICS_H_
+#define _DL_STATISTICS_H_
+
+/*
+ * Defines and Typedefs
+ */
+
+/* Running statistics for a stream of integer samples, updated one sample at a time
+(Welford's method) so that the samples themselves never need to be kept */
+struct running_statistics
+{
+	uint32_t count;
+	int32_t min;
+	int32_t max;
+	double mean;
+	double m2; // Sum of squared differences from the mean
+};
+typedef struct running_statistics RUNNING_STATISTICS;
+
+/*
+ * Public Functions
+ */
+
+void STATS_Reset(RUNNING_STATISTICS * stats);
+void STATS_Add(RUNNING_STATISTICS * stats, int32_t sample);
+void STATS_Merge(RUNNING_STATISTICS * stats, RUNNING_STATISTICS const * other);
+
+float STATS_Mean(RUNNING_STATISTICS const * stats);
+float STATS_Variance(RUNNING_STATISTICS const * stats);
+float STATS_StdDev(RUNNING_STATISTICS const * stats);
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ * DLUtility.Reducers.Benchmark.cpp
+ *
+ * Compares the per-sample cost of each reducer with the boxcar Averager,
+ * for a range of window sizes.
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "DLUtility.Averager.h"
+#include "DLUtility.Reducers.h"
+
+#define SAMPLES 1000000
+
+static int32_t s_samples[SAMPLES];
+
+// Results are summed so that the compiler cannot optimise the reducers away
+static double s_checksum = 0.0;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double nsPerSample(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / SAMPLES;
+}
+
+static double runAverager(uint16_t size, bool keepSamples)
+{
+	uint32_t i;
+	Averager<int32_t> averager(size, keepSamples);
+
+	Clock::time_point start = Clock::now();
+	for (i = 0; i < SAMPLES; i++)
+	{
+		averager.newData(s_samples[i]);
+		if ((i % size) == (uint32_t)(size - 1)) { s_checksum += averager.getFloatAverage(); }
+	}
+	return nsPerSample(start);
+}
+
+/* Reducers are restarted at the end of each window, as the aggregator does */
+static double runReducer(Reducer<int32_t> * reducer, uint16_t size)
+{
+	uint32_t i;
+
+	Clock::time_point start = Clock::now();
+	for (i = 0; i < SAMPLES; i++)
+	{
+		reducer->newData(s_samples[i]);
+		if ((i % size) == (uint32_t)(size - 1))
+		{
+			s_checksum += reducer->getFloatResult();
+			reducer->restart();
+		}
+	}
+	delete reducer;
+	return nsPerSample(start);
+}
+
+/* The sliding median gets a result after every sample */
+static double runSlidingMedian(uint16_t size)
+{
+	uint32_t i;
+	MedianReducer<int32_t> median = MedianReducer<int32_t>(size);
+
+	Clock::time_point start = Clock::now();
+	for (i = 0; i < SAMPLES; i++)
+	{
+		median.newData(s_samples[i]);
+		s_checksum += median.getFloatResult();
+	}
+	return nsPerSample(start);
+}
+
+static void report(uint16_t size)
+{
+	std::cout << "Window of " << size << " samples (ns per sample): ";
+	std::cout << "averager " << runAverager(size, false) << ", ";
+	std::cout << "sliding averager " << runAverager(size, true) << ", ";
+	std::cout << "median " << runReducer(new MedianReducer<int32_t>(size), size) << ", ";
+	std::cout << "sliding median " << runSlidingMedian(size) << ", ";
+	std::cout << "trimmed mean " << runReducer(new TrimmedMeanReducer<int32_t>(size, 10), size) << ", ";
+	std::cout << "EMA " << runReducer(new EMAReducer<int32_t>(size), size) << ", ";
+	std::cout << "CIC (order 3) " << runReducer(new CICReducer<int32_t>(size, 3), size) << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+	(void)argc; (void)argv;
+
+	uint32_t i;
+
+	// 16-bit ADC readings, with an occasional glitch
+	for (i = 0; i < SAMPLES; i++)
+	{
+		s_samples[i] = ((i % 997) == 0) ? 32767 : (rand() % 32768);
+	}
+
+	report(16);
+	report(256);
+	report(4096);
+
+	std::cout << "(checksum " << s_checksum << ")" << std::endl;
+
+	return 0;
+}
@@ -15,7 +15,7 @@
 template <typename T>
 void testReset(T expected_result)
 {
-	Averager<T> averager = Averager<T>(20);
+	Averager<T> averager(20);
 	averager.reset(&expected_result);
 
 	TEST_ASSERT_EQUAL(expected_result, averager.getAverage());
@@ -31,7 +31,7 @@ void testReset(T expected_result)
 template <typename T>
 void testRunning(T * data_ptr, uint16_t size, T expected_result, float expectedFloatResult)
 {
-	Averager<T> averager = Averager<T>(size);
+	Averager<T> averager(size);
 	averager.fillFromArray(data_ptr, size);
 	TEST_ASSERT_EQUAL(expected_result, averager.getAverage());
 	TEST_ASSERT_EQUAL_FLOAT(expectedFloatResult, averager.getFloatAverage());
@@ -110,7 +110,7 @@ void test_AveragerU32Reset(void) { testReset(u32resetValue); }
 
 void test_AveragerSizeIsCorrect(void)
 {
-	Averager<uint32_t> averager = Averager<uint32_t>(32);
+	Averager<uint32_t> averager(32);
 
 	uint8_t i;
 	for (i = 0; i < 32; i++)
@@ -122,6 +122,63 @@ void test_AveragerSizeIsCorrect(void)
 	TEST_ASSERT_TRUE(averager.full());
 }
 
+void test_AveragerSlidesWhenFullWithSamplesKept(void)
+{
+	Averager<int32_t> averager(4);
+
+	int32_t data[] = {10, 20, 30, 40, 50, 60};
+	averager.fillFromArray(data, 6);
+
+	// Only the last four values (30, 40, 50, 60) should be in the average
+	TEST_ASSERT_TRUE(averager.full());
+	TEST_ASSERT_EQUAL(4, averager.N());
+	TEST_ASSERT_EQUAL(45, averager.getAverage());
+	TEST_ASSERT_EQUAL_FLOAT(45.0f, averager.getFloatAverage());
+}
+
+void test_AveragerWithoutSamplesStartsNewWindowWhenFull(void)
+{
+	Averager<int32_t> averager(4, false);
+
+	int32_t data[] = {10, 20, 30, 40};
+	averager.fillFromArray(data, 4);
+
+	TEST_ASSERT_TRUE(averager.full());
+	TEST_ASSERT_EQUAL(25, averager.getAverage());
+
+	averager.newData(100);
+	TEST_ASSERT_FALSE(averager.full());
+	TEST_ASSERT_EQUAL(1, averager.N());
+	TEST_ASSERT_EQUAL(100, averager.getAverage());
+}
+
+void test_AveragerWithoutSamplesCanBeReset(void)
+{
+	Averager<int16_t> averager(10, false);
+	int16_t resetValue = -7;
+
+	averager.reset(&resetValue);
+	TEST_ASSERT_TRUE(averager.full());
+	TEST_ASSERT_EQUAL(-7, averager.getAverage());
+
+	averager.reset(NULL);
+	TEST_ASSERT_FALSE(averager.full());
+	TEST_ASSERT_EQUAL(0, averager.N());
+	TEST_ASSERT_EQUAL(0, averager.getAverage());
+}
+
+void test_AveragerSumDoesNotOverflowForLargeValues(void)
+{
+	Averager<uint32_t> averager(1000, false);
+
+	uint16_t i;
+	for (i = 0; i < 1000; i++)
+	{
+		averager.newData(4000000000UL);
+	}
+	TEST_ASSERT_EQUAL(4000000000UL, averager.getAverage());
+}
+
 //=======Test Reset Option=====
 void resetTest()
 {
@@ -149,6 +206,11 @@ int main(void)
 	RUN_TEST(test_AveragerU32Reset);
 
 	RUN_TEST(test_AveragerSizeIsCorrect);
+
+	RUN_TEST(test_AveragerSlidesWhenFullWithSamplesKept);
+	RUN_TEST(test_AveragerWithoutSamplesStartsNewWindowWhenFull);
+	RUN_TEST(test_AveragerWithoutSamplesCanBeReset);
+	RUN_TEST(test_AveragerSumDoesNotOverflowForLargeValues);
 	
 	return (UnityEnd());
 }
@@ -0,0 +1,116 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "../DLUtility.FixedPoint.h"
+
+static void test_ConversionToAndFromFixedPoint(void)
+{
+	TEST_ASSERT_EQUAL(FIXED_ONE, FIXED_FromInt(1));
+	TEST_ASSERT_EQUAL(-3 * FIXED_ONE, FIXED_FromInt(-3));
+	TEST_ASSERT_EQUAL(FIXED_ONE / 2, FIXED_FromFloat(0.5f));
+	TEST_ASSERT_EQUAL(-FIXED_ONE / 4, FIXED_FromFloat(-0.25f));
+
+	TEST_ASSERT_EQUAL_FLOAT(1.5f, FIXED_ToFloat(FIXED_FromFloat(1.5f)));
+	TEST_ASSERT_EQUAL_FLOAT(-32768.0f, FIXED_ToFloat(FIXED_FromInt(-32768)));
+}
+
+static void test_ConversionSaturates(void)
+{
+	TEST_ASSERT_EQUAL(FIXED_MAX, FIXED_FromInt(40000));
+	TEST_ASSERT_EQUAL(FIXED_MIN, FIXED_FromInt(-40000));
+	TEST_ASSERT_EQUAL(FIXED_MAX, FIXED_FromFloat(1.0e6f));
+	TEST_ASSERT_EQUAL(FIXED_MIN, FIXED_FromFloat(-1.0e6f));
+	TEST_ASSERT_EQUAL(FIXED_MAX, FIXED_Add(FIXED_MAX, FIXED_ONE));
+	TEST_ASSERT_EQUAL(FIXED_MIN, FIXED_Add(FIXED_MIN, -FIXED_ONE));
+}
+
+static void test_AverageIsRoundedToNearest(void)
+{
+	TEST_ASSERT_EQUAL(0, FIXED_Average(100, 0));
+	TEST_ASSERT_EQUAL(FIXED_FromInt(5), FIXED_Average(50, 10));
+	TEST_ASSERT_EQUAL(FIXED_FromFloat(-2.5f), FIXED_Average(-5, 2));
+
+	// 1/3 = 21845.33/65536 rounds down, 2/3 = 43690.67/65536 rounds up
+	TEST_ASSERT_EQUAL(21845, FIXED_Average(1, 3));
+	TEST_ASSERT_EQUAL(43691, FIXED_Average(2, 3));
+	TEST_ASSERT_EQUAL(-43691, FIXED_Average(-2, 3));
+
+	// Large sums (e.g. an hour of 16-bit ADC readings) do not overflow
+	TEST_ASSERT_EQUAL(FIXED_FromInt(32767), FIXED_Average((int64_t)32767 * 18000, 18000));
+}
+
+static void test_MultiplyByCoefficient(void)
+{
+	FIXED_COEFFICIENT coefficient;
+	float coefficients[] = {0.0f, 1.0f, -1.0f, 0.002625f, 0.000208333f, 3.75f, 1234.5f};
+	float values[] = {0.0f, 1.0f, -1.0f, 1023.0f, -32768.0f, 32767.0f, 0.0001f};
+	uint8_t c, v;
+	char message[128];
+
+	for (c = 0; c < 7; c++)
+	{
+		FIXED_CoefficientFromFloat(coefficients[c], &coefficient);
+		for (v = 0; v < 7; v++)
+		{
+			float expected = coefficients[c] * values[v];
+			if ((expected > 32767.0f) || (expected < -32768.0f)) { continue; }
+
+			float actual = FIXED_ToFloat(FIXED_MultiplyByCoefficient(FIXED_FromFloat(values[v]), &coefficient));
+			sprintf(message, "%f * %f: expected %f, actual %f", values[v], coefficients[c], expected, actual);
+
+			// Error is at most one least significant bit of the result (plus error in the input value)
+			float tolerance = (2.0f / FIXED_ONE) * (1.0f + (coefficients[c] < 0 ? -coefficients[c] : coefficients[c]));
+			TEST_ASSERT_FLOAT_WITHIN_MESSAGE(tolerance, expected, actual, message);
+		}
+	}
+}
+
+static void test_MultiplyByCoefficientSaturates(void)
+{
+	FIXED_COEFFICIENT coefficient;
+	FIXED_CoefficientFromFloat(1000.0f, &coefficient);
+	TEST_ASSERT_EQUAL(FIXED_MAX, FIXED_MultiplyByCoefficient(FIXED_FromInt(100), &coefficient));
+	TEST_ASSERT_EQUAL(FIXED_MIN, FIXED_MultiplyByCoefficient(FIXED_FromInt(-100), &coefficient));
+}
+
+static void test_ToStringMatchesPrintf(void)
+{
+	float values[] = {0.0f, 1.0f, -1.0f, 0.5f, 1.5f, 12.3456f, -12.3456f, 0.99999f, -0.00001f, 32767.9f, -32768.0f};
+	uint8_t decimals[] = {0, 1, 4};
+	char expected[32];
+	char actual[32];
+	char format[8];
+	uint8_t v, d;
+
+	for (d = 0; d < 3; d++)
+	{
+		sprintf(format, "%%.%df", decimals[d]);
+		for (v = 0; v < 11; v++)
+		{
+			FIXED value = FIXED_FromFloat(values[v]);
+			sprintf(expected, format, FIXED_ToFloat(value));
+			uint8_t length = FIXED_ToString(actual, value, decimals[d]);
+			TEST_ASSERT_EQUAL_STRING(expected, actual);
+			TEST_ASSERT_EQUAL(strlen(expected), length);
+		}
+	}
+}
+
+int main(void)
+{
+	UnityBegin("DLUtility.FixedPoint.cpp");
+
+	RUN_TEST(test_ConversionToAndFromFixedPoint);
+	RUN_TEST(test_ConversionSaturates);
+	RUN_TEST(test_AverageIsRoundedToNearest);
+	RUN_TEST(test_MultiplyByCoefficient);
+	RUN_TEST(test_MultiplyByCoefficientSaturates);
+	RUN_TEST(test_ToStringMatchesPrintf);
+
+	return (UnityEnd());
+}
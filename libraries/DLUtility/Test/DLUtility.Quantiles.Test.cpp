@@ -0,0 +1,151 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "unity.h"
+
+#include "../DLUtility.Quantiles.h"
+
+/*
+ * Private Test Functions
+ */
+
+static int compareFloat(const void * a, const void * b)
+{
+	float x = *(float const *)a;
+	float y = *(float const *)b;
+	return (x > y) - (x < y);
+}
+
+/* Reference quantile by sorting a copy of the samples (nearest rank) */
+static float referenceQuantile(float const * samples, uint16_t n, float q)
+{
+	static float sorted[5000];
+	memcpy(sorted, samples, n * sizeof(float));
+	qsort(sorted, n, sizeof(float), compareFloat);
+	return sorted[(uint16_t)(q * (n - 1) + 0.5f)];
+}
+
+static uint32_t s_random = 2463534242UL;
+
+static float randomFloat(void)
+{
+	s_random ^= s_random << 13;
+	s_random ^= s_random >> 17;
+	s_random ^= s_random << 5;
+	return (float)(s_random % 100000) / 100000.0f;
+}
+
+/*
+ * Tests
+ */
+
+static void test_EmptySketchReturnsZero(void)
+{
+	QuantileSketch sketch(20);
+	TEST_ASSERT_EQUAL(0, sketch.count());
+	TEST_ASSERT_EQUAL_FLOAT(0.0f, sketch.quantile(0.5f));
+}
+
+static void test_SingleSampleIsEveryQuantile(void)
+{
+	QuantileSketch sketch(20);
+	sketch.add(512.0f);
+	TEST_ASSERT_EQUAL_FLOAT(512.0f, sketch.quantile(0.05f));
+	TEST_ASSERT_EQUAL_FLOAT(512.0f, sketch.quantile(0.5f));
+	TEST_ASSERT_EQUAL_FLOAT(512.0f, sketch.quantile(0.95f));
+}
+
+static void test_ExtremesAreExact(void)
+{
+	QuantileSketch sketch(20);
+	uint16_t i;
+
+	for (i = 0; i < 1000; i++) { sketch.add(randomFloat() * 1000.0f - 500.0f); }
+	sketch.add(-1234.0f);
+	sketch.add(4321.0f);
+
+	TEST_ASSERT_EQUAL_FLOAT(-1234.0f, sketch.quantile(0.0f));
+	TEST_ASSERT_EQUAL_FLOAT(4321.0f, sketch.quantile(1.0f));
+}
+
+static void test_UniformQuantilesAreAccurate(void)
+{
+	QuantileSketch sketch(50);
+	static float samples[5000];
+	uint16_t i;
+
+	for (i = 0; i < 5000; i++)
+	{
+		samples[i] = randomFloat() * 1023.0f;
+		sketch.add(samples[i]);
+	}
+
+	// Within 1% of the range
+	TEST_ASSERT_FLOAT_WITHIN(10.0f, referenceQuantile(samples, 5000, 0.05f), sketch.quantile(0.05f));
+	TEST_ASSERT_FLOAT_WITHIN(10.0f, referenceQuantile(samples, 5000, 0.5f), sketch.quantile(0.5f));
+	TEST_ASSERT_FLOAT_WITHIN(10.0f, referenceQuantile(samples, 5000, 0.95f), sketch.quantile(0.95f));
+}
+
+static void test_SkewedTailsAreAccurate(void)
+{
+	// Mostly steady readings with occasional large spikes: the P95 must not be dragged towards the spikes
+	QuantileSketch sketch(100);
+	static float samples[2000];
+	uint16_t i;
+
+	for (i = 0; i < 2000; i++)
+	{
+		samples[i] = ((i % 50) == 0) ? 4000.0f + (float)i : 500.0f + (randomFloat() * 20.0f);
+		sketch.add(samples[i]);
+	}
+
+	TEST_ASSERT_FLOAT_WITHIN(2.0f, referenceQuantile(samples, 2000, 0.05f), sketch.quantile(0.05f));
+	TEST_ASSERT_FLOAT_WITHIN(2.0f, referenceQuantile(samples, 2000, 0.5f), sketch.quantile(0.5f));
+	TEST_ASSERT_FLOAT_WITHIN(2.0f, referenceQuantile(samples, 2000, 0.95f), sketch.quantile(0.95f));
+}
+
+static void test_MemoryIsBounded(void)
+{
+	QuantileSketch sketch(20);
+	uint32_t i;
+
+	for (i = 0; i < 100000; i++)
+	{
+		sketch.add(randomFloat());
+		TEST_ASSERT(sketch.centroidCount() <= 21);
+	}
+
+	TEST_ASSERT_EQUAL(100000, sketch.count());
+}
+
+static void test_ResetClearsSamples(void)
+{
+	QuantileSketch sketch(20);
+	uint16_t i;
+
+	for (i = 0; i < 100; i++) { sketch.add(1000.0f); }
+	sketch.reset();
+	TEST_ASSERT_EQUAL(0, sketch.count());
+
+	for (i = 0; i < 100; i++) { sketch.add(10.0f); }
+	TEST_ASSERT_EQUAL_FLOAT(10.0f, sketch.quantile(0.95f));
+}
+
+int main(void)
+{
+	UnityBegin("DLUtility.Quantiles.cpp");
+
+	RUN_TEST(test_EmptySketchReturnsZero);
+	RUN_TEST(test_SingleSampleIsEveryQuantile);
+	RUN_TEST(test_ExtremesAreExact);
+	RUN_TEST(test_UniformQuantilesAreAccurate);
+	RUN_TEST(test_SkewedTailsAreAccurate);
+	RUN_TEST(test_MemoryIsBounded);
+	RUN_TEST(test_ResetClearsSamples);
+
+	return (UnityEnd());
+}
@@ -0,0 +1,221 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "../DLUtility.Averager.h"
+#include "../DLUtility.Reducers.h"
+#include "../DLUtility.HelperMacros.h"
+
+/*
+ * Private Test Functions
+ */
+
+static int compareInt32(const void * a, const void * b)
+{
+	int32_t x = *(int32_t const *)a;
+	int32_t y = *(int32_t const *)b;
+	return (x > y) - (x < y);
+}
+
+/* Reference median and trimmed mean, by sorting a copy of the samples */
+static float referenceMedian(int32_t const * samples, uint16_t n)
+{
+	int32_t sorted[256];
+	memcpy(sorted, samples, n * sizeof(int32_t));
+	qsort(sorted, n, sizeof(int32_t), compareInt32);
+	return (n & 1) ? (float)sorted[n / 2] : ((float)sorted[(n / 2) - 1] + (float)sorted[n / 2]) / 2.0f;
+}
+
+static float referenceTrimmedMean(int32_t const * samples, uint16_t n, uint8_t trimPercent)
+{
+	int32_t sorted[256];
+	uint16_t i;
+	uint16_t trim = ((uint32_t)n * trimPercent) / 100;
+	int64_t sum = 0;
+
+	memcpy(sorted, samples, n * sizeof(int32_t));
+	qsort(sorted, n, sizeof(int32_t), compareInt32);
+	for (i = trim; i < n - trim; i++) { sum += sorted[i]; }
+	return (float)sum / (float)(n - (2 * trim));
+}
+
+/*
+ * Private Test Variables
+ */
+
+static int32_t s_samples[1000];
+
+void setUp(void)
+{
+	uint16_t i;
+	srand(1);
+	for (i = 0; i < N_ELE(s_samples); i++)
+	{
+		s_samples[i] = (rand() % 2048) - 1024;
+	}
+	// Some repeated values, to check that equal samples are handled
+	for (i = 0; i < N_ELE(s_samples); i += 7) { s_samples[i] = 100; }
+}
+
+void tearDown(void) {}
+
+void test_MedianIgnoresGlitches(void)
+{
+	MedianReducer<int32_t> median = MedianReducer<int32_t>(5);
+	int32_t data[] = {500, 501, 32767, 499, 0};
+	uint8_t i;
+
+	for (i = 0; i < 5; i++) { median.newData(data[i]); }
+
+	TEST_ASSERT_EQUAL(5, median.N());
+	TEST_ASSERT_EQUAL_FLOAT(500.0f, median.getFloatResult());
+
+	median.newData(502); // Replaces 500
+	TEST_ASSERT_EQUAL_FLOAT(501.0f, median.getFloatResult());
+
+	median.restart();
+	TEST_ASSERT_EQUAL(0, median.N());
+	TEST_ASSERT_EQUAL_FLOAT(0.0f, median.getFloatResult());
+
+	median.newData(10);
+	median.newData(20);
+	TEST_ASSERT_EQUAL_FLOAT(15.0f, median.getFloatResult());
+}
+
+void test_SlidingMedianMatchesSortedWindow(void)
+{
+	const uint16_t size = 64;
+	MedianReducer<int32_t> median = MedianReducer<int32_t>(size);
+	uint16_t i;
+
+	for (i = 0; i < N_ELE(s_samples); i++)
+	{
+		median.newData(s_samples[i]);
+		uint16_t n = min(i + 1, size);
+		TEST_ASSERT_EQUAL_FLOAT(referenceMedian(&s_samples[i + 1 - n], n), median.getFloatResult());
+	}
+}
+
+void test_SlidingTrimmedMeanMatchesSortedWindow(void)
+{
+	const uint16_t size = 50;
+	TrimmedMeanReducer<int32_t> trimmedMean = TrimmedMeanReducer<int32_t>(size, 10);
+	uint16_t i;
+
+	for (i = 0; i < N_ELE(s_samples); i++)
+	{
+		trimmedMean.newData(s_samples[i]);
+		uint16_t n = min(i + 1, size);
+		TEST_ASSERT_FLOAT_WITHIN(1e-3, referenceTrimmedMean(&s_samples[i + 1 - n], n, 10), trimmedMean.getFloatResult());
+	}
+}
+
+void test_TrimmedMeanDiscardsOutliers(void)
+{
+	TrimmedMeanReducer<int32_t> trimmedMean = TrimmedMeanReducer<int32_t>(10, 10);
+	int32_t data[] = {100, 101, 99, 100, 32767, 100, 102, 98, 100, -32768};
+	uint8_t i;
+
+	for (i = 0; i < 10; i++) { trimmedMean.newData(data[i]); }
+
+	TEST_ASSERT_EQUAL_FLOAT(100.0f, trimmedMean.getFloatResult());
+}
+
+void test_EMAStartsFromFirstSampleAndConverges(void)
+{
+	EMAReducer<int32_t> ema = EMAReducer<int32_t>(9); // alpha = 0.2
+	uint16_t i;
+
+	ema.newData(100);
+	TEST_ASSERT_EQUAL_FLOAT(100.0f, ema.getFloatResult());
+
+	ema.newData(200);
+	TEST_ASSERT_EQUAL_FLOAT(120.0f, ema.getFloatResult());
+
+	// Restarting a window does not reset the filter
+	ema.restart();
+	TEST_ASSERT_EQUAL(0, ema.N());
+	TEST_ASSERT_EQUAL_FLOAT(120.0f, ema.getFloatResult());
+
+	for (i = 0; i < 200; i++) { ema.newData(200); }
+	TEST_ASSERT_FLOAT_WITHIN(1e-3, 200.0f, ema.getFloatResult());
+}
+
+void test_FirstOrderCICIsBoxcarMean(void)
+{
+	CICReducer<int32_t> cic = CICReducer<int32_t>(10, 1);
+	Averager<int32_t> averager(10, false);
+	uint16_t i;
+
+	for (i = 0; i < N_ELE(s_samples); i++)
+	{
+		cic.newData(s_samples[i]);
+		averager.newData(s_samples[i]);
+		if (averager.full())
+		{
+			TEST_ASSERT_FLOAT_WITHIN(1e-3, averager.getFloatAverage(), cic.getFloatResult());
+		}
+	}
+}
+
+void test_CICConstantInputHasNoStartupTransient(void)
+{
+	CICReducer<int32_t> cic = CICReducer<int32_t>(16, 3);
+	uint16_t i;
+
+	for (i = 0; i < 16 * 5; i++)
+	{
+		cic.newData(-1234);
+		if ((i % 16) == 15)
+		{
+			TEST_ASSERT_EQUAL_FLOAT(-1234.0f, cic.getFloatResult());
+		}
+	}
+}
+
+void test_SecondOrderCICMatchesCascadedBoxcars(void)
+{
+	const uint16_t R = 8;
+	CICReducer<int32_t> cic = CICReducer<int32_t>(R, 2);
+	int64_t firstStage[N_ELE(s_samples)];
+	int64_t secondStage;
+	uint16_t i;
+	uint16_t k;
+
+	// Reference: two moving sums of R samples, then keep every Rth output
+	for (i = 0; i < N_ELE(s_samples); i++)
+	{
+		firstStage[i] = 0;
+		for (k = 0; (k < R) && (k <= i); k++) { firstStage[i] += s_samples[i - k]; }
+
+		cic.newData(s_samples[i]);
+
+		// After the second output, the filter has seen all of its taps
+		if (((i % R) == (R - 1)) && (i >= (2 * R) - 1))
+		{
+			secondStage = 0;
+			for (k = 0; k < R; k++) { secondStage += firstStage[i - k]; }
+			TEST_ASSERT_FLOAT_WITHIN(1e-3, (float)secondStage / (float)(R * R), cic.getFloatResult());
+		}
+	}
+}
+
+int main(void)
+{
+	UnityBegin("DLUtility.Reducers.Test.cpp");
+
+	RUN_TEST(test_MedianIgnoresGlitches);
+	RUN_TEST(test_SlidingMedianMatchesSortedWindow);
+	RUN_TEST(test_SlidingTrimmedMeanMatchesSortedWindow);
+	RUN_TEST(test_TrimmedMeanDiscardsOutliers);
+	RUN_TEST(test_EMAStartsFromFirstSampleAndConverges);
+	RUN_TEST(test_FirstOrderCICIsBoxcarMean);
+	RUN_TEST(test_CICConstantInputHasNoStartupTransient);
+	RUN_TEST(test_SecondOrderCICMatchesCascadedBoxcars);
+
+	return (UnityEnd());
+}
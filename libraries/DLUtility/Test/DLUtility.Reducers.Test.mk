@@ -0,0 +1,5 @@
+SRC_FILES += ./DLUtility/DLUtility.Averager.cpp
+SRC_FILES += ./DLUtility/DLUtility.ArrayFunctions.cpp
+
+local_setup: ;
+local_teardown: ;
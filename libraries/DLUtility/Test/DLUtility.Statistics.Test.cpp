@@ -0,0 +1,108 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "unity.h"
+
+#include "../DLUtility.Statistics.h"
+
+static const int32_t s_samples[] = {512, 498, 530, 505, 1023, 0, 511, 509, 520, 490};
+#define N_SAMPLES (sizeof(s_samples) / sizeof(s_samples[0]))
+
+static void referenceStatistics(int32_t const * samples, uint32_t n, float * mean, float * stddev)
+{
+	uint32_t i;
+	double sum = 0.0;
+	double squares = 0.0;
+
+	for (i = 0; i < n; i++) { sum += samples[i]; }
+	*mean = sum / n;
+
+	for (i = 0; i < n; i++) { squares += (samples[i] - *mean) * (samples[i] - *mean); }
+	*stddev = sqrt(squares / n);
+}
+
+static void test_EmptyStatisticsAreZero(void)
+{
+	RUNNING_STATISTICS stats;
+	STATS_Reset(&stats);
+
+	TEST_ASSERT_EQUAL(0, stats.count);
+	TEST_ASSERT_EQUAL_FLOAT(0.0f, STATS_Mean(&stats));
+	TEST_ASSERT_EQUAL_FLOAT(0.0f, STATS_StdDev(&stats));
+}
+
+static void test_StatisticsMatchTwoPassCalculation(void)
+{
+	RUNNING_STATISTICS stats;
+	float mean, stddev;
+	uint32_t i;
+
+	STATS_Reset(&stats);
+	for (i = 0; i < N_SAMPLES; i++) { STATS_Add(&stats, s_samples[i]); }
+
+	referenceStatistics(s_samples, N_SAMPLES, &mean, &stddev);
+
+	TEST_ASSERT_EQUAL(N_SAMPLES, stats.count);
+	TEST_ASSERT_EQUAL(0, stats.min);
+	TEST_ASSERT_EQUAL(1023, stats.max);
+	TEST_ASSERT_FLOAT_WITHIN(1e-3, mean, STATS_Mean(&stats));
+	TEST_ASSERT_FLOAT_WITHIN(1e-3, stddev, STATS_StdDev(&stats));
+}
+
+static void test_ConstantSamplesHaveNoDeviation(void)
+{
+	RUNNING_STATISTICS stats;
+	uint32_t i;
+
+	STATS_Reset(&stats);
+	for (i = 0; i < 10000; i++) { STATS_Add(&stats, 30000); }
+
+	TEST_ASSERT_EQUAL_FLOAT(30000.0f, STATS_Mean(&stats));
+	TEST_ASSERT_EQUAL_FLOAT(0.0f, STATS_StdDev(&stats));
+}
+
+static void test_MergedStatisticsMatchSingleStream(void)
+{
+	RUNNING_STATISTICS all, first, second;
+	uint32_t i;
+
+	STATS_Reset(&all);
+	STATS_Reset(&first);
+	STATS_Reset(&second);
+
+	for (i = 0; i < N_SAMPLES; i++)
+	{
+		STATS_Add(&all, s_samples[i]);
+		STATS_Add((i < 3) ? &first : &second, s_samples[i]);
+	}
+
+	STATS_Merge(&first, &second);
+
+	TEST_ASSERT_EQUAL(all.count, first.count);
+	TEST_ASSERT_EQUAL(all.min, first.min);
+	TEST_ASSERT_EQUAL(all.max, first.max);
+	TEST_ASSERT_FLOAT_WITHIN(1e-3, STATS_Mean(&all), STATS_Mean(&first));
+	TEST_ASSERT_FLOAT_WITHIN(1e-3, STATS_StdDev(&all), STATS_StdDev(&first));
+
+	// Merging into empty statistics copies them
+	STATS_Reset(&second);
+	STATS_Merge(&second, &all);
+	TEST_ASSERT_EQUAL(all.count, second.count);
+	TEST_ASSERT_FLOAT_WITHIN(1e-3, STATS_StdDev(&all), STATS_StdDev(&second));
+}
+
+int main(void)
+{
+	UnityBegin("DLUtility.Statistics.cpp");
+
+	RUN_TEST(test_EmptyStatisticsAreZero);
+	RUN_TEST(test_StatisticsMatchTwoPassCalculation);
+	RUN_TEST(test_ConstantSamplesHaveNoDeviation);
+	RUN_TEST(test_MergedStatisticsMatchSingleStream);
+
+	return (UnityEnd());
+}